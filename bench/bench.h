@@ -0,0 +1,46 @@
+/*
+    File        : bench.h
+    Description : Timing and reporting helpers shared by the benchmarks.
+*/
+
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief Current monotonic time.
+ * 
+ * @return Time in seconds.
+ */
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Print a single benchmark result as operations per second.
+ * 
+ * @param name Name of the benchmark.
+ * @param ops Number of operations performed.
+ * @param secs Elapsed time (seconds).
+ */
+static inline void bench_report(const char *name, double ops, double secs) {
+    printf("%-40s %12.0f ops %10.4f s %14.0f ops/s\n", name, ops, secs, secs > 0 ? ops / secs : 0);
+}
+
+/**
+ * @brief Print a single benchmark result as throughput.
+ * 
+ * @param name Name of the benchmark.
+ * @param bytes Number of bytes processed.
+ * @param secs Elapsed time (seconds).
+ */
+static inline void bench_reportBytes(const char *name, double bytes, double secs) {
+    printf("%-40s %12.0f B   %10.4f s %14.1f MB/s\n", 
+        name, bytes, secs, secs > 0 ? bytes / secs / (1024 * 1024) : 0);
+}
+
+#endif // BENCH_H_INCLUDED
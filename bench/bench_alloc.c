@@ -0,0 +1,60 @@
+/*
+    File        : bench_alloc.c
+    Description : Benchmarks for the Dynamic Memory Allocator Library.
+*/
+
+#include "alloc.h"
+#include "darr.h"
+#include "bench.h"
+
+#define APPEND_COUNT 10000000
+#define CHURN_ROUNDS 10000
+#define CHURN_LIVE 100
+#define RESIZE_COUNT 10000000
+
+static void benchAppend(const char *name, AllocStrategy strat) {
+    DArr *d = darr_new(0, sizeof(int), strat);
+    if (d == NULL) return;
+
+    double start = bench_now();
+    for (int i = 0; i < APPEND_COUNT; i++) darr_append(d, &i, 1);
+    bench_report(name, APPEND_COUNT, bench_now() - start);
+
+    darr_free(d);
+}
+
+static void benchChurn(const char *name) {
+    DArr *arrs[CHURN_LIVE];
+
+    double start = bench_now();
+    for (int r = 0; r < CHURN_ROUNDS; r++) {
+        for (int i = 0; i < CHURN_LIVE; i++) arrs[i] = darr_new(4, sizeof(int), ALLOC_STRAT_DYNAMIC);
+        for (int i = 0; i < CHURN_LIVE; i++) darr_free(arrs[i]);
+    }
+    bench_report(name, (double)CHURN_ROUNDS * CHURN_LIVE, bench_now() - start);
+}
+
+static void benchResize(const char *name) {
+    AllocBlock *b = alloc_new(1 << 20, ALLOC_STRAT_BUDDY);
+    if (b == NULL) return;
+
+    // Every size in (2^19, 2^20] rounds to the same buddy size, so only the rounding is measured
+    unsigned int seed = 1;
+    double start = bench_now();
+    for (int i = 0; i < RESIZE_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        alloc_resize(b, ((size_t)1 << 19) + 1 + (seed % ((size_t)1 << 19)));
+    }
+    bench_report(name, RESIZE_COUNT, bench_now() - start);
+
+    alloc_free(b);
+}
+
+int main(void) {
+    benchAppend("darr_append (ALLOC_STRAT_DYNAMIC)", ALLOC_STRAT_DYNAMIC);
+    benchAppend("darr_append (ALLOC_STRAT_BUDDY)", ALLOC_STRAT_BUDDY);
+    benchAppend("darr_append (ALLOC_STRAT_GEOMETRIC)", ALLOC_STRAT_GEOMETRIC);
+    benchChurn("darr_new/darr_free churn");
+    benchResize("alloc_resize (ALLOC_STRAT_BUDDY)");
+    return 0;
+}
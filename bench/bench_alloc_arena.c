@@ -0,0 +1,38 @@
+/*
+    File        : bench_alloc_arena.c
+    Description : Benchmarks for the Arena (bump pointer) allocator.
+*/
+
+#include "alloc_arena.h"
+#include "darr.h"
+#include "bench.h"
+
+#define REQUESTS 10000
+#define ARRAYS_PER_REQUEST 100
+#define ITEMS_PER_ARRAY 16
+
+static void benchChurn(const char *name, Arena *a) {
+    DArr *arrs[ARRAYS_PER_REQUEST];
+
+    double start = bench_now();
+    for (int r = 0; r < REQUESTS; r++) {
+        for (int i = 0; i < ARRAYS_PER_REQUEST; i++) {
+            arrs[i] = darr_newIn(a, 0, sizeof(int), ALLOC_STRAT_GEOMETRIC);
+            for (int j = 0; j < ITEMS_PER_ARRAY; j++) darr_append(arrs[i], &j, 1);
+        }
+        if (a) {
+            arena_reset(a);
+        } else {
+            for (int i = 0; i < ARRAYS_PER_REQUEST; i++) darr_free(arrs[i]);
+        }
+    }
+    bench_report(name, (double)REQUESTS * ARRAYS_PER_REQUEST, bench_now() - start);
+}
+
+int main(void) {
+    Arena *a = arena_new(0);
+    benchChurn("darr_new/darr_free churn (malloc)", NULL);
+    benchChurn("darr_newIn/arena_reset churn (arena)", a);
+    arena_free(a);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+    File        : bench_alloc_buddy.c
+    Description : Benchmarks for the Buddy system allocator.
+*/
+
+#include <stdio.h>
+
+#include "alloc.h"
+#include "alloc_buddy.h"
+#include "bench.h"
+
+#define HEAP_SIZE (64 << 20)
+#define BLOCKS 64
+#define APPENDS 100000
+#define CHURN_OPS 10000000
+#define CHURN_LIVE 1024
+#define CHURN_MAX 4096
+
+static void benchAppend(const char *name, Buddy *h) {
+    AllocBlock *blocks[BLOCKS];
+    for (int i = 0; i < BLOCKS; i++) blocks[i] = alloc_newBuddy(h, 0);
+
+    // Interleaved growth of many blocks
+    double start = bench_now();
+    for (int n = 0; n < APPENDS; n++) {
+        for (int i = 0; i < BLOCKS; i++) alloc_append(blocks[i], &n, sizeof(n));
+    }
+    bench_report(name, (double)APPENDS * BLOCKS, bench_now() - start);
+
+    for (int i = 0; i < BLOCKS; i++) alloc_free(blocks[i]);
+}
+
+static void benchChurn(const char *name, Buddy *h) {
+    void *live[CHURN_LIVE] = { 0 };
+    unsigned int seed = 1;
+
+    // Random sized allocations replacing random live ones
+    double start = bench_now();
+    for (int n = 0; n < CHURN_OPS; n++) {
+        seed = seed * 1103515245 + 12345;
+        size_t i = (seed >> 8) % CHURN_LIVE;
+        size_t size = 1 + (seed >> 16) % CHURN_MAX;
+        if (h) {
+            buddy_release(h, live[i]);
+            live[i] = buddy_alloc(h, size);
+        } else {
+            free(live[i]);
+            live[i] = malloc(size);
+        }
+    }
+    bench_report(name, CHURN_OPS, bench_now() - start);
+
+    if (h) {
+        BuddyStats s = buddy_stats(h);
+        printf("  buddy heap: %zu used, %zu free in %zu blocks, fragmentation %.3f\n", 
+            s.used, s.free, s.freeBlocks, s.fragmentation);
+    }
+    for (int i = 0; i < CHURN_LIVE; i++) h ? buddy_release(h, live[i]) : free(live[i]);
+}
+
+int main(void) {
+    Buddy *h = buddy_new(HEAP_SIZE, 0);
+    benchAppend("alloc_append ALLOC_STRAT_BUDDY (realloc)", NULL);
+    benchAppend("alloc_append ALLOC_STRAT_BUDDY (buddy heap)", h);
+    benchChurn("alloc/release churn (malloc)", NULL);
+    benchChurn("alloc/release churn (buddy heap)", h);
+    buddy_free(h);
+    return 0;
+}
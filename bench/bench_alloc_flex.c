@@ -0,0 +1,58 @@
+/*
+    File        : bench_alloc_flex.c
+    Description : Benchmarks for the single allocation FlexBlock against AllocBlock.
+*/
+
+#include "alloc.h"
+#include "alloc_flex.h"
+#include "bench.h"
+
+#define BLOCKS 100000
+#define ITEMS 8
+#define LOOKUPS 10000000
+
+int main(void) {
+    static AllocBlock *blocks[BLOCKS];
+    static FlexBlock *flexes[BLOCKS];
+    double start;
+
+    // Creation
+    start = bench_now();
+    for (int i = 0; i < BLOCKS; i++) {
+        blocks[i] = alloc_new(ITEMS * sizeof(int), ALLOC_STRAT_DYNAMIC);
+        for (int j = 0; j < ITEMS; j++) alloc_append(blocks[i], &j, sizeof(int));
+    }
+    bench_report("alloc_new + append", BLOCKS, bench_now() - start);
+
+    start = bench_now();
+    for (int i = 0; i < BLOCKS; i++) {
+        flexes[i] = flex_new(ITEMS * sizeof(int), ALLOC_STRAT_DYNAMIC);
+        for (int j = 0; j < ITEMS; j++) flexes[i] = flex_append(flexes[i], &j, sizeof(int));
+    }
+    bench_report("flex_new + append", BLOCKS, bench_now() - start);
+
+    // Random indexing across many blocks (cache misses dominate)
+    unsigned seed = 1;
+    long sum = 0;
+    start = bench_now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        sum += *(int*)alloc_index(blocks[seed % BLOCKS], (seed >> 8) % ITEMS * sizeof(int));
+    }
+    bench_report("alloc_index (random blocks)", LOOKUPS, bench_now() - start);
+
+    seed = 1;
+    start = bench_now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        sum += *(int*)flex_index(flexes[seed % BLOCKS], (seed >> 8) % ITEMS * sizeof(int));
+    }
+    bench_report("flex_index (random blocks)", LOOKUPS, bench_now() - start);
+
+    for (int i = 0; i < BLOCKS; i++) {
+        alloc_free(blocks[i]);
+        flex_free(flexes[i]);
+    }
+
+    return sum == 42; // Keep the lookups from being optimised away
+}
@@ -0,0 +1,32 @@
+/*
+    File        : bench_alloc_pool.c
+    Description : Benchmarks for the Pool (slab) allocator.
+*/
+
+#include "alloc_pool.h"
+#include "alloc.h"
+#include "bench.h"
+
+#define ROUNDS 10000
+#define LIVE 100
+
+static void benchHeaders(const char *name, bool pooled) {
+    void *objs[LIVE];
+
+    double start = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < LIVE; i++) 
+            objs[i] = pooled ? pool_allocSmall(sizeof(AllocBlock)) : malloc(sizeof(AllocBlock));
+        for (int i = 0; i < LIVE; i++) {
+            if (pooled) pool_releaseSmall(objs[i], sizeof(AllocBlock));
+            else free(objs[i]);
+        }
+    }
+    bench_report(name, (double)ROUNDS * LIVE, bench_now() - start);
+}
+
+int main(void) {
+    benchHeaders("AllocBlock header (malloc/free)", false);
+    benchHeaders("AllocBlock header (pool)", true);
+    return 0;
+}
@@ -0,0 +1,44 @@
+/*
+    File        : bench_darr.c
+    Description : Benchmarks for the Dynamic Array Library.
+*/
+
+#include "darr.h"
+#include "bench.h"
+
+#define ITEM_COUNT 1000000
+#define EDIT_COUNT 20000
+#define JUMP_EVERY 1000
+
+/**
+ * @brief Edit an array of ITEM_COUNT ints the way an editor does: inserts and backspaces around a
+ * cursor, which jumps to a random position every JUMP_EVERY edits.
+ */
+static void benchEdits(const char *name, bool gap) {
+    DArr *d = darr_new(ITEM_COUNT, sizeof(int), ALLOC_STRAT_GEOMETRIC);
+    if (d == NULL) return;
+    for (int i = 0; i < ITEM_COUNT; i++) darr_append(d, &i, 1);
+    darr_setGap(d, gap);
+
+    unsigned int seed = 1;
+    size_t cursor = ITEM_COUNT / 2;
+    double start = bench_now();
+    for (int i = 0; i < EDIT_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        if (i % JUMP_EVERY == 0) cursor = (seed >> 4) % darr_len(d);
+        if ((seed >> 16) % 4 == 0 && cursor > 0) {
+            darr_remove(d, --cursor, 1);
+        } else {
+            darr_insert(d, &i, cursor++, 1);
+        }
+    }
+    bench_report(name, EDIT_COUNT, bench_now() - start);
+
+    darr_free(d);
+}
+
+int main(void) {
+    benchEdits("edits around a cursor (plain)", false);
+    benchEdits("edits around a cursor (gap buffer)", true);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+    File        : bench_deque.c
+    Description : Benchmarks for the ring buffer deque, against a DArr used as a queue.
+*/
+
+#include "darr.h"
+#include "deque.h"
+#include "bench.h"
+
+#define QUEUE_DEPTH 10000
+#define OP_COUNT 200000
+#define BULK_COUNT 64
+
+/**
+ * @brief Work queue on a DArr: push at the back, pop with darr_remove at the front.
+ */
+static void benchDArr(const char *name) {
+    DArr *d = darr_new(0, sizeof(size_t), ALLOC_STRAT_GEOMETRIC);
+    if (d == NULL) return;
+    for (size_t i = 0; i < QUEUE_DEPTH; i++) darr_append(d, &i, 1);
+
+    size_t sum = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < OP_COUNT; i++) {
+        sum += *(size_t*)darr_first(d);
+        darr_remove(d, 0, 1);
+        darr_append(d, &i, 1);
+    }
+    bench_report(name, OP_COUNT, bench_now() - start);
+    if (sum == 0) printf("  empty queue\n");
+
+    darr_free(d);
+}
+
+static void benchDeque(const char *name) {
+    Deque *q = deque_new(QUEUE_DEPTH, sizeof(size_t));
+    if (q == NULL) return;
+    for (size_t i = 0; i < QUEUE_DEPTH; i++) deque_pushBack(q, &i, 1);
+
+    size_t sum = 0, item;
+    double start = bench_now();
+    for (size_t i = 0; i < OP_COUNT; i++) {
+        deque_popFront(q, &item, 1);
+        sum += item;
+        deque_pushBack(q, &i, 1);
+    }
+    bench_report(name, OP_COUNT, bench_now() - start);
+    if (sum == 0) printf("  empty queue\n");
+
+    deque_free(q);
+}
+
+/**
+ * @brief Items enqueued BULK_COUNT at a time, consumed in place through the spans.
+ */
+static void benchDequeBulk(const char *name) {
+    Deque *q = deque_new(QUEUE_DEPTH, sizeof(size_t));
+    if (q == NULL) return;
+    size_t items[BULK_COUNT];
+    for (size_t i = 0; i < BULK_COUNT; i++) items[i] = i;
+    for (size_t i = 0; i < QUEUE_DEPTH / BULK_COUNT; i++) deque_pushBack(q, items, BULK_COUNT);
+
+    size_t sum = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < OP_COUNT / BULK_COUNT; i++) {
+        size_t len, done = 0;
+        while (done < BULK_COUNT) {
+            size_t *span = (size_t*)deque_span(q, 0, &len);
+            len = math_min(len, BULK_COUNT - done);
+            for (size_t j = 0; j < len; j++) sum += span[j];
+            done += deque_popFront(q, NULL, len);
+        }
+        deque_pushBack(q, items, BULK_COUNT);
+    }
+    bench_report(name, (double)(OP_COUNT / BULK_COUNT) * BULK_COUNT, bench_now() - start);
+    if (sum == 0) printf("  empty queue\n");
+
+    deque_free(q);
+}
+
+int main(void) {
+    benchDArr("queue darr_remove front/darr_append");
+    benchDeque("queue deque_popFront/deque_pushBack");
+    benchDequeBulk("queue deque spans, bulk of 64");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+    File        : bench_file.c
+    Description : Benchmarks for the File Operations.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file.h"
+#include "file_reader.h"
+#include "bench.h"
+
+#define PATH_BENCH_FILE "/tmp/clib_bench_file.txt"
+#define PATH_BENCH_COPY "/tmp/clib_bench_file_copy.txt"
+#define LINE_LEN 100
+
+/**
+ * @brief Write a file of `lines` lines of LINE_LEN bytes (including the newline).
+ */
+static bool writeFile(const char *path, size_t lines) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return false;
+    char line[LINE_LEN];
+    memset(line, 'A', LINE_LEN - 1);
+    line[LINE_LEN - 1] = '\n';
+    for (size_t i = 0; i < lines; i++) fwrite(line, 1, LINE_LEN, f);
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief Count the lines of a buffer.
+ */
+static size_t countLines(const char *data, size_t size) {
+    size_t lines = 0;
+    const char *end = data + size;
+    for (const char *p = data; (p = memchr(p, '\n', (size_t)(end - p))) != NULL; p++) lines++;
+    return lines;
+}
+
+/**
+ * @brief Previous file_read: line by line with getline, appended to a growing block.
+ */
+static char *readLines(const char *path, size_t *size, size_t *capacity) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return NULL;
+
+    AllocBlock *block = alloc_new(1024, ALLOC_STRAT_BUDDY);
+    size_t buffSize = 0;
+    ssize_t lineLen = 0;
+    char *line = NULL;
+    while ((lineLen = getline(&line, &buffSize, f)) != -1) alloc_append(block, line, lineLen);
+    free(line);
+    fclose(f);
+
+    *size = alloc_getUsed(block);
+    return (char*)alloc_detach(block, capacity);
+}
+
+static void benchRead(const char *name, const char *path, size_t lines, bool legacy) {
+    size_t size = 0, capacity = 0;
+    double start = bench_now();
+    char *text = legacy ? readLines(path, &size, &capacity) : file_read(path, &size);
+    size_t count = text ? countLines(text, size) : 0;
+    bench_reportBytes(name, (double)LINE_LEN * lines, bench_now() - start);
+    if (count != lines) printf("  unexpected line count %zu\n", count);
+    if (legacy) mem_free(text, capacity);
+    else free(text);
+}
+
+static void benchCopy(const char *name, const char *src, const char *dst, size_t lines,
+    bool legacy) {
+    remove(dst);
+    double start = bench_now();
+    bool ok;
+    if (legacy) {
+        // Whole file through user space: read into a buffer, written back out
+        size_t size;
+        char *text = file_read(src, &size);
+        ok = text != NULL && file_write(dst, text, size, false);
+        free(text);
+    } else {
+        ok = file_copy(src, dst, NULL, NULL);
+    }
+    bench_reportBytes(name, (double)LINE_LEN * lines, bench_now() - start);
+    if (!ok) printf("  copy failed\n");
+}
+
+static void benchMap(const char *name, const char *path, size_t lines, FileAccess access) {
+    double start = bench_now();
+    FileView view;
+    size_t count = file_map(path, access, &view) ? countLines(view.data, view.size) : 0;
+    file_unmap(&view);
+    bench_reportBytes(name, (double)LINE_LEN * lines, bench_now() - start);
+    if (count != lines) printf("  unexpected line count %zu\n", count);
+}
+
+static void benchReader(const char *name, const char *path, size_t lines) {
+    double start = bench_now();
+    Reader *r = reader_open(path, 0, FILE_ACCESS_SEQUENTIAL);
+    const char *line;
+    size_t len, count = 0;
+    while (r != NULL && reader_line(r, &line, &len)) count++;
+    reader_free(r);
+    bench_reportBytes(name, (double)LINE_LEN * lines, bench_now() - start);
+    if (count != lines) printf("  unexpected line count %zu\n", count);
+}
+
+int main(void) {
+    const size_t sizes[] = { 1 << 20, 100 << 20, 1 << 30 };
+    const char *labels[] = { "1 MB", "100 MB", "1 GB" };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t lines = sizes[i] / LINE_LEN;
+        if (!writeFile(PATH_BENCH_FILE, lines)) return 1;
+
+        char name[64];
+        snprintf(name, sizeof(name), "getline + append + scan (%s)", labels[i]);
+        benchRead(name, PATH_BENCH_FILE, lines, true);
+        snprintf(name, sizeof(name), "file_read + scan (%s)", labels[i]);
+        benchRead(name, PATH_BENCH_FILE, lines, false);
+        snprintf(name, sizeof(name), "reader_line (%s)", labels[i]);
+        benchReader(name, PATH_BENCH_FILE, lines);
+        snprintf(name, sizeof(name), "file_map + scan (%s)", labels[i]);
+        benchMap(name, PATH_BENCH_FILE, lines, FILE_ACCESS_NORMAL);
+        snprintf(name, sizeof(name), "file_map + scan sequential (%s)", labels[i]);
+        benchMap(name, PATH_BENCH_FILE, lines, FILE_ACCESS_SEQUENTIAL);
+        snprintf(name, sizeof(name), "file_read + file_write copy (%s)", labels[i]);
+        benchCopy(name, PATH_BENCH_FILE, PATH_BENCH_COPY, lines, true);
+        snprintf(name, sizeof(name), "file_copy (%s)", labels[i]);
+        benchCopy(name, PATH_BENCH_FILE, PATH_BENCH_COPY, lines, false);
+    }
+
+    remove(PATH_BENCH_FILE);
+    remove(PATH_BENCH_COPY);
+    return 0;
+}
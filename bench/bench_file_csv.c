@@ -0,0 +1,110 @@
+/*
+    File        : bench_file_csv.c
+    Description : Benchmarks for the delimited text parser.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file_csv.h"
+#include "bench.h"
+
+#define PATH_BENCH_FILE "/tmp/clib_bench_file_csv.csv"
+#define ROW_COUNT 2000000
+
+static const CsvType _types[] = { CSV_INT, CSV_STR, CSV_DOUBLE, CSV_STR, CSV_INT };
+
+/**
+ * @brief Write a CSV file of ROW_COUNT rows (id, name, price, quoted comment, quantity).
+ */
+static size_t writeFile(const char *path, bool quoted) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return 0;
+    fprintf(f, "id,name,price,comment,quantity\n");
+    for (size_t i = 0; i < ROW_COUNT; i++) {
+        if (quoted) {
+            fprintf(f, "%zu,item_%zu,%zu.%02zu,\"a \"\"quoted\"\", comment\",%zu\n",
+                i, i % 9973, i % 1000, i % 100, i % 37);
+        } else {
+            fprintf(f, "%zu,item_%zu,%zu.%02zu,a plain comment of some length,%zu\n",
+                i, i % 9973, i % 1000, i % 100, i % 37);
+        }
+    }
+    long size = ftell(f);
+    return fclose(f) == 0 && size > 0 ? (size_t)size : 0;
+}
+
+/**
+ * @brief Parse by hand, the way files were loaded before: file_read, then strtok_r and the strto
+ * functions, a strdup per string field.
+ */
+static size_t parseByHand(const char *path) {
+    size_t size;
+    char *text = file_read(path, &size);
+    if (text == NULL) return 0;
+
+    DArr *ids = darr_new(0, sizeof(int64_t), ALLOC_STRAT_GEOMETRIC);
+    DArr *names = darr_new(0, sizeof(char*), ALLOC_STRAT_GEOMETRIC);
+    DArr *prices = darr_new(0, sizeof(double), ALLOC_STRAT_GEOMETRIC);
+    char *lineSave, *line = strtok_r(text, "\n", &lineSave); // Header
+    while ((line = strtok_r(NULL, "\n", &lineSave)) != NULL) {
+        char *fieldSave;
+        int64_t id = strtoll(strtok_r(line, ",", &fieldSave), NULL, 10);
+        char *name = strdup(strtok_r(NULL, ",", &fieldSave));
+        double price = strtod(strtok_r(NULL, ",", &fieldSave), NULL);
+        darr_append(ids, &id, 1);
+        darr_append(names, &name, 1);
+        darr_append(prices, &price, 1);
+    }
+
+    size_t rows = darr_len(ids);
+    for (size_t i = 0; i < rows; i++) free(*(char**)darr_index(names, i));
+    darr_free(ids);
+    darr_free(names);
+    darr_free(prices);
+    free(text);
+    return rows;
+}
+
+static void benchByHand(const char *name, const char *path, size_t size) {
+    double start = bench_now();
+    size_t rows = parseByHand(path);
+    bench_reportBytes(name, (double)size, bench_now() - start);
+    if (rows != ROW_COUNT) printf("  unexpected row count %zu\n", rows);
+}
+
+static void benchCsv(const char *name, const char *path, size_t size, size_t batch) {
+    double start = bench_now();
+    Csv *c = csv_open(path, ',', _types, sizeof(_types) / sizeof(_types[0]), true);
+    size_t rows = 0, n;
+    while ((n = csv_read(c, batch)) > 0) {
+        rows += n;
+        if (batch > 0) csv_clear(c);
+    }
+    bool error = csv_error(c);
+    csv_free(c);
+    bench_reportBytes(name, (double)size, bench_now() - start);
+    if (rows != ROW_COUNT || error) printf("  unexpected row count %zu\n", rows);
+}
+
+int main(void) {
+    for (int quoted = 0; quoted < 2; quoted++) {
+        size_t size = writeFile(PATH_BENCH_FILE, quoted);
+        if (size == 0) return 1;
+
+        const char *label = quoted ? "quoted" : "plain";
+        char name[64];
+        if (!quoted) {
+            // strtok cannot split quoted fields
+            snprintf(name, sizeof(name), "file_read + strtok + strdup (%s)", label);
+            benchByHand(name, PATH_BENCH_FILE, size);
+        }
+        snprintf(name, sizeof(name), "csv_read whole file (%s)", label);
+        benchCsv(name, PATH_BENCH_FILE, size, 0);
+        snprintf(name, sizeof(name), "csv_read batches of 10k (%s)", label);
+        benchCsv(name, PATH_BENCH_FILE, size, 10000);
+    }
+
+    remove(PATH_BENCH_FILE);
+    return 0;
+}
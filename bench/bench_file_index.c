@@ -0,0 +1,85 @@
+/*
+    File        : bench_file_index.c
+    Description : Benchmarks for the line offset index.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file_index.h"
+#include "bench.h"
+
+#define PATH_BENCH_FILE "/tmp/clib_bench_file_index.txt"
+#define LINE_COUNT 5000000
+
+/**
+ * @brief Write a file of LINE_COUNT lines of varying length (1 to 199 bytes with the newline).
+ */
+static size_t writeFile(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return 0;
+    char line[200];
+    memset(line, 'A', sizeof(line));
+    size_t size = 0;
+    for (size_t i = 0; i < LINE_COUNT; i++) {
+        size_t len = (i * 37) % 199 + 1;
+        line[len - 1] = '\n';
+        fwrite(line, 1, len, f);
+        line[len - 1] = 'A';
+        size += len;
+    }
+    return fclose(f) == 0 ? size : 0;
+}
+
+static void benchGetline(const char *name, const char *path, size_t size) {
+    double start = bench_now();
+    FILE *f = fopen(path, "r");
+    DArr *idx = darr_new(0, sizeof(size_t), ALLOC_STRAT_GEOMETRIC);
+    char *line = NULL;
+    size_t buffSize = 0, off = 0;
+    ssize_t len;
+    while ((len = getline(&line, &buffSize, f)) != -1) {
+        darr_append(idx, &off, 1);
+        off += (size_t)len;
+    }
+    free(line);
+    fclose(f);
+    bench_reportBytes(name, (double)size, bench_now() - start);
+    if (darr_len(idx) != LINE_COUNT) printf("  unexpected line count %zu\n", darr_len(idx));
+    darr_free(idx);
+}
+
+static void benchBuild(const char *name, const char *path, size_t size, unsigned threads) {
+    double start = bench_now();
+    FileView view;
+    file_map(path, FILE_ACCESS_SEQUENTIAL, &view);
+    DArr *idx = index_build(view.data, view.size, threads);
+    file_unmap(&view);
+    bench_reportBytes(name, (double)size, bench_now() - start);
+    if (darr_len(idx) != LINE_COUNT) printf("  unexpected line count %zu\n", darr_len(idx));
+    darr_free(idx);
+}
+
+static void benchOpen(const char *name, const char *path, size_t size) {
+    double start = bench_now();
+    DArr *idx = index_open(path, 0);
+    bench_reportBytes(name, (double)size, bench_now() - start);
+    if (darr_len(idx) != LINE_COUNT) printf("  unexpected line count %zu\n", darr_len(idx));
+    darr_free(idx);
+}
+
+int main(void) {
+    size_t size = writeFile(PATH_BENCH_FILE);
+    if (size == 0) return 1;
+
+    benchGetline("getline offsets", PATH_BENCH_FILE, size);
+    benchBuild("index_build (1 thread)", PATH_BENCH_FILE, size, 1);
+    benchBuild("index_build (all cores)", PATH_BENCH_FILE, size, 0);
+    remove(PATH_BENCH_FILE INDEX_SUFFIX);
+    benchOpen("index_open (build + save sidecar)", PATH_BENCH_FILE, size);
+    benchOpen("index_open (load sidecar)", PATH_BENCH_FILE, size);
+
+    remove(PATH_BENCH_FILE INDEX_SUFFIX);
+    remove(PATH_BENCH_FILE);
+    return 0;
+}
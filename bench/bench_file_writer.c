@@ -0,0 +1,62 @@
+/*
+    File        : bench_file_writer.c
+    Description : Benchmarks for the buffered file writer.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file_writer.h"
+#include "bench.h"
+
+#define PATH_BENCH_FILE "/tmp/clib_bench_file_writer.txt"
+#define RECORDS 5000000
+
+static void benchFormattedStdio(const char *name) {
+    double start = bench_now();
+    FILE *f = fopen(PATH_BENCH_FILE, "w");
+    for (int i = 0; i < RECORDS; i++) fprintf(f, "%d,%.3f,record\n", i, i * 0.25);
+    fclose(f);
+    bench_report(name, RECORDS, bench_now() - start);
+}
+
+static void benchFormattedWriter(const char *name) {
+    double start = bench_now();
+    Writer *w = writer_open(PATH_BENCH_FILE, 0);
+    for (int i = 0; i < RECORDS; i++) {
+        writer_int(w, i);
+        writer_write(w, ",", 1);
+        writer_double(w, i * 0.25, 3);
+        writer_write(w, ",record\n", 8);
+    }
+    writer_free(w);
+    bench_report(name, RECORDS, bench_now() - start);
+}
+
+static void benchRawStdio(const char *name, const char *record, size_t size) {
+    double start = bench_now();
+    FILE *f = fopen(PATH_BENCH_FILE, "w");
+    for (int i = 0; i < RECORDS; i++) fwrite(record, 1, size, f);
+    fclose(f);
+    bench_report(name, RECORDS, bench_now() - start);
+}
+
+static void benchRawWriter(const char *name, const char *record, size_t size) {
+    double start = bench_now();
+    Writer *w = writer_open(PATH_BENCH_FILE, 0);
+    for (int i = 0; i < RECORDS; i++) writer_write(w, record, size);
+    writer_free(w);
+    bench_report(name, RECORDS, bench_now() - start);
+}
+
+int main(void) {
+    const char record[] = "0123456789,0123456789,0123456789\n";
+
+    benchFormattedStdio("int,double,str records (fprintf)");
+    benchFormattedWriter("int,double,str records (writer)");
+    benchRawStdio("33 byte records (fwrite)", record, sizeof(record) - 1);
+    benchRawWriter("33 byte records (writer_write)", record, sizeof(record) - 1);
+
+    remove(PATH_BENCH_FILE);
+    return 0;
+}
@@ -0,0 +1,37 @@
+/*
+    File        : bench_mem.c
+    Description : Benchmarks for the dynamic memory management operations.
+*/
+
+#include "alloc.h"
+#include "mem.h"
+#include "bench.h"
+
+#define ALLOC_COUNT 10000000
+#define APPEND_COUNT 10000000
+
+static void benchAlloc(const char *name) {
+    double start = bench_now();
+    for (int i = 0; i < ALLOC_COUNT; i++) mem_free(mem_alloc(64), 64);
+    bench_report(name, ALLOC_COUNT, bench_now() - start);
+}
+
+static void benchAppend(const char *name) {
+    AllocBlock *b = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    if (b == NULL) return;
+
+    double start = bench_now();
+    for (int i = 0; i < APPEND_COUNT; i++) alloc_append(b, &i, sizeof(i));
+    bench_report(name, APPEND_COUNT, bench_now() - start);
+
+    alloc_free(b);
+}
+
+int main(void) {
+    benchAlloc("mem_alloc/mem_free (stats off)");
+    benchAppend("alloc_append DYNAMIC (stats off)");
+    mem_enableStats(true);
+    benchAlloc("mem_alloc/mem_free (stats on)");
+    benchAppend("alloc_append DYNAMIC (stats on)");
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+    File        : bench_mpmc.c
+    Description : Benchmarks for the multi producer multi consumer queue, against a Deque behind a
+                  mutex and condition variables, at 1 to 16 producers and consumers.
+*/
+
+#include <pthread.h>
+
+#include "deque.h"
+#include "mpmc.h"
+#include "bench.h"
+
+#define ITEM_COUNT 2000000
+#define QUEUE_SIZE 1024
+#define MAX_THREADS 16
+
+// Record moved between the threads
+typedef struct {
+    const char *data;
+    size_t len;
+} Record;
+
+// Deque with blocking push and pop, as a work queue is usually written
+typedef struct {
+    Deque *q;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty, notFull;
+    bool closed;
+} LockedQueue;
+
+typedef struct {
+    Mpmc *mpmc;
+    LockedQueue *locked;
+    size_t items; // Items to push (producers)
+    size_t sum; // Sum of the lengths popped (consumers)
+} Worker;
+
+static void lockedPush(LockedQueue *l, const Record *r) {
+    pthread_mutex_lock(&l->lock);
+    while (deque_len(l->q) == QUEUE_SIZE) pthread_cond_wait(&l->notFull, &l->lock);
+    deque_pushBack(l->q, r, 1);
+    pthread_cond_signal(&l->notEmpty);
+    pthread_mutex_unlock(&l->lock);
+}
+
+static bool lockedPop(LockedQueue *l, Record *r) {
+    pthread_mutex_lock(&l->lock);
+    while (deque_isEmpty(l->q) && !l->closed) pthread_cond_wait(&l->notEmpty, &l->lock);
+    bool got = deque_popFront(l->q, r, 1) == 1;
+    if (got) pthread_cond_signal(&l->notFull);
+    pthread_mutex_unlock(&l->lock);
+    return got;
+}
+
+static void *produce(void *arg) {
+    Worker *w = (Worker*)arg;
+    for (size_t i = 0; i < w->items; i++) {
+        Record r = { NULL, i };
+        if (w->mpmc != NULL) mpmc_push(w->mpmc, &r);
+        else lockedPush(w->locked, &r);
+    }
+    return NULL;
+}
+
+static void *consume(void *arg) {
+    Worker *w = (Worker*)arg;
+    Record r;
+    if (w->mpmc != NULL) while (mpmc_pop(w->mpmc, &r)) w->sum += r.len;
+    else while (lockedPop(w->locked, &r)) w->sum += r.len;
+    return NULL;
+}
+
+/**
+ * @brief Move ITEM_COUNT records from `threads` producers to `threads` consumers.
+ */
+static void benchQueue(const char *name, int threads, bool locked) {
+    Mpmc *q = NULL;
+    LockedQueue l = { .closed = false };
+    if (locked) {
+        l.q = deque_new(QUEUE_SIZE, sizeof(Record));
+        pthread_mutex_init(&l.lock, NULL);
+        pthread_cond_init(&l.notEmpty, NULL);
+        pthread_cond_init(&l.notFull, NULL);
+    } else {
+        q = mpmc_new(QUEUE_SIZE, sizeof(Record));
+    }
+
+    pthread_t producers[MAX_THREADS], consumers[MAX_THREADS];
+    Worker p[MAX_THREADS], c[MAX_THREADS];
+    size_t perProducer = ITEM_COUNT / (size_t)threads;
+    double start = bench_now();
+    for (int i = 0; i < threads; i++) {
+        p[i] = (Worker){ q, &l, perProducer, 0 };
+        c[i] = (Worker){ q, &l, 0, 0 };
+        pthread_create(&consumers[i], NULL, consume, &c[i]);
+        pthread_create(&producers[i], NULL, produce, &p[i]);
+    }
+    for (int i = 0; i < threads; i++) pthread_join(producers[i], NULL);
+    if (locked) {
+        pthread_mutex_lock(&l.lock);
+        l.closed = true;
+        pthread_cond_broadcast(&l.notEmpty);
+        pthread_mutex_unlock(&l.lock);
+    } else {
+        mpmc_close(q);
+    }
+    size_t sum = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(consumers[i], NULL);
+        sum += c[i].sum;
+    }
+    bench_report(name, (double)perProducer * threads, bench_now() - start);
+    if (sum != (size_t)threads * perProducer * (perProducer - 1) / 2) printf("  items lost\n");
+
+    if (locked) {
+        pthread_cond_destroy(&l.notFull);
+        pthread_cond_destroy(&l.notEmpty);
+        pthread_mutex_destroy(&l.lock);
+        deque_free(l.q);
+    } else {
+        mpmc_free(q);
+    }
+}
+
+int main(void) {
+    char name[64];
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        snprintf(name, sizeof(name), "deque + mutex/cond (%dP/%dC)", threads, threads);
+        benchQueue(name, threads, true);
+        snprintf(name, sizeof(name), "mpmc blocking (%dP/%dC)", threads, threads);
+        benchQueue(name, threads, false);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+    File        : bench_scan.c
+    Description : Benchmarks for the byte search kernels, against memchr and plain loops.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan.h"
+#include "bench.h"
+
+#define SIZE (64 * 1024 * 1024)
+#define REPEAT 8
+
+static const char *_levels[] = { "scalar", "sse2", "avx2", "avx512" };
+
+/**
+ * @brief Fill a buffer with text lines of 1 to 199 bytes, fields separated by commas.
+ */
+static void fill(char *buff, size_t size) {
+    for (size_t i = 0, lineLen = 1, col = 0; i < size; i++, col++) {
+        if (col == lineLen) {
+            buff[i] = '\n';
+            col = (size_t)-1;
+            lineLen = (lineLen * 37) % 199 + 1;
+        } else {
+            buff[i] = col % 16 == 15 ? ',' : (char)('a' + i % 26);
+        }
+    }
+}
+
+static void benchLinesMemchr(const char *buff, size_t size) {
+    size_t lines = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) {
+        const char *p = buff, *end = buff + size;
+        while ((p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) { p++; lines++; }
+    }
+    bench_reportBytes("lines memchr", (double)size * REPEAT, bench_now() - start);
+    if (lines == 0) printf("  no lines\n");
+}
+
+static void benchLinesScan(const char *buff, size_t size, const char *name) {
+    size_t lines = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) {
+        const char *p = buff, *end = buff + size;
+        while ((p = scan_byte(p, (size_t)(end - p), '\n')) != NULL) { p++; lines++; }
+    }
+    bench_reportBytes(name, (double)size * REPEAT, bench_now() - start);
+    if (lines == 0) printf("  no lines\n");
+}
+
+static void benchMissMemchr(const char *buff, size_t size) {
+    size_t found = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) found += memchr(buff + r, '#', size - r) != NULL;
+    bench_reportBytes("miss memchr", (double)size * REPEAT, bench_now() - start);
+    if (found > 0) printf("  unexpected match\n");
+}
+
+static void benchMissScan(const char *buff, size_t size, const char *name) {
+    size_t found = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) found += scan_byte(buff + r, size - r, '#') != NULL;
+    bench_reportBytes(name, (double)size * REPEAT, bench_now() - start);
+    if (found > 0) printf("  unexpected match\n");
+}
+
+static void benchFieldsStrpbrk(char *buff, size_t size) {
+    // strpbrk needs a NUL terminated buffer (and stops at NUL bytes)
+    buff[size - 1] = '\0';
+    size_t fields = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) {
+        const char *p = buff;
+        while ((p = strpbrk(p, ",\n\"")) != NULL) { p++; fields++; }
+    }
+    bench_reportBytes("fields strpbrk", (double)size * REPEAT, bench_now() - start);
+    buff[size - 1] = '\n';
+    if (fields == 0) printf("  no fields\n");
+}
+
+static void benchFieldsScan(const char *buff, size_t size, const char *name) {
+    size_t fields = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) {
+        const char *p = buff, *end = buff + size;
+        while ((p = scan_any(p, (size_t)(end - p), ",\n\"", 3)) != NULL) { p++; fields++; }
+    }
+    bench_reportBytes(name, (double)size * REPEAT, bench_now() - start);
+    if (fields == 0) printf("  no fields\n");
+}
+
+static void benchCountLoop(const char *buff, size_t size) {
+    size_t count = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++)
+        for (size_t i = 0; i < size; i++) count += buff[i] == '\n';
+    bench_reportBytes("count loop", (double)size * REPEAT, bench_now() - start);
+    if (count == 0) printf("  no lines\n");
+}
+
+static void benchCountScan(const char *buff, size_t size, const char *name) {
+    size_t count = 0;
+    double start = bench_now();
+    for (int r = 0; r < REPEAT; r++) count += scan_count(buff, size, '\n');
+    bench_reportBytes(name, (double)size * REPEAT, bench_now() - start);
+    if (count == 0) printf("  no lines\n");
+}
+
+int main(void) {
+    char *buff = (char*)malloc(SIZE);
+    if (buff == NULL) return 1;
+    fill(buff, SIZE);
+    ScanLevel best = scan_level();
+    char name[64];
+
+    benchLinesMemchr(buff, SIZE);
+    for (int level = SCAN_SCALAR; level <= (int)best; level++) {
+        scan_setLevel((ScanLevel)level);
+        snprintf(name, sizeof(name), "lines scan_byte (%s)", _levels[level]);
+        benchLinesScan(buff, SIZE, name);
+    }
+
+    // Whole buffer scanned (no match): throughput of the kernels alone
+    benchMissMemchr(buff, SIZE);
+    for (int level = SCAN_SCALAR; level <= (int)best; level++) {
+        scan_setLevel((ScanLevel)level);
+        snprintf(name, sizeof(name), "miss scan_byte (%s)", _levels[level]);
+        benchMissScan(buff, SIZE, name);
+    }
+
+    benchFieldsStrpbrk(buff, SIZE);
+    for (int level = SCAN_SCALAR; level <= (int)best; level++) {
+        scan_setLevel((ScanLevel)level);
+        snprintf(name, sizeof(name), "fields scan_any (%s)", _levels[level]);
+        benchFieldsScan(buff, SIZE, name);
+    }
+
+    benchCountLoop(buff, SIZE);
+    for (int level = SCAN_SCALAR; level <= (int)best; level++) {
+        scan_setLevel((ScanLevel)level);
+        snprintf(name, sizeof(name), "count scan_count (%s)", _levels[level]);
+        benchCountScan(buff, SIZE, name);
+    }
+
+    free(buff);
+    return 0;
+}
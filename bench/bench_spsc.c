@@ -0,0 +1,180 @@
+/*
+    File        : bench_spsc.c
+    Description : Benchmarks for the single producer single consumer ring buffer, against a DArr
+                  behind a mutex, across two pinned threads.
+*/
+
+#define _GNU_SOURCE // pthread_setaffinity_np
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "darr.h"
+#include "spsc.h"
+#include "bench.h"
+
+#define ITEM_COUNT 2000000
+#define RING_SIZE 4096
+#define PING_COUNT 100000
+
+// Record moved between the threads (as from a reader to a parser)
+typedef struct {
+    const char *data;
+    size_t len;
+} Record;
+
+typedef struct {
+    Spsc *q, *back; // Ring, ring for the replies (latency)
+    DArr *d; // DArr behind `lock`
+    pthread_mutex_t lock;
+    size_t batch;
+    int cpu;
+} Shared;
+
+/**
+ * @brief Pin the calling thread to a CPU (wrapped to the CPUs online).
+ */
+static void pin(int cpu) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % (cpus > 0 ? cpus : 1), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *produceSpsc(void *arg) {
+    Shared *s = (Shared*)arg;
+    pin(s->cpu);
+    Record batch[64];
+    for (size_t next = 0; next < ITEM_COUNT;) {
+        size_t n = math_min(s->batch, ITEM_COUNT - next);
+        for (size_t i = 0; i < n; i++) batch[i] = (Record){ NULL, next + i };
+        for (size_t done = 0; done < n;) {
+            size_t pushed = spsc_push(s->q, batch + done, n - done);
+            if (pushed == 0) sched_yield();
+            done += pushed;
+        }
+        next += n;
+    }
+    return NULL;
+}
+
+static void *produceDArr(void *arg) {
+    Shared *s = (Shared*)arg;
+    pin(s->cpu);
+    Record batch[64];
+    for (size_t next = 0; next < ITEM_COUNT;) {
+        size_t n = math_min(s->batch, ITEM_COUNT - next);
+        for (size_t i = 0; i < n; i++) batch[i] = (Record){ NULL, next + i };
+        pthread_mutex_lock(&s->lock);
+        bool full = darr_len(s->d) + n > RING_SIZE;
+        if (!full) darr_append(s->d, batch, n);
+        pthread_mutex_unlock(&s->lock);
+        if (full) sched_yield();
+        else next += n;
+    }
+    return NULL;
+}
+
+static void benchSpsc(const char *name, size_t batch) {
+    Shared s = { .q = spsc_new(RING_SIZE, sizeof(Record)), .batch = batch, .cpu = 1 };
+    if (s.q == NULL) return;
+    pin(0);
+
+    double start = bench_now();
+    pthread_t producer;
+    pthread_create(&producer, NULL, produceSpsc, &s);
+    Record batchOut[64];
+    size_t received = 0, sum = 0;
+    while (received < ITEM_COUNT) {
+        size_t n = spsc_pop(s.q, batchOut, batch);
+        if (n == 0) sched_yield();
+        for (size_t i = 0; i < n; i++) sum += batchOut[i].len;
+        received += n;
+    }
+    pthread_join(producer, NULL);
+    bench_report(name, ITEM_COUNT, bench_now() - start);
+    if (sum != (size_t)ITEM_COUNT * (ITEM_COUNT - 1) / 2) printf("  items lost\n");
+
+    spsc_free(s.q);
+}
+
+static void benchDArr(const char *name, size_t batch) {
+    Shared s = { .d = darr_new(RING_SIZE, sizeof(Record), ALLOC_STRAT_GEOMETRIC), .batch = batch,
+        .cpu = 1 };
+    if (s.d == NULL) return;
+    pthread_mutex_init(&s.lock, NULL);
+    pin(0);
+
+    double start = bench_now();
+    pthread_t producer;
+    pthread_create(&producer, NULL, produceDArr, &s);
+    Record batchOut[64];
+    size_t received = 0, sum = 0;
+    while (received < ITEM_COUNT) {
+        pthread_mutex_lock(&s.lock);
+        size_t n = math_min(batch, darr_len(s.d));
+        if (n > 0) {
+            memcpy(batchOut, darr_first(s.d), n * sizeof(Record));
+            darr_remove(s.d, 0, n);
+        }
+        pthread_mutex_unlock(&s.lock);
+        if (n == 0) sched_yield();
+        for (size_t i = 0; i < n; i++) sum += batchOut[i].len;
+        received += n;
+    }
+    pthread_join(producer, NULL);
+    bench_report(name, ITEM_COUNT, bench_now() - start);
+    if (sum != (size_t)ITEM_COUNT * (ITEM_COUNT - 1) / 2) printf("  items lost\n");
+
+    pthread_mutex_destroy(&s.lock);
+    darr_free(s.d);
+}
+
+/**
+ * @brief Echo thread for the latency benchmark: sends back every record it receives.
+ */
+static void *echo(void *arg) {
+    Shared *s = (Shared*)arg;
+    pin(s->cpu);
+    Record r;
+    for (size_t i = 0; i < PING_COUNT; i++) {
+        while (spsc_pop(s->q, &r, 1) == 0) sched_yield();
+        while (spsc_push(s->back, &r, 1) == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void benchLatency(const char *name) {
+    Shared s = { .q = spsc_new(RING_SIZE, sizeof(Record)), .cpu = 1 };
+    s.back = spsc_new(RING_SIZE, sizeof(Record));
+    if (s.q == NULL || s.back == NULL) return;
+    pin(0);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, echo, &s);
+    double start = bench_now();
+    Record r = { NULL, 0 };
+    for (size_t i = 0; i < PING_COUNT; i++) {
+        r.len = i;
+        while (spsc_push(s.q, &r, 1) == 0) sched_yield();
+        while (spsc_pop(s.back, &r, 1) == 0) sched_yield();
+    }
+    double elapsed = bench_now() - start;
+    pthread_join(thread, NULL);
+    bench_report(name, PING_COUNT, elapsed);
+    printf("  %.0f ns per round trip\n", elapsed / PING_COUNT * 1e9);
+
+    spsc_free(s.q);
+    spsc_free(s.back);
+}
+
+int main(void) {
+    benchDArr("records darr + mutex (batch 1)", 1);
+    benchSpsc("records spsc (batch 1)", 1);
+    benchDArr("records darr + mutex (batch 64)", 64);
+    benchSpsc("records spsc (batch 64)", 64);
+    benchLatency("round trips spsc");
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+    File        : bench_tpool.c
+    Description : Benchmarks for the work-stealing thread pool: task throughput against a thread
+                  per task, and a fork-join sum against a single thread.
+*/
+
+#include <pthread.h>
+
+#include "tpool.h"
+#include "bench.h"
+
+#define TASK_COUNT 200000
+#define THREAD_COUNT 2000
+#define SUM_LEN (1 << 24)
+#define SUM_LEAF 4096
+
+typedef struct {
+    TPool *pool;
+    const int *items;
+    size_t len;
+    long long sum;
+} Sum;
+
+static void *work(void *arg) {
+    atomic_fetch_add_explicit((_Atomic size_t*)arg, 1, memory_order_relaxed);
+    return NULL;
+}
+
+static void task(void *arg) { work(arg); }
+
+static void sum(void *arg) {
+    Sum *s = (Sum*)arg;
+    if (s->len <= SUM_LEAF) {
+        for (size_t i = 0; i < s->len; i++) s->sum += s->items[i];
+        return;
+    }
+
+    Sum left = { s->pool, s->items, s->len / 2, 0 };
+    Sum right = { s->pool, s->items + left.len, s->len - left.len, 0 };
+    TPoolGroup g;
+    tpool_groupInit(&g);
+    if (!tpool_submit(s->pool, &g, sum, &left)) sum(&left);
+    sum(&right);
+    tpool_wait(s->pool, &g);
+    s->sum = left.sum + right.sum;
+}
+
+/**
+ * @brief Run tiny tasks, each on a thread of its own, then on the default pool.
+ */
+static void benchTasks(void) {
+    _Atomic size_t n = 0;
+    double start = bench_now();
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_t id;
+        pthread_create(&id, NULL, work, &n);
+        pthread_join(id, NULL);
+    }
+    bench_report("thread per task", THREAD_COUNT, bench_now() - start);
+
+    TPool *p = tpool_default();
+    TPoolGroup g;
+    tpool_groupInit(&g);
+    start = bench_now();
+    for (int i = 0; i < TASK_COUNT; i++) tpool_submit(p, &g, task, &n);
+    tpool_wait(p, &g);
+    bench_report("tpool submit + run", TASK_COUNT, bench_now() - start);
+    if (n != THREAD_COUNT + TASK_COUNT) printf("  tasks lost\n");
+}
+
+/**
+ * @brief Sum SUM_LEN ints on a single thread, then split in halves down to SUM_LEAF items on pools
+ * of 1 to 8 workers.
+ */
+static void benchSum(void) {
+    int *items = malloc(SUM_LEN * sizeof(int));
+    for (size_t i = 0; i < SUM_LEN; i++) items[i] = (int)(i & 1023);
+
+    Sum s = { NULL, items, SUM_LEN, 0 };
+    double start = bench_now();
+    for (size_t i = 0; i < SUM_LEN; i++) s.sum += items[i];
+    bench_reportBytes("sum (1 thread)", SUM_LEN * sizeof(int), bench_now() - start);
+    long long expected = s.sum;
+
+    char name[64];
+    for (unsigned workers = 1; workers <= 8; workers *= 2) {
+        s = (Sum){ tpool_new(workers, true), items, SUM_LEN, 0 };
+        start = bench_now();
+        sum(&s);
+        snprintf(name, sizeof(name), "fork-join sum (%u workers)", workers);
+        bench_reportBytes(name, SUM_LEN * sizeof(int), bench_now() - start);
+        if (s.sum != expected) printf("  wrong sum\n");
+        tpool_free(s.pool);
+    }
+    free(items);
+}
+
+int main(void) {
+    benchTasks();
+    benchSum();
+    return 0;
+}
@@ -9,23 +9,48 @@
 #define ALLOC_H_INCLUDED
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc_arena.h"
+#include "alloc_buddy.h"
+#include "alloc_pool.h"
 #include "math.h"
+#include "mem.h"
 
-// TODO - ALLOC_STRAT_CHUNKS - Fixed size chunks allocated/deallocated when needed/not needed
+// Default growth factor and minimum increment (bytes) for ALLOC_STRAT_GEOMETRIC
+#define ALLOC_GROWTH_FACTOR 1.5
+#define ALLOC_GROWTH_MIN 64
+
+// Default shrink threshold (fraction of capacity used before alloc_remove shrinks the block). Well
+// below the growth factors, so that removals at a steady size keep the slack growth added
+#define ALLOC_SHRINK_THRESHOLD 0.25
+
+// Default chunk size (bytes) for ALLOC_STRAT_CHUNKS
+#define ALLOC_CHUNK_SIZE 65536
+
+// ALLOC_STRAT_CHUNKS stores data in fixed size chunks that are allocated/released when 
+// needed/not needed, so existing data is never copied on growth (data is not contiguous). Chunks 
+// hold whole items of the chunk item size (see alloc_setChunkItem), so an item never straddles two 
+// chunks.
 typedef enum {
     _ALLOC_STRAT_MIN,
     ALLOC_STRAT_DYNAMIC,
     ALLOC_STRAT_BUDDY,
+    ALLOC_STRAT_GEOMETRIC,
+    ALLOC_STRAT_CHUNKS,
     _ALLOC_STRAT_MAX
 } AllocStrategy;
 
 typedef struct {
+    const Allocator *allocator; // Allocator the memory is taken from
     void *block;
     size_t used, total;
     AllocStrategy strat;
+    double growth, shrink;
+    size_t minGrowth, chunkSize;
+    size_t chunkItem; // Chunks hold chunkSize / chunkItem whole items, the rest is unused
 } AllocBlock;
 
 /**
@@ -53,6 +78,18 @@ void alloc_clear(AllocBlock *b);
  */
 AllocBlock *alloc_copy(const AllocBlock *b);
 
+/**
+ * @brief Free the AllocBlock object but keep its memory block, handing ownership of it to the 
+ * caller.
+ * 
+ * @param b AllocBlock object.
+ * @param size Set to the size (bytes) of the memory block, its capacity.
+ * @return Pointer to the memory block (release it with mem_free(p, *size)). NULL if NULL or empty 
+ * block, or if the block is chunked or does not use the default allocator (the block is then left 
+ * untouched).
+ */
+void *alloc_detach(AllocBlock *b, size_t *size);
+
 /**
  * @brief Free AllocBlock object.
  * 
@@ -60,6 +97,14 @@ AllocBlock *alloc_copy(const AllocBlock *b);
  */
 void alloc_free(AllocBlock *b);
 
+/**
+ * @brief Allocator the memory of the AllocBlock is taken from.
+ * 
+ * @param b AllocBlock object.
+ * @return Allocator. NULL if NULL block.
+ */
+const Allocator *alloc_getAllocator(const AllocBlock *b);
+
 /**
  * @brief Available memory of the AllocBlock.
  * 
@@ -72,10 +117,19 @@ size_t alloc_getAvail(const AllocBlock *b);
  * @brief Pointer to actual memory block in the AllocBlock.
  * 
  * @param  b AllocBlock object.
- * @return void* Pointer to actual memory block. NULL if NULL block.
+ * @return void* Pointer to actual memory block. NULL if NULL block or if the data is stored in 
+ * chunks (ALLOC_STRAT_CHUNKS), use alloc_span to access chunked data.
  */
 void *alloc_getBlock(const AllocBlock *b);
 
+/**
+ * @brief Chunk size used by the AllocBlock when using ALLOC_STRAT_CHUNKS.
+ * 
+ * @param b AllocBlock object.
+ * @return Chunk size (bytes). Zero if NULL block.
+ */
+size_t alloc_getChunkSize(const AllocBlock *b);
+
 /**
  * @brief Size of actual memory block in the AllocBlock.
  * 
@@ -100,6 +154,19 @@ AllocStrategy alloc_getStrat(const AllocBlock *b);
  */
 size_t alloc_getUsed(const AllocBlock *b);
 
+/**
+ * @brief Size to grow to geometrically (see ALLOC_STRAT_GEOMETRIC and alloc_setGrowth): the 
+ * largest of the required size, the current size multiplied by `factor` and the current size 
+ * plus `minGrowth`. Shrinking is exact.
+ * 
+ * @param total Current size (bytes).
+ * @param size Required size (bytes).
+ * @param factor Growth factor.
+ * @param minGrowth Minimum growth (bytes).
+ * @return Size (bytes).
+ */
+size_t alloc_growSize(size_t total, size_t size, double factor, size_t minGrowth);
+
 /**
  * @brief Index into AllocBlock.
  * 
@@ -120,6 +187,17 @@ void *alloc_index(AllocBlock *b, size_t byteIdx);
  */
 bool alloc_insert(AllocBlock *b, const void *data, size_t byteIdx, size_t size);
 
+/**
+ * @brief Insert uninitialised bytes into the AllocBlock at the given index, shifting the data 
+ * after it.
+ * 
+ * @param b AllocBlock object.
+ * @param byteIdx Index (byte position) to insert at.
+ * @param size Number of bytes to insert.
+ * @return true if insert succeeded, false otherwise.
+ */
+bool alloc_insertSpace(AllocBlock *b, size_t byteIdx, size_t size);
+
 /**
  * @brief Check if the AllocBlock is empty.
  * 
@@ -129,7 +207,18 @@ bool alloc_insert(AllocBlock *b, const void *data, size_t byteIdx, size_t size);
 bool alloc_isEmpty(const AllocBlock *b);
 
 /**
- * @brief Create a new AllocBlock.
+ * @brief Move data within the used memory of an AllocBlock (the ranges may overlap).
+ * 
+ * @param b AllocBlock object.
+ * @param dstIdx Index (byte position) to move to.
+ * @param srcIdx Index (byte position) to move from.
+ * @param size Size (bytes) of data.
+ * @return true if move succeeded, false otherwise (out of the used memory).
+ */
+bool alloc_move(AllocBlock *b, size_t dstIdx, size_t srcIdx, size_t size);
+
+/**
+ * @brief Create a new AllocBlock with the default allocator (see mem_setAllocator).
  * 
  * @param size Initial size of block (bytes).
  * @param strat Allocation strategy.
@@ -138,7 +227,51 @@ bool alloc_isEmpty(const AllocBlock *b);
 AllocBlock *alloc_new(size_t size, AllocStrategy strat);
 
 /**
- * @brief Removes data from an AllocBlock.
+ * @brief Create a new AllocBlock (ALLOC_STRAT_BUDDY) taking all of its memory from a buddy heap, 
+ * so it can grow in place while its buddies are free.
+ * 
+ * @param h Buddy object (NULL to use the default allocator, as alloc_new).
+ * @param size Initial size of block (bytes).
+ * @return AllocBlock object (or NULL if failure).
+ */
+AllocBlock *alloc_newBuddy(Buddy *h, size_t size);
+
+/**
+ * @brief Create a new AllocBlock taking all of its memory (including the AllocBlock itself) from 
+ * an arena. The memory is released when the arena is reset, alloc_free does not release it.
+ * 
+ * @param a Arena object (NULL to use the default allocator, as alloc_new).
+ * @param size Initial size of block (bytes).
+ * @param strat Allocation strategy.
+ * @return AllocBlock object (or NULL if failure).
+ */
+AllocBlock *alloc_newIn(Arena *a, size_t size, AllocStrategy strat);
+
+/**
+ * @brief Create a new AllocBlock taking all of its memory from an allocator. Copies and splits of 
+ * the block use the same allocator.
+ * 
+ * @param a Allocator (NULL for the default allocator). Must outlive the block.
+ * @param size Initial size of block (bytes).
+ * @param strat Allocation strategy.
+ * @return AllocBlock object (or NULL if failure).
+ */
+AllocBlock *alloc_newWith(const Allocator *a, size_t size, AllocStrategy strat);
+
+/**
+ * @brief Copy data out of the AllocBlock.
+ * 
+ * @param b AllocBlock object.
+ * @param dst Pointer to copy the data to.
+ * @param byteIdx Index (byte position) to copy from.
+ * @param size Size (bytes) of data.
+ * @return true if read succeeded, false otherwise.
+ */
+bool alloc_read(const AllocBlock *b, void *dst, size_t byteIdx, size_t size);
+
+/**
+ * @brief Removes data from an AllocBlock. The block is only shrunk if the used memory falls below 
+ * the shrink threshold of the block (see alloc_setShrink).
  * 
  * @param b AllocBlock object.
  * @param byteIdx Index (byte position) to remove at.
@@ -168,6 +301,50 @@ bool alloc_resize(AllocBlock *b, size_t size);
  */
 bool alloc_setAt(AllocBlock *b, const void *data, size_t byteIdx, size_t size);
 
+/**
+ * @brief Set the chunk size used by ALLOC_STRAT_CHUNKS. Can only be changed while a chunked block 
+ * holds no memory.
+ * 
+ * @param b AllocBlock object.
+ * @param size Chunk size (bytes). Must be a power of 2, at least the chunk item size.
+ * @return true if the chunk size was set, false otherwise.
+ */
+bool alloc_setChunkSize(AllocBlock *b, size_t size);
+
+/**
+ * @brief Set the size of the items stored in the chunks of ALLOC_STRAT_CHUNKS (1 by default). Each 
+ * chunk holds chunkSize / itemSize whole items, so a pointer to an item (see alloc_index) is valid 
+ * for the whole item. Can only be changed while a chunked block holds no memory.
+ * 
+ * @param b AllocBlock object.
+ * @param itemSize Item size (bytes), at most the chunk size.
+ * @return true if the item size was set, false otherwise.
+ */
+bool alloc_setChunkItem(AllocBlock *b, size_t itemSize);
+
+/**
+ * @brief Set the growth policy used by ALLOC_STRAT_GEOMETRIC. When the block must grow, its new 
+ * size is the largest of the required size, the current size multiplied by `factor` and the 
+ * current size plus `minGrowth`.
+ * 
+ * @param b AllocBlock object.
+ * @param factor Growth factor (must be at least 1.0).
+ * @param minGrowth Minimum increment (bytes) of each growth.
+ * @return true if the policy was set, false otherwise.
+ */
+bool alloc_setGrowth(AllocBlock *b, double factor, size_t minGrowth);
+
+/**
+ * @brief Set the shrink threshold used by alloc_remove (ALLOC_SHRINK_THRESHOLD by default). The 
+ * block is shrunk only when the used memory falls below `threshold` times the current size; 1.0 
+ * shrinks on every removal and 0.0 never shrinks.
+ * 
+ * @param b AllocBlock object.
+ * @param threshold Fraction of the current size (between 0.0 and 1.0).
+ * @return true if the threshold was set, false otherwise.
+ */
+bool alloc_setShrink(AllocBlock *b, double threshold);
+
 /**
  * @brief Set the Allocation strategy.
  * 
@@ -176,6 +353,26 @@ bool alloc_setAt(AllocBlock *b, const void *data, size_t byteIdx, size_t size);
  */
 void alloc_setStrat(AllocBlock *b, AllocStrategy strat);
 
+/**
+ * @brief Shrink the AllocBlock to the smallest size that holds its used memory, as allowed by the 
+ * allocation strategy.
+ * 
+ * @param b AllocBlock object.
+ * @return true if shrink succeeded, false otherwise.
+ */
+bool alloc_shrinkToFit(AllocBlock *b);
+
+/**
+ * @brief Pointer to the contiguous run of used memory starting at an index. For ALLOC_STRAT_CHUNKS 
+ * the run ends at the end of the chunk, otherwise at the end of the used memory.
+ * 
+ * @param b AllocBlock object.
+ * @param byteIdx Index (byte position) of the start of the run.
+ * @param len Address to store the length (bytes) of the run in (may be NULL).
+ * @return Pointer to the start of the run. NULL if out of bounds.
+ */
+void *alloc_span(const AllocBlock *b, size_t byteIdx, size_t *len);
+
 /**
  * @brief Splits an AllocBlock into two separate blocks. Original block (b) is free'd.
  * 
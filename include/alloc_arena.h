@@ -0,0 +1,120 @@
+/*
+    File        : alloc_arena.h
+    Description : Arena (bump pointer) allocator with save/restore marks and bulk reset.
+*/
+
+#ifndef ALLOC_ARENA_H_INCLUDED
+#define ALLOC_ARENA_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "math.h"
+#include "mem.h"
+
+// Default size (bytes) of each region the arena takes from the system
+#define ARENA_REGION_SIZE 65536
+
+// Alignment (bytes) of every arena allocation
+#define ARENA_ALIGN _Alignof(max_align_t)
+
+typedef struct ArenaRegion {
+    struct ArenaRegion *next;
+    size_t size, used;
+    _Alignas(max_align_t) char data[];
+} ArenaRegion;
+
+typedef struct Arena {
+    ArenaRegion *first, *current;
+    size_t regionSize;
+    void *last; // Most recent allocation (can be grown in place)
+    Allocator allocator; // Allocator interface to the arena (see arena_allocator)
+} Arena;
+
+typedef struct {
+    ArenaRegion *region;
+    size_t used;
+} ArenaMark;
+
+/**
+ * @brief Allocate memory from the arena. O(1) unless a new region is needed.
+ * 
+ * @param a Arena object.
+ * @param size Size (bytes) to allocate.
+ * @return Pointer to the memory (aligned to ARENA_ALIGN), or NULL if failure or `size` is 0.
+ */
+void *arena_alloc(Arena *a, size_t size);
+
+/**
+ * @brief Allocator interface to the arena, so any container can take its memory from it. Freeing 
+ * is a no-op, the memory is released when the arena is reset.
+ * 
+ * @param a Arena object.
+ * @return Allocator (valid as long as the arena), or NULL if NULL arena.
+ */
+const Allocator *arena_allocator(Arena *a);
+
+/**
+ * @brief Free an Arena object and all memory allocated from it.
+ * 
+ * @param a Arena object.
+ */
+void arena_free(Arena *a);
+
+/**
+ * @brief Create a new Arena.
+ * 
+ * @param regionSize Size (bytes) of each region taken from the system. ARENA_REGION_SIZE if 0.
+ * @return Arena object (or NULL if failure).
+ */
+Arena *arena_new(size_t regionSize);
+
+/**
+ * @brief Resize memory allocated from the arena. The most recent allocation is resized in place 
+ * when it fits, otherwise the data is copied to a new allocation (the old memory is only 
+ * reclaimed on reset/restore).
+ * 
+ * @param a Arena object.
+ * @param p Pointer to memory allocated from the arena, or NULL.
+ * @param oldSize Current size (bytes) of the memory.
+ * @param newSize New size (bytes).
+ * @return Pointer to the resized memory, or NULL if failure or `newSize` is 0.
+ */
+void *arena_realloc(Arena *a, void *p, size_t oldSize, size_t newSize);
+
+/**
+ * @brief Release all memory allocated from the arena at once. Regions are kept for reuse.
+ * 
+ * @param a Arena object.
+ */
+void arena_reset(Arena *a);
+
+/**
+ * @brief Release all memory allocated from the arena since a mark was saved. Marks can be nested, 
+ * restoring a mark invalidates all marks saved after it.
+ * 
+ * @param a Arena object.
+ * @param mark Mark returned by arena_save.
+ */
+void arena_restore(Arena *a, ArenaMark mark);
+
+/**
+ * @brief Save the current position of the arena.
+ * 
+ * @param a Arena object.
+ * @return Mark to pass to arena_restore.
+ */
+ArenaMark arena_save(const Arena *a);
+
+/**
+ * @brief Number of bytes allocated from the arena (including alignment padding).
+ * 
+ * @param a Arena object.
+ * @return Used memory (bytes). Zero if NULL arena.
+ */
+size_t arena_used(const Arena *a);
+
+#endif // ALLOC_ARENA_H_INCLUDED
@@ -0,0 +1,125 @@
+/*
+    File        : alloc_buddy.h
+    Description : Buddy system allocator over a pre-reserved region, with per-order free lists,
+                  buddy coalescing, in-place growth and fragmentation statistics.
+*/
+
+#ifndef ALLOC_BUDDY_H_INCLUDED
+#define ALLOC_BUDDY_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "math.h"
+#include "mem.h"
+
+// Default size (bytes) of the region a buddy heap reserves
+#define BUDDY_HEAP_SIZE 1048576
+
+// Default size (bytes) of the smallest block a buddy heap hands out
+#define BUDDY_MIN_BLOCK 64
+
+typedef struct BuddyNode {
+    struct BuddyNode *prev, *next;
+} BuddyNode;
+
+typedef struct Buddy {
+    unsigned char *base; // Reserved region
+    unsigned char *meta; // Order (and free flag) of the block starting at each minimum block
+    size_t size, used, allocations;
+    int minOrder, maxOrder;
+    BuddyNode *freeLists[MATH_SIZE_BITS]; // Free blocks of each order (block size 2^order)
+    Allocator allocator; // Allocator interface to the heap (see buddy_allocator)
+} Buddy;
+
+typedef struct {
+    size_t total; // Size (bytes) of the region
+    size_t used; // Bytes in allocated blocks
+    size_t free; // Bytes in free blocks
+    size_t largestFree; // Size (bytes) of the largest free block
+    size_t freeBlocks; // Number of free blocks
+    size_t allocations; // Number of allocated blocks
+    double fragmentation; // External fragmentation: 1 - largestFree / free (0 if no free memory)
+} BuddyStats;
+
+/**
+ * @brief Allocate a block from the buddy heap. The request is rounded up to a power of 2 (at least
+ * the minimum block size) and larger free blocks are split as needed. O(log n).
+ *
+ * @param h Buddy object.
+ * @param size Size (bytes) to allocate.
+ * @return Pointer to the memory (aligned to its block size, up to the alignment of the region),
+ * or NULL if failure or `size` is 0.
+ *
+ * @note A Buddy heap is not thread-safe.
+ */
+void *buddy_alloc(Buddy *h, size_t size);
+
+/**
+ * @brief Allocator interface to the buddy heap, so any container can take its memory from it.
+ *
+ * @param h Buddy object.
+ * @return Allocator (valid as long as the heap), or NULL if NULL heap.
+ */
+const Allocator *buddy_allocator(Buddy *h);
+
+/**
+ * @brief Size of the block holding an allocation.
+ *
+ * @param h Buddy object.
+ * @param p Pointer to memory allocated from the heap.
+ * @return Block size (bytes), or 0 if `p` is not an allocation of the heap.
+ */
+size_t buddy_blockSize(const Buddy *h, const void *p);
+
+/**
+ * @brief Free a Buddy object and its region. All allocations become invalid.
+ *
+ * @param h Buddy object.
+ */
+void buddy_free(Buddy *h);
+
+/**
+ * @brief Create a new buddy heap, reserving its whole region up front.
+ *
+ * @param size Size (bytes) of the region, rounded up to a power of 2. BUDDY_HEAP_SIZE if 0.
+ * @param minBlock Size (bytes) of the smallest block, rounded up to a power of 2 (and to fit a
+ * free list node). BUDDY_MIN_BLOCK if 0.
+ * @return Buddy object (or NULL if failure).
+ */
+Buddy *buddy_new(size_t size, size_t minBlock);
+
+/**
+ * @brief Resize memory allocated from the buddy heap. Shrinking splits the block in place, growing
+ * absorbs the following buddies in place when they are free, otherwise the data is moved to a new
+ * block.
+ *
+ * @param h Buddy object.
+ * @param p Pointer to memory allocated from the heap, or NULL.
+ * @param oldSize Current size (bytes) of the memory.
+ * @param newSize New size (bytes).
+ * @return Pointer to the resized memory, or NULL if failure or `newSize` is 0 (`p` is then left
+ * untouched).
+ */
+void *buddy_realloc(Buddy *h, void *p, size_t oldSize, size_t newSize);
+
+/**
+ * @brief Return a block to the buddy heap, coalescing it with its free buddies.
+ *
+ * @param h Buddy object.
+ * @param p Pointer to memory allocated from the heap, or NULL.
+ */
+void buddy_release(Buddy *h, void *p);
+
+/**
+ * @brief Usage and fragmentation statistics of the buddy heap. O(number of free blocks).
+ *
+ * @param h Buddy object.
+ * @return Statistics (all zero if NULL heap).
+ */
+BuddyStats buddy_stats(const Buddy *h);
+
+#endif // ALLOC_BUDDY_H_INCLUDED
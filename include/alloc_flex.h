@@ -0,0 +1,139 @@
+/*
+    File        : alloc_flex.h
+    Description : Single allocation memory block with the header and data stored together. 
+                  Functions that may grow the block return its (possibly moved) new address.
+*/
+
+#ifndef ALLOC_FLEX_H_INCLUDED
+#define ALLOC_FLEX_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "math.h"
+
+typedef struct {
+    const Allocator *allocator; // Allocator the block is taken from
+    size_t used, total;
+    AllocStrategy strat;
+    _Alignas(max_align_t) unsigned char data[];
+} FlexBlock;
+
+/**
+ * @brief Append data into the FlexBlock at the end.
+ * 
+ * @param f FlexBlock object.
+ * @param data Pointer to data (will be copied).
+ * @param size Size (bytes) of data.
+ * @return FlexBlock object (may have moved), or NULL if failure (`f` is then left untouched).
+ */
+FlexBlock *flex_append(FlexBlock *f, const void *data, size_t size);
+
+/**
+ * @brief Clears all data in the FlexBlock but keeps the allocated memory.
+ * 
+ * @param f FlexBlock object.
+ */
+void flex_clear(FlexBlock *f);
+
+/**
+ * @brief Free FlexBlock object.
+ * 
+ * @param f FlexBlock object.
+ */
+void flex_free(FlexBlock *f);
+
+/**
+ * @brief Size of the data area of the FlexBlock.
+ * 
+ * @param f FlexBlock object.
+ * @return Size (bytes). Zero if NULL block.
+ */
+static inline size_t flex_getSize(const FlexBlock *f) { return f ? f->total : 0; }
+
+/**
+ * @brief Used memory of the FlexBlock.
+ * 
+ * @param f FlexBlock object.
+ * @return Used memory (bytes). Zero if NULL block.
+ */
+static inline size_t flex_getUsed(const FlexBlock *f) { return f ? f->used : 0; }
+
+/**
+ * @brief Index into FlexBlock.
+ * 
+ * @param f FlexBlock object.
+ * @param byteIdx Index (byte position) to index at.
+ * @return Pointer to item at given index (NULL if out of bounds).
+ */
+static inline void *flex_index(FlexBlock *f, size_t byteIdx) {
+    return f && byteIdx < f->used ? f->data + byteIdx : NULL;
+}
+
+/**
+ * @brief Insert data into the FlexBlock at the given index.
+ * 
+ * @param f FlexBlock object.
+ * @param data Pointer to data (will be copied).
+ * @param byteIdx Index (byte position) to insert at.
+ * @param size Size (bytes) of data.
+ * @return FlexBlock object (may have moved), or NULL if failure (`f` is then left untouched).
+ */
+FlexBlock *flex_insert(FlexBlock *f, const void *data, size_t byteIdx, size_t size);
+
+/**
+ * @brief Create a new FlexBlock with a single allocation from the default allocator (see 
+ * mem_setAllocator).
+ * 
+ * @param size Initial size of the data area (bytes).
+ * @param strat Allocation strategy (ALLOC_STRAT_CHUNKS is not supported). Geometric growth uses 
+ * ALLOC_GROWTH_FACTOR and ALLOC_GROWTH_MIN.
+ * @return FlexBlock object (or NULL if failure).
+ */
+FlexBlock *flex_new(size_t size, AllocStrategy strat);
+
+/**
+ * @brief Create a new FlexBlock taken from an allocator.
+ * 
+ * @param a Allocator (NULL for the default allocator). Must outlive the block.
+ * @param size Initial size of the data area (bytes).
+ * @param strat Allocation strategy (ALLOC_STRAT_CHUNKS is not supported).
+ * @return FlexBlock object (or NULL if failure).
+ */
+FlexBlock *flex_newWith(const Allocator *a, size_t size, AllocStrategy strat);
+
+/**
+ * @brief Removes data from a FlexBlock. The block is never reallocated (so never moves), use 
+ * flex_shrinkToFit to release memory.
+ * 
+ * @param f FlexBlock object.
+ * @param byteIdx Index (byte position) to remove at.
+ * @param size Size (bytes) of data.
+ * @return true if remove succeeded, false otherwise.
+ */
+bool flex_remove(FlexBlock *f, size_t byteIdx, size_t size);
+
+/**
+ * @brief Resize the data area of a FlexBlock. Data beyond the new size is discarded.
+ * 
+ * @param f FlexBlock object.
+ * @param size New size (bytes). This is the required size, but actual size could be larger 
+ * depending on allocation strategy.
+ * @return FlexBlock object (may have moved), or NULL if failure (`f` is then left untouched).
+ */
+FlexBlock *flex_resize(FlexBlock *f, size_t size);
+
+/**
+ * @brief Shrink the FlexBlock to the smallest size that holds its used memory, as allowed by the 
+ * allocation strategy.
+ * 
+ * @param f FlexBlock object.
+ * @return FlexBlock object (may have moved), or NULL if failure (`f` is then left untouched).
+ */
+FlexBlock *flex_shrinkToFit(FlexBlock *f);
+
+#endif // ALLOC_FLEX_H_INCLUDED
@@ -0,0 +1,112 @@
+/*
+    File        : alloc_pool.h
+    Description : Pool (slab) allocator for fixed size objects with free list recycling, and 
+                  per-thread pools for small objects.
+*/
+
+#ifndef ALLOC_POOL_H_INCLUDED
+#define ALLOC_POOL_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Default number of objects in each slab the pool takes from the system
+#define POOL_SLAB_OBJECTS 64
+
+// Size classes (bytes) served by the per-thread small object pools
+#define POOL_SMALL_STEP 16
+#define POOL_SMALL_MAX 256
+#define POOL_SMALL_CLASSES (POOL_SMALL_MAX / POOL_SMALL_STEP)
+
+// Free objects each thread keeps per size class. Beyond it, batches of POOL_SMALL_BATCH objects go 
+// to a depot shared by all threads, which threads refill from before taking a new slab
+#define POOL_SMALL_CACHED 256
+#define POOL_SMALL_BATCH (POOL_SMALL_CACHED / 2)
+
+typedef struct PoolSlab {
+    struct PoolSlab *next;
+    _Alignas(max_align_t) char data[];
+} PoolSlab;
+
+typedef struct Pool {
+    size_t objSize, slabObjects;
+    PoolSlab *slabs;
+    void *freeList;
+} Pool;
+
+/**
+ * @brief Allocate an object from the pool. O(1) unless a new slab is needed.
+ * 
+ * @param p Pool object.
+ * @return Pointer to the object (aligned to max_align_t if the object size is a multiple of it), 
+ * or NULL if failure.
+ * 
+ * @note A Pool is not thread-safe, use pool_allocSmall for objects shared between threads.
+ */
+void *pool_alloc(Pool *p);
+
+/**
+ * @brief Allocate a small object from the pool of the calling thread.
+ * 
+ * @param size Size (bytes) of the object. Sizes above POOL_SMALL_MAX are allocated with malloc.
+ * @return Pointer to the object, or NULL if failure or `size` is 0.
+ * 
+ * @note Objects can be released by any thread with pool_releaseSmall and the same `size`. Objects 
+ * released by other threads come back through the shared depot, so memory stays bounded when 
+ * threads allocate and others release.
+ */
+void *pool_allocSmall(size_t size);
+
+/**
+ * @brief Release all slabs held by a pool initialised with pool_init. All objects allocated from 
+ * the pool become invalid.
+ * 
+ * @param p Pool object.
+ */
+void pool_destroy(Pool *p);
+
+/**
+ * @brief Free a Pool object created with pool_new and all objects allocated from it.
+ * 
+ * @param p Pool object.
+ */
+void pool_free(Pool *p);
+
+/**
+ * @brief Initialise a Pool object in place (e.g. a static or stack Pool).
+ * 
+ * @param p Pool object.
+ * @param objSize Size (bytes) of each object.
+ * @param slabObjects Number of objects in each slab. POOL_SLAB_OBJECTS if 0.
+ * @return true if the pool was initialised, false otherwise.
+ */
+bool pool_init(Pool *p, size_t objSize, size_t slabObjects);
+
+/**
+ * @brief Create a new Pool.
+ * 
+ * @param objSize Size (bytes) of each object.
+ * @param slabObjects Number of objects in each slab. POOL_SLAB_OBJECTS if 0.
+ * @return Pool object (or NULL if failure).
+ */
+Pool *pool_new(size_t objSize, size_t slabObjects);
+
+/**
+ * @brief Return an object to the pool so it can be reused.
+ * 
+ * @param p Pool object.
+ * @param obj Pointer to an object allocated from the pool (or NULL).
+ */
+void pool_release(Pool *p, void *obj);
+
+/**
+ * @brief Return a small object allocated with pool_allocSmall.
+ * 
+ * @param obj Pointer to the object (or NULL).
+ * @param size Size (bytes) the object was allocated with.
+ */
+void pool_releaseSmall(void *obj, size_t size);
+
+#endif // ALLOC_POOL_H_INCLUDED
@@ -12,9 +12,14 @@
 
 #include "alloc.h"
 
+// Minimum number of item slots a gap buffer DArr grows its gap by (see darr_setGap)
+#define DARR_GAP_MIN 64
+
 typedef struct { 
     AllocBlock *block;
     size_t itemSize, len;
+    bool gapMode; // Gap buffer mode (see darr_setGap)
+    size_t gap, gapLen; // Start and length (items) of the gap in the block
 } DArr;
 
 /**
@@ -120,7 +125,7 @@ void *darr_last(DArr *d);
 size_t darr_len(DArr *d);
 
 /**
- * @brief Create a new DArr object.
+ * @brief Create a new DArr object with the default allocator (see mem_setAllocator).
  * 
  * @param size Number of allocated item slots.
  * @param itemSize Size of a single item (bytes).
@@ -129,6 +134,30 @@ size_t darr_len(DArr *d);
  */
 DArr *darr_new(size_t size, size_t itemSize, AllocStrategy strat);
 
+/**
+ * @brief Create a new DArr object taking all of its memory from an arena. The memory is released 
+ * when the arena is reset, darr_free does not release it.
+ * 
+ * @param a Arena object (NULL to use the default allocator, as darr_new).
+ * @param size Number of allocated item slots.
+ * @param itemSize Size of a single item (bytes).
+ * @param strat Allocation strategy.
+ * @return DArr object (or NULL if failure).
+ */
+DArr *darr_newIn(Arena *a, size_t size, size_t itemSize, AllocStrategy strat);
+
+/**
+ * @brief Create a new DArr object taking all of its memory from an allocator. Copies and splits 
+ * of the DArr use the same allocator.
+ * 
+ * @param a Allocator (NULL for the default allocator). Must outlive the DArr.
+ * @param size Number of allocated item slots.
+ * @param itemSize Size of a single item (bytes).
+ * @param strat Allocation strategy.
+ * @return DArr object (or NULL if failure).
+ */
+DArr *darr_newWith(const Allocator *a, size_t size, size_t itemSize, AllocStrategy strat);
+
 /**
  * @brief Remove items from the DArr at the given index.
  * 
@@ -160,6 +189,30 @@ bool darr_resize(DArr *d, size_t size);
  */
 bool darr_setAt(DArr *d, const void *items, size_t idx, size_t count);
 
+/**
+ * @brief Switch a DArr into or out of gap buffer mode. In gap buffer mode the free slots of the 
+ * array are kept as a gap at the last position inserted at or removed from, so inserts and removes 
+ * next to it only write the items inserted, and the items between the old and the new position 
+ * are moved only when the position jumps. Switching out moves the gap to the end.
+ * 
+ * @param d DArr object.
+ * @param gap true for gap buffer mode, false for a plain array.
+ * @return true if switch succeeded, false otherwise.
+ * 
+ * @note Items are indexed as in a plain array (darr_index skips the gap), but the items before and 
+ * after the gap are not contiguous.
+ */
+bool darr_setGap(DArr *d, bool gap);
+
+/**
+ * @brief Shrink a DArr to the smallest number of item slots that holds its items, as allowed by 
+ * the allocation strategy.
+ * 
+ * @param d DArr object.
+ * @return true if shrink succeeded, false otherwise.
+ */
+bool darr_shrinkToFit(DArr *d);
+
 /**
  * @brief Return the size (number of total item slots) of the DArr.
  * 
@@ -0,0 +1,178 @@
+/*
+    File        : deque.h
+    Description : Double-ended queue of items of any single type, stored in a ring buffer on an
+                  AllocBlock, with O(1) push and pop at both ends.
+*/
+
+#ifndef DEQUE_H_INCLUDED
+#define DEQUE_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+
+// Minimum number of item slots of a Deque
+#define DEQUE_MIN_SIZE 8
+
+typedef struct {
+    AllocBlock *block; // Ring of item slots, all of them used bytes of the block
+    size_t itemSize;
+    size_t head, len; // Slot of the first item, number of items
+    size_t mask; // Number of slots (a power of 2) - 1, so that slots wrap with a mask
+} Deque;
+
+/**
+ * @brief Remove all items from a Deque but keep the allocated memory.
+ *
+ * @param q Deque object.
+ */
+void deque_clear(Deque *q);
+
+/**
+ * @brief Add items at the back of a Deque that were written in place into the slots returned by 
+ * deque_reserveBack.
+ *
+ * @param q Deque object.
+ * @param count Number of items written (at most the number of slots reserved).
+ * @return true if the items were added, false if the Deque has fewer free slots.
+ */
+bool deque_commitBack(Deque *q, size_t count);
+
+/**
+ * @brief Free Deque object. Does not free contained items.
+ *
+ * @param q Deque object (or NULL).
+ */
+void deque_free(Deque *q);
+
+/**
+ * @brief Get a pointer to an item in a Deque.
+ *
+ * @param q Deque object.
+ * @param idx Index of item (0 for the front).
+ * @return Pointer to desired item (NULL if it does not exist).
+ */
+void *deque_index(Deque *q, size_t idx);
+
+/**
+ * @brief Is the Deque empty?
+ *
+ * @param q Deque object.
+ * @return true if the Deque contains no items, false otherwise.
+ */
+bool deque_isEmpty(const Deque *q);
+
+/**
+ * @brief Return the number of items in a Deque.
+ *
+ * @param q Deque object.
+ * @return Number of items.
+ */
+size_t deque_len(const Deque *q);
+
+/**
+ * @brief Create a new Deque object with the default allocator (see mem_setAllocator).
+ *
+ * @param size Number of allocated item slots (rounded up to a power of 2, at least DEQUE_MIN_SIZE).
+ * @param itemSize Size of a single item (bytes).
+ * @return Deque object (or NULL if failure).
+ */
+Deque *deque_new(size_t size, size_t itemSize);
+
+/**
+ * @brief Create a new Deque object taking all of its memory from an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator). Must outlive the Deque.
+ * @param size Number of allocated item slots (rounded up to a power of 2, at least DEQUE_MIN_SIZE).
+ * @param itemSize Size of a single item (bytes).
+ * @return Deque object (or NULL if failure).
+ */
+Deque *deque_newWith(const Allocator *a, size_t size, size_t itemSize);
+
+/**
+ * @brief Remove items from the back of a Deque.
+ *
+ * @param q Deque object.
+ * @param items Where to copy the removed items to, in their order in the Deque (NULL to discard
+ * them).
+ * @param count Maximum number of items to remove.
+ * @return Number of items removed (fewer than `count` if the Deque holds fewer).
+ */
+size_t deque_popBack(Deque *q, void *items, size_t count);
+
+/**
+ * @brief Remove items from the front of a Deque.
+ *
+ * @param q Deque object.
+ * @param items Where to copy the removed items to, in their order in the Deque (NULL to discard
+ * them, e.g. after reading them in place with deque_span).
+ * @param count Maximum number of items to remove.
+ * @return Number of items removed (fewer than `count` if the Deque holds fewer).
+ */
+size_t deque_popFront(Deque *q, void *items, size_t count);
+
+/**
+ * @brief Add items at the back of a Deque, growing it if full.
+ *
+ * @param q Deque object.
+ * @param items Pointer to items (will be copied).
+ * @param count Number of items to add.
+ * @return true if push succeeded, false otherwise.
+ */
+bool deque_pushBack(Deque *q, const void *items, size_t count);
+
+/**
+ * @brief Add items at the front of a Deque, growing it if full. The items keep their order: the
+ * first of them becomes the front.
+ *
+ * @param q Deque object.
+ * @param items Pointer to items (will be copied).
+ * @param count Number of items to add.
+ * @return true if push succeeded, false otherwise.
+ */
+bool deque_pushFront(Deque *q, const void *items, size_t count);
+
+/**
+ * @brief Grow a Deque so that it holds a number of items without reallocating.
+ *
+ * @param q Deque object.
+ * @param size Number of item slots required (rounded up to a power of 2).
+ * @return true if the Deque has that many slots, false otherwise.
+ */
+bool deque_reserve(Deque *q, size_t size);
+
+/**
+ * @brief Get free slots at the back of a Deque to write items into in place (e.g. reading them 
+ * straight from a file), growing it if needed. The slots are in at most two spans: the one 
+ * following the last item, then the start of the ring. Add the items with deque_commitBack, 
+ * before any other change to the Deque.
+ *
+ * @param q Deque object.
+ * @param count Number of slots.
+ * @param spans Set to the first slot of each span (the second NULL if the slots do not wrap).
+ * @param lens Set to the number of slots of each span (the second 0 if the slots do not wrap).
+ * @return true if the slots were reserved, false otherwise.
+ */
+bool deque_reserveBack(Deque *q, size_t count, void *spans[2], size_t lens[2]);
+
+/**
+ * @brief Return the size (number of total item slots) of a Deque.
+ *
+ * @param q Deque object.
+ * @return Size.
+ */
+size_t deque_size(const Deque *q);
+
+/**
+ * @brief Get the contiguous items of a Deque starting at an index. The items are in at most two
+ * spans: the one at index 0, then the one following it.
+ *
+ * @param q Deque object.
+ * @param idx Index of the first item of the span.
+ * @param len Set to the number of items of the span (0 if none).
+ * @return Pointer to the first item of the span (NULL if it does not exist).
+ */
+void *deque_span(Deque *q, size_t idx, size_t *len);
+
+#endif // DEQUE_H_INCLUDED
@@ -14,15 +14,67 @@
 
 #include "alloc.h"
 
-#define _ALLOC_STRAT ALLOC_STRAT_BUDDY
-#define _BUFF_SIZE 1024
+// Initial buffer size (bytes) of file_read for files whose size is not known up front
+#define _BUFF_SIZE 65536
+
+// Bytes copied by file_copy between two progress reports
+#define FILE_COPY_CHUNK (16 * 1024 * 1024)
+
+// Expected access pattern of a mapped file, passed to the kernel as a paging hint
+typedef enum {
+    FILE_ACCESS_NORMAL,
+    FILE_ACCESS_SEQUENTIAL, // Aggressive read-ahead, pages behind are dropped early
+    FILE_ACCESS_RANDOM // No read-ahead
+} FileAccess;
+
+// Read-only view of a whole file mapped into memory (see file_map)
+typedef struct {
+    const char *data; // File content (not NUL terminated)
+    size_t size; // File size (bytes)
+    void *base; // Mapping to release with file_unmap (NULL for an empty file)
+} FileView;
 
 /**
- * @brief Create a file and write content to it if it does not already exist.
+ * @brief Progress report of file_copy, called after each chunk.
+ * 
+ * @param copied Number of bytes copied so far.
+ * @param total Size (bytes) of the source file when the copy started (0 if not a regular file).
+ * @param arg Argument given to file_copy.
+ * @return true to continue, false to cancel the copy.
+ */
+typedef bool (*FileProgress)(size_t copied, size_t total, void *arg);
+
+/**
+ * @brief Change the access pattern hint of a mapped file.
+ * 
+ * @param view View returned by file_map.
+ * @param access Expected access pattern.
+ * @return true if the hint was applied (or the view is empty), false otherwise.
+ */
+bool file_advise(const FileView *view, FileAccess access);
+
+/**
+ * @brief Copy a file without passing its content through user space when possible: 
+ * copy_file_range (which can share the extents on reflink capable filesystems), then sendfile, 
+ * then a read / write loop, whichever the filesystems of the two files support.
+ * 
+ * @param src Path to the file to copy.
+ * @param dst Path to the copy, created (with the permissions of `src`) or truncated.
+ * @param progress Called after each chunk of FILE_COPY_CHUNK bytes at most. Can be NULL.
+ * @param arg Passed to `progress`.
+ * @return true if the whole file was copied, false otherwise (failure, cancelled, or `dst` is 
+ * `src`). A partial copy is removed.
+ */
+bool file_copy(const char *src, const char *dst, FileProgress progress, void *arg);
+
+/**
+ * @brief Create a file and write content to it if it does not already exist. The existence check 
+ * and the creation are a single atomic step (O_CREAT | O_EXCL).
  * 
  * @param path Path to the file to be created.
  * @param content Content to write to the file.
- * @return true if the file was created and written to successfully, false otherwise.
+ * @return true if the file was created and written to successfully, false otherwise (a partly 
+ * written file is removed).
  */
 bool file_create(const char *path, const char *content);
 
@@ -34,6 +86,20 @@ bool file_create(const char *path, const char *content);
  */
 bool file_delete(const char *path);
 
+/**
+ * @brief Map a whole file into memory read-only, so it can be scanned without copying it. Pages 
+ * are loaded on first access.
+ * 
+ * @param path Path to the file to map.
+ * @param access Expected access pattern.
+ * @param view View to fill in. Left as an empty view if failure.
+ * @return true if the file was mapped, false otherwise.
+ * 
+ * @note The view stays valid after the file is deleted, but its content is undefined if the file 
+ * is truncated or modified while mapped. Release it with file_unmap.
+ */
+bool file_map(const char *path, FileAccess access, FileView *view);
+
 /**
  * @brief Open a file with the specified mode. Exits the program if it fails to open a file.
  * 
@@ -44,15 +110,50 @@ bool file_delete(const char *path);
 FILE *file_open(const char *path, const char *modes);
 
 /**
- * @brief Read the entire content of a file into a dynamically allocated buffer.
+ * @brief Read the entire content of a file into a dynamically allocated buffer. Regular files are 
+ * sized with fstat and read into a single allocation, other files (pipes, /proc files) are read in 
+ * growing chunks.
  * 
  * @param path Path to the file to be read. Must be a valid path string.
- * @return Pointer to the file content as a dynamically allocated string. NULL if an error occurs.
+ * @param size Set to the number of bytes read (0 if an error occurs). Can be NULL.
+ * @return Pointer to the file content, NUL terminated. NULL if an error occurs.
+ * 
+ * @note The caller is responsible for freeing the returned buffer with free. The content can hold 
+ * NUL bytes (binary files), use `size` rather than strlen for its length.
+ */
+char *file_read(const char *path, size_t *size);
+
+/**
+ * @brief Flush all written data and metadata of the filesystem holding a path to its storage 
+ * device (syncfs), completing a batch of file_write calls made without `sync`.
+ * 
+ * @param path Path to any file or directory on the filesystem.
+ * @return true if the filesystem was synced, false otherwise.
+ */
+bool file_syncFs(const char *path);
+
+/**
+ * @brief Release a view returned by file_map. The view is left empty.
+ * 
+ * @param view View to release (or NULL).
+ */
+void file_unmap(FileView *view);
+
+/**
+ * @brief Atomically create or replace a file. The data is written to a temporary file in the same 
+ * directory which is then renamed over `path`, so readers see either the old or the new content.
+ * 
+ * @param path Path to the file.
+ * @param data Content to write.
+ * @param size Size (bytes) of the content.
+ * @param sync true to fsync the file before the rename and its directory after it, so the new 
+ * content is durable when the call returns. false to leave it to a later file_syncFs covering 
+ * many files (a crash before it can leave the old content or, on some filesystems, an empty file).
+ * @return true if the file was written, false otherwise (the temporary file is removed and `path` 
+ * is left untouched).
  * 
- * @note The caller is responsible for freeing the returned string. If memory allocation fails or 
- * the file cannot be opened, NULL will be returned. The file content is concatenated into a 
- * single dynamically allocated buffer.
+ * @note The replaced file gets the default permissions of new files, not those of the old file.
  */
-char *file_read(const char *path);
+bool file_write(const char *path, const void *data, size_t size, bool sync);
 
 #endif
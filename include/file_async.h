@@ -0,0 +1,234 @@
+/*
+    File        : file_async.h
+    Description : Asynchronous file I/O engine over io_uring, with a thread pool (pread/pwrite) 
+                  fallback, reading into and writing from plain buffers, AllocBlocks and DArrs.
+*/
+
+#ifndef FILE_ASYNC_H_INCLUDED
+#define FILE_ASYNC_H_INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include "alloc.h"
+#include "darr.h"
+
+// Default maximum number of requests queued or in flight
+#define ASYNC_QUEUE_DEPTH 64
+
+// Number of worker threads of the thread pool engine (at most the queue depth)
+#define ASYNC_THREADS 4
+
+typedef enum {
+    ASYNC_ENGINE_AUTO, // io_uring if the kernel supports it, the thread pool otherwise
+    ASYNC_ENGINE_URING,
+    ASYNC_ENGINE_THREADS
+} AsyncEngine;
+
+typedef enum {
+    ASYNC_OP_READ,
+    ASYNC_OP_WRITE
+} AsyncOp;
+
+typedef struct {
+    void *userData; // As passed when queued
+    ssize_t result; // Bytes transferred (may be short, 0 at the end of a file), or -errno
+} AsyncCompletion;
+
+// A queued or in flight request
+typedef struct AsyncSlot {
+    struct AsyncSlot *next;
+    AsyncOp op;
+    int fd;
+    void *buff;
+    size_t size;
+    off_t offset;
+    void *userData;
+    AllocBlock *block; // Block (or block of the DArr) whose used size grows with a read
+    DArr *darr;
+    size_t pos; // Offset (bytes) in the block the read lands at
+    uint64_t seq; // Order the request was queued in
+    bool done; // Read completed (applied once the earlier reads into the block are)
+    ssize_t result;
+} AsyncSlot;
+
+typedef struct Async {
+    AsyncEngine engine;
+    unsigned depth, queued, inflight;
+    AsyncSlot *slots, *freeSlots;
+    uint64_t seq; // Requests queued so far
+
+    // io_uring: rings shared with the kernel
+    int ringFd;
+    void *sqRing, *cqRing;
+    size_t sqRingSize, cqRingSize, sqesSize;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray, *cqHead, *cqTail, *cqMask;
+    unsigned sqLocalTail; // Tail including the queued entries not yet handed to the kernel
+
+    // Thread pool: queued (not submitted), submitted and completed requests, in order
+    pthread_t *threads;
+    unsigned threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t workCond, doneCond;
+    AsyncSlot *staged, *stagedTail, *work, *workTail, *done, *doneTail;
+    bool stop;
+} Async;
+
+/**
+ * @brief Engine used by an Async object.
+ * 
+ * @param a Async object.
+ * @return ASYNC_ENGINE_URING or ASYNC_ENGINE_THREADS (ASYNC_ENGINE_AUTO if NULL object).
+ */
+AsyncEngine async_engine(const Async *a);
+
+/**
+ * @brief Free an Async object. Requests queued but not submitted are dropped, requests in flight 
+ * are waited for (their completions are discarded).
+ * 
+ * @param a Async object.
+ */
+void async_free(Async *a);
+
+/**
+ * @brief Create a new Async object.
+ * 
+ * @param depth Maximum number of requests queued or in flight. ASYNC_QUEUE_DEPTH if 0.
+ * @param engine Engine to use. ASYNC_ENGINE_URING fails if io_uring is not available (too old a 
+ * kernel, or disabled), ASYNC_ENGINE_AUTO then falls back to the thread pool.
+ * @return Async object (or NULL if failure).
+ * 
+ * @note An Async object is not thread-safe, a single thread queues and reaps its requests.
+ */
+Async *async_new(unsigned depth, AsyncEngine engine);
+
+/**
+ * @brief Number of requests queued or in flight (not yet reaped).
+ * 
+ * @param a Async object.
+ * @return Number of requests.
+ */
+size_t async_pending(const Async *a);
+
+/**
+ * @brief Reap the completed requests without blocking.
+ * 
+ * @param a Async object.
+ * @param out Array to store the completions in.
+ * @param max Size of `out`.
+ * @return Number of completions stored.
+ */
+int async_poll(Async *a, AsyncCompletion *out, int max);
+
+/**
+ * @brief Queue a read into a buffer. The request is started by async_submit (or async_wait).
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param buff Buffer, untouched by the caller until the request completes.
+ * @param size Size (bytes) to read (as with read, at most 0x7ffff000 bytes are transferred).
+ * @param offset File offset to read from.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false if failure or the queue is full (reap completions first).
+ */
+bool async_read(Async *a, int fd, void *buff, size_t size, off_t offset, void *userData);
+
+/**
+ * @brief Queue a read appended to an AllocBlock, after the reads into it still pending. The block 
+ * is grown up front when no read into it is pending (it is never moved while the kernel or a worker 
+ * writes into it, so further reads must fit its size). Its used size grows by the bytes read once 
+ * the completions of this read and of the earlier reads into the block are reaped, in the order the 
+ * reads were queued (the bytes of a short read are followed by those of the next read).
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param b AllocBlock object, untouched by the caller until the reads into it complete. Cannot use 
+ * ALLOC_STRAT_CHUNKS.
+ * @param size Size (bytes) to read.
+ * @param offset File offset to read from.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false otherwise (see async_read).
+ */
+bool async_readBlock(Async *a, int fd, AllocBlock *b, size_t size, off_t offset, void *userData);
+
+/**
+ * @brief Queue a read of items appended to a DArr, after the reads into it still pending. As with 
+ * async_readBlock, the DArr is only grown when no read into it is pending, and its length grows by 
+ * the whole items read in the order the reads were queued.
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param d DArr object, untouched by the caller until the reads into it complete. Cannot use 
+ * ALLOC_STRAT_CHUNKS, nor hold a gap (see darr_setGap).
+ * @param count Number of items to read.
+ * @param offset File offset to read from.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false otherwise (see async_read).
+ */
+bool async_readDArr(Async *a, int fd, DArr *d, size_t count, off_t offset, void *userData);
+
+/**
+ * @brief Start all queued requests.
+ * 
+ * @param a Async object.
+ * @return Number of requests started, or -1 if failure.
+ */
+int async_submit(Async *a);
+
+/**
+ * @brief Start all queued requests and wait for at least one completion, then reap the completed 
+ * requests.
+ * 
+ * @param a Async object.
+ * @param out Array to store the completions in.
+ * @param max Size of `out`.
+ * @return Number of completions stored (0 if nothing is pending), or -1 if failure.
+ */
+int async_wait(Async *a, AsyncCompletion *out, int max);
+
+/**
+ * @brief Queue a write from a buffer. The request is started by async_submit (or async_wait).
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param buff Buffer, unmodified by the caller until the request completes.
+ * @param size Size (bytes) to write (as with write, at most 0x7ffff000 bytes are transferred).
+ * @param offset File offset to write at.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false otherwise (see async_read).
+ */
+bool async_write(Async *a, int fd, const void *buff, size_t size, off_t offset, void *userData);
+
+/**
+ * @brief Queue a write of the used memory of an AllocBlock.
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param b AllocBlock object, unmodified by the caller until the request completes. Cannot use 
+ * ALLOC_STRAT_CHUNKS.
+ * @param offset File offset to write at.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false otherwise (see async_read).
+ */
+bool async_writeBlock(Async *a, int fd, const AllocBlock *b, off_t offset, void *userData);
+
+/**
+ * @brief Queue a write of the items of a DArr.
+ * 
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param d DArr object, unmodified by the caller until the request completes. Cannot use 
+ * ALLOC_STRAT_CHUNKS, nor hold a gap (see darr_setGap).
+ * @param offset File offset to write at.
+ * @param userData Passed back with the completion.
+ * @return true if queued, false otherwise (see async_read).
+ */
+bool async_writeDArr(Async *a, int fd, const DArr *d, off_t offset, void *userData);
+
+#endif // FILE_ASYNC_H_INCLUDED
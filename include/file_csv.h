@@ -0,0 +1,154 @@
+/*
+    File        : file_csv.h
+    Description : Streaming parser of delimited text (CSV, TSV) into one DArr per column, with
+                  numeric columns parsed in place and string columns stored without allocating
+                  per field.
+*/
+
+#ifndef FILE_CSV_H_INCLUDED
+#define FILE_CSV_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "darr.h"
+#include "file_reader.h"
+
+// Type of a column, and of the items of its DArr
+typedef enum {
+    CSV_SKIP, // Not stored (no DArr)
+    CSV_INT, // int64_t (an empty field is 0)
+    CSV_DOUBLE, // double (an empty field is NaN)
+    CSV_STR // CsvStr
+} CsvType;
+
+// String field: bytes of the text of the parser (see csv_str), quotes removed
+typedef struct {
+    size_t offset, len;
+} CsvStr;
+
+// Number of records parsed before their values are appended to the columns, one column at a time
+#define CSV_BATCH 256
+
+// Field of a parsed record, not yet appended (bytes from the start of the buffered data)
+typedef struct {
+    size_t start, len;
+    bool escaped; // Quoted field holding doubled quotes
+    union { int64_t i; double d; } value; // Parsed numeric value
+} CsvField;
+
+typedef struct {
+    Reader *reader;
+    char delim;
+    bool header; // The header row is still to be read
+    bool error;
+    size_t cols;
+    size_t rows; // Rows in the columns
+    CsvType *types;
+    DArr **columns; // NULL for skipped columns
+    DArr *text; // Bytes of the string fields
+    char **names; // Column names from the header row (NULL if none)
+    CsvField *fields; // Fields of the parsed records (CSV_BATCH rows of `cols`)
+    size_t batch; // Number of parsed records
+    uint64_t *marks; // Delimiters, newlines and quotes of the buffered data (see scan_mask)
+    size_t marksCap; // Words
+    void *values; // Values of a column for CSV_BATCH rows, appended at once
+    char *scratch; // Text of a column for CSV_BATCH rows, appended at once
+    size_t scratchCap;
+} Csv;
+
+/**
+ * @brief Empty the columns and the text of a parser, to parse the next rows of a large file in
+ * bounded memory. The column names are kept.
+ *
+ * @param c Parser.
+ */
+void csv_clear(Csv *c);
+
+/**
+ * @brief Column of parsed values.
+ *
+ * @param c Parser.
+ * @param col Column index.
+ * @return DArr of the type of the column (see CsvType), one item per row. NULL for a skipped
+ * column or an invalid index.
+ */
+DArr *csv_column(Csv *c, size_t col);
+
+/**
+ * @brief Check if a parser stopped on an error: a read failure, a malformed record (wrong number
+ * of fields, unterminated quotes, text after closing quotes) or an invalid number. The rows before
+ * it are kept.
+ *
+ * @param c Parser.
+ * @return true if an error occurred (or `c` is NULL), false otherwise.
+ */
+bool csv_error(const Csv *c);
+
+/**
+ * @brief Free a parser, its columns and its text. Closes its file if opened by csv_open.
+ *
+ * @param c Parser (or NULL).
+ */
+void csv_free(Csv *c);
+
+/**
+ * @brief Name of a column, from the header row.
+ *
+ * @param c Parser.
+ * @param col Column index.
+ * @return Name (NUL terminated), or NULL if there is no header or it was not read yet.
+ */
+const char *csv_name(const Csv *c, size_t col);
+
+/**
+ * @brief Create a parser reading from a file descriptor.
+ *
+ * @param fd File descriptor, left open by csv_free.
+ * @param delim Field delimiter (e.g. ',' or '\t'), neither a quote nor a newline.
+ * @param types Type of each column (copied).
+ * @param cols Number of columns. Every record must have this many fields.
+ * @param header true if the first record holds the column names.
+ * @return Parser, or NULL if failure.
+ *
+ * @note Records end at newlines outside quotes ("\r\n" too). Fields holding the delimiter, quotes
+ * or newlines are quoted, with quotes doubled ("a ""b"""). Blank lines are skipped.
+ */
+Csv *csv_new(int fd, char delim, const CsvType *types, size_t cols, bool header);
+
+/**
+ * @brief Create a parser reading a file (see csv_new).
+ *
+ * @param path Path to the file.
+ * @param delim Field delimiter.
+ * @param types Type of each column (copied).
+ * @param cols Number of columns.
+ * @param header true if the first record holds the column names.
+ * @return Parser, or NULL if failure.
+ */
+Csv *csv_open(const char *path, char delim, const CsvType *types, size_t cols, bool header);
+
+/**
+ * @brief Parse rows, appending their values to the columns.
+ *
+ * @param c Parser.
+ * @param maxRows Maximum number of rows to parse (0 for the rest of the file).
+ * @return Number of rows parsed (0 at the end of the file or on error, see csv_error).
+ */
+size_t csv_read(Csv *c, size_t maxRows);
+
+/**
+ * @brief String field of a parsed row.
+ *
+ * @param c Parser.
+ * @param col Column index (of type CSV_STR).
+ * @param row Row index (in the current columns, see csv_clear).
+ * @param len Set to the length (bytes) of the field.
+ * @return Start of the field (not NUL terminated), valid until the next csv_read or csv_clear.
+ * NULL if invalid arguments.
+ */
+const char *csv_str(Csv *c, size_t col, size_t row, size_t *len);
+
+#endif // FILE_CSV_H_INCLUDED
@@ -0,0 +1,82 @@
+/*
+    File        : file_index.h
+    Description : Line offset index of large text files, built by scanning byte ranges in parallel,
+                  and persisted to a sidecar file for instant reopening.
+*/
+
+#ifndef FILE_INDEX_H_INCLUDED
+#define FILE_INDEX_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "darr.h"
+#include "file.h"
+
+// Minimum number of bytes of each range scanned in parallel (smaller inputs use fewer ranges)
+#define INDEX_MIN_RANGE 1048576
+
+// Suffix of the sidecar file of index_open
+#define INDEX_SUFFIX ".idx"
+
+/**
+ * @brief Build the line index of a buffer: a DArr of size_t holding the byte offset where each
+ * line starts. A line ends at a newline or at the end of the buffer, a final newline does not
+ * start an empty line.
+ *
+ * @param data Buffer (e.g. the data of a FileView).
+ * @param size Size (bytes) of the buffer.
+ * @param threads Maximum number of ranges scanned in parallel on the shared thread pool (see
+ * tpool_default), one per core if 0.
+ * @return Line index (empty for an empty buffer), or NULL if failure.
+ */
+DArr *index_build(const char *data, size_t size, unsigned threads);
+
+/**
+ * @brief Get a line of a buffer from its index.
+ *
+ * @param idx Line index built over the buffer.
+ * @param data Buffer.
+ * @param size Size (bytes) of the buffer.
+ * @param n Line number (from 0).
+ * @param line Set to the start of the line (not NUL terminated).
+ * @param len Set to the length (bytes) of the line, without its newline.
+ * @return true if the line exists, false otherwise.
+ */
+bool index_line(DArr *idx, const char *data, size_t size, size_t n, const char **line, size_t *len);
+
+/**
+ * @brief Load a line index saved with index_save.
+ *
+ * @param path Path to the index file.
+ * @param source Path to the file the index was built over. Can be NULL to skip the check.
+ * @return Line index, or NULL if failure, if the index file is invalid, or if `source` changed
+ * (size or modification time) since the index was saved.
+ */
+DArr *index_load(const char *path, const char *source);
+
+/**
+ * @brief Line index of a file, loaded from its sidecar file (path + INDEX_SUFFIX) if it is up to
+ * date, otherwise built over the mapped file and saved to the sidecar.
+ *
+ * @param path Path to the file.
+ * @param threads Maximum number of ranges to build with in parallel (one per core if 0).
+ * @return Line index, or NULL if failure. A sidecar that cannot be written is not a failure.
+ */
+DArr *index_open(const char *path, unsigned threads);
+
+/**
+ * @brief Save a line index, with the size and modification time of the file it was built over.
+ *
+ * @param idx Line index.
+ * @param path Path to the index file (native byte order, not portable between architectures).
+ * @param source Path to the file the index was built over.
+ * @return true if saved, false otherwise.
+ * @note `source` is stat'ed when saving: save before it can change, or the index is taken as up to 
+ * date with a version it was not built over (index_open stats the file before mapping it instead).
+ */
+bool index_save(DArr *idx, const char *path, const char *source);
+
+#endif // FILE_INDEX_H_INCLUDED
@@ -0,0 +1,110 @@
+/*
+    File        : file_reader.h
+    Description : Streaming file reader yielding chunks or lines from a reusable buffer, for files 
+                  too large to be read whole.
+*/
+
+#ifndef FILE_READER_H_INCLUDED
+#define FILE_READER_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include "file.h"
+
+// Default size (bytes) of the buffer of a reader
+#define READER_BUFF_SIZE 65536
+
+typedef struct Reader {
+    int fd;
+    bool owned; // The descriptor was opened by the reader and is closed by reader_free
+    bool stream; // Pipe or socket (no file offset, reads return what is available)
+    bool eof, error;
+    FileAccess access;
+    char *buff;
+    size_t cap, start, end; // Data not yet handed out is buff[start, end)
+    off_t offset; // File offset of the end of the buffered data
+} Reader;
+
+/**
+ * @brief Check if the reader stopped because of a read error (rather than the end of the file).
+ * 
+ * @param r Reader object.
+ * @return true if a read failed, false otherwise.
+ */
+bool reader_error(const Reader *r);
+
+/**
+ * @brief Free a Reader object, closing its file if it was opened by reader_open.
+ * 
+ * @param r Reader object.
+ */
+void reader_free(Reader *r);
+
+/**
+ * @brief Next line of the file. Lines are returned in place from the buffer, which only grows 
+ * if a single line does not fit in it.
+ * 
+ * @param r Reader object.
+ * @param line Set to the start of the line (without the newline, not NUL terminated). Valid until 
+ * the next call on the reader.
+ * @param len Set to the length (bytes) of the line.
+ * @return true if a line was read, false at the end of the file or if failure.
+ */
+bool reader_line(Reader *r, const char **line, size_t *len);
+
+/**
+ * @brief Create a new Reader over an open file descriptor. The descriptor is read from its 
+ * current offset and is left open by reader_free.
+ * 
+ * @param fd File descriptor (a file, pipe or socket).
+ * @param buffSize Size (bytes) of the buffer. READER_BUFF_SIZE if 0.
+ * @param access Expected access pattern, passed to the kernel with posix_fadvise. With 
+ * FILE_ACCESS_SEQUENTIAL the next buffer of the file is also prefetched on every refill.
+ * @return Reader object (or NULL if failure).
+ */
+Reader *reader_new(int fd, size_t buffSize, FileAccess access);
+
+/**
+ * @brief Create a new Reader over a file.
+ * 
+ * @param path Path to the file.
+ * @param buffSize Size (bytes) of the buffer. READER_BUFF_SIZE if 0.
+ * @param access Expected access pattern (see reader_new).
+ * @return Reader object (or NULL if failure).
+ */
+Reader *reader_open(const char *path, size_t buffSize, FileAccess access);
+
+/**
+ * @brief Data buffered and not yet consumed, reading more first if fewer than `min` bytes are 
+ * buffered (the buffer grows if they do not fit). Nothing is consumed, see reader_skip.
+ * 
+ * @param r Reader object.
+ * @param data Set to the start of the data. Valid until the next call on the reader.
+ * @param min Number of bytes wanted.
+ * @return Size (bytes) of the data: at least `min`, unless the end of the file was reached or 
+ * failure.
+ */
+size_t reader_peek(Reader *r, const char **data, size_t min);
+
+/**
+ * @brief Next chunk of the file. Chunks fill the buffer, except the last one and chunks of 
+ * pipes that reach the end of the available data.
+ * 
+ * @param r Reader object.
+ * @param chunk Set to the start of the chunk. Valid until the next call on the reader.
+ * @return Size (bytes) of the chunk, or 0 at the end of the file or if failure.
+ */
+size_t reader_read(Reader *r, const char **chunk);
+
+/**
+ * @brief Consume data returned by reader_peek.
+ * 
+ * @param r Reader object.
+ * @param n Number of bytes to consume (at most the buffered data).
+ */
+void reader_skip(Reader *r, size_t n);
+
+#endif // FILE_READER_H_INCLUDED
@@ -0,0 +1,158 @@
+/*
+    File        : file_writer.h
+    Description : Buffered file writer over direct write calls, coalescing small records into large 
+                  writes, with number formatting that bypasses stdio.
+*/
+
+#ifndef FILE_WRITER_H_INCLUDED
+#define FILE_WRITER_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+
+#include "darr.h"
+#include "file.h"
+
+// Default size (bytes) of the buffer of a writer
+#define WRITER_BUFF_SIZE 65536
+
+// Maximum number of decimals of writer_double (larger values are clamped)
+#define WRITER_MAX_DECIMALS 17
+
+typedef struct Writer {
+    int fd;
+    bool owned; // The descriptor was opened by the writer and is closed by writer_free
+    bool error;
+    char *buff;
+    size_t cap, len;
+} Writer;
+
+/**
+ * @brief Write the raw bytes of the items of a DArr (each chunk of a chunked DArr is written in 
+ * place, and the items around the gap of a gap buffer DArr without the gap).
+ * 
+ * @param w Writer object.
+ * @param d DArr object.
+ * @return true if the items were written or buffered, false if failure.
+ */
+bool writer_darr(Writer *w, DArr *d);
+
+/**
+ * @brief Write a floating point number in fixed notation (as "%.*f"). Values below 2^53 once scaled 
+ * by the decimals are formatted directly, rounded half to even (the scaling can round, so the last 
+ * decimal may differ from printf for values close to a tie); others (and NaN, infinity) fall back 
+ * to snprintf.
+ * 
+ * @param w Writer object.
+ * @param v Value.
+ * @param decimals Number of decimals (0 to WRITER_MAX_DECIMALS).
+ * @return true if the number was written or buffered, false if failure.
+ */
+bool writer_double(Writer *w, double v, int decimals);
+
+/**
+ * @brief Check if a write failed. Once set, all further writes fail.
+ * 
+ * @param w Writer object.
+ * @return true if a write failed, false otherwise.
+ */
+bool writer_error(const Writer *w);
+
+/**
+ * @brief Write the buffered data to the file.
+ * 
+ * @param w Writer object.
+ * @return true if all buffered data was written, false if failure.
+ */
+bool writer_flush(Writer *w);
+
+/**
+ * @brief Flush and free a Writer object, closing its file if it was opened by writer_open.
+ * 
+ * @param w Writer object.
+ * 
+ * @note Errors of the last flush are lost, call writer_flush (or writer_sync) first to check them.
+ */
+void writer_free(Writer *w);
+
+/**
+ * @brief Write a signed integer in decimal.
+ * 
+ * @param w Writer object.
+ * @param v Value.
+ * @return true if the number was written or buffered, false if failure.
+ */
+bool writer_int(Writer *w, int64_t v);
+
+/**
+ * @brief Create a new Writer over an open file descriptor. The descriptor is left open by 
+ * writer_free.
+ * 
+ * @param fd File descriptor (a file, pipe or socket).
+ * @param buffSize Size (bytes) of the buffer. WRITER_BUFF_SIZE if 0.
+ * @return Writer object (or NULL if failure).
+ */
+Writer *writer_new(int fd, size_t buffSize);
+
+/**
+ * @brief Create a new Writer over a file, created if needed and truncated.
+ * 
+ * @param path Path to the file.
+ * @param buffSize Size (bytes) of the buffer. WRITER_BUFF_SIZE if 0.
+ * @return Writer object (or NULL if failure).
+ */
+Writer *writer_open(const char *path, size_t buffSize);
+
+/**
+ * @brief Write a NUL terminated string (without the terminator).
+ * 
+ * @param w Writer object.
+ * @param s String.
+ * @return true if the string was written or buffered, false if failure.
+ */
+bool writer_str(Writer *w, const char *s);
+
+/**
+ * @brief Flush the buffered data and wait until the file content is on the storage device 
+ * (fdatasync).
+ * 
+ * @param w Writer object.
+ * @return true if the data is durable, false if failure.
+ */
+bool writer_sync(Writer *w);
+
+/**
+ * @brief Write an unsigned integer in decimal.
+ * 
+ * @param w Writer object.
+ * @param v Value.
+ * @return true if the number was written or buffered, false if failure.
+ */
+bool writer_uint(Writer *w, uint64_t v);
+
+/**
+ * @brief Write a range of bytes. Data that fits is copied into the buffer, larger data is written 
+ * together with the buffered data in a single writev call.
+ * 
+ * @param w Writer object.
+ * @param data Data.
+ * @param size Size (bytes) of the data.
+ * @return true if the data was written or buffered, false if failure.
+ */
+bool writer_write(Writer *w, const void *data, size_t size);
+
+/**
+ * @brief Write several segments of data, in order. Segments are written in a single writev call 
+ * with the buffered data unless they all fit in the buffer.
+ * 
+ * @param w Writer object.
+ * @param iov Segments.
+ * @param count Number of segments.
+ * @return true if the data was written or buffered, false if failure.
+ */
+bool writer_writev(Writer *w, const struct iovec *iov, int count);
+
+#endif // FILE_WRITER_H_INCLUDED
@@ -7,6 +7,19 @@
 #ifndef MATH_H_INCLUDED
 #define MATH_H_INCLUDED
 
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Number of bits in a size_t
+#define MATH_SIZE_BITS ((int)(sizeof(size_t) * CHAR_BIT))
+
+// Use compiler builtins for bit manipulation unless MATH_NO_BUILTINS is defined
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(MATH_NO_BUILTINS)
+    #define MATH_BUILTINS
+    #define _MATH_ULL_BITS ((int)(sizeof(unsigned long long) * CHAR_BIT))
+#endif
+
 /**
  * @brief Compute the maximum value between `x` and `y`.
  * 
@@ -25,4 +38,87 @@
  */
 #define math_min(x, y) ((x) < (y) ? (x) : (y))
 
+/**
+ * @brief Count the leading (most significant) zero bits.
+ * 
+ * @param x Value.
+ * @return Number of leading zero bits (MATH_SIZE_BITS if `x` is 0).
+ */
+static inline int math_clz(size_t x) {
+    if (x == 0) return MATH_SIZE_BITS;
+#ifdef MATH_BUILTINS
+    return __builtin_clzll((unsigned long long)x) - (_MATH_ULL_BITS - MATH_SIZE_BITS);
+#else
+    int n = 0;
+    for (int shift = MATH_SIZE_BITS / 2; shift > 0; shift /= 2) {
+        if ((x >> (MATH_SIZE_BITS - shift)) == 0) { n += shift; x <<= shift; }
+    }
+    return n;
+#endif
+}
+
+/**
+ * @brief Count the trailing (least significant) zero bits.
+ * 
+ * @param x Value.
+ * @return Number of trailing zero bits (MATH_SIZE_BITS if `x` is 0).
+ */
+static inline int math_ctz(size_t x) {
+    if (x == 0) return MATH_SIZE_BITS;
+#ifdef MATH_BUILTINS
+    return __builtin_ctzll((unsigned long long)x);
+#else
+    int n = 0;
+    for (int shift = MATH_SIZE_BITS / 2; shift > 0; shift /= 2) {
+        if ((x & (((size_t)1 << shift) - 1)) == 0) { n += shift; x >>= shift; }
+    }
+    return n;
+#endif
+}
+
+/**
+ * @brief Floor of the base 2 logarithm (index of the most significant set bit).
+ * 
+ * @param x Value.
+ * @return Base 2 logarithm of `x`, or -1 if `x` is 0.
+ */
+static inline int math_ilog2(size_t x) { return MATH_SIZE_BITS - 1 - math_clz(x); }
+
+/**
+ * @brief Is the value a power of 2?
+ * 
+ * @param x Value.
+ * @return true if `x` is a power of 2, false otherwise (including 0).
+ */
+static inline bool math_isPow2(size_t x) { return x != 0 && (x & (x - 1)) == 0; }
+
+/**
+ * @brief Round up to the nearest (ceiling) power of 2.
+ * 
+ * @param x Value.
+ * @return Smallest power of 2 that is greater than or equal to `x` (1 if `x` is 0), or 0 if it 
+ * cannot be represented in a size_t (overflow).
+ */
+static inline size_t math_nextPow2(size_t x) {
+    if (x <= 1) return 1;
+    int bits = MATH_SIZE_BITS - math_clz(x - 1);
+    return bits < MATH_SIZE_BITS ? (size_t)1 << bits : 0;
+}
+
+/**
+ * @brief Count the set bits.
+ * 
+ * @param x Value.
+ * @return Number of set bits.
+ */
+static inline int math_popcount(size_t x) {
+#ifdef MATH_BUILTINS
+    return __builtin_popcountll((unsigned long long)x);
+#else
+    int n = 0;
+    for (; x != 0; x &= x - 1) n++;
+    return n;
+#endif
+}
+
 #endif // MATH_H_INCLUDED
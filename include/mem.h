@@ -1,4 +1,3 @@
-
 /*
     File        : mem.h
     Description : Dynamic memory management operations.
@@ -7,11 +6,43 @@
 #ifndef MEM_H_INCLUDED
 #define MEM_H_INCLUDED
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+// Number of size classes in the allocation histogram. Class i counts sizes up to 16 << i bytes
+// (and above 8 << i), the last class also counts all larger sizes.
+#define MEM_STATS_CLASSES 20
+
+// Growth (bytes) of the live bytes of a thread that samples the peak bytes. Live bytes are counted 
+// per thread and summed on read, so the peak is sampled by reads and by threads growing by a step
+#define MEM_STATS_PEAK_STEP 65536
+
+// Allocator interface. `ctx` is passed back to every call (e.g. the arena or heap the memory is
+// taken from). Memory must be released with the allocator it was allocated from.
+typedef struct Allocator {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *p, size_t oldSize, size_t newSize); // Must accept NULL `p`
+    void (*free)(void *ctx, void *p, size_t size); // Must accept NULL `p`
+    void *ctx;
+} Allocator;
+
+// Statistics of the memory allocated through mem_* (which includes all AllocBlock, DArr and pool memory)
+typedef struct {
+    size_t liveBytes;
+    size_t peakBytes; // Sampled: may miss up to MEM_STATS_PEAK_STEP bytes per thread
+    size_t allocs, frees, reallocs;
+    size_t reallocBytesCopied; // Bytes moved by reallocations that could not resize in place
+    size_t sizeClasses[MEM_STATS_CLASSES]; // Allocations and reallocations by (new) size
+} MemStats;
+
+typedef enum {
+    MEM_STATS_TEXT,
+    MEM_STATS_JSON
+} MemStatsFormat;
+
 /**
- * @brief Allocates a block of memory of the given size.
+ * @brief Allocates a block of memory of the given size with the default allocator.
  *
  * @param size The number of bytes to allocate. If 0, NULL is returned.
  * @return A pointer to the allocated memory block, or NULL if `size` is 0.
@@ -20,7 +51,27 @@
 void *mem_alloc(size_t size);
 
 /**
- * @brief Allocates memory for an array of elements and initialises them to zero.
+ * @brief Allocate a small object (e.g. the header of a container) with an allocator. Objects of the
+ * system allocator come from the per-thread small object pools (see pool_allocSmall).
+ *
+ * @param a Allocator.
+ * @param size Size (bytes) of the object.
+ * @return Uninitialised object, or NULL if failure.
+ */
+void *mem_allocObject(const Allocator *a, size_t size);
+
+/**
+ * @brief Allocate memory with an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator).
+ * @param size Size (bytes) to allocate.
+ * @return Pointer to the memory, or NULL if failure or `size` is 0.
+ */
+void *mem_allocWith(const Allocator *a, size_t size);
+
+/**
+ * @brief Allocates memory for an array of elements with the default allocator and initialises
+ *        them to zero.
  *
  * @param num The number of elements to allocate. If 0, NULL is returned.
  * @param size The size of each element in bytes. If 0, NULL is returned.
@@ -30,13 +81,114 @@ void *mem_alloc(size_t size);
 void *mem_calloc(size_t num, size_t size);
 
 /**
- * @brief Resizes a previously allocated memory block.
+ * @brief Dump the memory statistics.
+ *
+ * @param f Stream to write to.
+ * @param format MEM_STATS_TEXT (one value per line) or MEM_STATS_JSON (a single object).
+ * @return true if the statistics were written, false otherwise.
+ */
+bool mem_dumpStats(FILE *f, MemStatsFormat format);
+
+/**
+ * @brief Enable or disable the memory statistics. They are disabled by default, which costs one
+ * flag check per allocation.
+ *
+ * @param enable true to record statistics, false to stop recording (the values are kept).
+ *
+ * @note Memory allocated while disabled and freed while enabled makes the live bytes inaccurate,
+ * enable the statistics before allocating.
+ */
+void mem_enableStats(bool enable);
+
+/**
+ * @brief Frees a memory block allocated with the default allocator.
+ *
+ * @param p A pointer to the memory block, or NULL.
+ * @param size The size of the block in bytes (as allocated or last resized).
+ */
+void mem_free(void *p, size_t size);
+
+/**
+ * @brief Free a small object allocated with mem_allocObject.
+ *
+ * @param a Allocator the object was allocated with.
+ * @param p Object, or NULL.
+ * @param size Size (bytes) of the object.
+ */
+void mem_freeObject(const Allocator *a, void *p, size_t size);
+
+/**
+ * @brief Free memory with an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator).
+ * @param p Pointer to the memory, or NULL.
+ * @param size Size (bytes) of the memory (as allocated or last resized).
+ */
+void mem_freeWith(const Allocator *a, void *p, size_t size);
+
+/**
+ * @brief The default allocator, used by every container that is not given one.
+ *
+ * @return Allocator (the system allocator unless replaced with mem_setAllocator).
+ */
+const Allocator *mem_getAllocator(void);
+
+/**
+ * @brief Current memory statistics, merged from the counters of all threads.
+ *
+ * @return Statistics (all zero if never enabled).
+ */
+MemStats mem_getStats(void);
+
+/**
+ * @brief Resizes a memory block allocated with the default allocator.
  *
  * @param p A pointer to the previously allocated memory block, or NULL.
+ * @param oldSize The current size of the block in bytes (0 if `p` is NULL).
  * @param size The new size in bytes. If 0, the memory is freed.
  * @return A pointer to the reallocated memory block, or NULL if size is 0.
  *         Exits the program if reallocation fails (when size is non-zero).
  */
-void *mem_realloc(void *p, size_t size);
+void *mem_realloc(void *p, size_t oldSize, size_t size);
+
+/**
+ * @brief Resize memory with an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator).
+ * @param p Pointer to the memory, or NULL.
+ * @param oldSize Current size (bytes) of the memory.
+ * @param newSize New size (bytes).
+ * @return Pointer to the resized memory, or NULL if failure or `newSize` is 0 (`p` is then left
+ * untouched).
+ */
+void *mem_reallocWith(const Allocator *a, void *p, size_t oldSize, size_t newSize);
+
+/**
+ * @brief Reset the memory statistics counters. The live bytes are kept and the peak restarts from
+ * them.
+ */
+void mem_resetStats(void);
+
+/**
+ * @brief Replace the default allocator. Containers keep the allocator they were created with, so
+ * their memory is always released with the allocator it came from.
+ *
+ * @param a Allocator (NULL to restore the system allocator). Must outlive its use as the default.
+ */
+void mem_setAllocator(const Allocator *a);
+
+/**
+ * @brief Check if the memory statistics are being recorded.
+ *
+ * @return true if enabled, false otherwise.
+ */
+bool mem_statsEnabled(void);
+
+/**
+ * @brief The system allocator (malloc/realloc/free).
+ *
+ * @return Allocator.
+ */
+const Allocator *mem_systemAllocator(void);
 
 #endif // MEM_H_INCLUDED
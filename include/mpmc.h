@@ -0,0 +1,132 @@
+/*
+    File        : mpmc.h
+    Description : Bounded lock-free queue of items of any single type shared by any number of
+                  producer and consumer threads, with blocking variants waiting on futexes.
+*/
+
+#ifndef MPMC_H_INCLUDED
+#define MPMC_H_INCLUDED
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+
+// Size (bytes) of a cache line, the padding between the positions of producers and consumers
+#define MPMC_CACHE_LINE 64
+
+// Minimum number of item slots of a Mpmc
+#define MPMC_MIN_SIZE 2
+
+// Each slot holds a sequence number followed by an item. A slot is free for the push at position
+// `pos` when its sequence is `pos`, and holds the item for the pop at `pos` when it is `pos + 1`.
+// Producers and consumers claim positions with a compare and swap, then publish the slot by
+// storing its next sequence.
+typedef struct {
+    AllocBlock *block; // Slots
+    char *slots; // Memory of the block
+    size_t itemSize;
+    size_t stride; // Size (bytes) of a slot
+    size_t mask; // Number of slots (a power of 2) - 1
+    char pad0[MPMC_CACHE_LINE];
+    _Atomic size_t tail; // Position of the next push
+    char pad1[MPMC_CACHE_LINE];
+    _Atomic size_t head; // Position of the next pop
+    char pad2[MPMC_CACHE_LINE];
+    // Futex words of blocked consumers / producers: bit 0 set while threads block on it, the
+    // other bits count the wakes. Each wake reaches a single thread.
+    _Atomic uint32_t pushed, popped;
+    _Atomic uint32_t popWaiters, pushWaiters; // Threads about to block or blocked on each word
+    atomic_bool closed;
+} Mpmc;
+
+/**
+ * @brief Close a Mpmc: pushes fail from now on, pops fail once it is empty. Wakes all blocked
+ * threads.
+ *
+ * @param q Mpmc object.
+ */
+void mpmc_close(Mpmc *q);
+
+/**
+ * @brief Free Mpmc object. No thread may use it anymore.
+ *
+ * @param q Mpmc object (or NULL).
+ */
+void mpmc_free(Mpmc *q);
+
+/**
+ * @brief Return the number of items in a Mpmc (a snapshot while other threads use it).
+ *
+ * @param q Mpmc object.
+ * @return Number of items.
+ */
+size_t mpmc_len(Mpmc *q);
+
+/**
+ * @brief Create a new Mpmc object with the default allocator (see mem_setAllocator).
+ *
+ * @param size Number of item slots (rounded up to a power of 2, at least MPMC_MIN_SIZE). The queue
+ * does not grow.
+ * @param itemSize Size of a single item (bytes).
+ * @return Mpmc object (or NULL if failure).
+ */
+Mpmc *mpmc_new(size_t size, size_t itemSize);
+
+/**
+ * @brief Create a new Mpmc object taking all of its memory from an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator). Must outlive the Mpmc.
+ * @param size Number of item slots (rounded up to a power of 2, at least MPMC_MIN_SIZE).
+ * @param itemSize Size of a single item (bytes).
+ * @return Mpmc object (or NULL if failure).
+ */
+Mpmc *mpmc_newWith(const Allocator *a, size_t size, size_t itemSize);
+
+/**
+ * @brief Remove an item, sleeping while the queue is empty.
+ *
+ * @param q Mpmc object.
+ * @param item Where to copy the item to.
+ * @return true if an item was removed, false if the queue is closed and empty.
+ */
+bool mpmc_pop(Mpmc *q, void *item);
+
+/**
+ * @brief Add an item, sleeping while the queue is full.
+ *
+ * @param q Mpmc object.
+ * @param item Pointer to the item (will be copied).
+ * @return true if the item was added, false if the queue is closed.
+ */
+bool mpmc_push(Mpmc *q, const void *item);
+
+/**
+ * @brief Return the size (number of item slots) of a Mpmc.
+ *
+ * @param q Mpmc object.
+ * @return Size.
+ */
+size_t mpmc_size(const Mpmc *q);
+
+/**
+ * @brief Remove an item if there is one. Never blocks.
+ *
+ * @param q Mpmc object.
+ * @param item Where to copy the item to.
+ * @return true if an item was removed, false if the queue is empty.
+ */
+bool mpmc_tryPop(Mpmc *q, void *item);
+
+/**
+ * @brief Add an item if there is room. Never blocks.
+ *
+ * @param q Mpmc object.
+ * @param item Pointer to the item (will be copied).
+ * @return true if the item was added, false if the queue is full or closed.
+ */
+bool mpmc_tryPush(Mpmc *q, const void *item);
+
+#endif // MPMC_H_INCLUDED
@@ -0,0 +1,87 @@
+/*
+    File        : scan.h
+    Description : Byte search kernels (first byte, first of a set, occurrence count) with SSE2, AVX2
+                  and AVX-512 implementations selected at runtime, and a scalar fallback.
+*/
+
+#ifndef SCAN_H_INCLUDED
+#define SCAN_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "math.h"
+
+// Largest set searched by scan_any with vector compares (larger sets use a lookup table)
+#define SCAN_SET_MAX 8
+
+typedef enum {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2,
+    SCAN_AVX512 // AVX-512 BW
+} ScanLevel;
+
+/**
+ * @brief Find the first byte of a buffer that is in a set (as strpbrk, with explicit lengths).
+ *
+ * @param s Buffer.
+ * @param n Size (bytes) of the buffer.
+ * @param set Bytes to search for (may contain NUL).
+ * @param setLen Number of bytes in the set.
+ * @return Pointer to the first byte found, or NULL if none.
+ */
+const char *scan_any(const char *s, size_t n, const char *set, size_t setLen);
+
+/**
+ * @brief Find the first occurrence of a byte in a buffer (as memchr).
+ *
+ * @param s Buffer.
+ * @param n Size (bytes) of the buffer.
+ * @param c Byte to search for.
+ * @return Pointer to the byte, or NULL if not found.
+ */
+const char *scan_byte(const char *s, size_t n, char c);
+
+/**
+ * @brief Count the occurrences of a byte in a buffer.
+ *
+ * @param s Buffer.
+ * @param n Size (bytes) of the buffer.
+ * @param c Byte to count.
+ * @return Number of occurrences.
+ */
+size_t scan_count(const char *s, size_t n, char c);
+
+/**
+ * @brief Instruction set level of the kernels in use: the best one supported by the CPU, unless
+ * lowered with scan_setLevel.
+ *
+ * @return Level.
+ */
+ScanLevel scan_level(void);
+
+/**
+ * @brief Mark the bytes of a buffer that are in a set, 64 per word: bit `i % 64` of 
+ * `masks[i / 64]` is set if `s[i]` is in the set. Lets a parser walk all its delimiters with bit 
+ * operations rather than search for each one.
+ *
+ * @param s Buffer.
+ * @param n Size (bytes) of the buffer.
+ * @param set Bytes to mark (may contain NUL).
+ * @param setLen Number of bytes in the set.
+ * @param masks Set to the marks, (n + 63) / 64 words (the bits past `n` are 0).
+ */
+void scan_mask(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks);
+
+/**
+ * @brief Select the kernels of an instruction set level (e.g. to compare them, or to test the
+ * fallbacks). Applies to all threads.
+ *
+ * @param level Level, lowered to the best one supported by the CPU.
+ * @return Level in use.
+ */
+ScanLevel scan_setLevel(ScanLevel level);
+
+#endif // SCAN_H_INCLUDED
@@ -0,0 +1,103 @@
+/*
+    File        : spsc.h
+    Description : Bounded lock-free ring buffer moving items of any single type from one producer
+                  thread to one consumer thread, in batches.
+*/
+
+#ifndef SPSC_H_INCLUDED
+#define SPSC_H_INCLUDED
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+
+// Size (bytes) of a cache line, the padding between the indices of the two threads
+#define SPSC_CACHE_LINE 64
+
+// Minimum number of item slots of a Spsc
+#define SPSC_MIN_SIZE 2
+
+// Indices count items since creation (they are not wrapped), slots are indices masked by `mask`.
+// Each thread writes one index and keeps a cached copy of the other, read again only when the
+// cached copy shows the ring full (producer) or empty (consumer).
+typedef struct {
+    AllocBlock *block; // Item slots
+    char *slots; // Memory of the block
+    size_t itemSize;
+    size_t mask; // Number of slots (a power of 2) - 1
+    char pad0[SPSC_CACHE_LINE];
+    _Atomic size_t tail; // Items published by the producer
+    size_t headCache; // Producer copy of `head`
+    char pad1[SPSC_CACHE_LINE];
+    _Atomic size_t head; // Items consumed by the consumer
+    size_t tailCache; // Consumer copy of `tail`
+    char pad2[SPSC_CACHE_LINE];
+} Spsc;
+
+/**
+ * @brief Free Spsc object. No thread may use it anymore.
+ *
+ * @param q Spsc object (or NULL).
+ */
+void spsc_free(Spsc *q);
+
+/**
+ * @brief Return the number of items in a Spsc. Exact from the producer or the consumer thread
+ * when the other is idle, a snapshot otherwise.
+ *
+ * @param q Spsc object.
+ * @return Number of items.
+ */
+size_t spsc_len(Spsc *q);
+
+/**
+ * @brief Create a new Spsc object with the default allocator (see mem_setAllocator).
+ *
+ * @param size Number of item slots (rounded up to a power of 2, at least SPSC_MIN_SIZE). The ring
+ * does not grow.
+ * @param itemSize Size of a single item (bytes).
+ * @return Spsc object (or NULL if failure).
+ */
+Spsc *spsc_new(size_t size, size_t itemSize);
+
+/**
+ * @brief Create a new Spsc object taking all of its memory from an allocator.
+ *
+ * @param a Allocator (NULL for the default allocator). Must outlive the Spsc.
+ * @param size Number of item slots (rounded up to a power of 2, at least SPSC_MIN_SIZE).
+ * @param itemSize Size of a single item (bytes).
+ * @return Spsc object (or NULL if failure).
+ */
+Spsc *spsc_newWith(const Allocator *a, size_t size, size_t itemSize);
+
+/**
+ * @brief Consume items. Only called by the consumer thread. Never blocks.
+ *
+ * @param q Spsc object.
+ * @param items Where to copy the items to, in the order they were pushed.
+ * @param count Maximum number of items to consume.
+ * @return Number of items consumed, all released to the producer at once (0 if empty).
+ */
+size_t spsc_pop(Spsc *q, void *items, size_t count);
+
+/**
+ * @brief Publish items. Only called by the producer thread. Never blocks.
+ *
+ * @param q Spsc object.
+ * @param items Pointer to items (will be copied).
+ * @param count Maximum number of items to publish.
+ * @return Number of items published, all made visible to the consumer at once (0 if full).
+ */
+size_t spsc_push(Spsc *q, const void *items, size_t count);
+
+/**
+ * @brief Return the size (number of item slots) of a Spsc.
+ *
+ * @param q Spsc object.
+ * @return Size.
+ */
+size_t spsc_size(const Spsc *q);
+
+#endif // SPSC_H_INCLUDED
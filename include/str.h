@@ -13,7 +13,8 @@
 #include "mem.h"
 
 /**
- * @brief Join two strings together into a new dynamically allocated string.
+ * @brief Join two strings together into a new string allocated with the default allocator (release 
+ * it with mem_free, its size is its length + 1).
  * 
  * @param l Left string (must be non-NULL).
  * @param r Right string (must be non-NULL).
@@ -0,0 +1,141 @@
+/*
+    File        : tpool.h
+    Description : Work-stealing thread pool running the parallel operations of the library: a
+                  Chase-Lev deque per worker, idle workers parked on a futex, and task groups to
+                  wait on.
+*/
+
+#ifndef TPOOL_H_INCLUDED
+#define TPOOL_H_INCLUDED
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+#include "mpmc.h"
+
+// Size (bytes) of a cache line, the padding between the deque indices of the workers
+#define TPOOL_CACHE_LINE 64
+
+// Initial number of task slots of each worker deque (grown when full)
+#define TPOOL_DEQUE_SIZE 256
+
+// Number of task slots of the queue of tasks submitted from outside the pool
+#define TPOOL_INJECT_SIZE 4096
+
+typedef void (*TPoolFn)(void *arg);
+
+// Tasks submitted together, to wait for (see tpool_wait)
+typedef struct {
+    _Atomic size_t pending; // Tasks submitted and not finished yet
+} TPoolGroup;
+
+typedef struct {
+    TPoolFn fn;
+    void *arg;
+    TPoolGroup *group; // NULL if none
+} TPoolTask;
+
+// Ring of task slots of a worker deque. Rings replaced by larger ones are kept (in `prev`) until
+// the pool is freed, as thieves may still read them.
+typedef struct TPoolRing {
+    struct TPoolRing *prev;
+    size_t mask; // Number of slots (a power of 2) - 1
+    _Atomic(TPoolTask*) slots[];
+} TPoolRing;
+
+struct TPool;
+
+// Worker thread and its deque: the worker pushes and takes tasks at the bottom, other threads
+// steal them from the top
+typedef struct {
+    struct TPool *pool;
+    pthread_t thread;
+    unsigned id;
+    unsigned seed; // Victim selection of the worker
+    _Atomic(TPoolRing*) ring;
+    char pad0[TPOOL_CACHE_LINE];
+    _Atomic int64_t top;
+    char pad1[TPOOL_CACHE_LINE];
+    _Atomic int64_t bottom;
+    char pad2[TPOOL_CACHE_LINE];
+} TPoolWorker;
+
+typedef struct TPool {
+    TPoolWorker *workers;
+    unsigned count;
+    bool pin; // Workers pinned to CPUs
+    Mpmc *inject; // Tasks submitted from outside the pool (TPoolTask pointers)
+    // Futex word of the parked threads: bit 0 set while threads park on it, the other bits count
+    // the wakes. A submit wakes a single thread.
+    _Atomic uint32_t wake;
+    _Atomic uint32_t parked; // Threads about to park or parked
+    atomic_bool stop;
+} TPool;
+
+/**
+ * @brief Shared pool of the library, with one worker per CPU, created on first use and never
+ * freed. Parallel operations of the library (e.g. index_build) run on it.
+ *
+ * @return Pool, or NULL if it could not be created.
+ */
+TPool *tpool_default(void);
+
+/**
+ * @brief Stop the workers of a pool, once they run out of tasks, and free it. No thread may submit
+ * to it anymore.
+ *
+ * @param p Pool (or NULL). Not the default pool.
+ */
+void tpool_free(TPool *p);
+
+/**
+ * @brief Initialise an empty task group.
+ *
+ * @param g Task group.
+ */
+void tpool_groupInit(TPoolGroup *g);
+
+/**
+ * @brief Create a pool of worker threads.
+ *
+ * @param workers Number of workers (one per CPU if 0).
+ * @param pin true to pin worker `i` to the `i`-th CPU the process may run on (modulo their number).
+ * @return Pool, or NULL if failure (including a worker that could not be pinned).
+ */
+TPool *tpool_new(unsigned workers, bool pin);
+
+/**
+ * @brief Submit a task. From a worker of the pool, the task goes to the bottom of its deque (run
+ * next by the worker, unless stolen). From another thread, it goes to the queue shared by the
+ * workers, waiting while that queue is full.
+ *
+ * @param p Pool.
+ * @param g Task group the task belongs to until it finishes (NULL for none).
+ * @param fn Function of the task.
+ * @param arg Argument passed to `fn`.
+ * @return true if submitted, false otherwise.
+ */
+bool tpool_submit(TPool *p, TPoolGroup *g, TPoolFn fn, void *arg);
+
+/**
+ * @brief Wait until all tasks of a group are finished, running tasks of the pool meanwhile (so
+ * tasks can wait for the tasks they submit), and parking when there are none.
+ *
+ * @param p Pool the tasks of the group were submitted to.
+ * @param g Task group.
+ */
+void tpool_wait(TPool *p, TPoolGroup *g);
+
+/**
+ * @brief Return the number of workers of a pool.
+ *
+ * @param p Pool.
+ * @return Number of workers.
+ */
+unsigned tpool_workers(const TPool *p);
+
+#endif // TPOOL_H_INCLUDED
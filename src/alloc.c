@@ -7,36 +7,372 @@
 
 #include "alloc.h"
 
+/**
+ * @brief Allocate memory for an AllocBlock from its allocator.
+ * 
+ * @param b AllocBlock object.
+ * @param size Size (bytes) to allocate.
+ * @return Pointer to the memory (or NULL if failure).
+ */
+static inline void *_memAlloc(const AllocBlock *b, size_t size) {
+    return mem_allocWith(b->allocator, size);
+}
+
+/**
+ * @brief Resize memory of an AllocBlock with its allocator.
+ * 
+ * @param b AllocBlock object.
+ * @param p Pointer to the memory (or NULL).
+ * @param oldSize Current size (bytes) of the memory.
+ * @param newSize New size (bytes).
+ * @return Pointer to the resized memory (or NULL if failure).
+ */
+static inline void *_memRealloc(const AllocBlock *b, void *p, size_t oldSize, size_t newSize) {
+    return mem_reallocWith(b->allocator, p, oldSize, newSize);
+}
+
+/**
+ * @brief Free memory of an AllocBlock with its allocator.
+ * 
+ * @param b AllocBlock object.
+ * @param p Pointer to the memory (or NULL).
+ * @param size Size (bytes) of the memory.
+ */
+static inline void _memFree(const AllocBlock *b, void *p, size_t size) { 
+    mem_freeWith(b->allocator, p, size); 
+}
+
+/**
+ * @brief Free an AllocBlock object (but not its memory block). Blocks using the system allocator 
+ * take their AllocBlock from the small object pools, others from their allocator.
+ * 
+ * @param b AllocBlock object.
+ */
+static inline void _freeHeader(AllocBlock *b) { 
+    mem_freeObject(b->allocator, b, sizeof(AllocBlock));
+}
+
 /**
  * @brief Convert a size to its nearest (ceiling) power of 2 value.
  * 
- * @param size Memory block size to convert (bytes).
+ * @param size Memory block size to convert (bytes). Replaced with the converted size.
+ * @return true if the size could be converted, false on overflow.
+ */
+static inline bool _buddySize(size_t *size) {
+    size_t newSize = math_nextPow2(*size);
+    if (newSize == 0) return false;
+    *size = newSize;
+    return true;
+}
+
+/**
+ * @brief Copy the growth and shrink policies of one AllocBlock to another.
+ * 
+ * @param dst AllocBlock object to copy the policies to.
+ * @param src AllocBlock object to copy the policies from.
+ */
+static void _copyPolicy(AllocBlock *dst, const AllocBlock *src) {
+    if (dst == NULL) return;
+    dst->growth = src->growth;
+    dst->minGrowth = src->minGrowth;
+    dst->shrink = src->shrink;
+    dst->chunkSize = src->chunkSize;
+    dst->chunkItem = src->chunkItem;
+}
+
+/**
+ * @brief Grow a size geometrically from the current block size. Shrinking is exact.
+ * 
+ * @param b AllocBlock object.
+ * @param size Required memory block size (bytes).
  * @return Converted memory block size (bytes).
  */
-static size_t _buddySize(size_t size) {
-    if (size == 0) return 0;
-    size_t newSize = 1;
-    while (newSize < size) newSize *= 2;
-    return newSize;
+static inline size_t _geometricSize(const AllocBlock *b, size_t size) {
+    return alloc_growSize(b->total, size, b->growth, b->minGrowth);
 }
 
 /**
- * @brief Convert a size based on the allocation strategy.
+ * @brief Number of bytes of data held by each chunk: the chunk size rounded down to whole items.
  * 
- * @param strat Allocation strategy.
+ * @param b AllocBlock object.
+ * @return Number of bytes.
+ */
+static inline size_t _chunkCap(const AllocBlock *b) {
+    return b->chunkItem == 1 ? b->chunkSize : b->chunkSize - b->chunkSize % b->chunkItem;
+}
+
+/**
+ * @brief Round a size up to a whole number of chunks.
+ * 
+ * @param b AllocBlock object.
  * @param size Memory block size to convert (bytes).
- * @return Converted memory block size (bytes).
+ * @param chunked Address to store the converted memory block size (bytes) in.
+ * @return true if the size could be represented, false on overflow.
  */
-static size_t _convertSize(AllocStrategy strat, size_t size) {
-    if (size == 0) return 0;
-    switch (strat) {
+static bool _chunksSize(const AllocBlock *b, size_t size, size_t *chunked) {
+    size_t cap = _chunkCap(b);
+    size_t count = size / cap + (size % cap != 0);
+    if (count > SIZE_MAX / cap) return false;
+    *chunked = count * cap;
+    return true;
+}
+
+/**
+ * @brief Convert a size based on the allocation strategy of the block.
+ * 
+ * @param b AllocBlock object.
+ * @param size Memory block size to convert (bytes). Replaced with the converted size.
+ * @return true if the size could be converted, false on overflow.
+ */
+static bool _convertSize(const AllocBlock *b, size_t *size) {
+    if (*size == 0) return true;
+    switch (b->strat) {
         case ALLOC_STRAT_BUDDY:
             return _buddySize(size);
+        case ALLOC_STRAT_CHUNKS:
+            return _chunksSize(b, *size, size);
+        case ALLOC_STRAT_GEOMETRIC:
+            *size = _geometricSize(b, *size);
+            return true;
         default:
-            return size;
+            return true;
+    }
+}
+
+/**
+ * @brief Pointer to a byte of a chunked AllocBlock.
+ * 
+ * @param b AllocBlock object (ALLOC_STRAT_CHUNKS).
+ * @param byteIdx Index (byte position) within the block.
+ * @return Pointer to the byte.
+ */
+static inline char *_chunkPtr(const AllocBlock *b, size_t byteIdx) {
+    size_t cap = _chunkCap(b);
+    if (cap != b->chunkSize) return (char*)((void**)b->block)[byteIdx / cap] + byteIdx % cap;
+    void *chunk = ((void**)b->block)[byteIdx >> math_ctz(b->chunkSize)];
+    return (char*)chunk + (byteIdx & (b->chunkSize - 1));
+}
+
+/**
+ * @brief Number of contiguous bytes from an index to the end of its chunk.
+ * 
+ * @param b AllocBlock object (ALLOC_STRAT_CHUNKS).
+ * @param byteIdx Index (byte position) within the block.
+ * @return Number of bytes.
+ */
+static inline size_t _chunkRemain(const AllocBlock *b, size_t byteIdx) {
+    size_t cap = _chunkCap(b);
+    if (cap != b->chunkSize) return cap - byteIdx % cap;
+    return b->chunkSize - (byteIdx & (b->chunkSize - 1));
+}
+
+/**
+ * @brief Copy data into an AllocBlock at the given index. The block must already be large enough.
+ * 
+ * @param b AllocBlock object.
+ * @param src Pointer to data.
+ * @param byteIdx Index (byte position) to copy to.
+ * @param size Size (bytes) of data.
+ */
+static void _write(AllocBlock *b, const void *src, size_t byteIdx, size_t size) {
+    if (b->strat != ALLOC_STRAT_CHUNKS) { memcpy((char*)b->block + byteIdx, src, size); return; }
+
+    while (size > 0) {
+        size_t n = math_min(size, _chunkRemain(b, byteIdx));
+        memcpy(_chunkPtr(b, byteIdx), src, n);
+        src = (const char*)src + n;
+        byteIdx += n;
+        size -= n;
+    }
+}
+
+/**
+ * @brief Copy data out of an AllocBlock from the given index.
+ * 
+ * @param b AllocBlock object.
+ * @param dst Pointer to copy the data to.
+ * @param byteIdx Index (byte position) to copy from.
+ * @param size Size (bytes) of data.
+ */
+static void _read(const AllocBlock *b, void *dst, size_t byteIdx, size_t size) {
+    if (b->strat != ALLOC_STRAT_CHUNKS) { memcpy(dst, (char*)b->block + byteIdx, size); return; }
+
+    while (size > 0) {
+        size_t n = math_min(size, _chunkRemain(b, byteIdx));
+        memcpy(dst, _chunkPtr(b, byteIdx), n);
+        dst = (char*)dst + n;
+        byteIdx += n;
+        size -= n;
+    }
+}
+
+/**
+ * @brief Move data within an AllocBlock. The source and destination may overlap.
+ * 
+ * @param b AllocBlock object.
+ * @param dstIdx Index (byte position) to move to.
+ * @param srcIdx Index (byte position) to move from.
+ * @param size Size (bytes) of data.
+ */
+static void _move(AllocBlock *b, size_t dstIdx, size_t srcIdx, size_t size) {
+    if (size == 0 || dstIdx == srcIdx) return;
+
+    if (b->strat != ALLOC_STRAT_CHUNKS) {
+        memmove((char*)b->block + dstIdx, (char*)b->block + srcIdx, size);
+        return;
+    }
+
+    if (dstIdx < srcIdx) {
+        // Front to back, so that source bytes are read before they are overwritten
+        for (size_t pos = 0; pos < size;) {
+            size_t n = math_min(size - pos, 
+                math_min(_chunkRemain(b, srcIdx + pos), _chunkRemain(b, dstIdx + pos)));
+            memmove(_chunkPtr(b, dstIdx + pos), _chunkPtr(b, srcIdx + pos), n);
+            pos += n;
+        }
+    } else {
+        // Back to front
+        for (size_t pos = size; pos > 0;) {
+            size_t srcEnd = srcIdx + pos, dstEnd = dstIdx + pos, cap = _chunkCap(b);
+            size_t n = math_min(pos, math_min((srcEnd - 1) % cap + 1, (dstEnd - 1) % cap + 1));
+            memmove(_chunkPtr(b, dstEnd - n), _chunkPtr(b, srcEnd - n), n);
+            pos -= n;
+        }
+    }
+}
+
+/**
+ * @brief Release the memory held by an AllocBlock (but not the AllocBlock itself).
+ * 
+ * @param b AllocBlock object.
+ */
+static void _release(AllocBlock *b) {
+    if (b->block == NULL) return;
+    if (b->strat == ALLOC_STRAT_CHUNKS) {
+        void **chunks = (void**)b->block;
+        size_t count = b->total / _chunkCap(b);
+        for (size_t i = 0; i < count; i++) _memFree(b, chunks[i], b->chunkSize);
+        _memFree(b, b->block, count * sizeof(void*));
+    } else {
+        _memFree(b, b->block, b->total);
+    }
+    b->block = NULL;
+}
+
+/**
+ * @brief Resize a chunked AllocBlock by adding or releasing chunks. Existing chunks never move.
+ * 
+ * @param b AllocBlock object (ALLOC_STRAT_CHUNKS).
+ * @param size New size (bytes), a whole number of chunks (see _chunkCap).
+ * @return true if resize succeeded, false otherwise.
+ */
+static bool _resizeChunks(AllocBlock *b, size_t size) {
+    size_t have = b->total / _chunkCap(b);
+    size_t want = size / _chunkCap(b);
+    void **chunks = (void**)b->block;
+
+    if (want == 0) { _release(b); return true; }
+
+    if (want < have) {
+        for (size_t i = want; i < have; i++) _memFree(b, chunks[i], b->chunkSize);
+        // A failed shrink of the chunk table leaves the larger (still valid) table in place
+        void **newChunks = (void**)_memRealloc(b, chunks, have * sizeof(void*), want * sizeof(void*));
+        b->block = newChunks ? newChunks : chunks;
+        return true;
+    }
+
+    if (want > SIZE_MAX / sizeof(void*)) return false;
+    void **newChunks = (void**)_memRealloc(b, chunks, have * sizeof(void*), want * sizeof(void*));
+    if (newChunks == NULL) return false;
+    b->block = newChunks;
+
+    for (size_t i = have; i < want; i++) {
+        newChunks[i] = _memAlloc(b, b->chunkSize);
+        if (newChunks[i] == NULL) {
+            while (i-- > have) _memFree(b, newChunks[i], b->chunkSize);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Copy data from one AllocBlock into another. The destination must already be large enough.
+ * 
+ * @param dst AllocBlock object to copy to.
+ * @param dstIdx Index (byte position) to copy to.
+ * @param src AllocBlock object to copy from.
+ * @param srcIdx Index (byte position) to copy from.
+ * @param size Size (bytes) of data.
+ */
+static void _transfer(AllocBlock *dst, size_t dstIdx, const AllocBlock *src, size_t srcIdx, size_t size) {
+    while (size > 0) {
+        size_t n;
+        const void *data = alloc_span(src, srcIdx, &n);
+        n = math_min(n, size);
+        _write(dst, data, dstIdx, n);
+        dstIdx += n;
+        srcIdx += n;
+        size -= n;
     }
 }
 
+/**
+ * @brief Set the size of the memory block of an AllocBlock (no strategy conversion).
+ * 
+ * @param b AllocBlock object.
+ * @param size New size (bytes).
+ * @return true if resize succeeded, false otherwise.
+ */
+static bool _setSize(AllocBlock *b, size_t size) {
+    if(size == b->total) return true;
+
+    if (b->strat == ALLOC_STRAT_CHUNKS) {
+        if (!_resizeChunks(b, size)) return false;
+    } else if (size == 0 && b->block != NULL) {
+        _memFree(b, b->block, b->total);
+        b->block = NULL;
+    } else if (size > 0) {
+        void *new_block = _memRealloc(b, b->block, b->total, size);
+        if (new_block == NULL) return false;
+        b->block = new_block;
+    }
+
+    b->total = size;
+    b->used = math_min(b->total, b->used);
+
+    return true;
+}
+
+/**
+ * @brief Allocate the initial memory of a new AllocBlock. Sizes are converted by the allocation 
+ * strategy, except for geometric growth which starts at the exact size.
+ * 
+ * @param b AllocBlock object.
+ * @param size Initial size (bytes).
+ * @return true if allocation succeeded, false otherwise.
+ */
+static bool _initSize(AllocBlock *b, size_t size) {
+    if (b->strat != ALLOC_STRAT_GEOMETRIC && !_convertSize(b, &size)) return false;
+    return _setSize(b, size);
+}
+
+/**
+ * @brief Create a new AllocBlock with the allocator of another.
+ * 
+ * @param b AllocBlock object to take the allocator, strategy and policies from.
+ * @param size Initial size (bytes).
+ * @return AllocBlock object (or NULL if failure).
+ */
+static AllocBlock *_newLike(const AllocBlock *b, size_t size) {
+    AllocBlock *n = alloc_newWith(b->allocator, 0, b->strat);
+    if (n == NULL) return NULL;
+    _copyPolicy(n, b);
+    if (!_initSize(n, size)) { alloc_free(n); return NULL; }
+    return n;
+}
+
 bool alloc_append(AllocBlock *b, const void *data, size_t size) {
     return alloc_insert(b, data, b->used, size);
 }
@@ -46,29 +382,43 @@ void alloc_clear(AllocBlock *b) { if (b != NULL) b->used = 0; }
 AllocBlock *alloc_copy(const AllocBlock *b) {
     if (b == NULL) return NULL;
 
-    AllocBlock *copy = alloc_new(b->total, b->strat);
+    AllocBlock *copy = _newLike(b, b->total);
+    if (copy == NULL) return NULL;
 
     if (b->used > 0 && b->block != NULL) {
-        memcpy(copy->block, b->block, b->used);
+        _transfer(copy, 0, b, 0, b->used);
         copy->used = b->used;
     }
 
     return copy;
 }
 
+void *alloc_detach(AllocBlock *b, size_t *size) {
+    if (b == NULL || size == NULL || b->block == NULL || b->strat == ALLOC_STRAT_CHUNKS || 
+        b->allocator != mem_getAllocator()) 
+        return NULL;
+    void *block = b->block;
+    *size = b->total;
+    _freeHeader(b);
+    return block;
+}
+
 void alloc_free(AllocBlock *b) { 
     if (b != NULL) { 
-        if (b->block != NULL) {
-            free(b->block);
-            b->block = NULL; 
-        }
-        free(b); 
+        _release(b);
+        _freeHeader(b); 
     } 
 }
 
+const Allocator *alloc_getAllocator(const AllocBlock *b) { return b ? b->allocator : NULL; }
+
 size_t alloc_getAvail(const AllocBlock *b) { return b ? b->total - b->used : 0; }
 
-void *alloc_getBlock(const AllocBlock *b) { return b ? b->block : NULL; }
+void *alloc_getBlock(const AllocBlock *b) { 
+    return b && b->strat != ALLOC_STRAT_CHUNKS ? b->block : NULL; 
+}
+
+size_t alloc_getChunkSize(const AllocBlock *b) { return b ? b->chunkSize : 0; }
 
 size_t alloc_getSize(const AllocBlock *b) { return b ? b->total : 0; }
 
@@ -76,15 +426,33 @@ AllocStrategy alloc_getStrat(const AllocBlock *b) { return b ? b->strat : ALLOC_
 
 size_t alloc_getUsed(const AllocBlock *b) { return b ? b->used : 0; }
 
+size_t alloc_growSize(size_t total, size_t size, double factor, size_t minGrowth) {
+    if (size <= total) return size;
+
+    double scaled = (double)total * factor;
+    size_t grown = scaled >= (double)SIZE_MAX ? SIZE_MAX : (size_t)scaled;
+    size_t stepped = total > SIZE_MAX - minGrowth ? SIZE_MAX : total + minGrowth;
+
+    return math_max(size, math_max(grown, stepped));
+}
+
 void *alloc_index(AllocBlock *b, size_t byteIdx) {
     if (b == NULL || byteIdx >= b->used) return NULL;
+    if (b->strat == ALLOC_STRAT_CHUNKS) return _chunkPtr(b, byteIdx);
     return (char*)b->block + byteIdx;
 }
 
 bool alloc_insert(AllocBlock *b, const void *data, size_t byteIdx, size_t size) {
-    if (b == NULL || data == NULL || size == 0) return false;
+    if (data == NULL || !alloc_insertSpace(b, byteIdx, size)) return false;
+    _write(b, data, byteIdx, size);
+    return true;
+}
+
+bool alloc_insertSpace(AllocBlock *b, size_t byteIdx, size_t size) {
+    if (b == NULL || size == 0) return false;
     
     if (byteIdx > b->used) return false; // Index out of bounds
+    if (size > SIZE_MAX - b->used) return false; // Size overflow
     
     // Resize the block if necessary
     size_t newSize = b->used + size;
@@ -92,14 +460,8 @@ bool alloc_insert(AllocBlock *b, const void *data, size_t byteIdx, size_t size)
         if (!alloc_resize(b, newSize)) return false;
     
     // Shift memory to make space for the new items, if necessary
-    if (byteIdx < b->used) 
-        memmove(
-            (char*)b->block + byteIdx + size, 
-            (char*)b->block + byteIdx, 
-            b->used - byteIdx
-        );
+    if (byteIdx < b->used) _move(b, byteIdx + size, byteIdx, b->used - byteIdx);
     
-    memcpy((char*)b->block + byteIdx, data, size);
     b->used = newSize;
 
     return true;
@@ -107,69 +469,86 @@ bool alloc_insert(AllocBlock *b, const void *data, size_t byteIdx, size_t size)
 
 bool alloc_isEmpty(const AllocBlock *b) { return b->used == 0; }
 
-AllocBlock *alloc_new(size_t size, AllocStrategy strat) {
-    AllocBlock *b = (AllocBlock*)malloc(sizeof(AllocBlock));
+bool alloc_move(AllocBlock *b, size_t dstIdx, size_t srcIdx, size_t size) {
+    if (b == NULL) return false;
+    if (dstIdx > b->used || srcIdx > b->used) return false; // Out of bounds
+    if (size > b->used - dstIdx || size > b->used - srcIdx) return false;
+    _move(b, dstIdx, srcIdx, size);
+    return true;
+}
+
+AllocBlock *alloc_new(size_t size, AllocStrategy strat) { return alloc_newWith(NULL, size, strat); }
+
+AllocBlock *alloc_newBuddy(Buddy *h, size_t size) {
+    return alloc_newWith(buddy_allocator(h), size, ALLOC_STRAT_BUDDY);
+}
+
+AllocBlock *alloc_newIn(Arena *a, size_t size, AllocStrategy strat) {
+    return alloc_newWith(arena_allocator(a), size, strat);
+}
+
+AllocBlock *alloc_newWith(const Allocator *a, size_t size, AllocStrategy strat) {
+    if (a == NULL) a = mem_getAllocator();
+    AllocBlock *b = (AllocBlock*)mem_allocObject(a, sizeof(AllocBlock));
     if (b == NULL) return NULL;
-    
-    b->block = size ? malloc(size) : NULL;
-    if (size != 0 && b->block == NULL) {
-        b->block = malloc(size);
-        if (b->block == NULL) { free(b); return NULL; }
-    }
-    
+
+    b->allocator = a;
+    b->block = NULL;
     b->used = 0;
-    b->total = size;
+    b->total = 0;
+    b->strat = ALLOC_STRAT_DYNAMIC;
+    b->growth = ALLOC_GROWTH_FACTOR;
+    b->minGrowth = ALLOC_GROWTH_MIN;
+    b->shrink = ALLOC_SHRINK_THRESHOLD;
+    b->chunkSize = ALLOC_CHUNK_SIZE;
+    b->chunkItem = 1;
+
     alloc_setStrat(b, strat);
+    if (!_initSize(b, size)) { _freeHeader(b); return NULL; }
     
     return b;
 }
 
+bool alloc_read(const AllocBlock *b, void *dst, size_t byteIdx, size_t size) {
+    if (b == NULL || dst == NULL || size == 0) return false;
+    if (byteIdx >= b->used || size > b->used - byteIdx) return false; // Out of bounds
+    _read(b, dst, byteIdx, size);
+    return true;
+}
+
 bool alloc_remove(AllocBlock *b, size_t byteIdx, size_t size) {
     if (b == NULL || size == 0) return false;
 
+    if (byteIdx >= b->used || size > b->used - byteIdx) return false; // Out of bounds
     size_t endByte = byteIdx + size;
-    if (byteIdx >= b->used || endByte > b->used) return false; // Out of bounds
 
     // Shift remaining items to fill the gap
-    memmove((char*)b->block + byteIdx, (char*)b->block + endByte, b->used - endByte);
+    _move(b, byteIdx, endByte, b->used - endByte);
 
     b->used -= size;
-    alloc_resize(b, b->used);
+    if ((double)b->used < (double)b->total * b->shrink) alloc_resize(b, b->used);
 
     return true;
 }
 
 bool alloc_resize(AllocBlock *b, size_t size) {
     if (b == NULL) return false;
-
-    size = _convertSize(b->strat, size);
-    if(size == b->total) return true;
-
-    if (size == 0 && b->block != NULL) {
-        free(b->block);
-        b->block = NULL;
-    } else if (size > 0) {
-        void *new_block = realloc(b->block, size);
-        if (new_block == NULL) return false;
-        b->block = new_block;
-    }
-
-    b->total = size;
-    b->used = math_min(b->total, b->used);
-
-    return true;
+    if (!_convertSize(b, &size)) return false;
+    return _setSize(b, size);
 }
 
 bool alloc_setAt(AllocBlock *b, const void *data, size_t byteIdx, size_t size) {
     if (b == NULL || data == NULL || size == 0) return false;
 
     if (byteIdx > b->used) return false; // Index out of bounds
+    if (size > SIZE_MAX - byteIdx) return false; // Size overflow
 
     // Resize the block if necessary
     size_t newSize = byteIdx + size;
-    if (newSize > b->total) alloc_resize(b, newSize);
+    if (newSize > b->total) 
+        if (!alloc_resize(b, newSize)) return false;
 
-    memcpy((char*)b->block + byteIdx, data, size);
+    _write(b, data, byteIdx, size);
 
     // Update used size if it was expanded
     if (newSize > b->used) b->used = newSize;
@@ -177,31 +556,89 @@ bool alloc_setAt(AllocBlock *b, const void *data, size_t byteIdx, size_t size) {
     return true;
 }
 
+bool alloc_setChunkItem(AllocBlock *b, size_t itemSize) {
+    if (b == NULL || itemSize == 0 || itemSize > b->chunkSize) return false;
+    if (b->strat == ALLOC_STRAT_CHUNKS && b->total > 0) return false;
+    b->chunkItem = itemSize;
+    return true;
+}
+
+bool alloc_setChunkSize(AllocBlock *b, size_t size) {
+    if (b == NULL || !math_isPow2(size) || size < b->chunkItem) return false;
+    if (b->strat == ALLOC_STRAT_CHUNKS && b->total > 0) return false;
+    b->chunkSize = size;
+    return true;
+}
+
+bool alloc_setGrowth(AllocBlock *b, double factor, size_t minGrowth) {
+    if (b == NULL || !(factor >= 1.0)) return false;
+    b->growth = factor;
+    b->minGrowth = minGrowth;
+    return true;
+}
+
+bool alloc_setShrink(AllocBlock *b, double threshold) {
+    if (b == NULL || !(threshold >= 0.0 && threshold <= 1.0)) return false;
+    b->shrink = threshold;
+    return true;
+}
+
 void alloc_setStrat(AllocBlock *b, AllocStrategy strat) {
     if (b == NULL || strat <= _ALLOC_STRAT_MIN || _ALLOC_STRAT_MAX <= strat) return;
+
+    if ((b->strat == ALLOC_STRAT_CHUNKS) != (strat == ALLOC_STRAT_CHUNKS) && b->total > 0) {
+        // Changing between contiguous and chunked storage, so the data must be moved
+        AllocBlock tmp = *b;
+        tmp.block = NULL;
+        tmp.total = 0;
+        tmp.strat = strat;
+        if (!alloc_resize(&tmp, b->total)) return;
+        _transfer(&tmp, 0, b, 0, b->used);
+        _release(b);
+        *b = tmp;
+        return;
+    }
+
     b->strat = strat;
     alloc_resize(b, b->total);
 }
 
+bool alloc_shrinkToFit(AllocBlock *b) { return b ? alloc_resize(b, b->used) : false; }
+
+void *alloc_span(const AllocBlock *b, size_t byteIdx, size_t *len) {
+    if (b == NULL || byteIdx >= b->used) { if (len) *len = 0; return NULL; }
+
+    if (b->strat != ALLOC_STRAT_CHUNKS) {
+        if (len) *len = b->used - byteIdx;
+        return (char*)b->block + byteIdx;
+    }
+
+    if (len) *len = math_min(b->used - byteIdx, _chunkRemain(b, byteIdx));
+    return _chunkPtr(b, byteIdx);
+}
+
 bool alloc_split(AllocBlock *b, AllocBlock **lb, AllocBlock **rb, size_t byteIdx) {
     if (b == NULL || lb == NULL || rb == NULL || byteIdx > b->used) return false;
 
     size_t leftUsed = byteIdx;
     size_t rightUsed = b->used - byteIdx;
 
-    *lb = alloc_new(leftUsed, b->strat);
-    *rb = alloc_new(rightUsed, b->strat);
+    AllocBlock *l = _newLike(b, leftUsed);
+    AllocBlock *r = _newLike(b, rightUsed);
 
-    if (leftUsed > 0) {
-        if (*lb == NULL) return false;
-        if (!alloc_append(*lb, b->block, leftUsed)) return false;
+    if (l == NULL || r == NULL) {
+        alloc_free(l);
+        alloc_free(r);
+        return false;
     }
 
-    if (rightUsed > 0) {
-        if (*rb == NULL) return false;
-        if (!alloc_append(*rb, (char *)b->block + byteIdx, rightUsed)) return false;
-    }
+    _transfer(l, 0, b, 0, leftUsed);
+    l->used = leftUsed;
+    _transfer(r, 0, b, byteIdx, rightUsed);
+    r->used = rightUsed;
 
+    *lb = l;
+    *rb = r;
     alloc_free(b);
 
     return true;
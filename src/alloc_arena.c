@@ -0,0 +1,159 @@
+/*
+    File        : alloc_arena.c
+    Description : Arena (bump pointer) allocator with save/restore marks and bulk reset.
+*/
+
+#include "alloc_arena.h"
+
+/**
+ * @brief Round a size up to the arena alignment.
+ * 
+ * @param size Size (bytes).
+ * @return Aligned size (bytes), or 0 on overflow.
+ */
+static inline size_t _align(size_t size) {
+    if (size > SIZE_MAX - (ARENA_ALIGN - 1)) return 0;
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/**
+ * @brief Create a new region.
+ * 
+ * @param size Usable size (bytes) of the region.
+ * @return Region (or NULL if failure).
+ */
+static ArenaRegion *_newRegion(size_t size) {
+    if (size > SIZE_MAX - sizeof(ArenaRegion)) return NULL;
+    ArenaRegion *r = (ArenaRegion*)malloc(sizeof(ArenaRegion) + size);
+    if (r == NULL) return NULL;
+    r->next = NULL;
+    r->size = size;
+    r->used = 0;
+    return r;
+}
+
+/**
+ * @brief Move the arena to a region that can hold an allocation, reusing retained regions if 
+ * possible.
+ * 
+ * @param a Arena object.
+ * @param size Aligned size (bytes) of the allocation.
+ * @return true if a region was found or created, false otherwise.
+ */
+static bool _nextRegion(Arena *a, size_t size) {
+    ArenaRegion *next = a->current->next;
+
+    if (next == NULL || next->size < size) {
+        ArenaRegion *r = _newRegion(math_max(size, a->regionSize));
+        if (r == NULL) return false;
+        r->next = next;
+        a->current->next = r;
+        next = r;
+    }
+
+    next->used = 0;
+    a->current = next;
+    return true;
+}
+
+// Allocator interface callbacks (see mem.h)
+static void *_allocatorAlloc(void *ctx, size_t size) { return arena_alloc((Arena*)ctx, size); }
+
+static void *_allocatorRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    return arena_realloc((Arena*)ctx, p, oldSize, newSize);
+}
+
+static void _allocatorFree(void *ctx, void *p, size_t size) { (void)ctx; (void)p; (void)size; }
+
+void *arena_alloc(Arena *a, size_t size) {
+    if (a == NULL || size == 0) return NULL;
+
+    size_t aligned = _align(size);
+    if (aligned == 0) return NULL;
+
+    if (a->current->size - a->current->used < aligned && !_nextRegion(a, aligned)) return NULL;
+
+    void *p = a->current->data + a->current->used;
+    a->current->used += aligned;
+    a->last = p;
+    return p;
+}
+
+const Allocator *arena_allocator(Arena *a) { return a ? &a->allocator : NULL; }
+
+void arena_free(Arena *a) {
+    if (a == NULL) return;
+    ArenaRegion *r = a->first;
+    while (r != NULL) {
+        ArenaRegion *next = r->next;
+        free(r);
+        r = next;
+    }
+    free(a);
+}
+
+Arena *arena_new(size_t regionSize) {
+    Arena *a = (Arena*)malloc(sizeof(Arena));
+    if (a == NULL) return NULL;
+
+    a->regionSize = _align(regionSize ? regionSize : ARENA_REGION_SIZE);
+    a->first = a->current = a->regionSize ? _newRegion(a->regionSize) : NULL;
+    if (a->first == NULL) { free(a); return NULL; }
+    a->last = NULL;
+    a->allocator = (Allocator){ _allocatorAlloc, _allocatorRealloc, _allocatorFree, a };
+
+    return a;
+}
+
+void *arena_realloc(Arena *a, void *p, size_t oldSize, size_t newSize) {
+    if (a == NULL) return NULL;
+    if (newSize == 0) return NULL;
+    if (p == NULL) return arena_alloc(a, newSize);
+
+    // Grow/shrink the most recent allocation in place
+    if (p == a->last) {
+        size_t offset = (size_t)((char*)p - a->current->data);
+        size_t aligned = _align(newSize);
+        if (aligned != 0 && aligned <= a->current->size - offset) {
+            a->current->used = offset + aligned;
+            return p;
+        }
+    }
+
+    if (newSize <= oldSize) return p;
+
+    void *np = arena_alloc(a, newSize);
+    if (np == NULL) return NULL;
+    memcpy(np, p, oldSize);
+    return np;
+}
+
+void arena_reset(Arena *a) {
+    if (a == NULL) return;
+    a->current = a->first;
+    a->current->used = 0;
+    a->last = NULL;
+}
+
+void arena_restore(Arena *a, ArenaMark mark) {
+    if (a == NULL || mark.region == NULL) return;
+    a->current = mark.region;
+    a->current->used = mark.used;
+    a->last = NULL;
+}
+
+ArenaMark arena_save(const Arena *a) {
+    ArenaMark mark = { NULL, 0 };
+    if (a != NULL) {
+        mark.region = a->current;
+        mark.used = a->current->used;
+    }
+    return mark;
+}
+
+size_t arena_used(const Arena *a) {
+    if (a == NULL) return 0;
+    size_t used = 0;
+    for (ArenaRegion *r = a->first; r != a->current; r = r->next) used += r->used;
+    return used + a->current->used;
+}
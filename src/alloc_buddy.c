@@ -0,0 +1,277 @@
+/*
+    File        : alloc_buddy.c
+    Description : Buddy system allocator over a pre-reserved region, with per-order free lists,
+                  buddy coalescing, in-place growth and fragmentation statistics.
+*/
+
+#include "alloc_buddy.h"
+
+// Flag set in the metadata of a free block (the rest of the byte is its order)
+#define BUDDY_FREE 0x80
+
+/**
+ * @brief Index of the minimum block a pointer starts at.
+ *
+ * @param h Buddy object.
+ * @param p Pointer within the region.
+ * @return Metadata index.
+ */
+static inline size_t _metaIdx(const Buddy *h, const void *p) {
+    return (size_t)((const unsigned char*)p - h->base) >> h->minOrder;
+}
+
+/**
+ * @brief Buddy of a block.
+ *
+ * @param h Buddy object.
+ * @param p Block.
+ * @param order Order of the block.
+ * @return The block it merges with to form a block of the next order.
+ */
+static inline unsigned char *_buddyOf(const Buddy *h, const void *p, int order) {
+    return h->base + (((size_t)((const unsigned char*)p - h->base)) ^ ((size_t)1 << order));
+}
+
+/**
+ * @brief Check if a block is free with exactly the given order.
+ *
+ * @param h Buddy object.
+ * @param p Block.
+ * @param order Order of the block.
+ * @return true if free, false otherwise.
+ */
+static inline bool _isFree(const Buddy *h, const void *p, int order) {
+    return h->meta[_metaIdx(h, p)] == ((unsigned char)order | BUDDY_FREE);
+}
+
+/**
+ * @brief Order of the block needed for an allocation.
+ *
+ * @param h Buddy object.
+ * @param size Size (bytes) of the allocation.
+ * @return Order, or -1 if the allocation cannot fit in the region.
+ */
+static int _order(const Buddy *h, size_t size) {
+    if (size > h->size) return -1;
+    if (size <= ((size_t)1 << h->minOrder)) return h->minOrder;
+    return math_ilog2(math_nextPow2(size));
+}
+
+/**
+ * @brief Add a block to the free list of its order.
+ *
+ * @param h Buddy object.
+ * @param p Block.
+ * @param order Order of the block.
+ */
+static void _push(Buddy *h, void *p, int order) {
+    BuddyNode *n = (BuddyNode*)p;
+    n->prev = NULL;
+    n->next = h->freeLists[order];
+    if (n->next != NULL) n->next->prev = n;
+    h->freeLists[order] = n;
+    h->meta[_metaIdx(h, p)] = (unsigned char)order | BUDDY_FREE;
+}
+
+/**
+ * @brief Remove a block from the free list of its order.
+ *
+ * @param h Buddy object.
+ * @param p Block.
+ * @param order Order of the block.
+ */
+static void _unlink(Buddy *h, void *p, int order) {
+    BuddyNode *n = (BuddyNode*)p;
+    if (n->prev != NULL) n->prev->next = n->next;
+    else h->freeLists[order] = n->next;
+    if (n->next != NULL) n->next->prev = n->prev;
+    h->meta[_metaIdx(h, p)] = 0;
+}
+
+/**
+ * @brief Order of an allocated block.
+ *
+ * @param h Buddy object.
+ * @param p Pointer to memory allocated from the heap.
+ * @return Order, or -1 if `p` is not an allocation of the heap.
+ */
+static int _allocOrder(const Buddy *h, const void *p) {
+    const unsigned char *c = (const unsigned char*)p;
+    if (c < h->base || c >= h->base + h->size) return -1;
+
+    size_t offset = (size_t)(c - h->base);
+    if (offset & (((size_t)1 << h->minOrder) - 1)) return -1;
+
+    unsigned char m = h->meta[offset >> h->minOrder];
+    return m == 0 || (m & BUDDY_FREE) ? -1 : m;
+}
+
+/**
+ * @brief Try to grow an allocated block in place by absorbing its following (free) buddies.
+ *
+ * @param h Buddy object.
+ * @param p Block.
+ * @param order Current order of the block.
+ * @param target Order to grow to.
+ * @return true if the block was grown, false otherwise (the heap is left untouched).
+ */
+static bool _growInPlace(Buddy *h, unsigned char *p, int order, int target) {
+    size_t offset = (size_t)(p - h->base);
+
+    for (int o = order; o < target; o++) {
+        // The block must be the lower half at every level, with a whole free upper half
+        if (offset & ((size_t)1 << o)) return false;
+        if (!_isFree(h, p + ((size_t)1 << o), o)) return false;
+    }
+
+    for (int o = order; o < target; o++) _unlink(h, p + ((size_t)1 << o), o);
+    h->meta[_metaIdx(h, p)] = (unsigned char)target;
+    h->used += ((size_t)1 << target) - ((size_t)1 << order);
+    return true;
+}
+
+// Allocator interface callbacks (see mem.h)
+static void *_allocatorAlloc(void *ctx, size_t size) { return buddy_alloc((Buddy*)ctx, size); }
+
+static void *_allocatorRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    return buddy_realloc((Buddy*)ctx, p, oldSize, newSize);
+}
+
+static void _allocatorFree(void *ctx, void *p, size_t size) { 
+    (void)size; 
+    buddy_release((Buddy*)ctx, p); 
+}
+
+void *buddy_alloc(Buddy *h, size_t size) {
+    if (h == NULL || size == 0) return NULL;
+
+    int order = _order(h, size);
+    if (order < 0) return NULL;
+
+    int o = order;
+    while (o <= h->maxOrder && h->freeLists[o] == NULL) o++;
+    if (o > h->maxOrder) return NULL;
+
+    unsigned char *p = (unsigned char*)h->freeLists[o];
+    _unlink(h, p, o);
+
+    // Split down to the requested order, freeing the upper halves
+    while (o > order) {
+        o--;
+        _push(h, p + ((size_t)1 << o), o);
+    }
+
+    h->meta[_metaIdx(h, p)] = (unsigned char)order;
+    h->used += (size_t)1 << order;
+    h->allocations++;
+    return p;
+}
+
+const Allocator *buddy_allocator(Buddy *h) { return h ? &h->allocator : NULL; }
+
+size_t buddy_blockSize(const Buddy *h, const void *p) {
+    if (h == NULL || p == NULL) return 0;
+    int order = _allocOrder(h, p);
+    return order < 0 ? 0 : (size_t)1 << order;
+}
+
+void buddy_free(Buddy *h) {
+    if (h == NULL) return;
+    free(h->base);
+    free(h->meta);
+    free(h);
+}
+
+Buddy *buddy_new(size_t size, size_t minBlock) {
+    size = math_nextPow2(size ? size : BUDDY_HEAP_SIZE);
+    minBlock = math_nextPow2(math_max(minBlock ? minBlock : BUDDY_MIN_BLOCK, sizeof(BuddyNode)));
+    if (size == 0 || minBlock == 0 || minBlock > size) return NULL;
+
+    Buddy *h = (Buddy*)malloc(sizeof(Buddy));
+    if (h == NULL) return NULL;
+
+    h->minOrder = math_ilog2(minBlock);
+    h->maxOrder = math_ilog2(size);
+    h->size = size;
+    h->used = 0;
+    h->allocations = 0;
+    h->allocator = (Allocator){ _allocatorAlloc, _allocatorRealloc, _allocatorFree, h };
+    h->base = (unsigned char*)malloc(size);
+    h->meta = (unsigned char*)calloc(size >> h->minOrder, 1);
+    if (h->base == NULL || h->meta == NULL) { buddy_free(h); return NULL; }
+
+    for (int o = 0; o < MATH_SIZE_BITS; o++) h->freeLists[o] = NULL;
+    _push(h, h->base, h->maxOrder);
+
+    return h;
+}
+
+void *buddy_realloc(Buddy *h, void *p, size_t oldSize, size_t newSize) {
+    if (h == NULL || newSize == 0) return NULL;
+    if (p == NULL) return buddy_alloc(h, newSize);
+
+    int order = _allocOrder(h, p);
+    int target = _order(h, newSize);
+    if (order < 0 || target < 0) return NULL;
+
+    unsigned char *c = (unsigned char*)p;
+
+    // Shrink in place, freeing the upper halves (their buddies are still allocated, so no merging)
+    if (target <= order) {
+        for (int o = order - 1; o >= target; o--) _push(h, c + ((size_t)1 << o), o);
+        h->meta[_metaIdx(h, c)] = (unsigned char)target;
+        h->used -= ((size_t)1 << order) - ((size_t)1 << target);
+        return p;
+    }
+
+    if (_growInPlace(h, c, order, target)) return p;
+
+    void *np = buddy_alloc(h, newSize);
+    if (np == NULL) return NULL;
+    memcpy(np, p, math_min(oldSize, (size_t)1 << order));
+    buddy_release(h, p);
+    return np;
+}
+
+void buddy_release(Buddy *h, void *p) {
+    if (h == NULL || p == NULL) return;
+
+    int order = _allocOrder(h, p);
+    if (order < 0) return;
+
+    unsigned char *c = (unsigned char*)p;
+    h->used -= (size_t)1 << order;
+    h->allocations--;
+    h->meta[_metaIdx(h, c)] = 0;
+
+    // Coalesce with free buddies
+    while (order < h->maxOrder) {
+        unsigned char *b = _buddyOf(h, c, order);
+        if (!_isFree(h, b, order)) break;
+        _unlink(h, b, order);
+        if (b < c) c = b;
+        order++;
+    }
+
+    _push(h, c, order);
+}
+
+BuddyStats buddy_stats(const Buddy *h) {
+    BuddyStats s = { 0, 0, 0, 0, 0, 0, 0.0 };
+    if (h == NULL) return s;
+
+    s.total = h->size;
+    s.used = h->used;
+    s.free = h->size - h->used;
+    s.allocations = h->allocations;
+
+    for (int o = h->minOrder; o <= h->maxOrder; o++) {
+        for (const BuddyNode *n = h->freeLists[o]; n != NULL; n = n->next) {
+            s.freeBlocks++;
+            s.largestFree = (size_t)1 << o;
+        }
+    }
+
+    if (s.free > 0) s.fragmentation = 1.0 - (double)s.largestFree / (double)s.free;
+    return s;
+}
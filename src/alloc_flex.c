@@ -0,0 +1,126 @@
+/*
+    File        : alloc_flex.c
+    Description : Single allocation memory block with the header and data stored together. 
+                  Functions that may grow the block return its (possibly moved) new address.
+*/
+
+#include "alloc_flex.h"
+
+/**
+ * @brief Convert a size based on the allocation strategy of the block.
+ * 
+ * @param strat Allocation strategy.
+ * @param total Current size (bytes) of the data area.
+ * @param size Required size (bytes). Replaced with the converted size.
+ * @return true if the size could be converted, false on overflow.
+ */
+static bool _convertSize(AllocStrategy strat, size_t total, size_t *size) {
+    if (*size == 0) return true;
+    switch (strat) {
+        case ALLOC_STRAT_BUDDY:
+            *size = math_nextPow2(*size);
+            return *size != 0;
+        case ALLOC_STRAT_GEOMETRIC:
+            *size = alloc_growSize(total, *size, ALLOC_GROWTH_FACTOR, ALLOC_GROWTH_MIN);
+            return true;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Reallocate a FlexBlock to an exact data area size.
+ * 
+ * @param a Allocator of the block.
+ * @param f FlexBlock object (or NULL to allocate a new one).
+ * @param size New size (bytes) of the data area.
+ * @return FlexBlock object (may have moved), or NULL if failure.
+ */
+static FlexBlock *_setSize(const Allocator *a, FlexBlock *f, size_t size) {
+    if (size > SIZE_MAX - sizeof(FlexBlock)) return NULL;
+    size_t oldSize = f ? sizeof(FlexBlock) + f->total : 0;
+    FlexBlock *nf = (FlexBlock*)mem_reallocWith(a, f, oldSize, sizeof(FlexBlock) + size);
+    if (nf == NULL) return NULL;
+    nf->allocator = a;
+    nf->total = size;
+    return nf;
+}
+
+FlexBlock *flex_append(FlexBlock *f, const void *data, size_t size) {
+    return f ? flex_insert(f, data, f->used, size) : NULL;
+}
+
+void flex_clear(FlexBlock *f) { if (f != NULL) f->used = 0; }
+
+void flex_free(FlexBlock *f) { 
+    if (f != NULL) mem_freeWith(f->allocator, f, sizeof(FlexBlock) + f->total); 
+}
+
+FlexBlock *flex_insert(FlexBlock *f, const void *data, size_t byteIdx, size_t size) {
+    if (f == NULL || data == NULL || size == 0) return NULL;
+
+    if (byteIdx > f->used) return NULL; // Index out of bounds
+    if (size > SIZE_MAX - f->used) return NULL; // Size overflow
+
+    // Resize the block if necessary
+    size_t newSize = f->used + size;
+    if (newSize > f->total) {
+        f = flex_resize(f, newSize);
+        if (f == NULL) return NULL;
+    }
+
+    // Shift memory to make space for the new items, if necessary
+    if (byteIdx < f->used) memmove(f->data + byteIdx + size, f->data + byteIdx, f->used - byteIdx);
+
+    memcpy(f->data + byteIdx, data, size);
+    f->used = newSize;
+
+    return f;
+}
+
+FlexBlock *flex_new(size_t size, AllocStrategy strat) { return flex_newWith(NULL, size, strat); }
+
+FlexBlock *flex_newWith(const Allocator *a, size_t size, AllocStrategy strat) {
+    if (strat <= _ALLOC_STRAT_MIN || _ALLOC_STRAT_MAX <= strat || strat == ALLOC_STRAT_CHUNKS) 
+        return NULL;
+    if (a == NULL) a = mem_getAllocator();
+
+    // Initial size is exact for geometric growth
+    if (strat != ALLOC_STRAT_GEOMETRIC && !_convertSize(strat, 0, &size)) return NULL;
+
+    FlexBlock *f = _setSize(a, NULL, size);
+    if (f == NULL) return NULL;
+
+    f->used = 0;
+    f->strat = strat;
+
+    return f;
+}
+
+bool flex_remove(FlexBlock *f, size_t byteIdx, size_t size) {
+    if (f == NULL || size == 0) return false;
+
+    if (byteIdx >= f->used || size > f->used - byteIdx) return false; // Out of bounds
+    size_t endByte = byteIdx + size;
+
+    // Shift remaining items to fill the gap
+    memmove(f->data + byteIdx, f->data + endByte, f->used - endByte);
+    f->used -= size;
+
+    return true;
+}
+
+FlexBlock *flex_resize(FlexBlock *f, size_t size) {
+    if (f == NULL) return NULL;
+
+    if (!_convertSize(f->strat, f->total, &size)) return NULL;
+    if (size == f->total) return f;
+
+    f = _setSize(f->allocator, f, size);
+    if (f == NULL) return NULL;
+    f->used = math_min(f->total, f->used);
+
+    return f;
+}
+
+FlexBlock *flex_shrinkToFit(FlexBlock *f) { return f ? flex_resize(f, f->used) : NULL; }
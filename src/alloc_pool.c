@@ -0,0 +1,291 @@
+/*
+    File        : alloc_pool.c
+    Description : Pool (slab) allocator for fixed size objects with free list recycling, and 
+                  per-thread pools for small objects.
+*/
+
+#include <pthread.h>
+
+#include "alloc_pool.h"
+#include "mem.h"
+
+typedef struct {
+    Pool classes[POOL_SMALL_CLASSES];
+    size_t freeCount[POOL_SMALL_CLASSES]; // Objects on the free list of each class
+    bool init;
+    bool retired; // Handed over to the orphans as the thread exits
+} PoolCache;
+
+// Small object pools of the calling thread (initial-exec avoids a TLS lookup call per access)
+#if defined(__GNUC__)
+static _Thread_local PoolCache _cache __attribute__((tls_model("initial-exec")));
+#else
+static _Thread_local PoolCache _cache;
+#endif
+
+// Pools of exited threads, adopted by the next new thread (their objects may still be in use)
+static PoolCache _orphans;
+static pthread_mutex_t _orphansLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t _cacheKey;
+
+// Batches of free objects handed over between threads, per class. The first word of each object 
+// links the objects of a batch, the second word of its first object links the batches.
+static void *_depot[POOL_SMALL_CLASSES];
+static pthread_mutex_t _depotLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _cacheKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Append the slabs and free objects of one pool to another of the same object size.
+ * 
+ * @param dst Pool to move to.
+ * @param src Pool to move from (left empty).
+ * @return Number of free objects moved.
+ */
+static size_t _merge(Pool *dst, Pool *src) {
+    if (src->slabs != NULL) {
+        PoolSlab *tail = src->slabs;
+        while (tail->next != NULL) tail = tail->next;
+        tail->next = dst->slabs;
+        dst->slabs = src->slabs;
+    }
+
+    size_t count = 0;
+    if (src->freeList != NULL) {
+        void **tail = (void**)src->freeList;
+        for (count = 1; *tail != NULL; count++) tail = (void**)*tail;
+        *tail = dst->freeList;
+        dst->freeList = src->freeList;
+    }
+
+    src->slabs = NULL;
+    src->freeList = NULL;
+    return count;
+}
+
+/**
+ * @brief Hand the pools of an exiting thread over to the orphans. Small objects allocated or 
+ * released later by the thread (e.g. in other TLS destructors) go to the orphans directly.
+ * 
+ * @param arg PoolCache of the exiting thread.
+ */
+static void _retireCache(void *arg) {
+    PoolCache *cache = (PoolCache*)arg;
+    pthread_mutex_lock(&_orphansLock);
+    for (size_t i = 0; i < POOL_SMALL_CLASSES; i++) {
+        _merge(&_orphans.classes[i], &cache->classes[i]);
+    }
+    cache->init = false;
+    cache->retired = true;
+    pthread_mutex_unlock(&_orphansLock);
+}
+
+static void _createCacheKey(void) {
+    pthread_key_create(&_cacheKey, _retireCache);
+    for (size_t i = 0; i < POOL_SMALL_CLASSES; i++) 
+        pool_init(&_orphans.classes[i], (i + 1) * POOL_SMALL_STEP, 0);
+}
+
+/**
+ * @brief Initialise the small object pools of the calling thread.
+ * 
+ * @return PoolCache of the calling thread, or NULL if the thread is exiting and its pools were 
+ * retired.
+ */
+static PoolCache *_initCache(void) {
+    PoolCache *cache = &_cache;
+    if (cache->retired) return NULL;
+
+    pthread_once(&_cacheKeyOnce, _createCacheKey);
+    for (size_t i = 0; i < POOL_SMALL_CLASSES; i++) 
+        pool_init(&cache->classes[i], (i + 1) * POOL_SMALL_STEP, 0);
+
+    // Adopt the pools of exited threads
+    pthread_mutex_lock(&_orphansLock);
+    for (size_t i = 0; i < POOL_SMALL_CLASSES; i++) 
+        cache->freeCount[i] = _merge(&cache->classes[i], &_orphans.classes[i]);
+    pthread_mutex_unlock(&_orphansLock);
+
+    pthread_setspecific(_cacheKey, cache);
+    cache->init = true;
+    return cache;
+}
+
+/**
+ * @brief Small object pools of the calling thread, initialised on first use.
+ * 
+ * @return PoolCache of the calling thread (NULL once retired, see _retireCache).
+ */
+static inline PoolCache *_threadCache(void) { return _cache.init ? &_cache : _initCache(); }
+
+/**
+ * @brief Size of the slabs of a pool.
+ * 
+ * @param p Pool object.
+ * @return Size (bytes).
+ */
+static inline size_t _slabSize(const Pool *p) {
+    return sizeof(PoolSlab) + p->objSize * p->slabObjects;
+}
+
+/**
+ * @brief Add a new slab to the pool and thread its objects onto the free list. Slabs come from the 
+ * system allocator through mem_allocWith, so they are counted by the memory statistics.
+ * 
+ * @param p Pool object.
+ * @return true if a slab was added, false otherwise.
+ */
+static bool _addSlab(Pool *p) {
+    if (p->objSize > (SIZE_MAX - sizeof(PoolSlab)) / p->slabObjects) return false;
+
+    PoolSlab *slab = (PoolSlab*)mem_allocWith(mem_systemAllocator(), _slabSize(p));
+    if (slab == NULL) return false;
+
+    slab->next = p->slabs;
+    p->slabs = slab;
+
+    for (size_t i = p->slabObjects; i > 0; i--) {
+        void **obj = (void**)(slab->data + (i - 1) * p->objSize);
+        *obj = p->freeList;
+        p->freeList = obj;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Refill the empty free list of a small object class of a thread: a batch from the depot, 
+ * or a new slab if the depot has none.
+ * 
+ * @param c PoolCache of the calling thread.
+ * @param i Size class.
+ * @return true if the free list was refilled, false otherwise.
+ */
+static bool _refill(PoolCache *c, size_t i) {
+    pthread_mutex_lock(&_depotLock);
+    void **batch = (void**)_depot[i];
+    if (batch != NULL) _depot[i] = batch[1];
+    pthread_mutex_unlock(&_depotLock);
+
+    if (batch != NULL) {
+        c->classes[i].freeList = batch;
+        c->freeCount[i] = POOL_SMALL_BATCH;
+        return true;
+    }
+    if (!_addSlab(&c->classes[i])) return false;
+    c->freeCount[i] = c->classes[i].slabObjects;
+    return true;
+}
+
+/**
+ * @brief Move a batch of objects from the free list of a small object class of a thread to the 
+ * depot.
+ * 
+ * @param c PoolCache of the calling thread.
+ * @param i Size class (holding more than POOL_SMALL_BATCH free objects).
+ */
+static void _flush(PoolCache *c, size_t i) {
+    Pool *p = &c->classes[i];
+    void **first = (void**)p->freeList, **last = first;
+    for (size_t n = 1; n < POOL_SMALL_BATCH; n++) last = (void**)*last;
+    p->freeList = *last;
+    *last = NULL;
+    c->freeCount[i] -= POOL_SMALL_BATCH;
+
+    pthread_mutex_lock(&_depotLock);
+    first[1] = _depot[i];
+    _depot[i] = first;
+    pthread_mutex_unlock(&_depotLock);
+}
+
+void *pool_alloc(Pool *p) {
+    if (p == NULL) return NULL;
+    if (p->freeList == NULL && !_addSlab(p)) return NULL;
+
+    void **obj = (void**)p->freeList;
+    p->freeList = *obj;
+    return obj;
+}
+
+void *pool_allocSmall(size_t size) {
+    if (size == 0) return NULL;
+    if (size > POOL_SMALL_MAX) return mem_allocWith(mem_systemAllocator(), size);
+
+    PoolCache *c = _threadCache();
+    size_t i = (size - 1) / POOL_SMALL_STEP;
+    if (c == NULL) {
+        pthread_mutex_lock(&_orphansLock);
+        void *obj = pool_alloc(&_orphans.classes[i]);
+        pthread_mutex_unlock(&_orphansLock);
+        return obj;
+    }
+
+    if (c->classes[i].freeList == NULL && !_refill(c, i)) return NULL;
+    c->freeCount[i]--;
+    return pool_alloc(&c->classes[i]);
+}
+
+void pool_destroy(Pool *p) {
+    if (p == NULL) return;
+    PoolSlab *slab = p->slabs;
+    while (slab != NULL) {
+        PoolSlab *next = slab->next;
+        mem_freeWith(mem_systemAllocator(), slab, _slabSize(p));
+        slab = next;
+    }
+    p->slabs = NULL;
+    p->freeList = NULL;
+}
+
+void pool_free(Pool *p) {
+    if (p == NULL) return;
+    pool_destroy(p);
+    mem_freeWith(mem_systemAllocator(), p, sizeof(Pool));
+}
+
+bool pool_init(Pool *p, size_t objSize, size_t slabObjects) {
+    if (p == NULL || objSize == 0) return false;
+
+    // Objects must hold the free list link and keep their neighbours aligned
+    size_t align = objSize < sizeof(max_align_t) ? sizeof(void*) : _Alignof(max_align_t);
+    objSize = objSize < sizeof(void*) ? sizeof(void*) : objSize;
+    if (objSize > SIZE_MAX - (align - 1)) return false;
+
+    p->objSize = (objSize + align - 1) & ~(align - 1);
+    p->slabObjects = slabObjects ? slabObjects : POOL_SLAB_OBJECTS;
+    p->slabs = NULL;
+    p->freeList = NULL;
+    return true;
+}
+
+Pool *pool_new(size_t objSize, size_t slabObjects) {
+    Pool *p = (Pool*)mem_allocWith(mem_systemAllocator(), sizeof(Pool));
+    if (p == NULL) return NULL;
+    if (!pool_init(p, objSize, slabObjects)) {
+        mem_freeWith(mem_systemAllocator(), p, sizeof(Pool));
+        return NULL;
+    }
+    return p;
+}
+
+void pool_release(Pool *p, void *obj) {
+    if (p == NULL || obj == NULL) return;
+    *(void**)obj = p->freeList;
+    p->freeList = obj;
+}
+
+void pool_releaseSmall(void *obj, size_t size) {
+    if (obj == NULL || size == 0) return;
+    if (size > POOL_SMALL_MAX) { mem_freeWith(mem_systemAllocator(), obj, size); return; }
+
+    PoolCache *c = _threadCache();
+    size_t i = (size - 1) / POOL_SMALL_STEP;
+    if (c == NULL) {
+        pthread_mutex_lock(&_orphansLock);
+        pool_release(&_orphans.classes[i], obj);
+        pthread_mutex_unlock(&_orphansLock);
+        return;
+    }
+
+    pool_release(&c->classes[i], obj);
+    if (++c->freeCount[i] > POOL_SMALL_CACHED) _flush(c, i);
+}
@@ -6,17 +6,92 @@
 
 #include "darr.h"
 
+/**
+ * @brief Slot of an item in the block of a DArr, past the gap if the item is after it.
+ * 
+ * @param d DArr object.
+ * @param idx Index of item in DArr.
+ * @return Slot (items from the start of the block).
+ */
+static inline size_t _slot(const DArr *d, size_t idx) { 
+    return idx < d->gap ? idx : idx + d->gapLen; 
+}
+
+/**
+ * @brief Move the gap of a DArr, moving the items between its old and new positions over it.
+ * 
+ * @param d DArr object.
+ * @param idx Index of the item the gap is to be in front of.
+ */
+static void _moveGap(DArr *d, size_t idx) {
+    size_t is = d->itemSize;
+    if (d->gapLen > 0 && idx < d->gap)
+        alloc_move(d->block, (idx + d->gapLen) * is, idx * is, (d->gap - idx) * is);
+    else if (d->gapLen > 0 && idx > d->gap)
+        alloc_move(d->block, d->gap * is, (d->gap + d->gapLen) * is, (idx - d->gap) * is);
+    d->gap = idx;
+}
+
+/**
+ * @brief Remove the gap of a DArr, so that its items are contiguous and fill its block.
+ * 
+ * @param d DArr object.
+ * @return true if the gap was removed, false otherwise.
+ */
+static bool _closeGap(DArr *d) {
+    if (d->gapLen == 0) return true;
+    _moveGap(d, d->len);
+    if (!alloc_remove(d->block, d->len * d->itemSize, d->gapLen * d->itemSize)) return false;
+    d->gap = d->gapLen = 0;
+    return true;
+}
+
+/**
+ * @brief Insert items into a DArr in gap buffer mode: the gap is moved to the index, grown if too 
+ * small, and the items are written at its start.
+ * 
+ * @param d DArr object.
+ * @param items Pointer to items (will be copied).
+ * @param idx Index to insert at.
+ * @param count Number of items to insert.
+ * @return true if insert succeeded, false otherwise.
+ */
+static bool _insertGap(DArr *d, const void *items, size_t idx, size_t count) {
+    _moveGap(d, idx);
+    if (d->gapLen < count) {
+        // Grown in proportion to the array, so the items after the gap are moved O(1) amortized
+        size_t grow = math_max(count - d->gapLen, math_max(d->len / 8, DARR_GAP_MIN));
+        if (!alloc_insertSpace(d->block, (d->gap + d->gapLen) * d->itemSize, grow * d->itemSize)) 
+            return false;
+        d->gapLen += grow;
+    }
+    alloc_setAt(d->block, items, d->gap * d->itemSize, count * d->itemSize);
+    d->gap += count;
+    d->gapLen -= count;
+    d->len += count;
+    return true;
+}
+
 bool darr_append(DArr *d, const void *items, size_t count) {
     return darr_insert(d, items, darr_len(d), count);
 }
 
-void darr_clear(DArr *d) { if (d != NULL) { alloc_clear(d->block); d->len = 0; }; }
+void darr_clear(DArr *d) { 
+    if (d != NULL) { alloc_clear(d->block); d->len = d->gap = d->gapLen = 0; }; 
+}
 
 DArr *darr_copy(const DArr *d) {
     if (d == NULL) return NULL;
-    DArr *copy = darr_new(d->len, d->itemSize, alloc_getStrat(d->block));
+    const Allocator *a = alloc_getAllocator(d->block);
+    DArr *copy = (DArr*)mem_allocObject(a, sizeof(DArr));
+    if (copy == NULL) return NULL;
     copy->block = alloc_copy(d->block);
+    if (copy->block == NULL) { mem_freeObject(a, copy, sizeof(DArr)); return NULL; }
+    copy->itemSize = d->itemSize;
     copy->len = d->len;
+    copy->gapMode = d->gapMode;
+    copy->gap = d->gap;
+    copy->gapLen = d->gapLen;
     return copy;
 }
 
@@ -27,15 +102,22 @@ bool darr_expand(DArr *d, size_t size) {
 
 void *darr_first(DArr *d) { return darr_index(d, 0); }
 
-void darr_free(DArr *d) { if (d != NULL) { alloc_free(d->block); free(d); } }
+void darr_free(DArr *d) { 
+    if (d != NULL) { 
+        const Allocator *a = alloc_getAllocator(d->block);
+        alloc_free(d->block); 
+        mem_freeObject(a, d, sizeof(DArr)); 
+    } 
+}
 
 void *darr_index(DArr *d, size_t idx) { 
     if (d == NULL || darr_isEmpty(d) || idx >= darr_len(d)) return NULL; 
-    return alloc_index(d->block, idx * d->itemSize); 
+    return alloc_index(d->block, _slot(d, idx) * d->itemSize); 
 }
 
 bool darr_insert(DArr *d, const void *items, size_t idx, size_t count) {
     if (d == NULL || items == NULL || idx > darr_len(d) || count == 0) return false;
+    if (d->gapMode) return _insertGap(d, items, idx, count);
     if (!alloc_insert(d->block, items, idx * d->itemSize, count * d->itemSize)) 
         return false;
     d->len += count;
@@ -51,71 +133,111 @@ void *darr_last(DArr *d) { return darr_index(d, darr_len(d) - 1); }
 size_t darr_len(DArr *d) { return d ? d->len : 0; }
 
 DArr *darr_new(size_t size, size_t itemSize, AllocStrategy strat) {
+    return darr_newWith(NULL, size, itemSize, strat);
+}
+
+DArr *darr_newIn(Arena *a, size_t size, size_t itemSize, AllocStrategy strat) {
+    return darr_newWith(arena_allocator(a), size, itemSize, strat);
+}
+
+DArr *darr_newWith(const Allocator *a, size_t size, size_t itemSize, AllocStrategy strat) {
     if (itemSize == 0) return NULL;
+    if (a == NULL) a = mem_getAllocator();
 
-    DArr *d = (DArr*)malloc(sizeof(DArr));
+    DArr *d = (DArr*)mem_allocObject(a, sizeof(DArr));
     if (d == NULL) return NULL;
 
-    d->block = alloc_new(size * itemSize, strat);
-    if (d->block == NULL) { free(d); return NULL; }
+    // Chunks hold whole items, so that an item never straddles two chunks
+    bool chunked = strat == ALLOC_STRAT_CHUNKS;
+    d->block = alloc_newWith(a, chunked ? 0 : size * itemSize, strat);
+    if (d->block != NULL && itemSize > alloc_getChunkSize(d->block))
+        alloc_setChunkSize(d->block, math_nextPow2(itemSize));
+    if (d->block == NULL || !alloc_setChunkItem(d->block, itemSize) || 
+        (chunked && size > 0 && !alloc_resize(d->block, size * itemSize))) {
+        alloc_free(d->block);
+        mem_freeObject(a, d, sizeof(DArr));
+        return NULL;
+    }
 
     d->itemSize = itemSize;
-    d->len = 0;
+    d->len = d->gap = d->gapLen = 0;
+    d->gapMode = false;
 
     return d;
 }
 
 bool darr_remove(DArr *d, size_t idx, size_t count) {
     if (d == NULL || darr_len(d) <= idx || darr_len(d) < idx + count || count == 0 ) return false;
+    if (d->gapMode) {
+        // The removed items join the gap
+        _moveGap(d, idx);
+        d->gapLen += count;
+        d->len -= count;
+        return true;
+    }
     if (false == alloc_remove(d->block, idx * d->itemSize, count * d->itemSize)) return false;
     d->len -= count;
     return true;
 }
 
 bool darr_resize(DArr *d, size_t size) {
-    if (d == NULL) return false;
+    if (d == NULL || !_closeGap(d)) return false;
     if (size < d->len) d->len = size;
     return alloc_resize(d->block, size * d->itemSize);
 }
 
 bool darr_setAt(DArr *d, const void *items, size_t idx, size_t count) {
     if (d == NULL || items == NULL || idx + count > darr_len(d) || count == 0) return false;
-    return alloc_setAt(d->block, items, idx * d->itemSize, count * d->itemSize);
+    size_t is = d->itemSize;
+    if (d->gapLen > 0 && idx < d->gap && d->gap < idx + count) {
+        // Set on both sides of the gap
+        size_t before = d->gap - idx;
+        return alloc_setAt(d->block, items, idx * is, before * is) && 
+            alloc_setAt(d->block, (const char*)items + before * is, (d->gap + d->gapLen) * is, 
+                (count - before) * is);
+    }
+    return alloc_setAt(d->block, items, _slot(d, idx) * is, count * is);
 }
 
-size_t darr_size(DArr *d) { return d ? alloc_getSize(d->block) / d->itemSize : 0; }
+bool darr_setGap(DArr *d, bool gap) {
+    if (d == NULL || (!gap && !_closeGap(d))) return false;
+    d->gapMode = gap;
+    return true;
+}
 
-bool darr_split(DArr *d, DArr **ld, DArr **rd, size_t idx) {
-    if (d == NULL || ld == NULL || rd == NULL || idx > d->len) return false;
+bool darr_shrinkToFit(DArr *d) { 
+    return d && _closeGap(d) ? alloc_shrinkToFit(d->block) : false; 
+}
 
-    *ld = darr_new(idx, d->itemSize, alloc_getStrat(d->block));
-    *rd = darr_new(d->len - idx, d->itemSize, alloc_getStrat(d->block));
+size_t darr_size(DArr *d) { return d ? alloc_getSize(d->block) / d->itemSize : 0; }
 
-    if (*ld == NULL || *rd == NULL) {
-        if (*ld) darr_free(*ld);
-        if (*rd) darr_free(*rd);
+bool darr_split(DArr *d, DArr **ld, DArr **rd, size_t idx) {
+    if (d == NULL || ld == NULL || rd == NULL || idx > d->len || !_closeGap(d)) return false;
+
+    const Allocator *a = alloc_getAllocator(d->block);
+    DArr *l = (DArr*)mem_allocObject(a, sizeof(DArr));
+    DArr *r = (DArr*)mem_allocObject(a, sizeof(DArr));
+    if (l == NULL || r == NULL) {
+        mem_freeObject(a, l, sizeof(DArr));
+        mem_freeObject(a, r, sizeof(DArr));
         return false;
     }
 
-    // Copy the data into the left DArr
-    if (idx > 0) {
-        if (!darr_append(*ld, alloc_getBlock(d->block), idx)) {
-            darr_free(*ld);
-            darr_free(*rd);
-            return false;
-        }
+    if (!alloc_split(d->block, &l->block, &r->block, idx * d->itemSize)) {
+        mem_freeObject(a, l, sizeof(DArr));
+        mem_freeObject(a, r, sizeof(DArr));
+        return false;
     }
 
-    // Copy the data into the right DArr
-    if (idx < d->len) {
-        if (!darr_append(*rd, alloc_index(d->block, idx * d->itemSize), d->len - idx)) {
-            darr_free(*ld);
-            darr_free(*rd);
-            return false;
-        }
-    }
+    l->itemSize = r->itemSize = d->itemSize;
+    l->len = idx;
+    r->len = d->len - idx;
+    l->gapMode = r->gapMode = d->gapMode;
+    l->gap = l->gapLen = r->gap = r->gapLen = 0;
 
-    darr_free(d);
+    *ld = l;
+    *rd = r;
+    mem_freeObject(a, d, sizeof(DArr));
 
     return true;
 }
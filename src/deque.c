@@ -0,0 +1,170 @@
+/*
+    File        : deque.c
+    Description : Double-ended queue of items of any single type, stored in a ring buffer on an
+                  AllocBlock, with O(1) push and pop at both ends.
+*/
+
+#include "deque.h"
+
+/**
+ * @brief Pointer to a slot of a Deque.
+ *
+ * @param q Deque object.
+ * @param slot Slot (less than the size of the Deque).
+ * @return Pointer to the slot.
+ */
+static inline char *_slotPtr(const Deque *q, size_t slot) {
+    return (char*)alloc_getBlock(q->block) + slot * q->itemSize;
+}
+
+/**
+ * @brief Copy items into consecutive slots of a Deque, wrapping at its end.
+ *
+ * @param q Deque object.
+ * @param slot First slot.
+ * @param items Pointer to items.
+ * @param count Number of items (at most the size of the Deque).
+ */
+static void _copyIn(Deque *q, size_t slot, const void *items, size_t count) {
+    size_t first = math_min(count, q->mask + 1 - slot), is = q->itemSize;
+    memcpy(_slotPtr(q, slot), items, first * is);
+    if (count > first) memcpy(_slotPtr(q, 0), (const char*)items + first * is, (count - first) * is);
+}
+
+/**
+ * @brief Copy items out of consecutive slots of a Deque, wrapping at its end.
+ *
+ * @param q Deque object.
+ * @param slot First slot.
+ * @param items Where to copy the items to.
+ * @param count Number of items (at most the size of the Deque).
+ */
+static void _copyOut(const Deque *q, size_t slot, void *items, size_t count) {
+    size_t first = math_min(count, q->mask + 1 - slot), is = q->itemSize;
+    memcpy(items, _slotPtr(q, slot), first * is);
+    if (count > first) memcpy((char*)items + first * is, _slotPtr(q, 0), (count - first) * is);
+}
+
+void deque_clear(Deque *q) { if (q != NULL) q->head = q->len = 0; }
+
+bool deque_commitBack(Deque *q, size_t count) {
+    if (q == NULL || count > q->mask + 1 - q->len) return false;
+    q->len += count;
+    return true;
+}
+
+void deque_free(Deque *q) {
+    if (q != NULL) {
+        const Allocator *a = alloc_getAllocator(q->block);
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Deque));
+    }
+}
+
+void *deque_index(Deque *q, size_t idx) {
+    if (q == NULL || idx >= q->len) return NULL;
+    return _slotPtr(q, (q->head + idx) & q->mask);
+}
+
+bool deque_isEmpty(const Deque *q) { return deque_len(q) == 0; }
+
+size_t deque_len(const Deque *q) { return q ? q->len : 0; }
+
+Deque *deque_new(size_t size, size_t itemSize) { return deque_newWith(NULL, size, itemSize); }
+
+Deque *deque_newWith(const Allocator *a, size_t size, size_t itemSize) {
+    if (itemSize == 0) return NULL;
+    if (a == NULL) a = mem_getAllocator();
+
+    size = math_nextPow2(math_max(size, DEQUE_MIN_SIZE));
+    if (size == 0 || size > SIZE_MAX / itemSize) return NULL;
+
+    Deque *q = (Deque*)mem_allocObject(a, sizeof(Deque));
+    if (q == NULL) return NULL;
+
+    q->block = alloc_newWith(a, 0, ALLOC_STRAT_DYNAMIC);
+    if (q->block == NULL || !alloc_insertSpace(q->block, 0, size * itemSize)) {
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Deque));
+        return NULL;
+    }
+
+    q->itemSize = itemSize;
+    q->head = q->len = 0;
+    q->mask = size - 1;
+
+    return q;
+}
+
+size_t deque_popBack(Deque *q, void *items, size_t count) {
+    if (q == NULL) return 0;
+    count = math_min(count, q->len);
+    q->len -= count;
+    if (items != NULL && count > 0) _copyOut(q, (q->head + q->len) & q->mask, items, count);
+    return count;
+}
+
+size_t deque_popFront(Deque *q, void *items, size_t count) {
+    if (q == NULL) return 0;
+    count = math_min(count, q->len);
+    if (items != NULL && count > 0) _copyOut(q, q->head, items, count);
+    q->head = (q->head + count) & q->mask;
+    q->len -= count;
+    return count;
+}
+
+bool deque_pushBack(Deque *q, const void *items, size_t count) {
+    if (q == NULL || items == NULL || count == 0) return false;
+    if (count > SIZE_MAX - q->len || !deque_reserve(q, q->len + count)) return false;
+    _copyIn(q, (q->head + q->len) & q->mask, items, count);
+    q->len += count;
+    return true;
+}
+
+bool deque_pushFront(Deque *q, const void *items, size_t count) {
+    if (q == NULL || items == NULL || count == 0) return false;
+    if (count > SIZE_MAX - q->len || !deque_reserve(q, q->len + count)) return false;
+    q->head = (q->head - count) & q->mask;
+    _copyIn(q, q->head, items, count);
+    q->len += count;
+    return true;
+}
+
+bool deque_reserve(Deque *q, size_t size) {
+    if (q == NULL) return false;
+    size_t oldSize = q->mask + 1;
+    if (size <= oldSize) return true;
+
+    size = math_nextPow2(size);
+    if (size == 0 || size > SIZE_MAX / q->itemSize) return false;
+    if (!alloc_insertSpace(q->block, oldSize * q->itemSize, (size - oldSize) * q->itemSize))
+        return false;
+
+    // Items that wrapped to the start of the old ring move past its end, where the new slots are
+    // (the new ring is at least twice as large, so they fit)
+    if (q->head + q->len > oldSize)
+        memcpy(_slotPtr(q, oldSize), _slotPtr(q, 0), (q->head + q->len - oldSize) * q->itemSize);
+    q->mask = size - 1;
+    return true;
+}
+
+bool deque_reserveBack(Deque *q, size_t count, void *spans[2], size_t lens[2]) {
+    if (q == NULL || spans == NULL || lens == NULL || count == 0) return false;
+    if (count > SIZE_MAX - q->len || !deque_reserve(q, q->len + count)) return false;
+
+    size_t slot = (q->head + q->len) & q->mask;
+    lens[0] = math_min(count, q->mask + 1 - slot);
+    lens[1] = count - lens[0];
+    spans[0] = _slotPtr(q, slot);
+    spans[1] = lens[1] > 0 ? _slotPtr(q, 0) : NULL;
+    return true;
+}
+
+size_t deque_size(const Deque *q) { return q ? q->mask + 1 : 0; }
+
+void *deque_span(Deque *q, size_t idx, size_t *len) {
+    if (q == NULL || idx >= q->len) { if (len) *len = 0; return NULL; }
+    size_t slot = (q->head + idx) & q->mask;
+    if (len) *len = math_min(q->len - idx, q->mask + 1 - slot);
+    return _slotPtr(q, slot);
+}
@@ -4,22 +4,189 @@
     Description : File Operations
 */
 
+#define _GNU_SOURCE // copy_file_range, syncfs
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "file.h"
 
-bool file_create(const char *path, const char *content) {
-    // Check if the file already exists
-    FILE *checkFile = fopen(path, "r");
-    if (checkFile != NULL) { fclose(checkFile); return false; }
+// Buffer size (bytes) of the read / write loop of file_copy
+#define _COPY_BUFF_SIZE (1024 * 1024)
+
+// Ways of copying between two files, from the fastest to the most widely supported
+typedef enum {
+    COPY_RANGE, // copy_file_range: within the kernel, reflinks or server side copies when possible
+    COPY_SENDFILE, // sendfile: within the kernel, through the page cache
+    COPY_LOOP // read / write through a user space buffer
+} CopyMethod;
 
-    FILE *file = fopen(path, "w");
-    if (file == NULL) return false;
+/**
+ * @brief Convert an access pattern to its madvise hint.
+ * 
+ * @param access Access pattern.
+ * @return madvise advice.
+ */
+static int _madvice(FileAccess access) {
+    switch (access) {
+        case FILE_ACCESS_SEQUENTIAL:
+            return MADV_SEQUENTIAL;
+        case FILE_ACCESS_RANDOM:
+            return MADV_RANDOM;
+        default:
+            return MADV_NORMAL;
+    }
+}
 
-    if (fprintf(file, "%s", content) < 0) { fclose(file); return false; }
+/**
+ * @brief Read from a file descriptor, retrying if interrupted by a signal.
+ * 
+ * @param fd File descriptor.
+ * @param buf Buffer to read into.
+ * @param count Maximum number of bytes to read.
+ * @return Number of bytes read (0 at end of file), or -1 if failure.
+ */
+static ssize_t _read(int fd, void *buf, size_t count) {
+    ssize_t n;
+    do n = read(fd, buf, count); while (n == -1 && errno == EINTR);
+    return n;
+}
 
-    fclose(file);
+/**
+ * @brief Write a whole buffer to a file descriptor, retrying partial writes and interrupted calls.
+ * 
+ * @param fd File descriptor.
+ * @param data Data.
+ * @param size Size (bytes) of the data.
+ * @return true if all data was written, false otherwise.
+ */
+static bool _writeAll(int fd, const void *data, size_t size) {
+    const char *p = (const char*)data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= (size_t)n;
+    }
     return true;
 }
 
+/**
+ * @brief Copy the next chunk between two files, from and to their current offsets. Moves on to the 
+ * next method when the files do not support one.
+ * 
+ * @param in Source file descriptor.
+ * @param out Destination file descriptor.
+ * @param method Method to try first, set to the one that worked.
+ * @param buff Buffer of the read / write loop, allocated on first use (to free afterwards).
+ * @param copied Number of bytes copied so far.
+ * @return Number of bytes copied (0 at end of file), or -1 if failure.
+ */
+static ssize_t _copyChunk(int in, int out, CopyMethod *method, char **buff, size_t copied) {
+    while (*method != COPY_LOOP) {
+        ssize_t n = *method == COPY_RANGE
+            ? copy_file_range(in, NULL, out, NULL, FILE_COPY_CHUNK, 0)
+            : sendfile(out, in, NULL, FILE_COPY_CHUNK);
+        if (n == -1 && errno == EINTR) continue;
+
+        // Some files (/proc, /sys) give nothing to these calls, the loop confirms the end of file
+        if (n > 0 || (n == 0 && copied > 0)) return n;
+        if (n == -1 && errno != EXDEV && errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP)
+            return -1;
+        *method = *method == COPY_RANGE ? COPY_SENDFILE : COPY_LOOP;
+    }
+
+    if (*buff == NULL && (*buff = (char*)malloc(_COPY_BUFF_SIZE)) == NULL) return -1;
+    ssize_t n = _read(in, *buff, _COPY_BUFF_SIZE);
+    if (n > 0 && !_writeAll(out, *buff, (size_t)n)) return -1;
+    return n;
+}
+
+/**
+ * @brief Flush the entries of the directory holding a path (e.g. a rename into it) to storage.
+ * 
+ * @param path Path to a file in the directory.
+ * @return true if the directory was synced, false otherwise.
+ */
+static bool _syncDir(const char *path) {
+    const char *slash = strrchr(path, '/');
+    size_t len = slash == NULL ? 0 : math_max((size_t)(slash - path), 1); // Keep the root "/"
+    char *dir = len == 0 ? strdup(".") : strndup(path, len);
+    if (dir == NULL) return false;
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    free(dir);
+    if (fd == -1) return false;
+
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool file_advise(const FileView *view, FileAccess access) {
+    if (view == NULL) return false;
+    if (view->base == NULL) return true;
+    return madvise(view->base, view->size, _madvice(access)) == 0;
+}
+
+bool file_copy(const char *src, const char *dst, FileProgress progress, void *arg) {
+    if (src == NULL || dst == NULL) return false;
+
+    int in = open(src, O_RDONLY | O_CLOEXEC);
+    if (in == -1) return false;
+
+    struct stat st;
+    if (fstat(in, &st) == -1 || S_ISDIR(st.st_mode)) { close(in); return false; }
+
+    // Truncated only once known not to be the source
+    int out = open(dst, O_WRONLY | O_CREAT | O_CLOEXEC, st.st_mode & 0777);
+    if (out == -1) { close(in); return false; }
+
+    struct stat dstSt;
+    bool ok = fstat(out, &dstSt) == 0;
+    if (ok && dstSt.st_dev == st.st_dev && dstSt.st_ino == st.st_ino) {
+        close(in);
+        close(out);
+        return false;
+    }
+    ok = ok && ftruncate(out, 0) == 0;
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    size_t total = S_ISREG(st.st_mode) ? (size_t)st.st_size : 0, copied = 0;
+    CopyMethod method = COPY_RANGE;
+    char *buff = NULL;
+    while (ok) {
+        ssize_t n = _copyChunk(in, out, &method, &buff, copied);
+        if (n <= 0) { ok = n == 0; break; }
+        copied += (size_t)n;
+        if (progress != NULL && !progress(copied, total, arg)) ok = false;
+    }
+
+    free(buff);
+    close(in);
+    if (close(out) == -1) ok = false;
+    if (!ok) unlink(dst);
+    return ok;
+}
+
+bool file_create(const char *path, const char *content) {
+    if (path == NULL || content == NULL) return false;
+
+    // Fails if the file already exists, in the same call that creates it
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd == -1) return false;
+
+    bool ok = _writeAll(fd, content, strlen(content));
+    if (close(fd) == -1) ok = false;
+    if (!ok) unlink(path);
+    return ok;
+}
+
 bool file_delete(const char *path) {
     if (!(remove(path) == 0 || errno == ENOENT)) {
         fprintf(stderr, "Error: Failed to delete file '%s': %s\n", path, strerror(errno));
@@ -28,6 +195,36 @@ bool file_delete(const char *path) {
     return true;
 }
 
+bool file_map(const char *path, FileAccess access, FileView *view) {
+    if (view == NULL) return false;
+    view->data = "";
+    view->size = 0;
+    view->base = NULL;
+    if (path == NULL) return false;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) { close(fd); return false; }
+
+    // Empty files cannot be mapped, they get an empty view
+    if (st.st_size == 0) { close(fd); return true; }
+    if ((uintmax_t)st.st_size > SIZE_MAX) { close(fd); return false; }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps its own reference to the file
+    if (base == MAP_FAILED) return false;
+
+    view->data = (const char*)base;
+    view->size = size;
+    view->base = base;
+    file_advise(view, access);
+
+    return true;
+}
+
 FILE *file_open(const char *path, const char *modes) {
     FILE *f = fopen(path, modes);
     if (f == NULL)
@@ -35,25 +232,94 @@ FILE *file_open(const char *path, const char *modes) {
     return f;
 }
 
-char *file_read(const char *path) {
-    FILE *f = fopen(path, "r");
-    if (f == NULL) return NULL; 
+char *file_read(const char *path, size_t *size) {
+    if (size != NULL) *size = 0;
+    if (path == NULL) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return NULL;
 
-    AllocBlock *block = alloc_new(_BUFF_SIZE, _ALLOC_STRAT);
-    if (block == NULL) { fclose(f); return NULL; }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || S_ISDIR(st.st_mode)) { close(fd); return NULL; }
 
-    size_t buffSize = 0;
-    ssize_t lineLen = 0;
-    char *line = NULL;
+    // Room for the whole file and the terminator when its size is known, /proc files report 0
+    size_t cap = _BUFF_SIZE;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        if ((uintmax_t)st.st_size >= SIZE_MAX) { close(fd); return NULL; }
+        cap = (size_t)st.st_size + 1;
+    }
 
-    while ((lineLen = getline(&line, &buffSize, f)) != -1) 
-        alloc_append(block, line, lineLen * sizeof(char));
+    char *text = (char*)malloc(cap);
+    if (text == NULL) { close(fd); return NULL; }
 
-    free(line);
-    fclose(f);
-    
-    char *text = (char*)alloc_getBlock(block);
-    free(block);
+    size_t len = 0;
+    while (true) {
+        ssize_t n;
+        if (len + 1 < cap) {
+            n = _read(fd, text + len, cap - 1 - len);
+        } else {
+            // Full: probe for the end of file before growing, so a file that kept its fstat size 
+            // is never reallocated
+            char c;
+            n = _read(fd, &c, 1);
+            if (n == 1) {
+                char *grown = cap <= SIZE_MAX / 2 ? (char*)realloc(text, cap * 2) : NULL;
+                if (grown == NULL) n = -1;
+                else { text = grown; cap *= 2; text[len] = c; }
+            }
+        }
+        if (n == 0) break;
+        if (n == -1) { free(text); close(fd); return NULL; }
+        len += (size_t)n;
+    }
 
+    close(fd);
+    text[len] = '\0';
+    if (size != NULL) *size = len;
     return text;
 }
+
+bool file_syncFs(const char *path) {
+    if (path == NULL) return false;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+
+    bool ok = syncfs(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+void file_unmap(FileView *view) {
+    if (view == NULL) return;
+    if (view->base != NULL) munmap(view->base, view->size);
+    view->data = "";
+    view->size = 0;
+    view->base = NULL;
+}
+
+bool file_write(const char *path, const void *data, size_t size, bool sync) {
+    if (path == NULL || (data == NULL && size > 0)) return false;
+
+    // Unique temporary name next to the file, so the rename stays within its filesystem
+    static atomic_uint counter;
+    size_t tmpSize = strlen(path) + 32;
+    char *tmp = (char*)malloc(tmpSize);
+    if (tmp == NULL) return false;
+
+    int fd = -1;
+    for (int i = 0; fd == -1 && i < 100; i++) {
+        snprintf(tmp, tmpSize, "%s.tmp.%ld.%u", path, (long)getpid(), atomic_fetch_add(&counter, 1));
+        fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd == -1 && errno != EEXIST) break;
+    }
+    if (fd == -1) { free(tmp); return false; }
+
+    bool ok = _writeAll(fd, data, size) && (!sync || fsync(fd) == 0);
+    if (close(fd) == -1) ok = false;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) unlink(tmp);
+    free(tmp);
+
+    return ok && (!sync || _syncDir(path));
+}
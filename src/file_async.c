@@ -0,0 +1,566 @@
+/*
+    File        : file_async.c
+    Description : Asynchronous file I/O engine over io_uring, with a thread pool (pread/pwrite)
+                  fallback, reading into and writing from plain buffers, AllocBlocks and DArrs.
+*/
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "file_async.h"
+
+// Largest transfer of a single read or write (as the kernel caps read/write)
+#define _MAX_RW 0x7ffff000
+
+/**
+ * @brief Append a slot to a FIFO list.
+ *
+ * @param head Head of the list.
+ * @param tail Tail of the list.
+ * @param s Slot.
+ */
+static void _listPush(AsyncSlot **head, AsyncSlot **tail, AsyncSlot *s) {
+    s->next = NULL;
+    if (*tail != NULL) (*tail)->next = s;
+    else *head = s;
+    *tail = s;
+}
+
+/**
+ * @brief Remove the first slot of a FIFO list.
+ *
+ * @param head Head of the list.
+ * @param tail Tail of the list.
+ * @return Slot, or NULL if the list is empty.
+ */
+static AsyncSlot *_listPop(AsyncSlot **head, AsyncSlot **tail) {
+    AsyncSlot *s = *head;
+    if (s == NULL) return NULL;
+    *head = s->next;
+    if (*head == NULL) *tail = NULL;
+    return s;
+}
+
+/**
+ * @brief Find the oldest read into a block not applied to it yet.
+ *
+ * @param a Async object.
+ * @param b Block.
+ * @return Slot of the read, or NULL if none.
+ */
+static AsyncSlot *_firstRead(Async *a, const AllocBlock *b) {
+    AsyncSlot *first = NULL;
+    for (unsigned i = 0; i < a->depth; i++) {
+        AsyncSlot *s = &a->slots[i];
+        if (s->block == b && (first == NULL || s->seq < first->seq)) first = s;
+    }
+    return first;
+}
+
+/**
+ * @brief Offset (bytes) in a block past the reads into it not applied yet, where a new read lands.
+ *
+ * @param a Async object.
+ * @param b Block.
+ * @return Offset.
+ */
+static size_t _reserved(const Async *a, const AllocBlock *b) {
+    size_t end = b->used;
+    for (unsigned i = 0; i < a->depth; i++) {
+        const AsyncSlot *s = &a->slots[i];
+        if (s->block == b) end = math_max(end, s->pos + s->size);
+    }
+    return end;
+}
+
+/**
+ * @brief Release the slot of a request.
+ *
+ * @param a Async object.
+ * @param s Slot.
+ */
+static inline void _release(Async *a, AsyncSlot *s) {
+    s->block = NULL;
+    s->darr = NULL;
+    s->next = a->freeSlots;
+    a->freeSlots = s;
+}
+
+/**
+ * @brief Apply the completed reads into a block, in the order they were queued, up to the first
+ * read still pending.
+ *
+ * @param a Async object.
+ * @param b Block.
+ */
+static void _settle(Async *a, AllocBlock *b) {
+    AsyncSlot *s;
+    while ((s = _firstRead(a, b)) != NULL && s->done) {
+        size_t n = s->result > 0 ? (size_t)s->result : 0;
+        if (s->darr != NULL) {
+            // Only whole items are added, the bytes of a partial item are dropped
+            n -= n % s->darr->itemSize;
+            s->darr->len += n / s->darr->itemSize;
+        }
+
+        // Moved down over the bytes an earlier short read left unused
+        char *data = (char*)alloc_getBlock(b);
+        if (s->pos != b->used) memmove(data + b->used, data + s->pos, n);
+        b->used += n;
+        _release(a, s);
+    }
+}
+
+/**
+ * @brief Finish a request: update the block or DArr it read into and release its slot.
+ *
+ * @param a Async object.
+ * @param s Slot of the request.
+ * @param result Result of the request (bytes transferred or -errno).
+ * @return Completion to hand to the caller.
+ */
+static AsyncCompletion _complete(Async *a, AsyncSlot *s, ssize_t result) {
+    AsyncCompletion c = { s->userData, result };
+
+    a->inflight--;
+    if (s->block != NULL) {
+        s->result = result;
+        s->done = true;
+        _settle(a, s->block);
+    } else {
+        _release(a, s);
+    }
+    return c;
+}
+
+/**
+ * @brief Perform a request synchronously (thread pool engine).
+ *
+ * @param s Slot of the request.
+ * @return Bytes transferred, or -errno.
+ */
+static ssize_t _perform(const AsyncSlot *s) {
+    ssize_t n;
+    do {
+        n = s->op == ASYNC_OP_READ
+            ? pread(s->fd, s->buff, s->size, s->offset)
+            : pwrite(s->fd, s->buff, s->size, s->offset);
+    } while (n == -1 && errno == EINTR);
+    return n == -1 ? -errno : n;
+}
+
+/**
+ * @brief Worker thread of the thread pool engine. Runs submitted requests until stopped, then
+ * exits once no submitted requests are left.
+ *
+ * @param arg Async object.
+ * @return NULL.
+ */
+static void *_worker(void *arg) {
+    Async *a = (Async*)arg;
+
+    pthread_mutex_lock(&a->lock);
+    while (true) {
+        while (a->work == NULL && !a->stop) pthread_cond_wait(&a->workCond, &a->lock);
+        AsyncSlot *s = _listPop(&a->work, &a->workTail);
+        if (s == NULL) break;
+
+        pthread_mutex_unlock(&a->lock);
+        s->result = _perform(s);
+        pthread_mutex_lock(&a->lock);
+
+        _listPush(&a->done, &a->doneTail, s);
+        pthread_cond_signal(&a->doneCond);
+    }
+    pthread_mutex_unlock(&a->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Stop and join the worker threads of the thread pool engine.
+ *
+ * @param a Async object.
+ * @param count Number of threads started.
+ */
+static void _stopThreads(Async *a, unsigned count) {
+    pthread_mutex_lock(&a->lock);
+    a->stop = true;
+    pthread_cond_broadcast(&a->workCond);
+    pthread_mutex_unlock(&a->lock);
+
+    for (unsigned i = 0; i < count; i++) pthread_join(a->threads[i], NULL);
+    free(a->threads);
+    pthread_mutex_destroy(&a->lock);
+    pthread_cond_destroy(&a->workCond);
+    pthread_cond_destroy(&a->doneCond);
+}
+
+/**
+ * @brief Start the thread pool engine.
+ *
+ * @param a Async object.
+ * @return true if started, false otherwise.
+ */
+static bool _startThreads(Async *a) {
+    a->threadCount = a->depth < ASYNC_THREADS ? a->depth : ASYNC_THREADS;
+    a->threads = (pthread_t*)malloc(a->threadCount * sizeof(pthread_t));
+    if (a->threads == NULL) return false;
+
+    a->staged = a->stagedTail = a->work = a->workTail = a->done = a->doneTail = NULL;
+    a->stop = false;
+    pthread_mutex_init(&a->lock, NULL);
+    pthread_cond_init(&a->workCond, NULL);
+    pthread_cond_init(&a->doneCond, NULL);
+
+    for (unsigned i = 0; i < a->threadCount; i++) {
+        if (pthread_create(&a->threads[i], NULL, _worker, a) != 0) {
+            _stopThreads(a, i);
+            return false;
+        }
+    }
+
+    a->engine = ASYNC_ENGINE_THREADS;
+    return true;
+}
+
+/**
+ * @brief Unmap the rings and close an io_uring instance.
+ *
+ * @param a Async object.
+ */
+static void _closeRing(Async *a) {
+    if (a->sqes != NULL) munmap(a->sqes, a->sqesSize);
+    if (a->cqRing != NULL && a->cqRing != a->sqRing) munmap(a->cqRing, a->cqRingSize);
+    if (a->sqRing != NULL) munmap(a->sqRing, a->sqRingSize);
+    close(a->ringFd);
+}
+
+/**
+ * @brief Set up the io_uring engine.
+ *
+ * @param a Async object.
+ * @return true if io_uring is available and was set up, false otherwise.
+ */
+static bool _startRing(Async *a) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    a->ringFd = (int)syscall(__NR_io_uring_setup, a->depth, &p);
+    if (a->ringFd < 0) return false;
+
+    a->sqRing = a->cqRing = NULL;
+    a->sqes = NULL;
+
+    // IORING_OP_READ/WRITE came with the same kernel (5.6) as this feature
+    if (!(p.features & IORING_FEAT_RW_CUR_POS)) { _closeRing(a); return false; }
+
+    a->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    a->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    a->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) a->sqRingSize = a->cqRingSize = math_max(a->sqRingSize, a->cqRingSize);
+
+    int prot = PROT_READ | PROT_WRITE, flags = MAP_SHARED | MAP_POPULATE;
+    void *sq = mmap(NULL, a->sqRingSize, prot, flags, a->ringFd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) { _closeRing(a); return false; }
+    a->sqRing = sq;
+
+    void *cq = single ? sq : mmap(NULL, a->cqRingSize, prot, flags, a->ringFd, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) { _closeRing(a); return false; }
+    a->cqRing = cq;
+
+    void *sqes = mmap(NULL, a->sqesSize, prot, flags, a->ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) { _closeRing(a); return false; }
+    a->sqes = (struct io_uring_sqe*)sqes;
+
+    char *s = (char*)sq, *c = (char*)cq;
+    a->sqHead = (unsigned*)(s + p.sq_off.head);
+    a->sqTail = (unsigned*)(s + p.sq_off.tail);
+    a->sqMask = (unsigned*)(s + p.sq_off.ring_mask);
+    a->sqArray = (unsigned*)(s + p.sq_off.array);
+    a->cqHead = (unsigned*)(c + p.cq_off.head);
+    a->cqTail = (unsigned*)(c + p.cq_off.tail);
+    a->cqMask = (unsigned*)(c + p.cq_off.ring_mask);
+    a->cqes = (struct io_uring_cqe*)(c + p.cq_off.cqes);
+    a->sqLocalTail = *a->sqTail;
+
+    a->engine = ASYNC_ENGINE_URING;
+    return true;
+}
+
+/**
+ * @brief Hand the queued io_uring entries to the kernel, optionally waiting for completions.
+ *
+ * @param a Async object.
+ * @param minComplete Number of completions to wait for (0 to return immediately).
+ * @return Number of entries consumed by the kernel, or -1 if failure.
+ */
+static int _enterRing(Async *a, unsigned minComplete) {
+    __atomic_store_n(a->sqTail, a->sqLocalTail, __ATOMIC_RELEASE);
+
+    unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    long n;
+    do {
+        n = syscall(__NR_io_uring_enter, a->ringFd, a->queued, minComplete, flags, NULL, 0);
+    } while (n == -1 && errno == EINTR);
+    if (n < 0) return -1;
+
+    a->queued -= (unsigned)n;
+    a->inflight += (unsigned)n;
+    return (int)n;
+}
+
+/**
+ * @brief Reap the completions posted by the kernel.
+ *
+ * @param a Async object.
+ * @param out Array to store the completions in.
+ * @param max Size of `out`.
+ * @return Number of completions stored.
+ */
+static int _reapRing(Async *a, AsyncCompletion *out, int max) {
+    unsigned head = *a->cqHead;
+    unsigned tail = __atomic_load_n(a->cqTail, __ATOMIC_ACQUIRE);
+
+    int n = 0;
+    for (; head != tail && n < max; head++) {
+        const struct io_uring_cqe *cqe = &a->cqes[head & *a->cqMask];
+        out[n++] = _complete(a, (AsyncSlot*)(uintptr_t)cqe->user_data, cqe->res);
+    }
+
+    __atomic_store_n(a->cqHead, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+/**
+ * @brief Reap the completions of the worker threads. The lock must be held.
+ *
+ * @param a Async object.
+ * @param out Array to store the completions in.
+ * @param max Size of `out`.
+ * @return Number of completions stored.
+ */
+static int _reapThreads(Async *a, AsyncCompletion *out, int max) {
+    int n = 0;
+    AsyncSlot *s;
+    while (n < max && (s = _listPop(&a->done, &a->doneTail)) != NULL)
+        out[n++] = _complete(a, s, s->result);
+    return n;
+}
+
+/**
+ * @brief Queue a request.
+ *
+ * @param a Async object.
+ * @param op Operation.
+ * @param fd File descriptor.
+ * @param buff Buffer.
+ * @param size Size (bytes) to transfer.
+ * @param offset File offset.
+ * @param userData Passed back with the completion.
+ * @return Slot of the request (to attach a block or DArr to), or NULL if the queue is full.
+ */
+static AsyncSlot *_queue(Async *a, AsyncOp op, int fd, void *buff, size_t size, off_t offset,
+    void *userData) {
+    AsyncSlot *s = a->freeSlots;
+    if (s == NULL) return NULL;
+    a->freeSlots = s->next;
+
+    s->op = op;
+    s->fd = fd;
+    s->buff = buff;
+    s->size = math_min(size, (size_t)_MAX_RW);
+    s->offset = offset;
+    s->userData = userData;
+    s->block = NULL;
+    s->darr = NULL;
+    s->done = false;
+    s->seq = a->seq++;
+
+    if (a->engine == ASYNC_ENGINE_URING) {
+        unsigned idx = a->sqLocalTail & *a->sqMask;
+        struct io_uring_sqe *sqe = &a->sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = op == ASYNC_OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = (uintptr_t)buff;
+        sqe->len = (unsigned)s->size;
+        sqe->off = (uint64_t)offset;
+        sqe->user_data = (uintptr_t)s;
+        a->sqArray[idx] = idx;
+        a->sqLocalTail++;
+    } else {
+        _listPush(&a->staged, &a->stagedTail, s);
+    }
+
+    a->queued++;
+    return s;
+}
+
+/**
+ * @brief Check the arguments of a request.
+ *
+ * @param a Async object.
+ * @param fd File descriptor.
+ * @param offset File offset.
+ * @return true if valid, false otherwise.
+ */
+static inline bool _valid(const Async *a, int fd, off_t offset) {
+    return a != NULL && fd >= 0 && offset >= 0;
+}
+
+AsyncEngine async_engine(const Async *a) { return a ? a->engine : ASYNC_ENGINE_AUTO; }
+
+void async_free(Async *a) {
+    if (a == NULL) return;
+
+    // Drop the queued requests, the buffers of those in flight must outlive them
+    if (a->engine == ASYNC_ENGINE_URING) {
+        a->sqLocalTail -= a->queued;
+        a->queued = 0;
+    } else {
+        while (_listPop(&a->staged, &a->stagedTail) != NULL) a->queued--;
+    }
+
+    AsyncCompletion c[16];
+    while (a->inflight > 0 && async_wait(a, c, 16) >= 0) {}
+
+    if (a->engine == ASYNC_ENGINE_URING) _closeRing(a);
+    else _stopThreads(a, a->threadCount);
+
+    free(a->slots);
+    free(a);
+}
+
+Async *async_new(unsigned depth, AsyncEngine engine) {
+    Async *a = (Async*)malloc(sizeof(Async));
+    if (a == NULL) return NULL;
+
+    a->depth = depth ? depth : ASYNC_QUEUE_DEPTH;
+    a->queued = 0;
+    a->inflight = 0;
+    a->seq = 0;
+    a->slots = (AsyncSlot*)malloc(a->depth * sizeof(AsyncSlot));
+    if (a->slots == NULL) { free(a); return NULL; }
+
+    a->freeSlots = NULL;
+    for (unsigned i = a->depth; i > 0; i--) _release(a, &a->slots[i - 1]);
+
+    bool started = false;
+    if (engine != ASYNC_ENGINE_THREADS) started = _startRing(a);
+    if (!started && engine != ASYNC_ENGINE_URING) started = _startThreads(a);
+    if (!started) { free(a->slots); free(a); return NULL; }
+
+    return a;
+}
+
+size_t async_pending(const Async *a) { return a ? (size_t)a->queued + a->inflight : 0; }
+
+int async_poll(Async *a, AsyncCompletion *out, int max) {
+    if (a == NULL || out == NULL || max <= 0) return 0;
+    if (a->engine == ASYNC_ENGINE_URING) return _reapRing(a, out, max);
+
+    pthread_mutex_lock(&a->lock);
+    int n = _reapThreads(a, out, max);
+    pthread_mutex_unlock(&a->lock);
+    return n;
+}
+
+bool async_read(Async *a, int fd, void *buff, size_t size, off_t offset, void *userData) {
+    if (!_valid(a, fd, offset) || (buff == NULL && size > 0)) return false;
+    return _queue(a, ASYNC_OP_READ, fd, buff, size, offset, userData) != NULL;
+}
+
+bool async_readBlock(Async *a, int fd, AllocBlock *b, size_t size, off_t offset, void *userData) {
+    if (!_valid(a, fd, offset) || b == NULL || b->strat == ALLOC_STRAT_CHUNKS) return false;
+    if (a->freeSlots == NULL) return false;
+
+    size_t at = _reserved(a, b);
+    if (size > SIZE_MAX - at) return false;
+
+    // The block is not moved while reads into it are pending
+    if (at + size > alloc_getSize(b)) {
+        if (_firstRead(a, b) != NULL || !alloc_resize(b, at + size)) return false;
+    }
+
+    char *buff = (char*)alloc_getBlock(b) + at;
+    AsyncSlot *s = _queue(a, ASYNC_OP_READ, fd, buff, size, offset, userData);
+    s->block = b;
+    s->pos = at;
+    return true;
+}
+
+bool async_readDArr(Async *a, int fd, DArr *d, size_t count, off_t offset, void *userData) {
+    if (!_valid(a, fd, offset) || d == NULL || d->block->strat == ALLOC_STRAT_CHUNKS) return false;
+    if (d->gapLen > 0 || a->freeSlots == NULL) return false;
+
+    // Whole items past the reads pending (a read capped to 0x7ffff000 bytes may end mid-item)
+    size_t len = (_reserved(a, d->block) + d->itemSize - 1) / d->itemSize;
+    if (count > SIZE_MAX / d->itemSize - len) return false;
+
+    if (len + count > darr_size(d)) {
+        if (_firstRead(a, d->block) != NULL || !darr_expand(d, len + count)) return false;
+    }
+
+    char *buff = (char*)alloc_getBlock(d->block) + len * d->itemSize;
+    AsyncSlot *s = _queue(a, ASYNC_OP_READ, fd, buff, count * d->itemSize, offset, userData);
+    s->block = d->block;
+    s->darr = d;
+    s->pos = len * d->itemSize;
+    return true;
+}
+
+int async_submit(Async *a) {
+    if (a == NULL) return -1;
+    if (a->queued == 0) return 0;
+    if (a->engine == ASYNC_ENGINE_URING) return _enterRing(a, 0);
+
+    pthread_mutex_lock(&a->lock);
+    AsyncSlot *s;
+    while ((s = _listPop(&a->staged, &a->stagedTail)) != NULL) _listPush(&a->work, &a->workTail, s);
+    pthread_cond_broadcast(&a->workCond);
+    pthread_mutex_unlock(&a->lock);
+
+    int n = (int)a->queued;
+    a->inflight += a->queued;
+    a->queued = 0;
+    return n;
+}
+
+int async_wait(Async *a, AsyncCompletion *out, int max) {
+    if (a == NULL || out == NULL || max <= 0) return -1;
+
+    if (a->engine == ASYNC_ENGINE_URING) {
+        int n = _reapRing(a, out, max);
+        if (n > 0 || a->queued + a->inflight == 0) return n;
+        if (_enterRing(a, 1) < 0) return -1;
+        return _reapRing(a, out, max);
+    }
+
+    if (async_submit(a) < 0) return -1;
+
+    pthread_mutex_lock(&a->lock);
+    while (a->done == NULL && a->inflight > 0) pthread_cond_wait(&a->doneCond, &a->lock);
+    int n = _reapThreads(a, out, max);
+    pthread_mutex_unlock(&a->lock);
+    return n;
+}
+
+bool async_write(Async *a, int fd, const void *buff, size_t size, off_t offset, void *userData) {
+    if (!_valid(a, fd, offset) || (buff == NULL && size > 0)) return false;
+    return _queue(a, ASYNC_OP_WRITE, fd, (void*)buff, size, offset, userData) != NULL;
+}
+
+bool async_writeBlock(Async *a, int fd, const AllocBlock *b, off_t offset, void *userData) {
+    if (b == NULL || b->strat == ALLOC_STRAT_CHUNKS) return false;
+    return async_write(a, fd, alloc_getBlock(b), b->used, offset, userData);
+}
+
+bool async_writeDArr(Async *a, int fd, const DArr *d, off_t offset, void *userData) {
+    return d && d->gapLen == 0 ? async_writeBlock(a, fd, d->block, offset, userData) : false;
+}
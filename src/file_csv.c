@@ -0,0 +1,476 @@
+/*
+    File        : file_csv.c
+    Description : Streaming parser of delimited text (CSV, TSV) into one DArr per column, with
+                  numeric columns parsed in place and string columns stored without allocating
+                  per field.
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_csv.h"
+#include "scan.h"
+
+// Longest number handed to strtod when the fast path does not apply
+#define _NUM_MAX 64
+
+// Outcome of scanning the record at the start of the buffered data
+typedef enum {
+    RECORD_DONE,
+    RECORD_BLANK, // Blank line, skipped
+    RECORD_MORE, // Incomplete, more data is needed
+    RECORD_ERROR
+} RecordStatus;
+
+// Position in the marks of the buffered data (see scan_mask)
+typedef struct {
+    size_t w, words; // Current word, number of words
+    uint64_t m; // Marks of the current word not yet returned
+} MarkCursor;
+
+// Powers of 10 exactly representable as doubles
+static const double _pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief Parse a decimal floating point number, exactly as strtod. Numbers of at most 19 digits
+ * whose mantissa fits in 53 bits with a power of 10 up to 22 (most data) are computed with a
+ * single correctly rounded operation, others are handed to strtod.
+ *
+ * @param s Field (not NUL terminated).
+ * @param len Length (bytes) of the field.
+ * @param value Set to the number.
+ * @return true if the whole field is a number, false otherwise.
+ */
+static bool _parseDouble(const char *s, size_t len, double *value) {
+    if (len == 0) { *value = __builtin_nan(""); return true; }
+
+    size_t i = 0;
+    bool neg = s[0] == '-';
+    if (s[0] == '-' || s[0] == '+') i++;
+
+    uint64_t mant = 0;
+    int digits = 0, exp = 0;
+    for (; i < len && s[i] >= '0' && s[i] <= '9'; i++, digits++)
+        mant = mant * 10 + (uint64_t)(s[i] - '0');
+    if (i < len && s[i] == '.') {
+        for (i++; i < len && s[i] >= '0' && s[i] <= '9'; i++, digits++, exp--)
+            mant = mant * 10 + (uint64_t)(s[i] - '0');
+    }
+    if (digits > 0 && i < len && (s[i] == 'e' || s[i] == 'E')) {
+        size_t j = i + 1;
+        bool expNeg = j < len && s[j] == '-';
+        if (j < len && (s[j] == '-' || s[j] == '+')) j++;
+        int e = 0;
+        size_t start = j;
+        for (; j < len && s[j] >= '0' && s[j] <= '9' && e < 10000; j++) e = e * 10 + (s[j] - '0');
+        if (j > start) { exp += expNeg ? -e : e; i = j; }
+    }
+
+    if (i == len && digits > 0 && digits <= 19 && mant <= ((uint64_t)1 << 53) && exp >= -22
+        && exp <= 22) {
+        double d = (double)mant;
+        d = exp < 0 ? d / _pow10[-exp] : d * _pow10[exp];
+        *value = neg ? -d : d;
+        return true;
+    }
+
+    // Other forms (long mantissas, large exponents, inf, nan, hexadecimal)
+    char buff[_NUM_MAX];
+    if (len >= sizeof(buff)) return false;
+    memcpy(buff, s, len);
+    buff[len] = '\0';
+    char *end;
+    *value = strtod(buff, &end);
+    return end == buff + len;
+}
+
+/**
+ * @brief Parse a decimal integer.
+ *
+ * @param s Field (not NUL terminated).
+ * @param len Length (bytes) of the field.
+ * @param value Set to the number.
+ * @return true if the whole field is an integer within the range of int64_t, false otherwise.
+ */
+static bool _parseInt(const char *s, size_t len, int64_t *value) {
+    if (len == 0) { *value = 0; return true; }
+
+    size_t i = 0;
+    bool neg = s[0] == '-';
+    if (s[0] == '-' || s[0] == '+') i++;
+    if (i == len) return false;
+
+    uint64_t limit = neg ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX, v = 0;
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        uint64_t digit = (uint64_t)(s[i] - '0');
+        if (v > (limit - digit) / 10) return false;
+        v = v * 10 + digit;
+    }
+
+    *value = neg ? (int64_t)(0 - v) : (int64_t)v;
+    return true;
+}
+
+/**
+ * @brief Copy a quoted field with its doubled quotes made single.
+ *
+ * @param dst Destination (at least `len` bytes).
+ * @param s Field (without its enclosing quotes).
+ * @param len Length (bytes) of the field.
+ * @return Length (bytes) copied.
+ */
+static size_t _unescape(char *dst, const char *s, size_t len) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        dst[n++] = s[i];
+        if (s[i] == '"') i++;
+    }
+    return n;
+}
+
+/**
+ * @brief Move a cursor over the marks of the buffered data to a position.
+ *
+ * @param c Parser (its marks are those of the data).
+ * @param cur Cursor.
+ * @param p Position (the next mark returned is at or after it).
+ * @param n Size (bytes) of the data.
+ */
+static inline void _seek(const Csv *c, MarkCursor *cur, size_t p, size_t n) {
+    cur->w = p / 64;
+    cur->words = (n + 63) / 64;
+    cur->m = cur->w < cur->words ? c->marks[cur->w] & (~(uint64_t)0 << (p % 64)) : 0;
+}
+
+/**
+ * @brief Position of the next delimiter, newline or quote, consuming it from a cursor.
+ *
+ * @param c Parser (its marks are those of the data).
+ * @param cur Cursor.
+ * @param n Size (bytes) of the data.
+ * @return Position, or `n` if none.
+ */
+static inline size_t _next(const Csv *c, MarkCursor *cur, size_t n) {
+    while (cur->m == 0) {
+        if (cur->w + 1 >= cur->words) return n;
+        cur->m = c->marks[++cur->w];
+    }
+    size_t p = cur->w * 64 + (size_t)math_ctz(cur->m);
+    cur->m &= cur->m - 1;
+    return p;
+}
+
+/**
+ * @brief Read more data, then mark its delimiters, newlines and quotes.
+ *
+ * @param c Parser.
+ * @param data Set to the buffered data.
+ * @param min Number of bytes wanted (see reader_peek).
+ * @return Size (bytes) of the buffered data (0 if failure).
+ */
+static size_t _peek(Csv *c, const char **data, size_t min) {
+    size_t n = reader_peek(c->reader, data, min), words = (n + 63) / 64;
+    if (words > c->marksCap) {
+        uint64_t *marks = (uint64_t*)realloc(c->marks, words * sizeof(uint64_t));
+        if (marks == NULL) { c->error = true; return 0; }
+        c->marks = marks;
+        c->marksCap = words;
+    }
+
+    const char set[3] = { c->delim, '\n', '"' };
+    scan_mask(*data, n, set, sizeof(set), c->marks);
+    return n;
+}
+
+/**
+ * @brief Find the fields of the record at a position of the buffered data, adding them to the
+ * parsed records.
+ *
+ * @param c Parser.
+ * @param s Data.
+ * @param pos Position of the record.
+ * @param n Size (bytes) of the data.
+ * @param eof true if no more data follows.
+ * @param used Set to the size (bytes) of the record, with its newline.
+ * @return Outcome of the scan.
+ */
+static RecordStatus _record(Csv *c, const char *s, size_t pos, size_t n, bool eof, size_t *used) {
+    if (s[pos] == '\n') { *used = 1; return RECORD_BLANK; }
+    if (pos + 1 < n && s[pos] == '\r' && s[pos + 1] == '\n') { *used = 2; return RECORD_BLANK; }
+
+    CsvField *fields = c->fields + c->batch * c->cols;
+    size_t p = pos, count = 0;
+    MarkCursor cur;
+    _seek(c, &cur, p, n);
+    while (true) {
+        CsvField f = { .start = p, .len = 0, .escaped = false };
+        size_t end; // Delimiter or newline ending the field (n at the end of the data)
+
+        if (p < n && s[p] == '"') {
+            // Quoted: up to the next quote that is not doubled
+            size_t q = p + 1;
+            while (true) {
+                const char *quote = scan_byte(s + q, n - q, '"');
+                if (quote == NULL) return eof ? RECORD_ERROR : RECORD_MORE;
+                q = (size_t)(quote - s) + 1;
+                if (q == n && !eof) return RECORD_MORE;
+                if (q == n || s[q] != '"') break;
+                f.escaped = true;
+                q++;
+            }
+            f.start = p + 1;
+            f.len = q - 1 - f.start;
+            end = q;
+            if (end < n && s[end] == '\r') {
+                if (end + 1 == n && !eof) return RECORD_MORE;
+                if (end + 1 < n && s[end + 1] == '\n') end++;
+            }
+            if (end < n && s[end] != c->delim && s[end] != '\n') return RECORD_ERROR;
+            _seek(c, &cur, end + 1, n);
+        } else {
+            // Unquoted: quotes inside are plain characters
+            end = _next(c, &cur, n);
+            while (end < n && s[end] == '"') end = _next(c, &cur, n);
+            if (end == n && !eof) return RECORD_MORE;
+            f.len = end - p;
+            bool last = end == n || s[end] == '\n';
+            if (last && f.len > 0 && s[end - 1] == '\r') f.len--;
+        }
+
+        if (count < c->cols) fields[count] = f;
+        count++;
+        if (end < n && s[end] == c->delim) { p = end + 1; continue; }
+
+        *used = (end < n ? end + 1 : n) - pos;
+        return count == c->cols ? RECORD_DONE : RECORD_ERROR;
+    }
+}
+
+/**
+ * @brief Store the fields of the first parsed record as the column names.
+ *
+ * @param c Parser.
+ * @param s Buffered data.
+ * @return true if stored, false otherwise.
+ */
+static bool _storeNames(Csv *c, const char *s) {
+    c->names = (char**)calloc(c->cols, sizeof(char*));
+    if (c->names == NULL) return false;
+
+    for (size_t i = 0; i < c->cols; i++) {
+        CsvField *f = &c->fields[i];
+        c->names[i] = (char*)malloc(f->len + 1);
+        if (c->names[i] == NULL) return false;
+        size_t len = f->escaped ? _unescape(c->names[i], s + f->start, f->len) : f->len;
+        if (!f->escaped) memcpy(c->names[i], s + f->start, f->len);
+        c->names[i][len] = '\0';
+    }
+
+    return true;
+}
+
+/**
+ * @brief Append the parsed records to the columns, one column at a time. Numbers are all parsed
+ * first, the records from the first invalid one are dropped.
+ *
+ * @param c Parser.
+ * @param s Buffered data.
+ * @param rows Incremented by the number of records appended.
+ * @return true if all the records were appended, false otherwise.
+ */
+static bool _flush(Csv *c, const char *s, size_t *rows) {
+    size_t count = c->batch, valid = count;
+    c->batch = 0;
+
+    for (size_t r = 0; r < valid; r++) {
+        CsvField *f = c->fields + r * c->cols;
+        for (size_t i = 0; i < c->cols; i++) {
+            bool ok = true;
+            if (c->types[i] == CSV_INT) ok = _parseInt(s + f[i].start, f[i].len, &f[i].value.i);
+            if (c->types[i] == CSV_DOUBLE)
+                ok = _parseDouble(s + f[i].start, f[i].len, &f[i].value.d);
+            if (!ok) { valid = r; break; }
+        }
+    }
+    if (valid == 0) return valid == count;
+
+    for (size_t i = 0; i < c->cols; i++) {
+        bool ok = true;
+        if (c->types[i] == CSV_INT || c->types[i] == CSV_DOUBLE) {
+            // Both are 8 bytes, copied through the union
+            uint64_t *values = (uint64_t*)c->values;
+            for (size_t r = 0; r < valid; r++)
+                memcpy(&values[r], &c->fields[r * c->cols + i].value, sizeof(uint64_t));
+            ok = darr_append(c->columns[i], values, valid);
+        } else if (c->types[i] == CSV_STR) {
+            size_t total = 0;
+            for (size_t r = 0; r < valid; r++) total += c->fields[r * c->cols + i].len;
+            if (total > c->scratchCap) {
+                char *scratch = (char*)realloc(c->scratch, total);
+                if (scratch == NULL) return false;
+                c->scratch = scratch;
+                c->scratchCap = total;
+            }
+
+            CsvStr *strs = (CsvStr*)c->values;
+            size_t base = darr_len(c->text), len = 0;
+            for (size_t r = 0; r < valid; r++) {
+                CsvField *f = &c->fields[r * c->cols + i];
+                strs[r].offset = base + len;
+                if (f->escaped) strs[r].len = _unescape(c->scratch + len, s + f->start, f->len);
+                else { memcpy(c->scratch + len, s + f->start, f->len); strs[r].len = f->len; }
+                len += strs[r].len;
+            }
+            ok = (len == 0 || darr_append(c->text, c->scratch, len))
+                && darr_append(c->columns[i], strs, valid);
+        }
+        if (!ok) return false;
+    }
+
+    *rows += valid;
+    c->rows += valid;
+    return valid == count;
+}
+
+void csv_clear(Csv *c) {
+    if (c == NULL) return;
+    for (size_t i = 0; i < c->cols; i++) darr_clear(c->columns[i]);
+    darr_clear(c->text);
+    c->rows = 0;
+}
+
+DArr *csv_column(Csv *c, size_t col) {
+    return c != NULL && col < c->cols ? c->columns[col] : NULL;
+}
+
+bool csv_error(const Csv *c) { return c ? c->error : true; }
+
+void csv_free(Csv *c) {
+    if (c == NULL) return;
+
+    for (size_t i = 0; c->columns != NULL && i < c->cols; i++) darr_free(c->columns[i]);
+    for (size_t i = 0; c->names != NULL && i < c->cols; i++) free(c->names[i]);
+    free(c->columns);
+    free(c->names);
+    free(c->types);
+    free(c->fields);
+    free(c->marks);
+    free(c->values);
+    free(c->scratch);
+    darr_free(c->text);
+    reader_free(c->reader);
+    free(c);
+}
+
+const char *csv_name(const Csv *c, size_t col) {
+    return c != NULL && c->names != NULL && col < c->cols ? c->names[col] : NULL;
+}
+
+Csv *csv_new(int fd, char delim, const CsvType *types, size_t cols, bool header) {
+    if (fd < 0 || types == NULL || cols == 0 || cols > SIZE_MAX / CSV_BATCH / sizeof(CsvField)
+        || delim == '"' || delim == '\n' || delim == '\r') return NULL;
+
+    Csv *c = (Csv*)calloc(1, sizeof(Csv));
+    if (c == NULL) return NULL;
+
+    c->delim = delim;
+    c->header = header;
+    c->cols = cols;
+    c->reader = reader_new(fd, 0, FILE_ACCESS_SEQUENTIAL);
+    c->types = (CsvType*)malloc(cols * sizeof(CsvType));
+    c->columns = (DArr**)calloc(cols, sizeof(DArr*));
+    c->fields = (CsvField*)malloc(CSV_BATCH * cols * sizeof(CsvField));
+    c->values = malloc(CSV_BATCH * sizeof(CsvStr));
+    c->text = darr_new(0, sizeof(char), ALLOC_STRAT_GEOMETRIC);
+    bool ok = c->reader && c->types && c->columns && c->fields && c->values && c->text;
+
+    for (size_t i = 0; ok && i < cols; i++) {
+        c->types[i] = types[i];
+        size_t itemSize;
+        switch (types[i]) {
+            case CSV_INT: itemSize = sizeof(int64_t); break;
+            case CSV_DOUBLE: itemSize = sizeof(double); break;
+            case CSV_STR: itemSize = sizeof(CsvStr); break;
+            default: continue;
+        }
+        c->columns[i] = darr_new(0, itemSize, ALLOC_STRAT_GEOMETRIC);
+        ok = c->columns[i] != NULL;
+    }
+
+    if (!ok) { csv_free(c); return NULL; }
+    return c;
+}
+
+Csv *csv_open(const char *path, char delim, const CsvType *types, size_t cols, bool header) {
+    if (path == NULL) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return NULL;
+
+    Csv *c = csv_new(fd, delim, types, cols, header);
+    if (c == NULL) { close(fd); return NULL; }
+    c->reader->owned = true;
+
+    return c;
+}
+
+size_t csv_read(Csv *c, size_t maxRows) {
+    if (c == NULL || c->error) return 0;
+
+    const char *data;
+    size_t rows = 0, pos = 0, n = _peek(c, &data, 1);
+    bool ok = true;
+    while (ok && pos < n && (maxRows == 0 || rows + c->batch < maxRows)) {
+        size_t used = 0;
+        RecordStatus status = _record(c, data, pos, n, c->reader->eof, &used);
+
+        if (status == RECORD_MORE) {
+            // Read on until the record is whole (the buffer grows for records larger than it)
+            ok = _flush(c, data, &rows);
+            reader_skip(c->reader, pos);
+            size_t left = n - pos;
+            pos = 0;
+            n = _peek(c, &data, left + 1);
+
+            // Nothing more could be read (the buffer could not grow, or a read failed)
+            if (reader_error(c->reader) || (n <= left && !c->reader->eof)) { ok = false; break; }
+            continue;
+        }
+
+        if (status == RECORD_ERROR) { ok = false; break; }
+        if (status == RECORD_DONE && c->header) {
+            ok = _storeNames(c, data);
+            c->header = false;
+        } else if (status == RECORD_DONE && ++c->batch == CSV_BATCH) {
+            ok = _flush(c, data, &rows);
+        }
+
+        pos += used;
+        if (ok && pos == n) {
+            ok = _flush(c, data, &rows);
+            reader_skip(c->reader, pos);
+            pos = 0;
+            n = _peek(c, &data, 1);
+        }
+    }
+
+    // Records before an error are kept
+    if (!_flush(c, data, &rows)) ok = false;
+    reader_skip(c->reader, pos);
+    if (!ok || reader_error(c->reader)) c->error = true;
+    return rows;
+}
+
+const char *csv_str(Csv *c, size_t col, size_t row, size_t *len) {
+    if (c == NULL || len == NULL || col >= c->cols || c->types[col] != CSV_STR
+        || row >= darr_len(c->columns[col])) return NULL;
+
+    CsvStr *str = (CsvStr*)darr_index(c->columns[col], row);
+    *len = str->len;
+    return str->len > 0 ? (const char*)darr_index(c->text, str->offset) : "";
+}
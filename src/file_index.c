@@ -0,0 +1,232 @@
+/*
+    File        : file_index.c
+    Description : Line offset index of large text files, built by scanning byte ranges in parallel,
+                  and persisted to a sidecar file for instant reopening.
+*/
+
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_index.h"
+#include "file_writer.h"
+#include "scan.h"
+#include "tpool.h"
+
+// Identifies index files (and their layout version)
+#define _MAGIC "CLIBIDX1"
+
+typedef struct {
+    char magic[8];
+    uint64_t sourceSize;
+    int64_t mtimeSec, mtimeNsec;
+    uint64_t count;
+} IndexHeader;
+
+typedef struct {
+    const char *data;
+    size_t start, end; // Byte range scanned
+    DArr *offsets; // Offsets of the lines starting in the range (after its first byte)
+} IndexRange;
+
+/**
+ * @brief Collect the starts of the lines following each newline of a range.
+ *
+ * @param arg IndexRange to scan (its offsets are NULL if failure).
+ */
+static void _scan(void *arg) {
+    IndexRange *r = (IndexRange*)arg;
+
+    // Lines of about 100 bytes are a reasonable first guess
+    r->offsets = darr_new((r->end - r->start) / 100 + 1, sizeof(size_t), ALLOC_STRAT_GEOMETRIC);
+    if (r->offsets == NULL) return;
+
+    const char *p = r->data + r->start, *end = r->data + r->end;
+    while ((p = scan_byte(p, (size_t)(end - p), '\n')) != NULL) {
+        size_t off = (size_t)(++p - r->data);
+        if (!darr_append(r->offsets, &off, 1)) {
+            darr_free(r->offsets);
+            r->offsets = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Fill the header of an index with the size and modification time of its source file.
+ *
+ * @param h Header.
+ * @param source Path to the source file.
+ * @return true if the source file could be stat'ed, false otherwise.
+ */
+static bool _header(IndexHeader *h, const char *source) {
+    struct stat st;
+    if (source == NULL || stat(source, &st) == -1) return false;
+
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, _MAGIC, sizeof(h->magic));
+    h->sourceSize = (uint64_t)st.st_size;
+    h->mtimeSec = (int64_t)st.st_mtim.tv_sec;
+    h->mtimeNsec = (int64_t)st.st_mtim.tv_nsec;
+    return true;
+}
+
+/**
+ * @brief Check if two headers describe the same version of a source file.
+ *
+ * @param a Header.
+ * @param b Header.
+ * @return true if the size and modification time match, false otherwise.
+ */
+static bool _sameSource(const IndexHeader *a, const IndexHeader *b) {
+    return a->sourceSize == b->sourceSize && a->mtimeSec == b->mtimeSec 
+        && a->mtimeNsec == b->mtimeNsec;
+}
+
+/**
+ * @brief Write a line index with the header of the version of its source file it was built over.
+ *
+ * @param idx Line index.
+ * @param path Path to the index file.
+ * @param h Header of the source file (its count is set).
+ * @return true if saved, false otherwise.
+ */
+static bool _save(DArr *idx, const char *path, IndexHeader *h) {
+    h->count = darr_len(idx);
+
+    Writer *w = writer_open(path, 0);
+    if (w == NULL) return false;
+
+    bool ok = writer_write(w, h, sizeof(*h)) && writer_darr(w, idx) && writer_flush(w);
+    writer_free(w);
+    if (!ok) unlink(path);
+    return ok;
+}
+
+DArr *index_build(const char *data, size_t size, unsigned threads) {
+    if (data == NULL && size > 0) return NULL;
+
+    if (threads == 0) threads = (unsigned)math_max(sysconf(_SC_NPROCESSORS_ONLN), 1L);
+    threads = (unsigned)math_max(math_min((size_t)threads, size / INDEX_MIN_RANGE), (size_t)1);
+
+    // On the heap, as `threads` comes from the caller
+    IndexRange *ranges = (IndexRange*)malloc(threads * sizeof(IndexRange));
+    if (ranges == NULL) return NULL;
+
+    size_t step = size / threads;
+    for (unsigned i = 0; i < threads; i++) {
+        ranges[i].data = data;
+        ranges[i].start = i * step;
+        ranges[i].end = i == threads - 1 ? size : (i + 1) * step;
+        ranges[i].offsets = NULL;
+    }
+
+    // The other ranges go to the shared pool, the calling thread scans the first one (and any
+    // range not submitted), then runs the tasks of the pool until all ranges are scanned
+    TPool *pool = tpool_default();
+    TPoolGroup group;
+    tpool_groupInit(&group);
+    for (unsigned i = 1; i < threads; i++)
+        if (!tpool_submit(pool, &group, _scan, &ranges[i])) _scan(&ranges[i]);
+    _scan(&ranges[0]);
+    tpool_wait(pool, &group);
+
+    bool ok = true;
+    size_t count = size > 0 ? 1 : 0;
+    for (unsigned i = 0; i < threads; i++) {
+        if (ranges[i].offsets == NULL) ok = false;
+        else count += darr_len(ranges[i].offsets);
+    }
+
+    DArr *idx = ok ? darr_new(count, sizeof(size_t), ALLOC_STRAT_GEOMETRIC) : NULL;
+    if (idx != NULL && size > 0) {
+        size_t first = 0;
+        ok = darr_append(idx, &first, 1);
+        for (unsigned i = 0; ok && i < threads; i++) {
+            size_t n = darr_len(ranges[i].offsets);
+            if (n > 0) ok = darr_append(idx, darr_first(ranges[i].offsets), n);
+        }
+
+        // A final newline does not start a line
+        if (ok && *(size_t*)darr_last(idx) == size) ok = darr_remove(idx, darr_len(idx) - 1, 1);
+        if (!ok) { darr_free(idx); idx = NULL; }
+    }
+
+    for (unsigned i = 0; i < threads; i++) darr_free(ranges[i].offsets);
+    free(ranges);
+    return idx;
+}
+
+bool index_line(DArr *idx, const char *data, size_t size, size_t n, const char **line, size_t *len) {
+    if (idx == NULL || data == NULL || line == NULL || len == NULL || n >= darr_len(idx))
+        return false;
+
+    size_t start = *(size_t*)darr_index(idx, n);
+    size_t end = n + 1 < darr_len(idx) ? *(size_t*)darr_index(idx, n + 1) : size;
+    if (start > end || end > size) return false; // Index of another buffer
+    if (end > start && data[end - 1] == '\n') end--;
+
+    *line = data + start;
+    *len = end - start;
+    return true;
+}
+
+DArr *index_load(const char *path, const char *source) {
+    FileView view;
+    if (!file_map(path, FILE_ACCESS_SEQUENTIAL, &view)) return NULL;
+
+    IndexHeader h, expected;
+    bool valid = view.size >= sizeof(h);
+    if (valid) {
+        memcpy(&h, view.data, sizeof(h));
+        valid = memcmp(h.magic, _MAGIC, sizeof(h.magic)) == 0
+            && h.count <= (view.size - sizeof(h)) / sizeof(size_t)
+            && view.size == sizeof(h) + h.count * sizeof(size_t);
+    }
+    if (valid && source != NULL) {
+        valid = _header(&expected, source) && _sameSource(&h, &expected);
+    }
+
+    DArr *idx = valid ? darr_new((size_t)h.count, sizeof(size_t), ALLOC_STRAT_GEOMETRIC) : NULL;
+    if (idx != NULL && h.count > 0 && !darr_append(idx, view.data + sizeof(h), (size_t)h.count)) {
+        darr_free(idx);
+        idx = NULL;
+    }
+
+    file_unmap(&view);
+    return idx;
+}
+
+DArr *index_open(const char *path, unsigned threads) {
+    if (path == NULL) return NULL;
+
+    size_t len = strlen(path);
+    char *sidecar = (char*)malloc(len + sizeof(INDEX_SUFFIX));
+    if (sidecar == NULL) return NULL;
+    memcpy(sidecar, path, len);
+    memcpy(sidecar + len, INDEX_SUFFIX, sizeof(INDEX_SUFFIX));
+
+    DArr *idx = index_load(sidecar, path);
+    if (idx == NULL) {
+        // Stamp the version mapped, and only save if it did not change while the index was built
+        IndexHeader before, after;
+        bool stamped = _header(&before, path);
+        FileView view;
+        if (file_map(path, FILE_ACCESS_SEQUENTIAL, &view)) {
+            idx = index_build(view.data, view.size, threads);
+            stamped = stamped && view.size == before.sourceSize;
+            file_unmap(&view);
+            if (idx != NULL && stamped && _header(&after, path) && _sameSource(&before, &after))
+                _save(idx, sidecar, &before);
+        }
+    }
+
+    free(sidecar);
+    return idx;
+}
+
+bool index_save(DArr *idx, const char *path, const char *source) {
+    IndexHeader h;
+    if (idx == NULL || path == NULL || !_header(&h, source)) return false;
+    return _save(idx, path, &h);
+}
@@ -0,0 +1,185 @@
+/*
+    File        : file_reader.c
+    Description : Streaming file reader yielding chunks or lines from a reusable buffer, for files 
+                  too large to be read whole.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_reader.h"
+#include "scan.h"
+
+/**
+ * @brief Convert an access pattern to its posix_fadvise hint.
+ * 
+ * @param access Access pattern.
+ * @return posix_fadvise advice.
+ */
+static int _fadvice(FileAccess access) {
+    switch (access) {
+        case FILE_ACCESS_SEQUENTIAL:
+            return POSIX_FADV_SEQUENTIAL;
+        case FILE_ACCESS_RANDOM:
+            return POSIX_FADV_RANDOM;
+        default:
+            return POSIX_FADV_NORMAL;
+    }
+}
+
+/**
+ * @brief Read more data after the buffered data, moving it to the front of the buffer first. 
+ * Files are read until the buffer is full or the end of the file, pipes and sockets only once.
+ * 
+ * @param r Reader object.
+ * @return Number of bytes added to the buffer (0 at the end of the file, if failure, or if the 
+ * buffer is full).
+ */
+static size_t _fill(Reader *r) {
+    if (r->start > 0) {
+        memmove(r->buff, r->buff + r->start, r->end - r->start);
+        r->end -= r->start;
+        r->start = 0;
+    }
+
+    // Prefetch the buffer after this one, so the disk works while the caller processes this one
+    if (r->access == FILE_ACCESS_SEQUENTIAL && !r->stream) {
+        off_t next = r->offset + (off_t)(r->cap - r->end);
+        posix_fadvise(r->fd, next, (off_t)r->cap, POSIX_FADV_WILLNEED);
+    }
+
+    size_t added = 0;
+    while (r->end < r->cap && !r->eof) {
+        ssize_t n = read(r->fd, r->buff + r->end, r->cap - r->end);
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1) { r->error = true; r->eof = true; break; }
+        if (n == 0) { r->eof = true; break; }
+
+        r->end += (size_t)n;
+        r->offset += n;
+        added += (size_t)n;
+        if (r->stream) break; // Hand out what a pipe has available rather than wait for more
+    }
+
+    return added;
+}
+
+bool reader_error(const Reader *r) { return r ? r->error : true; }
+
+void reader_free(Reader *r) {
+    if (r == NULL) return;
+    if (r->owned) close(r->fd);
+    free(r->buff);
+    free(r);
+}
+
+bool reader_line(Reader *r, const char **line, size_t *len) {
+    if (r == NULL || line == NULL || len == NULL) return false;
+
+    size_t searched = 0; // Bytes after `start` already known to hold no newline
+    while (true) {
+        char *s = r->buff + r->start;
+        char *nl = (char*)scan_byte(s + searched, r->end - r->start - searched, '\n');
+        if (nl != NULL) {
+            *line = s;
+            *len = (size_t)(nl - s);
+            r->start += *len + 1;
+            return true;
+        }
+        searched = r->end - r->start;
+
+        if (r->eof) {
+            // Last line without a newline
+            if (searched == 0) return false;
+            *line = s;
+            *len = searched;
+            r->start = r->end;
+            return true;
+        }
+
+        // The line fills the whole buffer, grow it
+        if (r->start == 0 && r->end == r->cap) {
+            char *grown = r->cap <= SIZE_MAX / 2 ? (char*)realloc(r->buff, r->cap * 2) : NULL;
+            if (grown == NULL) { r->error = true; return false; }
+            r->buff = grown;
+            r->cap *= 2;
+        }
+
+        _fill(r);
+    }
+}
+
+Reader *reader_new(int fd, size_t buffSize, FileAccess access) {
+    if (fd < 0) return NULL;
+
+    Reader *r = (Reader*)malloc(sizeof(Reader));
+    if (r == NULL) return NULL;
+
+    r->fd = fd;
+    r->owned = false;
+    r->eof = false;
+    r->error = false;
+    r->access = access;
+    r->cap = buffSize ? buffSize : READER_BUFF_SIZE;
+    r->start = 0;
+    r->end = 0;
+    r->buff = (char*)malloc(r->cap);
+    if (r->buff == NULL) { free(r); return NULL; }
+
+    // Pipes and sockets have no offset and ignore the hints
+    r->offset = lseek(fd, 0, SEEK_CUR);
+    r->stream = r->offset == -1;
+    if (r->stream) r->offset = 0;
+    else posix_fadvise(fd, 0, 0, _fadvice(access));
+
+    return r;
+}
+
+Reader *reader_open(const char *path, size_t buffSize, FileAccess access) {
+    if (path == NULL) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return NULL;
+
+    Reader *r = reader_new(fd, buffSize, access);
+    if (r == NULL) { close(fd); return NULL; }
+    r->owned = true;
+
+    return r;
+}
+
+size_t reader_peek(Reader *r, const char **data, size_t min) {
+    if (r == NULL || data == NULL) return 0;
+
+    while (r->end - r->start < min && !r->eof) {
+        // The data fills the whole buffer, grow it
+        if (r->start == 0 && r->end == r->cap) {
+            char *grown = r->cap <= SIZE_MAX / 2 ? (char*)realloc(r->buff, r->cap * 2) : NULL;
+            if (grown == NULL) { r->error = true; break; }
+            r->buff = grown;
+            r->cap *= 2;
+        }
+
+        _fill(r);
+    }
+
+    *data = r->buff + r->start;
+    return r->end - r->start;
+}
+
+size_t reader_read(Reader *r, const char **chunk) {
+    if (r == NULL || chunk == NULL) return 0;
+
+    if (r->start == r->end) _fill(r);
+
+    size_t n = r->end - r->start;
+    *chunk = r->buff + r->start;
+    r->start = r->end;
+    return n;
+}
+
+void reader_skip(Reader *r, size_t n) {
+    if (r != NULL) r->start += math_min(n, r->end - r->start);
+}
@@ -0,0 +1,289 @@
+/*
+    File        : file_writer.c
+    Description : Buffered file writer over direct write calls, coalescing small records into large 
+                  writes, with number formatting that bypasses stdio.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_writer.h"
+
+// Maximum number of segments handed to a single writev call
+#define _IOV_BATCH 64
+
+// Pairs of decimal digits of 0 to 99
+static const char _digits[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint64_t _pow10[WRITER_MAX_DECIMALS + 1] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL
+};
+
+/**
+ * @brief Mark a writer as failed.
+ * 
+ * @param w Writer object.
+ * @return false.
+ */
+static bool _fail(Writer *w) {
+    w->error = true;
+    return false;
+}
+
+/**
+ * @brief Format an unsigned integer in decimal, backwards from the end of a buffer.
+ * 
+ * @param end End of the buffer (needs room for 20 digits before it).
+ * @param v Value.
+ * @return Start of the digits.
+ */
+static char *_formatUint(char *end, uint64_t v) {
+    while (v >= 100) {
+        size_t i = (size_t)(v % 100) * 2;
+        v /= 100;
+        *--end = _digits[i + 1];
+        *--end = _digits[i];
+    }
+    if (v >= 10) {
+        size_t i = (size_t)v * 2;
+        *--end = _digits[i + 1];
+        *--end = _digits[i];
+    } else {
+        *--end = (char)('0' + v);
+    }
+    return end;
+}
+
+/**
+ * @brief Write segments completely, retrying partial writes and interrupted calls.
+ * 
+ * @param fd File descriptor.
+ * @param iov Segments (modified to track the progress).
+ * @param count Number of segments.
+ * @return true if all data was written, false otherwise.
+ */
+static bool _writeAll(int fd, struct iovec *iov, int count) {
+    while (true) {
+        while (count > 0 && iov->iov_len == 0) { iov++; count--; }
+        if (count == 0) return true;
+
+        ssize_t n = writev(fd, iov, count);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return false;
+
+        // Skip the segments written, and the written part of the first remaining one
+        size_t done = (size_t)n;
+        while (count > 0 && done >= iov->iov_len) { done -= iov->iov_len; iov++; count--; }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+}
+
+/**
+ * @brief Write a byte range of an AllocBlock, one contiguous span (chunk) at a time.
+ * 
+ * @param w Writer object.
+ * @param b AllocBlock object.
+ * @param from Start (bytes) of the range.
+ * @param to End (bytes) of the range.
+ * @return true if written or buffered, false if failure.
+ */
+static bool _writeSpans(Writer *w, AllocBlock *b, size_t from, size_t to) {
+    for (size_t i = from, n = 0; i < to; i += n) {
+        const void *span = alloc_span(b, i, &n);
+        n = math_min(n, to - i);
+        if (!writer_write(w, span, n)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write the buffered data followed by segments, in as few writev calls as possible.
+ * 
+ * @param w Writer object.
+ * @param iov Segments.
+ * @param count Number of segments.
+ * @return true if all data was written, false otherwise.
+ */
+static bool _writeSegments(Writer *w, const struct iovec *iov, int count) {
+    struct iovec batch[_IOV_BATCH];
+    int n = 0;
+    if (w->len > 0) batch[n++] = (struct iovec){ w->buff, w->len };
+
+    for (int i = 0; i < count; i++) {
+        batch[n++] = iov[i];
+        if (n == _IOV_BATCH && !_writeAll(w->fd, batch, n)) return _fail(w);
+        if (n == _IOV_BATCH) n = 0;
+    }
+    if (n > 0 && !_writeAll(w->fd, batch, n)) return _fail(w);
+
+    w->len = 0;
+    return true;
+}
+
+bool writer_darr(Writer *w, DArr *d) {
+    if (w == NULL || d == NULL) return false;
+
+    // The items before and after the gap of a gap buffer DArr, without the gap slots
+    size_t gap = d->gap * d->itemSize, gapEnd = (d->gap + d->gapLen) * d->itemSize;
+    return _writeSpans(w, d->block, 0, gap) 
+        && _writeSpans(w, d->block, gapEnd, alloc_getUsed(d->block));
+}
+
+bool writer_double(Writer *w, double v, int decimals) {
+    decimals = decimals < 0 ? 0 : math_min(decimals, WRITER_MAX_DECIMALS);
+
+    double scaled = (v < 0 ? -v : v) * (double)_pow10[decimals];
+    if (!(scaled < 9007199254740992.0)) {
+        // Digits beyond the precision of the scaled value (or NaN, infinity)
+        char buff[512];
+        int n = snprintf(buff, sizeof(buff), "%.*f", decimals, v);
+        if (n < 0) return w ? _fail(w) : false;
+        return writer_write(w, buff, math_min((size_t)n, sizeof(buff) - 1));
+    }
+
+    // Round half to even, as printf
+    uint64_t s = (uint64_t)scaled;
+    double frac = scaled - (double)s;
+    if (frac > 0.5 || (frac == 0.5 && (s & 1))) s++;
+
+    uint64_t ip = s / _pow10[decimals], fp = s % _pow10[decimals];
+
+    char buff[48];
+    char *end = buff + sizeof(buff), *p = end;
+    for (int i = 0; i < decimals; i++) {
+        *--p = (char)('0' + fp % 10);
+        fp /= 10;
+    }
+    if (decimals > 0) *--p = '.';
+    p = _formatUint(p, ip);
+    if (v < 0 || (v == 0 && 1 / v < 0)) *--p = '-';
+
+    return writer_write(w, p, (size_t)(end - p));
+}
+
+bool writer_error(const Writer *w) { return w ? w->error : true; }
+
+bool writer_flush(Writer *w) {
+    if (w == NULL || w->error) return false;
+    if (w->len == 0) return true;
+
+    struct iovec v = { w->buff, w->len };
+    if (!_writeAll(w->fd, &v, 1)) return _fail(w);
+    w->len = 0;
+    return true;
+}
+
+void writer_free(Writer *w) {
+    if (w == NULL) return;
+    writer_flush(w);
+    if (w->owned) close(w->fd);
+    free(w->buff);
+    free(w);
+}
+
+bool writer_int(Writer *w, int64_t v) {
+    char buff[24];
+    char *end = buff + sizeof(buff);
+    char *p = _formatUint(end, v < 0 ? 0 - (uint64_t)v : (uint64_t)v);
+    if (v < 0) *--p = '-';
+    return writer_write(w, p, (size_t)(end - p));
+}
+
+Writer *writer_new(int fd, size_t buffSize) {
+    if (fd < 0) return NULL;
+
+    Writer *w = (Writer*)malloc(sizeof(Writer));
+    if (w == NULL) return NULL;
+
+    w->fd = fd;
+    w->owned = false;
+    w->error = false;
+    w->cap = buffSize ? buffSize : WRITER_BUFF_SIZE;
+    w->len = 0;
+    w->buff = (char*)malloc(w->cap);
+    if (w->buff == NULL) { free(w); return NULL; }
+
+    return w;
+}
+
+Writer *writer_open(const char *path, size_t buffSize) {
+    if (path == NULL) return NULL;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) return NULL;
+
+    Writer *w = writer_new(fd, buffSize);
+    if (w == NULL) { close(fd); return NULL; }
+    w->owned = true;
+
+    return w;
+}
+
+bool writer_str(Writer *w, const char *s) { return s ? writer_write(w, s, strlen(s)) : false; }
+
+bool writer_sync(Writer *w) {
+    if (!writer_flush(w)) return false;
+    if (fdatasync(w->fd) == -1) return _fail(w);
+    return true;
+}
+
+bool writer_uint(Writer *w, uint64_t v) {
+    char buff[24];
+    char *end = buff + sizeof(buff);
+    char *p = _formatUint(end, v);
+    return writer_write(w, p, (size_t)(end - p));
+}
+
+bool writer_write(Writer *w, const void *data, size_t size) {
+    if (w == NULL || w->error || (data == NULL && size > 0)) return false;
+
+    size_t avail = w->cap - w->len;
+    if (size <= avail) {
+        memcpy(w->buff + w->len, data, size);
+        w->len += size;
+        return true;
+    }
+
+    // Smaller than the buffer: top it up so the file is always written in whole buffers
+    if (size < w->cap) {
+        memcpy(w->buff + w->len, data, avail);
+        w->len = w->cap;
+        if (!writer_flush(w)) return false;
+        memcpy(w->buff, (const char*)data + avail, size - avail);
+        w->len = size - avail;
+        return true;
+    }
+
+    struct iovec v = { (void*)data, size };
+    return _writeSegments(w, &v, 1);
+}
+
+bool writer_writev(Writer *w, const struct iovec *iov, int count) {
+    if (w == NULL || w->error || (iov == NULL && count > 0) || count < 0) return false;
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        if (iov[i].iov_len > SIZE_MAX - total) return false;
+        total += iov[i].iov_len;
+    }
+
+    if (total > w->cap - w->len) return _writeSegments(w, iov, count);
+
+    for (int i = 0; i < count; i++) {
+        if (iov[i].iov_len == 0) continue;
+        memcpy(w->buff + w->len, iov[i].iov_base, iov[i].iov_len);
+        w->len += iov[i].iov_len;
+    }
+    return true;
+}
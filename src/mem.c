@@ -1,14 +1,257 @@
-
 /*
     File        : mem.c
     Description : Dynamic memory management operations.
 */
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "alloc_pool.h"
+#include "math.h"
 #include "mem.h"
 
+// Statistics counters of one thread. Only the owner thread writes them (relaxed atomics, so a
+// plain load/store), readers merge all threads.
+typedef struct MemThreadStats {
+    struct MemThreadStats *prev, *next;
+    _Atomic size_t allocs, frees, reallocs, reallocBytesCopied;
+    _Atomic size_t sizeClasses[MEM_STATS_CLASSES];
+    // Bytes allocated minus bytes freed by the thread (negative when it frees memory of others)
+    _Atomic int64_t live;
+    int64_t sampled; // Lowest `live` since the last peak sample of the thread
+} MemThreadStats;
+
+static void *_sysAlloc(void *ctx, size_t size) { (void)ctx; return malloc(size); }
+
+static void *_sysRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    (void)ctx;
+    (void)oldSize;
+    return realloc(p, newSize);
+}
+
+static void _sysFree(void *ctx, void *p, size_t size) { (void)ctx; (void)size; free(p); }
+
+static const Allocator _system = { _sysAlloc, _sysRealloc, _sysFree, NULL };
+
+static _Atomic(const Allocator*) _default = &_system;
+
+static atomic_bool _statsEnabled = false;
+
+// Largest sum of the live bytes of all threads seen by a sample (see _samplePeak), under _statsLock
+static size_t _peakBytes = 0;
+
+// Counters of the calling thread (NULL until its first recorded allocation)
+#if defined(__GNUC__)
+static _Thread_local MemThreadStats *_local __attribute__((tls_model("initial-exec")));
+#else
+static _Thread_local MemThreadStats *_local;
+#endif
+
+// Counters of all running threads, and the merged counters of exited threads
+static MemThreadStats *_threads = NULL;
+static MemThreadStats _retired;
+static pthread_mutex_t _statsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t _statsKey;
+static pthread_once_t _statsKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Resolve an allocator argument.
+ *
+ * @param a Allocator, or NULL.
+ * @return `a`, or the default allocator if NULL.
+ */
+static inline const Allocator *_resolve(const Allocator *a) {
+    return a ? a : atomic_load_explicit(&_default, memory_order_acquire);
+}
+
+/**
+ * @brief Read a counter.
+ *
+ * @param c Counter.
+ * @return Value.
+ */
+static inline size_t _load(_Atomic size_t *c) { return atomic_load_explicit(c, memory_order_relaxed); }
+
+/**
+ * @brief Add to a counter owned by the calling thread.
+ *
+ * @param c Counter.
+ * @param n Value to add.
+ */
+static inline void _bump(_Atomic size_t *c, size_t n) {
+    atomic_store_explicit(c, _load(c) + n, memory_order_relaxed);
+}
+
+/**
+ * @brief Add the counters of one thread to another set of counters.
+ *
+ * @param dst Counters to add to.
+ * @param src Counters to add.
+ */
+static void _merge(MemThreadStats *dst, MemThreadStats *src) {
+    _bump(&dst->allocs, _load(&src->allocs));
+    _bump(&dst->frees, _load(&src->frees));
+    _bump(&dst->reallocs, _load(&src->reallocs));
+    _bump(&dst->reallocBytesCopied, _load(&src->reallocBytesCopied));
+    for (int i = 0; i < MEM_STATS_CLASSES; i++) _bump(&dst->sizeClasses[i], _load(&src->sizeClasses[i]));
+    atomic_store_explicit(&dst->live, atomic_load_explicit(&dst->live, memory_order_relaxed) + 
+        atomic_load_explicit(&src->live, memory_order_relaxed), memory_order_relaxed);
+}
+
+/**
+ * @brief Reset a set of counters.
+ *
+ * @param s Counters.
+ */
+static void _zero(MemThreadStats *s) {
+    atomic_store_explicit(&s->allocs, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->frees, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->reallocs, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->reallocBytesCopied, 0, memory_order_relaxed);
+    for (int i = 0; i < MEM_STATS_CLASSES; i++)
+        atomic_store_explicit(&s->sizeClasses[i], 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Merge the counters of an exiting thread into the retired counters.
+ *
+ * @param arg MemThreadStats of the exiting thread.
+ */
+static void _retireStats(void *arg) {
+    MemThreadStats *s = (MemThreadStats*)arg;
+    pthread_mutex_lock(&_statsLock);
+    _merge(&_retired, s);
+    if (s->prev != NULL) s->prev->next = s->next;
+    else _threads = s->next;
+    if (s->next != NULL) s->next->prev = s->prev;
+    pthread_mutex_unlock(&_statsLock);
+    free(s);
+    // Later TLS destructors of the thread (e.g. releasing small objects) register new counters
+    _local = NULL;
+}
+
+static void _createStatsKey(void) { pthread_key_create(&_statsKey, _retireStats); }
+
+/**
+ * @brief Counters of the calling thread, registering them on first use.
+ *
+ * @return MemThreadStats of the calling thread, or NULL if they could not be allocated.
+ */
+static MemThreadStats *_threadStats(void) {
+    if (_local != NULL) return _local;
+
+    MemThreadStats *s = (MemThreadStats*)calloc(1, sizeof(MemThreadStats));
+    if (s == NULL) return NULL;
+
+    pthread_once(&_statsKeyOnce, _createStatsKey);
+    pthread_mutex_lock(&_statsLock);
+    s->next = _threads;
+    if (_threads != NULL) _threads->prev = s;
+    _threads = s;
+    pthread_mutex_unlock(&_statsLock);
+    pthread_setspecific(_statsKey, s);
+
+    return _local = s;
+}
+
+/**
+ * @brief Size class of an allocation.
+ *
+ * @param size Size (bytes).
+ * @return Index in the size class histogram.
+ */
+static inline int _sizeClass(size_t size) {
+    if (size <= 16) return 0;
+    return math_min(math_ilog2(size - 1) - 3, MEM_STATS_CLASSES - 1);
+}
+
+/**
+ * @brief Sum the live bytes of all threads, running and exited. Called with _statsLock held.
+ *
+ * @return Live bytes.
+ */
+static size_t _liveBytes(void) {
+    int64_t live = atomic_load_explicit(&_retired.live, memory_order_relaxed);
+    for (MemThreadStats *s = _threads; s != NULL; s = s->next) 
+        live += atomic_load_explicit(&s->live, memory_order_relaxed);
+    return live > 0 ? (size_t)live : 0;
+}
+
+/**
+ * @brief Update the peak with the current live bytes.
+ *
+ * @return Live bytes.
+ */
+static size_t _samplePeak(void) {
+    pthread_mutex_lock(&_statsLock);
+    size_t live = _liveBytes();
+    _peakBytes = math_max(_peakBytes, live);
+    pthread_mutex_unlock(&_statsLock);
+    return live;
+}
+
+/**
+ * @brief Record a change of the live bytes of the calling thread. The peak is sampled when the 
+ * live bytes of the thread grew by MEM_STATS_PEAK_STEP since its lowest point after the last 
+ * sample, so the shared peak is only touched once per step of growth.
+ *
+ * @param s Counters of the calling thread.
+ * @param added Bytes allocated.
+ * @param removed Bytes released.
+ */
+static void _recordLive(MemThreadStats *s, size_t added, size_t removed) {
+    int64_t live = atomic_load_explicit(&s->live, memory_order_relaxed) + (int64_t)added - 
+        (int64_t)removed;
+    atomic_store_explicit(&s->live, live, memory_order_relaxed);
+
+    if (live < s->sampled) {
+        s->sampled = live;
+    } else if (live - s->sampled >= MEM_STATS_PEAK_STEP) {
+        s->sampled = live;
+        _samplePeak();
+    }
+}
+
+/**
+ * @brief Record an allocation, reallocation (`p` non-NULL) or free (`newSize` 0).
+ *
+ * @param p Memory before the operation (NULL for an allocation).
+ * @param np Memory after the operation (NULL for a free).
+ * @param oldSize Size (bytes) before the operation.
+ * @param newSize Size (bytes) after the operation.
+ */
+static void _record(const void *p, const void *np, size_t oldSize, size_t newSize) {
+    MemThreadStats *s = _threadStats();
+    if (s == NULL) return;
+
+    if (newSize == 0) {
+        _bump(&s->frees, 1);
+    } else if (p == NULL) {
+        _bump(&s->allocs, 1);
+        _bump(&s->sizeClasses[_sizeClass(newSize)], 1);
+    } else {
+        _bump(&s->reallocs, 1);
+        _bump(&s->sizeClasses[_sizeClass(newSize)], 1);
+        if (np != p) _bump(&s->reallocBytesCopied, math_min(oldSize, newSize));
+    }
+
+    _recordLive(s, newSize, oldSize);
+}
+
+/**
+ * @brief Check if statistics are recorded.
+ *
+ * @return true if enabled, false otherwise.
+ */
+static inline bool _recording(void) { 
+    return atomic_load_explicit(&_statsEnabled, memory_order_relaxed); 
+}
+
 void *mem_alloc(size_t size) {
     if (size == 0) return NULL;
-    void *p = malloc(size);
+    void *p = mem_allocWith(NULL, size);
     if (p == NULL) {
         fprintf(stderr, "Error: Memory allocation of %zu bytes failed.\n", size);
         exit(EXIT_FAILURE);
@@ -16,22 +259,132 @@ void *mem_alloc(size_t size) {
     return p;
 }
 
+void *mem_allocObject(const Allocator *a, size_t size) {
+    if (a == mem_systemAllocator()) return pool_allocSmall(size);
+    return mem_allocWith(a, size);
+}
+
+void *mem_allocWith(const Allocator *a, size_t size) {
+    if (size == 0) return NULL;
+    a = _resolve(a);
+    void *p = a->alloc(a->ctx, size);
+    if (p != NULL && _recording()) _record(NULL, p, 0, size);
+    return p;
+}
+
 void *mem_calloc(size_t num, size_t size) {
     if (num == 0 || size == 0) return NULL;
-    void *p = calloc(num, size);
+    void *p = num <= SIZE_MAX / size ? mem_allocWith(NULL, num * size) : NULL;
     if (p == NULL) {
         fprintf(stderr, "Error: Memory allocation for %zu elements of %zu bytes each failed.\n", num, size);
         exit(EXIT_FAILURE);
     }
-    return p;
+    return memset(p, 0, num * size);
+}
+
+bool mem_dumpStats(FILE *f, MemStatsFormat format) {
+    if (f == NULL) return false;
+    MemStats s = mem_getStats();
+    int ok = 0;
+
+    if (format == MEM_STATS_JSON) {
+        ok |= fprintf(f, "{\"liveBytes\":%zu,\"peakBytes\":%zu,\"allocs\":%zu,\"frees\":%zu,"
+            "\"reallocs\":%zu,\"reallocBytesCopied\":%zu,\"sizeClasses\":[", s.liveBytes,
+            s.peakBytes, s.allocs, s.frees, s.reallocs, s.reallocBytesCopied) < 0;
+        for (int i = 0; i < MEM_STATS_CLASSES; i++) {
+            size_t n = s.sizeClasses[i];
+            if (i < MEM_STATS_CLASSES - 1)
+                ok |= fprintf(f, "{\"maxBytes\":%zu,\"count\":%zu},", (size_t)16 << i, n) < 0;
+            else
+                ok |= fprintf(f, "{\"maxBytes\":null,\"count\":%zu}", n) < 0;
+        }
+        ok |= fprintf(f, "]}\n") < 0;
+    } else {
+        ok |= fprintf(f, "live bytes: %zu\npeak bytes: %zu\nallocs: %zu\nfrees: %zu\nreallocs: %zu\n"
+            "realloc bytes copied: %zu\nsize classes:\n", s.liveBytes, s.peakBytes, s.allocs,
+            s.frees, s.reallocs, s.reallocBytesCopied) < 0;
+        for (int i = 0; i < MEM_STATS_CLASSES; i++) {
+            if (i < MEM_STATS_CLASSES - 1)
+                ok |= fprintf(f, "  <= %zu: %zu\n", (size_t)16 << i, s.sizeClasses[i]) < 0;
+            else
+                ok |= fprintf(f, "  > %zu: %zu\n", (size_t)8 << i, s.sizeClasses[i]) < 0;
+        }
+    }
+
+    return ok == 0;
+}
+
+void mem_enableStats(bool enable) { 
+    atomic_store_explicit(&_statsEnabled, enable, memory_order_relaxed); 
+}
+
+void mem_free(void *p, size_t size) { mem_freeWith(NULL, p, size); }
+
+void mem_freeObject(const Allocator *a, void *p, size_t size) {
+    if (a == mem_systemAllocator()) pool_releaseSmall(p, size);
+    else mem_freeWith(a, p, size);
+}
+
+void mem_freeWith(const Allocator *a, void *p, size_t size) {
+    if (p == NULL) return;
+    a = _resolve(a);
+    a->free(a->ctx, p, size);
+    if (_recording()) _record(p, NULL, size, 0);
+}
+
+const Allocator *mem_getAllocator(void) { return _resolve(NULL); }
+
+MemStats mem_getStats(void) {
+    MemThreadStats sum;
+    memset(&sum, 0, sizeof(sum));
+
+    MemStats stats;
+    pthread_mutex_lock(&_statsLock);
+    _merge(&sum, &_retired);
+    for (MemThreadStats *s = _threads; s != NULL; s = s->next) _merge(&sum, s);
+    stats.liveBytes = _liveBytes();
+    _peakBytes = math_max(_peakBytes, stats.liveBytes);
+    stats.peakBytes = _peakBytes;
+    pthread_mutex_unlock(&_statsLock);
+
+    stats.allocs = sum.allocs;
+    stats.frees = sum.frees;
+    stats.reallocs = sum.reallocs;
+    stats.reallocBytesCopied = sum.reallocBytesCopied;
+    for (int i = 0; i < MEM_STATS_CLASSES; i++) stats.sizeClasses[i] = sum.sizeClasses[i];
+    return stats;
 }
 
-void *mem_realloc(void *p, size_t size) {
-    if (size == 0) { if (p != NULL) free(p); return NULL; }
-    void *np = realloc(p, size);
+void *mem_realloc(void *p, size_t oldSize, size_t size) {
+    if (size == 0) { mem_free(p, oldSize); return NULL; }
+    void *np = mem_reallocWith(NULL, p, oldSize, size);
     if (np == NULL) {
         fprintf(stderr, "Error: Memory reallocation of %zu bytes failed.\n", size);
         exit(EXIT_FAILURE);
     }
     return np;
 }
+
+void *mem_reallocWith(const Allocator *a, void *p, size_t oldSize, size_t newSize) {
+    if (newSize == 0) return NULL;
+    a = _resolve(a);
+    void *np = a->realloc(a->ctx, p, oldSize, newSize);
+    if (np != NULL && _recording()) _record(p, np, p ? oldSize : 0, newSize);
+    return np;
+}
+
+void mem_resetStats(void) {
+    pthread_mutex_lock(&_statsLock);
+    _zero(&_retired);
+    for (MemThreadStats *s = _threads; s != NULL; s = s->next) _zero(s);
+    _peakBytes = _liveBytes();
+    pthread_mutex_unlock(&_statsLock);
+}
+
+void mem_setAllocator(const Allocator *a) {
+    atomic_store_explicit(&_default, a ? a : &_system, memory_order_release);
+}
+
+bool mem_statsEnabled(void) { return _recording(); }
+
+const Allocator *mem_systemAllocator(void) { return &_system; }
@@ -0,0 +1,246 @@
+/*
+    File        : mpmc.c
+    Description : Bounded lock-free queue of items of any single type shared by any number of
+                  producer and consumer threads, with blocking variants waiting on futexes.
+*/
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mpmc.h"
+
+/**
+ * @brief Sleep until a futex word is woken, unless it no longer holds a value.
+ *
+ * @param word Futex word.
+ * @param value Value read before deciding to sleep.
+ */
+static inline void _futexWait(_Atomic uint32_t *word, uint32_t value) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/**
+ * @brief Wake threads sleeping on a futex word.
+ *
+ * @param word Futex word.
+ * @param count Maximum number of threads to wake (INT32_MAX for all).
+ */
+static inline void _futexWake(_Atomic uint32_t *word, int count) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/**
+ * @brief Wake one of the threads blocked on a futex word, if any. Called after a push or pop made
+ * the queue not empty or not full.
+ *
+ * @param word Futex word: bit 0 is set by threads about to block, the rest counts the wakes.
+ */
+static inline void _signal(_Atomic uint32_t *word) {
+    // Orders the push or pop before the read of the word (see mpmc_pop)
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((atomic_load_explicit(word, memory_order_relaxed) & 1) == 0) return;
+
+    // Clears bit 0 and counts a wake, so that the next signals are free until a thread blocks again
+    // (or the woken thread sets it again for the others, see _rearm)
+    atomic_fetch_add_explicit(word, 1, memory_order_release);
+    _futexWake(word, 1);
+}
+
+/**
+ * @brief Set bit 0 of a futex word again after a blocked thread was woken, if other threads are
+ * still blocked on it. The signals made until the woken thread ran found bit 0 clear and woke no
+ * one, so the caller then wakes the next thread if they left it work.
+ *
+ * @param word Futex word.
+ * @param waiters Number of threads about to block or blocked on the word.
+ * @return true if other threads are blocked, false otherwise.
+ */
+static inline bool _rearm(_Atomic uint32_t *word, _Atomic uint32_t *waiters) {
+    if (atomic_load_explicit(waiters, memory_order_seq_cst) == 0) return false;
+    atomic_fetch_or_explicit(word, 1, memory_order_seq_cst);
+    return true;
+}
+
+/**
+ * @brief Sequence number of a slot.
+ *
+ * @param q Mpmc object.
+ * @param pos Position of the slot.
+ * @return Sequence number.
+ */
+static inline _Atomic size_t *_seq(const Mpmc *q, size_t pos) {
+    return (_Atomic size_t*)(q->slots + (pos & q->mask) * q->stride);
+}
+
+void mpmc_close(Mpmc *q) {
+    if (q == NULL) return;
+    atomic_store_explicit(&q->closed, true, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&q->pushed, 2, memory_order_release);
+    atomic_fetch_add_explicit(&q->popped, 2, memory_order_release);
+    _futexWake(&q->pushed, INT32_MAX);
+    _futexWake(&q->popped, INT32_MAX);
+}
+
+void mpmc_free(Mpmc *q) {
+    if (q != NULL) {
+        const Allocator *a = alloc_getAllocator(q->block);
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Mpmc));
+    }
+}
+
+size_t mpmc_len(Mpmc *q) {
+    if (q == NULL) return 0;
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return tail > head ? math_min(tail - head, q->mask + 1) : 0;
+}
+
+Mpmc *mpmc_new(size_t size, size_t itemSize) { return mpmc_newWith(NULL, size, itemSize); }
+
+Mpmc *mpmc_newWith(const Allocator *a, size_t size, size_t itemSize) {
+    if (itemSize == 0 || itemSize > SIZE_MAX / 2) return NULL;
+    if (a == NULL) a = mem_getAllocator();
+
+    // Items follow the sequence number, slots keep it aligned
+    size_t align = sizeof(size_t), stride = (sizeof(size_t) + itemSize + align - 1) / align * align;
+    size = math_nextPow2(math_max(size, MPMC_MIN_SIZE));
+    if (size == 0 || size > SIZE_MAX / stride) return NULL;
+
+    Mpmc *q = (Mpmc*)mem_allocObject(a, sizeof(Mpmc));
+    if (q == NULL) return NULL;
+
+    q->block = alloc_newWith(a, 0, ALLOC_STRAT_DYNAMIC);
+    if (q->block == NULL || !alloc_insertSpace(q->block, 0, size * stride)) {
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Mpmc));
+        return NULL;
+    }
+
+    q->slots = (char*)alloc_getBlock(q->block);
+    q->itemSize = itemSize;
+    q->stride = stride;
+    q->mask = size - 1;
+    for (size_t i = 0; i < size; i++) atomic_init(_seq(q, i), i);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->pushed, 0);
+    atomic_init(&q->popped, 0);
+    atomic_init(&q->popWaiters, 0);
+    atomic_init(&q->pushWaiters, 0);
+    atomic_init(&q->closed, false);
+
+    return q;
+}
+
+bool mpmc_pop(Mpmc *q, void *item) {
+    if (q == NULL || item == NULL) return false;
+    bool popped = false, waited = false;
+    while (!popped && !(popped = mpmc_tryPop(q, item))) {
+        // Announce the wait, then check again: a producer either sees the announce and changes
+        // the word (so the wait returns at once) or pushed before the check
+        atomic_fetch_add_explicit(&q->popWaiters, 1, memory_order_seq_cst);
+        uint32_t value = atomic_fetch_or_explicit(&q->pushed, 1, memory_order_seq_cst) | 1;
+        popped = mpmc_tryPop(q, item);
+        bool closed = !popped && atomic_load_explicit(&q->closed, memory_order_acquire);
+        if (!popped && !closed) {
+            _futexWait(&q->pushed, value);
+            waited = true;
+        }
+        atomic_fetch_sub_explicit(&q->popWaiters, 1, memory_order_seq_cst);
+        if (closed) break;
+    }
+
+    if (popped) {
+        // Wake the next consumer for the items pushed while this one was being woken
+        if (waited && _rearm(&q->pushed, &q->popWaiters) && mpmc_len(q) > 0) _signal(&q->pushed);
+        return true;
+    }
+
+    // Closed: drain the pushes that claimed a slot before the close but are still writing it
+    while (!mpmc_tryPop(q, item)) {
+        size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (head >= atomic_load_explicit(&q->tail, memory_order_acquire)) return false;
+        sched_yield();
+    }
+    return true;
+}
+
+bool mpmc_push(Mpmc *q, const void *item) {
+    if (q == NULL || item == NULL) return false;
+    bool pushed = false, waited = false;
+    while (!pushed && !(pushed = mpmc_tryPush(q, item))) {
+        if (atomic_load_explicit(&q->closed, memory_order_acquire)) return false;
+
+        atomic_fetch_add_explicit(&q->pushWaiters, 1, memory_order_seq_cst);
+        uint32_t value = atomic_fetch_or_explicit(&q->popped, 1, memory_order_seq_cst) | 1;
+        pushed = mpmc_tryPush(q, item);
+        bool closed = !pushed && atomic_load_explicit(&q->closed, memory_order_acquire);
+        if (!pushed && !closed) {
+            _futexWait(&q->popped, value);
+            waited = true;
+        }
+        atomic_fetch_sub_explicit(&q->pushWaiters, 1, memory_order_seq_cst);
+        if (closed) return false;
+    }
+
+    // Wake the next producer for the room made while this one was being woken
+    if (waited && _rearm(&q->popped, &q->pushWaiters) && mpmc_len(q) <= q->mask)
+        _signal(&q->popped);
+    return true;
+}
+
+size_t mpmc_size(const Mpmc *q) { return q ? q->mask + 1 : 0; }
+
+bool mpmc_tryPop(Mpmc *q, void *item) {
+    if (q == NULL || item == NULL) return false;
+
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    _Atomic size_t *seq;
+    while (true) {
+        seq = _seq(q, pos);
+        intptr_t diff = (intptr_t)(atomic_load_explicit(seq, memory_order_acquire) - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1, memory_order_relaxed,
+                memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // Empty
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed); // Another consumer won
+        }
+    }
+
+    memcpy(item, (char*)seq + sizeof(size_t), q->itemSize);
+    atomic_store_explicit(seq, pos + q->mask + 1, memory_order_release); // Free for the next lap
+    _signal(&q->popped);
+    return true;
+}
+
+bool mpmc_tryPush(Mpmc *q, const void *item) {
+    if (q == NULL || item == NULL || atomic_load_explicit(&q->closed, memory_order_relaxed))
+        return false;
+
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    _Atomic size_t *seq;
+    while (true) {
+        seq = _seq(q, pos);
+        intptr_t diff = (intptr_t)(atomic_load_explicit(seq, memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1, memory_order_relaxed,
+                memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // Full
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed); // Another producer won
+        }
+    }
+
+    memcpy((char*)seq + sizeof(size_t), item, q->itemSize);
+    atomic_store_explicit(seq, pos + 1, memory_order_release); // Hand to the consumer at `pos`
+    _signal(&q->pushed);
+    return true;
+}
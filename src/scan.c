@@ -0,0 +1,449 @@
+/*
+    File        : scan.c
+    Description : Byte search kernels (first byte, first of a set, occurrence count) with SSE2, AVX2
+                  and AVX-512 implementations selected at runtime, and a scalar fallback.
+*/
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "scan.h"
+
+// 64-bit only: the kernels use 64-bit lane extracts and 64-bit AVX-512 masks
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define _SCAN_X86
+    #include <immintrin.h>
+#endif
+
+typedef struct {
+    ScanLevel level;
+    const char *(*byte)(const char *s, size_t n, char c);
+    const char *(*any)(const char *s, size_t n, const char *set, size_t setLen);
+    size_t (*count)(const char *s, size_t n, char c);
+    void (*mask)(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks);
+} ScanKernels;
+
+// The C library's memchr is itself vectorised on most platforms
+static const char *_byteScalar(const char *s, size_t n, char c) {
+    return n > 0 ? (const char*)memchr(s, (unsigned char)c, n) : NULL;
+}
+
+static const char *_anyScalar(const char *s, size_t n, const char *set, size_t setLen) {
+    bool table[256] = { false };
+    for (size_t i = 0; i < setLen; i++) table[(unsigned char)set[i]] = true;
+    for (size_t i = 0; i < n; i++) if (table[(unsigned char)s[i]]) return s + i;
+    return NULL;
+}
+
+/**
+ * @brief Scalar search for a small set, without the table setup of _anyScalar (for the tails of 
+ * the vector kernels).
+ */
+static const char *_anyShort(const char *s, size_t n, const char *set, size_t setLen) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < setLen; j++) if (s[i] == set[j]) return s + i;
+    return NULL;
+}
+
+static size_t _countScalar(const char *s, size_t n, char c) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) count += s[i] == c;
+    return count;
+}
+
+static void _maskScalar(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks) {
+    bool table[256] = { false };
+    for (size_t i = 0; i < setLen; i++) table[(unsigned char)set[i]] = true;
+    for (size_t w = 0; w * 64 < n; w++) {
+        const char *block = s + w * 64;
+        size_t len = math_min(n - w * 64, (size_t)64);
+        uint64_t m = 0;
+        for (size_t b = 0; b < len; b++) m |= (uint64_t)table[(unsigned char)block[b]] << b;
+        masks[w] = m;
+    }
+}
+
+#ifdef _SCAN_X86
+
+/**
+ * @brief Pad a set to SCAN_SET_MAX bytes by repeating its first one, so that the vector kernels 
+ * compare against a fixed number of registers rather than loop over the set.
+ */
+static inline void _pad(char padded[SCAN_SET_MAX], const char *set, size_t setLen) {
+    for (size_t j = 0; j < SCAN_SET_MAX; j++) padded[j] = set[j < setLen ? j : 0];
+}
+
+// SSE2: 16 bytes per step
+
+__attribute__((target("sse2")))
+static const char *_byteSse2(const char *s, size_t n, char c) {
+    __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, v));
+        if (m) return s + i + math_ctz(m);
+    }
+    return _byteScalar(s + i, n - i, c);
+}
+
+__attribute__((target("sse2")))
+static const char *_anySse2(const char *s, size_t n, const char *set, size_t setLen) {
+    if (setLen > SCAN_SET_MAX) return _anyScalar(s, n, set, setLen);
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m128i v0 = _mm_set1_epi8(p[0]), v1 = _mm_set1_epi8(p[1]);
+    __m128i v2 = _mm_set1_epi8(p[2]), v3 = _mm_set1_epi8(p[3]);
+    __m128i v4 = _mm_set1_epi8(p[4]), v5 = _mm_set1_epi8(p[5]);
+    __m128i v6 = _mm_set1_epi8(p[6]), v7 = _mm_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v0), _mm_cmpeq_epi8(x, v1)),
+            _mm_or_si128(_mm_cmpeq_epi8(x, v2), _mm_cmpeq_epi8(x, v3)));
+        if (wide) {
+            eq = _mm_or_si128(eq, _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(x, v4), _mm_cmpeq_epi8(x, v5)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, v6), _mm_cmpeq_epi8(x, v7))));
+        }
+        unsigned m = (unsigned)_mm_movemask_epi8(eq);
+        if (m) return s + i + math_ctz(m);
+    }
+    return _anyShort(s + i, n - i, set, setLen);
+}
+
+__attribute__((target("sse2")))
+static size_t _countSse2(const char *s, size_t n, char c) {
+    __m128i v = _mm_set1_epi8(c), zero = _mm_setzero_si128();
+    size_t count = 0, i = 0;
+
+    while (i + 16 <= n) {
+        // Matches are -1, subtracted into byte counters that are summed before they overflow
+        __m128i acc = zero;
+        for (int k = 0; k < 255 && i + 16 <= n; k++, i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(x, v));
+        }
+        __m128i sums = _mm_sad_epu8(acc, zero);
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+    }
+    return count + _countScalar(s + i, n - i, c);
+}
+
+__attribute__((target("sse2")))
+static void _maskSse2(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks) {
+    if (setLen > SCAN_SET_MAX) { _maskScalar(s, n, set, setLen, masks); return; }
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m128i v0 = _mm_set1_epi8(p[0]), v1 = _mm_set1_epi8(p[1]);
+    __m128i v2 = _mm_set1_epi8(p[2]), v3 = _mm_set1_epi8(p[3]);
+    __m128i v4 = _mm_set1_epi8(p[4]), v5 = _mm_set1_epi8(p[5]);
+    __m128i v6 = _mm_set1_epi8(p[6]), v7 = _mm_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    size_t w = 0;
+    for (; (w + 1) * 64 <= n; w++) {
+        uint64_t m = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(s + w * 64 + k * 16));
+            __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v0), _mm_cmpeq_epi8(x, v1)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, v2), _mm_cmpeq_epi8(x, v3)));
+            if (wide) {
+                eq = _mm_or_si128(eq, _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(x, v4), _mm_cmpeq_epi8(x, v5)),
+                    _mm_or_si128(_mm_cmpeq_epi8(x, v6), _mm_cmpeq_epi8(x, v7))));
+            }
+            m |= (uint64_t)(unsigned)_mm_movemask_epi8(eq) << (k * 16);
+        }
+        masks[w] = m;
+    }
+    if (w * 64 < n) _maskScalar(s + w * 64, n - w * 64, set, setLen, masks + w);
+}
+
+// AVX2: 32 bytes per step (128 while searching)
+
+__attribute__((target("avx2")))
+static const char *_byteAvx2(const char *s, size_t n, char c) {
+    __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+
+    // Four vectors per iteration, the match is located once one of them hits
+    for (; i + 128 <= n; i += 128) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i)), v);
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i + 32)), v);
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i + 64)), v);
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(s + i + 96)), v);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+        if (_mm256_movemask_epi8(any) == 0) continue;
+
+        __m256i e[4] = { e0, e1, e2, e3 };
+        for (int k = 0;; k++) {
+            unsigned m = (unsigned)_mm256_movemask_epi8(e[k]);
+            if (m) return s + i + 32 * k + math_ctz(m);
+        }
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v));
+        if (m) return s + i + math_ctz(m);
+    }
+    return _byteSse2(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static const char *_anyAvx2(const char *s, size_t n, const char *set, size_t setLen) {
+    if (setLen > SCAN_SET_MAX) return _anyScalar(s, n, set, setLen);
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m256i v0 = _mm256_set1_epi8(p[0]), v1 = _mm256_set1_epi8(p[1]);
+    __m256i v2 = _mm256_set1_epi8(p[2]), v3 = _mm256_set1_epi8(p[3]);
+    __m256i v4 = _mm256_set1_epi8(p[4]), v5 = _mm256_set1_epi8(p[5]);
+    __m256i v6 = _mm256_set1_epi8(p[6]), v7 = _mm256_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i eq = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, v0), _mm256_cmpeq_epi8(x, v1)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(x, v2), _mm256_cmpeq_epi8(x, v3)));
+        if (wide) {
+            eq = _mm256_or_si256(eq, _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, v4), _mm256_cmpeq_epi8(x, v5)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, v6), _mm256_cmpeq_epi8(x, v7))));
+        }
+        unsigned m = (unsigned)_mm256_movemask_epi8(eq);
+        if (m) return s + i + math_ctz(m);
+    }
+    return _anySse2(s + i, n - i, set, setLen);
+}
+
+__attribute__((target("avx2")))
+static size_t _countAvx2(const char *s, size_t n, char c) {
+    __m256i v = _mm256_set1_epi8(c), zero = _mm256_setzero_si256();
+    size_t count = 0, i = 0;
+
+    while (i + 32 <= n) {
+        __m256i acc = zero;
+        for (int k = 0; k < 255 && i + 32 <= n; k++, i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(x, v));
+        }
+        __m256i sums = _mm256_sad_epu8(acc, zero);
+        count += (size_t)_mm256_extract_epi64(sums, 0) + (size_t)_mm256_extract_epi64(sums, 1)
+            + (size_t)_mm256_extract_epi64(sums, 2) + (size_t)_mm256_extract_epi64(sums, 3);
+    }
+    return count + _countSse2(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static void _maskAvx2(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks) {
+    if (setLen > SCAN_SET_MAX) { _maskScalar(s, n, set, setLen, masks); return; }
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m256i v0 = _mm256_set1_epi8(p[0]), v1 = _mm256_set1_epi8(p[1]);
+    __m256i v2 = _mm256_set1_epi8(p[2]), v3 = _mm256_set1_epi8(p[3]);
+    __m256i v4 = _mm256_set1_epi8(p[4]), v5 = _mm256_set1_epi8(p[5]);
+    __m256i v6 = _mm256_set1_epi8(p[6]), v7 = _mm256_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    size_t w = 0;
+    for (; (w + 1) * 64 <= n; w++) {
+        uint64_t m = 0;
+        for (int k = 0; k < 2; k++) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(s + w * 64 + k * 32));
+            __m256i eq = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, v0), _mm256_cmpeq_epi8(x, v1)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, v2), _mm256_cmpeq_epi8(x, v3)));
+            if (wide) {
+                eq = _mm256_or_si256(eq, _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x, v4), _mm256_cmpeq_epi8(x, v5)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x, v6), _mm256_cmpeq_epi8(x, v7))));
+            }
+            m |= (uint64_t)(unsigned)_mm256_movemask_epi8(eq) << (k * 32);
+        }
+        masks[w] = m;
+    }
+    if (w * 64 < n) _maskScalar(s + w * 64, n - w * 64, set, setLen, masks + w);
+}
+
+// AVX-512 BW: 64 bytes per step (256 while searching), the tail is read with one masked load
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __mmask64 _tailMask(size_t n) {
+    return n >= 64 ? ~(__mmask64)0 : (((__mmask64)1 << n) - 1);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static const char *_byteAvx512(const char *s, size_t n, char c) {
+    __m512i v = _mm512_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 256 <= n; i += 256) {
+        __mmask64 m0 = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i), v);
+        __mmask64 m1 = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i + 64), v);
+        __mmask64 m2 = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i + 128), v);
+        __mmask64 m3 = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i + 192), v);
+        if ((m0 | m1 | m2 | m3) == 0) continue;
+        if (m0) return s + i + __builtin_ctzll(m0);
+        if (m1) return s + i + 64 + __builtin_ctzll(m1);
+        if (m2) return s + i + 128 + __builtin_ctzll(m2);
+        return s + i + 192 + __builtin_ctzll(m3);
+    }
+    for (; i + 64 <= n; i += 64) {
+        __mmask64 m = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i), v);
+        if (m) return s + i + __builtin_ctzll(m);
+    }
+    if (i == n) return NULL;
+
+    __mmask64 load = _tailMask(n - i);
+    __mmask64 m = _mm512_mask_cmpeq_epi8_mask(load, _mm512_maskz_loadu_epi8(load, s + i), v);
+    return m ? s + i + __builtin_ctzll(m) : NULL;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static const char *_anyAvx512(const char *s, size_t n, const char *set, size_t setLen) {
+    if (setLen > SCAN_SET_MAX) return _anyScalar(s, n, set, setLen);
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m512i v0 = _mm512_set1_epi8(p[0]), v1 = _mm512_set1_epi8(p[1]);
+    __m512i v2 = _mm512_set1_epi8(p[2]), v3 = _mm512_set1_epi8(p[3]);
+    __m512i v4 = _mm512_set1_epi8(p[4]), v5 = _mm512_set1_epi8(p[5]);
+    __m512i v6 = _mm512_set1_epi8(p[6]), v7 = _mm512_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    for (size_t i = 0; i < n; i += 64) {
+        // The tail is read with a masked load, the bytes past it compare as unmatched
+        __mmask64 load = _tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi8(load, s + i);
+        __mmask64 m = _mm512_cmpeq_epi8_mask(x, v0) | _mm512_cmpeq_epi8_mask(x, v1)
+            | _mm512_cmpeq_epi8_mask(x, v2) | _mm512_cmpeq_epi8_mask(x, v3);
+        if (wide) {
+            m |= _mm512_cmpeq_epi8_mask(x, v4) | _mm512_cmpeq_epi8_mask(x, v5)
+                | _mm512_cmpeq_epi8_mask(x, v6) | _mm512_cmpeq_epi8_mask(x, v7);
+        }
+        m &= load;
+        if (m) return s + i + __builtin_ctzll(m);
+    }
+    return NULL;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static size_t _countAvx512(const char *s, size_t n, char c) {
+    __m512i v = _mm512_set1_epi8(c);
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += 64) {
+        __mmask64 load = _tailMask(n - i);
+        __m512i x = _mm512_maskz_loadu_epi8(load, s + i);
+        count += (size_t)__builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(load, x, v));
+    }
+    return count;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void _maskAvx512(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks) {
+    if (setLen > SCAN_SET_MAX) { _maskScalar(s, n, set, setLen, masks); return; }
+
+    char p[SCAN_SET_MAX];
+    _pad(p, set, setLen);
+    __m512i v0 = _mm512_set1_epi8(p[0]), v1 = _mm512_set1_epi8(p[1]);
+    __m512i v2 = _mm512_set1_epi8(p[2]), v3 = _mm512_set1_epi8(p[3]);
+    __m512i v4 = _mm512_set1_epi8(p[4]), v5 = _mm512_set1_epi8(p[5]);
+    __m512i v6 = _mm512_set1_epi8(p[6]), v7 = _mm512_set1_epi8(p[7]);
+    bool wide = setLen > 4;
+
+    for (size_t w = 0; w * 64 < n; w++) {
+        __mmask64 load = _tailMask(n - w * 64);
+        __m512i x = _mm512_maskz_loadu_epi8(load, s + w * 64);
+        __mmask64 m = _mm512_cmpeq_epi8_mask(x, v0) | _mm512_cmpeq_epi8_mask(x, v1)
+            | _mm512_cmpeq_epi8_mask(x, v2) | _mm512_cmpeq_epi8_mask(x, v3);
+        if (wide) {
+            m |= _mm512_cmpeq_epi8_mask(x, v4) | _mm512_cmpeq_epi8_mask(x, v5)
+                | _mm512_cmpeq_epi8_mask(x, v6) | _mm512_cmpeq_epi8_mask(x, v7);
+        }
+        masks[w] = (uint64_t)(m & load);
+    }
+}
+
+#endif // _SCAN_X86
+
+static const ScanKernels _kernels[] = {
+    { SCAN_SCALAR, _byteScalar, _anyScalar, _countScalar, _maskScalar },
+#ifdef _SCAN_X86
+    { SCAN_SSE2, _byteSse2, _anySse2, _countSse2, _maskSse2 },
+    { SCAN_AVX2, _byteAvx2, _anyAvx2, _countAvx2, _maskAvx2 },
+    { SCAN_AVX512, _byteAvx512, _anyAvx512, _countAvx512, _maskAvx512 },
+#endif
+};
+
+// Kernels in use, selected on first use
+static _Atomic(const ScanKernels*) _active;
+
+/**
+ * @brief Best instruction set level supported by the CPU.
+ *
+ * @return Level.
+ */
+static ScanLevel _supported(void) {
+#ifdef _SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt")) return SCAN_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SCAN_SSE2;
+#endif
+    return SCAN_SCALAR;
+}
+
+/**
+ * @brief Kernels in use, selecting the best supported ones on first use.
+ *
+ * @return Kernels.
+ */
+static inline const ScanKernels *_get(void) {
+    const ScanKernels *k = atomic_load_explicit(&_active, memory_order_acquire);
+    if (k == NULL) {
+        // Threads racing here all pick the same kernels
+        k = &_kernels[_supported()];
+        atomic_store_explicit(&_active, k, memory_order_release);
+    }
+    return k;
+}
+
+const char *scan_any(const char *s, size_t n, const char *set, size_t setLen) {
+    if (s == NULL || n == 0 || set == NULL || setLen == 0) return NULL;
+    if (setLen == 1) return _get()->byte(s, n, set[0]);
+    return _get()->any(s, n, set, setLen);
+}
+
+const char *scan_byte(const char *s, size_t n, char c) {
+    if (s == NULL || n == 0) return NULL;
+    return _get()->byte(s, n, c);
+}
+
+size_t scan_count(const char *s, size_t n, char c) {
+    if (s == NULL || n == 0) return 0;
+    return _get()->count(s, n, c);
+}
+
+ScanLevel scan_level(void) { return _get()->level; }
+
+void scan_mask(const char *s, size_t n, const char *set, size_t setLen, uint64_t *masks) {
+    if (s == NULL || n == 0 || masks == NULL) return;
+    if (set == NULL || setLen == 0) { memset(masks, 0, (n + 63) / 64 * sizeof(uint64_t)); return; }
+    _get()->mask(s, n, set, setLen, masks);
+}
+
+ScanLevel scan_setLevel(ScanLevel level) {
+    ScanLevel best = _supported();
+    if (level > best) level = best;
+    if (level < SCAN_SCALAR) level = SCAN_SCALAR;
+    atomic_store_explicit(&_active, &_kernels[level], memory_order_release);
+    return level;
+}
@@ -0,0 +1,87 @@
+/*
+    File        : spsc.c
+    Description : Bounded lock-free ring buffer moving items of any single type from one producer
+                  thread to one consumer thread, in batches.
+*/
+
+#include "spsc.h"
+
+void spsc_free(Spsc *q) {
+    if (q != NULL) {
+        const Allocator *a = alloc_getAllocator(q->block);
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Spsc));
+    }
+}
+
+size_t spsc_len(Spsc *q) {
+    if (q == NULL) return 0;
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    return atomic_load_explicit(&q->tail, memory_order_acquire) - head;
+}
+
+Spsc *spsc_new(size_t size, size_t itemSize) { return spsc_newWith(NULL, size, itemSize); }
+
+Spsc *spsc_newWith(const Allocator *a, size_t size, size_t itemSize) {
+    if (itemSize == 0) return NULL;
+    if (a == NULL) a = mem_getAllocator();
+
+    size = math_nextPow2(math_max(size, SPSC_MIN_SIZE));
+    if (size == 0 || size > SIZE_MAX / itemSize) return NULL;
+
+    Spsc *q = (Spsc*)mem_allocObject(a, sizeof(Spsc));
+    if (q == NULL) return NULL;
+
+    q->block = alloc_newWith(a, 0, ALLOC_STRAT_DYNAMIC);
+    if (q->block == NULL || !alloc_insertSpace(q->block, 0, size * itemSize)) {
+        alloc_free(q->block);
+        mem_freeObject(a, q, sizeof(Spsc));
+        return NULL;
+    }
+
+    q->slots = (char*)alloc_getBlock(q->block);
+    q->itemSize = itemSize;
+    q->mask = size - 1;
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+    q->headCache = q->tailCache = 0;
+
+    return q;
+}
+
+size_t spsc_pop(Spsc *q, void *items, size_t count) {
+    if (q == NULL || items == NULL) return 0;
+
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (q->tailCache - head < count)
+        q->tailCache = atomic_load_explicit(&q->tail, memory_order_acquire);
+    count = math_min(count, q->tailCache - head);
+    if (count == 0) return 0;
+
+    // The slots may wrap at the end of the ring
+    size_t slot = head & q->mask, first = math_min(count, q->mask + 1 - slot), is = q->itemSize;
+    memcpy(items, q->slots + slot * is, first * is);
+    if (count > first) memcpy((char*)items + first * is, q->slots, (count - first) * is);
+
+    atomic_store_explicit(&q->head, head + count, memory_order_release);
+    return count;
+}
+
+size_t spsc_push(Spsc *q, const void *items, size_t count) {
+    if (q == NULL || items == NULL) return 0;
+
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed), size = q->mask + 1;
+    if (size - (tail - q->headCache) < count)
+        q->headCache = atomic_load_explicit(&q->head, memory_order_acquire);
+    count = math_min(count, size - (tail - q->headCache));
+    if (count == 0) return 0;
+
+    size_t slot = tail & q->mask, first = math_min(count, size - slot), is = q->itemSize;
+    memcpy(q->slots + slot * is, items, first * is);
+    if (count > first) memcpy(q->slots, (const char*)items + first * is, (count - first) * is);
+
+    atomic_store_explicit(&q->tail, tail + count, memory_order_release);
+    return count;
+}
+
+size_t spsc_size(const Spsc *q) { return q ? q->mask + 1 : 0; }
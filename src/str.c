@@ -11,7 +11,7 @@ char *str_join(const char *l, const char *r) {
 
     size_t len = strlen(l) + strlen(r) + 1; // +1 for the null terminator
 
-    char *s = (char*)malloc(len * sizeof(char));
+    char *s = (char*)mem_allocWith(NULL, len * sizeof(char));
     if (s == NULL) return NULL;
 
     strcpy(s, l);
@@ -0,0 +1,422 @@
+/*
+    File        : tpool.c
+    Description : Work-stealing thread pool running the parallel operations of the library: a
+                  Chase-Lev deque per worker, idle workers parked on a futex, and task groups to
+                  wait on.
+*/
+
+#define _GNU_SOURCE
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "tpool.h"
+
+// Worker run by the calling thread (NULL outside of pools)
+#if defined(__GNUC__)
+static _Thread_local TPoolWorker *_self __attribute__((tls_model("initial-exec")));
+#else
+static _Thread_local TPoolWorker *_self;
+#endif
+
+static TPool *_default;
+static pthread_once_t _defaultOnce = PTHREAD_ONCE_INIT;
+
+static void _createDefault(void) { _default = tpool_new(0, false); }
+
+/**
+ * @brief Sleep until a futex word is woken, unless it no longer holds a value.
+ *
+ * @param word Futex word.
+ * @param value Value read before deciding to sleep.
+ */
+static inline void _futexWait(_Atomic uint32_t *word, uint32_t value) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/**
+ * @brief Wake threads sleeping on a futex word.
+ *
+ * @param word Futex word.
+ * @param count Maximum number of threads to wake (INT32_MAX for all).
+ */
+static inline void _futexWake(_Atomic uint32_t *word, int count) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/**
+ * @brief Wake one of the parked threads of a pool, if any. Called after a task was submitted.
+ *
+ * @param p Pool.
+ */
+static inline void _signal(TPool *p) {
+    // Orders the submit before the read of the word (see _park)
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((atomic_load_explicit(&p->wake, memory_order_relaxed) & 1) == 0) return;
+
+    // Clears bit 0 and counts a wake, so that the next signals are free until a thread parks again
+    // (or a woken thread sets it again for the others, see _park)
+    atomic_fetch_add_explicit(&p->wake, 1, memory_order_release);
+    _futexWake(&p->wake, 1);
+}
+
+/**
+ * @brief Wake all the parked threads of a pool, if any. Called after a group finished, as any of
+ * them may wait for it (bit 0 may have been cleared by a submit, the count of parked threads
+ * decides).
+ *
+ * @param p Pool.
+ */
+static inline void _broadcast(TPool *p) {
+    // Orders the finish before the read of the count (see _park)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&p->parked, memory_order_relaxed) == 0) return;
+
+    // Counts a wake and keeps bit 0, so that the wait of a thread about to park returns at once
+    atomic_fetch_add_explicit(&p->wake, 2, memory_order_release);
+    _futexWake(&p->wake, INT32_MAX);
+}
+
+/**
+ * @brief Create an empty deque ring.
+ *
+ * @param size Number of slots (a power of 2).
+ * @param prev Ring replaced by the new one (or NULL).
+ * @return Ring (or NULL if failure).
+ */
+static TPoolRing *_newRing(size_t size, TPoolRing *prev) {
+    TPoolRing *r = (TPoolRing*)mem_alloc(sizeof(TPoolRing) + size * sizeof(TPoolTask*));
+    if (r == NULL) return NULL;
+    r->prev = prev;
+    r->mask = size - 1;
+    return r;
+}
+
+/**
+ * @brief Free the ring of a worker and all the rings it replaced.
+ *
+ * @param w Worker.
+ */
+static void _freeRings(TPoolWorker *w) {
+    TPoolRing *r = atomic_load_explicit(&w->ring, memory_order_relaxed);
+    while (r != NULL) {
+        TPoolRing *prev = r->prev;
+        mem_free(r, sizeof(TPoolRing) + (r->mask + 1) * sizeof(TPoolTask*));
+        r = prev;
+    }
+}
+
+/**
+ * @brief Push a task at the bottom of the deque of a worker, doubling its ring when full. Only
+ * called by the worker.
+ *
+ * @param w Worker.
+ * @param t Task.
+ * @return true if pushed, false if the ring could not grow.
+ */
+static bool _push(TPoolWorker *w, TPoolTask *t) {
+    int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&w->top, memory_order_acquire);
+    TPoolRing *r = atomic_load_explicit(&w->ring, memory_order_relaxed);
+
+    if (b - top > (int64_t)r->mask) {
+        TPoolRing *grown = _newRing((r->mask + 1) * 2, r);
+        if (grown == NULL) return false;
+        for (int64_t i = top; i < b; i++) {
+            TPoolTask *old = atomic_load_explicit(&r->slots[i & r->mask], memory_order_relaxed);
+            atomic_store_explicit(&grown->slots[i & grown->mask], old, memory_order_relaxed);
+        }
+        atomic_store_explicit(&w->ring, grown, memory_order_release);
+        r = grown;
+    }
+
+    // Publishes the task to the thread loading the slot
+    atomic_store_explicit(&r->slots[b & r->mask], t, memory_order_release);
+    // Publishes the slot to the thieves reading `bottom`
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Take the task at the bottom of the deque of a worker. Only called by the worker.
+ *
+ * @param w Worker.
+ * @return Task (or NULL if the deque is empty).
+ */
+static TPoolTask *_take(TPoolWorker *w) {
+    int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+    TPoolRing *r = atomic_load_explicit(&w->ring, memory_order_relaxed);
+    atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+    // Orders the claim of the slot before the read of `top` (see _steal)
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&w->top, memory_order_relaxed);
+
+    if (t > b) { // Empty
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    TPoolTask *task = atomic_load_explicit(&r->slots[b & r->mask], memory_order_relaxed);
+    if (t == b) {
+        // Last task: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1, memory_order_seq_cst,
+            memory_order_relaxed))
+            task = NULL;
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+/**
+ * @brief Steal the task at the top of the deque of a worker. Called by any thread.
+ *
+ * @param w Worker.
+ * @return Task (or NULL if the deque is empty or another thread took the task).
+ */
+static TPoolTask *_steal(TPoolWorker *w) {
+    int64_t t = atomic_load_explicit(&w->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+
+    TPoolRing *r = atomic_load_explicit(&w->ring, memory_order_acquire);
+    TPoolTask *task = atomic_load_explicit(&r->slots[t & r->mask], memory_order_acquire);
+    if (!atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1, memory_order_seq_cst,
+        memory_order_relaxed))
+        return NULL;
+    return task;
+}
+
+/**
+ * @brief Find a task to run: the bottom of the deque of the worker, then the tasks submitted from
+ * outside the pool, then the tops of the deques of the other workers, from a random one.
+ *
+ * @param p Pool.
+ * @param w Worker of the calling thread (NULL if not one of the pool).
+ * @param seed Victim selection of the calling thread.
+ * @return Task (or NULL if none was found).
+ */
+static TPoolTask *_find(TPool *p, TPoolWorker *w, unsigned *seed) {
+    TPoolTask *task = w != NULL ? _take(w) : NULL;
+    if (task != NULL || mpmc_tryPop(p->inject, &task)) return task;
+
+    // xorshift
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    for (unsigned i = 0, start = *seed % p->count; i < p->count; i++) {
+        TPoolWorker *victim = &p->workers[(start + i) % p->count];
+        if (victim != w && (task = _steal(victim)) != NULL) return task;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run a task and free it, waking the threads waiting for its group if it was the last.
+ *
+ * @param p Pool.
+ * @param t Task.
+ */
+static void _run(TPool *p, TPoolTask *t) {
+    TPoolGroup *g = t->group;
+    t->fn(t->arg);
+    pool_releaseSmall(t, sizeof(TPoolTask));
+    if (g != NULL && atomic_fetch_sub_explicit(&g->pending, 1, memory_order_acq_rel) == 1)
+        _broadcast(p);
+}
+
+/**
+ * @brief Hand a wake on after being woken. A wake reaches a single thread and clears bit 0, so the
+ * tasks submitted until that thread runs woke no one: it sets the bit again and wakes the next
+ * parked thread, on finding a task or when leaving without running the one it was woken for.
+ *
+ * @param p Pool.
+ */
+static inline void _passOn(TPool *p) {
+    if (atomic_load_explicit(&p->parked, memory_order_seq_cst) == 0) return;
+    atomic_fetch_or_explicit(&p->wake, 1, memory_order_seq_cst);
+    _signal(p);
+}
+
+/**
+ * @brief Run tasks of a pool until a group is finished (or the pool stops, without a group).
+ * Parks the calling thread when there are no tasks to run.
+ *
+ * @param p Pool.
+ * @param w Worker of the calling thread (NULL if not one of the pool).
+ * @param g Task group (NULL for a worker running until the pool stops).
+ */
+static void _park(TPool *p, TPoolWorker *w, TPoolGroup *g) {
+    unsigned seed = w != NULL ? w->seed : (unsigned)(uintptr_t)&seed | 1;
+    bool woken = false;
+    while (g == NULL || atomic_load_explicit(&g->pending, memory_order_acquire) > 0) {
+        TPoolTask *t = _find(p, w, &seed);
+        if (t == NULL) {
+            // Announce the park, then check again: a submitter either sees the announce and
+            // changes the word (so the wait returns at once) or submitted before the check
+            atomic_fetch_add_explicit(&p->parked, 1, memory_order_seq_cst);
+            uint32_t value = atomic_fetch_or_explicit(&p->wake, 1, memory_order_seq_cst) | 1;
+            t = _find(p, w, &seed);
+            bool done = t == NULL && (g != NULL
+                ? atomic_load_explicit(&g->pending, memory_order_seq_cst) == 0
+                : atomic_load_explicit(&p->stop, memory_order_seq_cst));
+            if (t == NULL && !done) {
+                _futexWait(&p->wake, value);
+                woken = true;
+            }
+            atomic_fetch_sub_explicit(&p->parked, 1, memory_order_seq_cst);
+            if (done) break;
+            if (t == NULL) continue;
+        }
+
+        if (woken) _passOn(p);
+        woken = false;
+        _run(p, t);
+    }
+    if (woken) _passOn(p);
+    if (w != NULL) w->seed = seed;
+}
+
+/**
+ * @brief CPU of a pinned worker.
+ *
+ * @param allowed CPUs the process may run on (at least one).
+ * @param id Worker number (pinned to the `id`-th allowed CPU, modulo their number).
+ * @param set Set to the CPU.
+ */
+static void _cpuOf(const cpu_set_t *allowed, unsigned id, cpu_set_t *set) {
+    unsigned i = id % (unsigned)CPU_COUNT(allowed);
+    CPU_ZERO(set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, allowed) && i-- == 0) { CPU_SET(cpu, set); return; }
+    }
+}
+
+/**
+ * @brief Thread of a worker.
+ *
+ * @param arg TPoolWorker.
+ * @return NULL.
+ */
+static void *_work(void *arg) {
+    TPoolWorker *w = (TPoolWorker*)arg;
+    _self = w;
+    _park(w->pool, w, NULL);
+    return NULL;
+}
+
+/**
+ * @brief Stop the workers of a pool and free it.
+ *
+ * @param p Pool.
+ * @param started Number of workers started.
+ */
+static void _stop(TPool *p, unsigned started) {
+    atomic_store_explicit(&p->stop, true, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&p->wake, 2, memory_order_release);
+    _futexWake(&p->wake, INT32_MAX);
+    for (unsigned i = 0; i < started; i++) pthread_join(p->workers[i].thread, NULL);
+
+    for (unsigned i = 0; i < p->count; i++) _freeRings(&p->workers[i]);
+    mpmc_free(p->inject);
+    mem_free(p->workers, p->count * sizeof(TPoolWorker));
+    mem_free(p, sizeof(TPool));
+}
+
+TPool *tpool_default(void) {
+    pthread_once(&_defaultOnce, _createDefault);
+    return _default;
+}
+
+void tpool_free(TPool *p) {
+    if (p != NULL && p != _default) _stop(p, p->count);
+}
+
+void tpool_groupInit(TPoolGroup *g) {
+    if (g != NULL) atomic_init(&g->pending, 0);
+}
+
+TPool *tpool_new(unsigned workers, bool pin) {
+    if (workers == 0) workers = (unsigned)math_max(sysconf(_SC_NPROCESSORS_ONLN), 1L);
+
+    TPool *p = (TPool*)mem_alloc(sizeof(TPool));
+    if (p == NULL) return NULL;
+    p->workers = (TPoolWorker*)mem_alloc(workers * sizeof(TPoolWorker));
+    p->inject = mpmc_new(TPOOL_INJECT_SIZE, sizeof(TPoolTask*));
+    if (p->workers == NULL || p->inject == NULL) {
+        mpmc_free(p->inject);
+        mem_free(p->workers, workers * sizeof(TPoolWorker));
+        mem_free(p, sizeof(TPool));
+        return NULL;
+    }
+
+    memset(p->workers, 0, workers * sizeof(TPoolWorker));
+    p->count = workers;
+    p->pin = pin;
+    atomic_init(&p->wake, 0);
+    atomic_init(&p->parked, 0);
+    atomic_init(&p->stop, false);
+
+    bool ok = true;
+    for (unsigned i = 0; i < workers; i++) {
+        TPoolWorker *w = &p->workers[i];
+        w->pool = p;
+        w->id = i;
+        w->seed = 2 * i + 1;
+        atomic_init(&w->top, 0);
+        atomic_init(&w->bottom, 0);
+        TPoolRing *r = _newRing(TPOOL_DEQUE_SIZE, NULL);
+        atomic_init(&w->ring, r);
+        ok &= r != NULL;
+    }
+
+    // Pinned workers start on their CPU, pthread_create fails if the affinity cannot be set
+    cpu_set_t allowed, cpu;
+    pthread_attr_t attr;
+    ok = ok && (!pin || sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    ok = ok && pthread_attr_init(&attr) == 0;
+
+    unsigned started = 0;
+    for (; ok && started < workers; started++) {
+        if (pin) _cpuOf(&allowed, started, &cpu);
+        if ((pin && pthread_attr_setaffinity_np(&attr, sizeof(cpu), &cpu) != 0)
+            || pthread_create(&p->workers[started].thread, &attr, _work, &p->workers[started]) != 0)
+            break;
+    }
+    if (ok) pthread_attr_destroy(&attr);
+    if (!ok || started < workers) {
+        _stop(p, started);
+        return NULL;
+    }
+    return p;
+}
+
+bool tpool_submit(TPool *p, TPoolGroup *g, TPoolFn fn, void *arg) {
+    if (p == NULL || fn == NULL) return false;
+
+    TPoolTask *t = (TPoolTask*)pool_allocSmall(sizeof(TPoolTask));
+    if (t == NULL) return false;
+    *t = (TPoolTask){ fn, arg, g };
+    if (g != NULL) atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+
+    TPoolWorker *w = _self;
+    if (!(w != NULL && w->pool == p ? _push(w, t) : mpmc_push(p->inject, &t))) {
+        if (g != NULL) atomic_fetch_sub_explicit(&g->pending, 1, memory_order_relaxed);
+        pool_releaseSmall(t, sizeof(TPoolTask));
+        return false;
+    }
+    _signal(p);
+    return true;
+}
+
+void tpool_wait(TPool *p, TPoolGroup *g) {
+    if (p == NULL || g == NULL) return;
+    TPoolWorker *w = _self;
+    _park(p, w != NULL && w->pool == p ? w : NULL, g);
+}
+
+unsigned tpool_workers(const TPool *p) { return p ? p->count : 0; }
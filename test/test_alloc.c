@@ -19,6 +19,42 @@
     TEST_ASSERT_EQUAL_INT(alloc_getUsed(b) == 0, alloc_isEmpty(b)); \
 }
 
+#define checkInts(b, exp, n) { \
+    int _buf[n]; \
+    TEST_ASSERT_TRUE(alloc_read(b, _buf, 0, (n) * SI)); \
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, _buf, n); \
+}
+
+/**
+ * @brief Create an empty chunked AllocBlock with chunks holding two ints.
+ */
+static AllocBlock *newChunked(void) {
+    AllocBlock *b = alloc_new(0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_TRUE(alloc_setChunkSize(b, 2 * SI));
+    return b;
+}
+
+/**
+ * @brief Allocator callbacks that count the live allocations in `ctx` (size_t).
+ */
+static void *countingAlloc(void *ctx, size_t size) { 
+    ++*(size_t*)ctx; 
+    return malloc(size); 
+}
+
+static void *countingRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    (void)oldSize;
+    void *np = realloc(p, newSize);
+    if (p == NULL && np != NULL) ++*(size_t*)ctx;
+    return np;
+}
+
+static void countingFree(void *ctx, void *p, size_t size) { 
+    (void)size;
+    if (p != NULL) --*(size_t*)ctx; 
+    free(p); 
+}
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -84,6 +120,33 @@ void test_alloc_append_stratBuddy(void) {
     block = NULL;
 }
 
+void test_alloc_append_stratChunks(void) {
+    int i;
+    AllocBlock *block = newChunked();
+    TEST_ASSERT_NULL(alloc_getBlock(block));
+
+    // Append to an empty block (allocates a single chunk)
+    i = 10;
+    TEST_ASSERT_TRUE(alloc_append(block, &i, SI));
+    checkSizes(block, SI, 2 * SI);
+    TEST_ASSERT_EQUAL_INT(10, *(int*)alloc_index(block, 0));
+    TEST_ASSERT_NULL(alloc_getBlock(block));
+
+    // Append across chunk boundaries
+    int arr[] = { 20, 30, 40, 50 };
+    int *first = (int*)alloc_index(block, 0);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 4 * SI));
+    checkSizes(block, 5 * SI, 6 * SI);
+    int exp[] = { 10, 20, 30, 40, 50 };
+    checkInts(block, exp, 5);
+    for (i = 0; i < 5; i++) TEST_ASSERT_EQUAL_INT(exp[i], *(int*)alloc_index(block, i * SI));
+
+    // Existing data is never moved
+    TEST_ASSERT_EQUAL_PTR(first, alloc_index(block, 0));
+
+    alloc_free(block);
+}
+
 void test_alloc_append_stratDynamic(void) {
     int i;
     AllocBlock *block;
@@ -139,6 +202,48 @@ void test_alloc_append_stratDynamic(void) {
     block = NULL;
 }
 
+void test_alloc_append_stratGeometric(void) {
+    int i;
+    AllocBlock *block;
+
+    block = alloc_new(0, ALLOC_STRAT_GEOMETRIC);
+    TEST_ASSERT_TRUE(alloc_setGrowth(block, 2.0, 4 * SI));
+
+    // Append to an empty block (grows by the minimum increment)
+    i = 10;
+    TEST_ASSERT_TRUE(alloc_append(block, &i, SI));
+    checkSizes(block, SI, 4 * SI);
+    TEST_ASSERT_EQUAL_INT(10, *(int*)alloc_index(block, 0));
+
+    // Append within the spare capacity (no resize)
+    int arr[] = { 20, 30, 40 };
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 3 * SI));
+    checkSizes(block, 4 * SI, 4 * SI);
+
+    // Append to invoke geometric resize
+    i = 50;
+    TEST_ASSERT_TRUE(alloc_append(block, &i, SI));
+    checkSizes(block, 5 * SI, 8 * SI);
+    int exp1[] = { 10, 20, 30, 40, 50 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp1, (int*)alloc_getBlock(block), 5);
+
+    // Append more than the growth factor provides (grows to the required size)
+    int big[12] = { 0 };
+    TEST_ASSERT_TRUE(alloc_append(block, big, 12 * SI));
+    checkSizes(block, 17 * SI, 17 * SI);
+
+    alloc_free(block);
+
+    // Default growth policy
+    block = alloc_new(0, ALLOC_STRAT_GEOMETRIC);
+    for (i = 0; i < 100; i++) TEST_ASSERT_TRUE(alloc_append(block, &i, SI));
+    TEST_ASSERT_EQUAL_INT(100 * SI, alloc_getUsed(block));
+    TEST_ASSERT_TRUE(alloc_getSize(block) >= 100 * SI);
+    for (i = 0; i < 100; i++) TEST_ASSERT_EQUAL_INT(i, *(int*)alloc_index(block, i * SI));
+
+    alloc_free(block);
+}
+
 void test_alloc_clear_stratBuddy(void) {
     int arr1[] = { 1, 2, 3 };
     AllocBlock *block = alloc_new(0, ALLOC_STRAT_BUDDY);
@@ -234,6 +339,42 @@ void test_alloc_copy_stratDynamic(void) {
     alloc_free(copy);
 }
 
+void test_alloc_detach(void) {
+    int arr[] = { 10, 20, 30 };
+
+    size_t size = 0;
+
+    // Memory block outlives the AllocBlock and is released through mem_free
+    mem_enableStats(true);
+    size_t live = mem_getStats().liveBytes;
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 3 * SI));
+    int *data = (int*)alloc_detach(block, &size);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_TRUE(size >= 3 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, data, 3);
+    mem_free(data, size);
+    TEST_ASSERT_EQUAL_size_t(live, mem_getStats().liveBytes);
+    mem_enableStats(false);
+
+    // Empty, chunked and non-default allocator blocks cannot be detached
+    TEST_ASSERT_NULL(alloc_detach(NULL, &size));
+    block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_NULL(alloc_detach(block, &size));
+    alloc_free(block);
+
+    block = alloc_new(0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 3 * SI));
+    TEST_ASSERT_NULL(alloc_detach(block, &size));
+    alloc_free(block);
+
+    Arena *a = arena_new(0);
+    block = alloc_newIn(a, 0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 3 * SI));
+    TEST_ASSERT_NULL(alloc_detach(block, &size));
+    arena_free(a);
+}
+
 void test_alloc_index(void) {
     AllocBlock *block;
     char data[] = "123456789";
@@ -369,6 +510,37 @@ void test_alloc_insert_stratBuddy(void) {
     block = NULL;
 }
 
+void test_alloc_insert_stratChunks(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    AllocBlock *block = newChunked();
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+
+    // Insert in the middle of a chunk
+    int i = 15;
+    TEST_ASSERT_TRUE(alloc_insert(block, &i, SI, SI));
+    checkSizes(block, 6 * SI, 6 * SI);
+    int exp1[] = { 10, 15, 20, 30, 40, 50 };
+    checkInts(block, exp1, 6);
+
+    // Insert multiple items across chunk boundaries
+    int ins[] = { 1, 2, 3 };
+    TEST_ASSERT_TRUE(alloc_insert(block, ins, 3 * SI, 3 * SI));
+    checkSizes(block, 9 * SI, 10 * SI);
+    int exp2[] = { 10, 15, 20, 1, 2, 3, 30, 40, 50 };
+    checkInts(block, exp2, 9);
+
+    // Insert at the start
+    i = 0;
+    TEST_ASSERT_TRUE(alloc_insert(block, &i, 0, SI));
+    int exp3[] = { 0, 10, 15, 20, 1, 2, 3, 30, 40, 50 };
+    checkInts(block, exp3, 10);
+
+    // Insert out of bounds
+    TEST_ASSERT_FALSE(alloc_insert(block, &i, 11 * SI, SI));
+
+    alloc_free(block);
+}
+
 void test_alloc_insert_stratDynamic(void) {
     int i;
     AllocBlock *block;
@@ -477,6 +649,53 @@ void test_alloc_insert_stratDynamic(void) {
     block = NULL;
 }
 
+void test_alloc_insertSpace(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    AllocBlock *block = newChunked();
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+
+    // Space across chunk boundaries, then filled
+    TEST_ASSERT_TRUE(alloc_insertSpace(block, SI, 3 * SI));
+    checkSizes(block, 8 * SI, 8 * SI);
+    int ins[] = { 1, 2, 3 };
+    TEST_ASSERT_TRUE(alloc_setAt(block, ins, SI, 3 * SI));
+    int exp[] = { 10, 1, 2, 3, 20, 30, 40, 50 };
+    checkInts(block, exp, 8);
+
+    // Out of bounds and empty inserts
+    TEST_ASSERT_FALSE(alloc_insertSpace(block, 9 * SI, SI));
+    TEST_ASSERT_FALSE(alloc_insertSpace(block, 0, 0));
+    TEST_ASSERT_FALSE(alloc_insertSpace(NULL, 0, SI));
+    checkSizes(block, 8 * SI, 8 * SI);
+
+    alloc_free(block);
+}
+
+void test_alloc_move(void) {
+    int arr[] = { 1, 2, 3, 4, 5, 6, 7 };
+    AllocBlock *blocks[] = { alloc_new(0, ALLOC_STRAT_DYNAMIC), newChunked() };
+    for (int i = 0; i < 2; i++) {
+        AllocBlock *block = blocks[i];
+        TEST_ASSERT_TRUE(alloc_append(block, arr, 7 * SI));
+
+        // Overlapping moves, forwards then backwards
+        TEST_ASSERT_TRUE(alloc_move(block, 3 * SI, SI, 4 * SI));
+        int exp1[] = { 1, 2, 3, 2, 3, 4, 5 };
+        checkInts(block, exp1, 7);
+        TEST_ASSERT_TRUE(alloc_move(block, 0, 2 * SI, 5 * SI));
+        int exp2[] = { 3, 2, 3, 4, 5, 4, 5 };
+        checkInts(block, exp2, 7);
+
+        // Only within the used memory
+        TEST_ASSERT_FALSE(alloc_move(block, 4 * SI, 0, 4 * SI));
+        TEST_ASSERT_FALSE(alloc_move(block, 0, 8 * SI, 0));
+        TEST_ASSERT_TRUE(alloc_move(block, 7 * SI, 0, 0));
+        checkInts(block, exp2, 7);
+        alloc_free(block);
+    }
+    TEST_ASSERT_FALSE(alloc_move(NULL, 0, 0, 0));
+}
+
 void test_alloc_new_stratBuddy(void) {
     AllocBlock *block;
 
@@ -541,9 +760,149 @@ void test_alloc_new_stratDynamic(void) {
     TEST_ASSERT_NULL(block); // Allocation should fail
 }
 
+void test_alloc_newBuddy(void) {
+    Buddy *h = buddy_new(4096, 64);
+    int arr[] = { 10, 20, 30, 40, 50 };
+
+    // Block and its data come from the heap, sizes follow the buddy strategy
+    AllocBlock *block = alloc_newBuddy(h, 3 * SI);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL_PTR(buddy_allocator(h), alloc_getAllocator(block));
+    TEST_ASSERT_EQUAL_INT(128, buddy_blockSize(h, block));
+    TEST_ASSERT_EQUAL_INT(ALLOC_STRAT_BUDDY, alloc_getStrat(block));
+    checkSizes(block, 0, 16);
+    TEST_ASSERT_EQUAL_INT(64, buddy_blockSize(h, alloc_getBlock(block)));
+
+    // Growth goes through the heap
+    for (int i = 0; i < 20; i++) TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    for (int i = 0; i < 20; i++) TEST_ASSERT_EQUAL_INT(arr[i % 5], *(int*)alloc_index(block, i * SI));
+    TEST_ASSERT_EQUAL_INT(512, buddy_blockSize(h, alloc_getBlock(block)));
+    TEST_ASSERT_EQUAL_INT(128 + 512, buddy_stats(h).used);
+
+    // Copies and splits stay in the heap
+    AllocBlock *copy = alloc_copy(block);
+    TEST_ASSERT_EQUAL_PTR(buddy_allocator(h), alloc_getAllocator(copy));
+    TEST_ASSERT_EQUAL_INT_ARRAY(alloc_getBlock(block), alloc_getBlock(copy), 100);
+
+    AllocBlock *lb, *rb;
+    TEST_ASSERT_TRUE(alloc_split(copy, &lb, &rb, 5 * SI));
+    TEST_ASSERT_EQUAL_PTR(buddy_allocator(h), alloc_getAllocator(lb));
+    TEST_ASSERT_EQUAL_PTR(buddy_allocator(h), alloc_getAllocator(rb));
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, (int*)alloc_getBlock(lb), 5);
+
+    // Heap blocks cannot be detached
+    size_t size = 0;
+    TEST_ASSERT_NULL(alloc_detach(lb, &size));
+
+    // Freeing returns the memory to the heap
+    alloc_free(lb);
+    alloc_free(rb);
+    alloc_free(block);
+    TEST_ASSERT_EQUAL_INT(0, buddy_stats(h).used);
+    TEST_ASSERT_EQUAL_INT(1, buddy_stats(h).freeBlocks);
+
+    // Blocks larger than the heap fail
+    TEST_ASSERT_NULL(alloc_newBuddy(h, 8192));
+
+    // NULL heap behaves as alloc_new
+    block = alloc_newBuddy(NULL, 3 * SI);
+    TEST_ASSERT_EQUAL_PTR(mem_getAllocator(), alloc_getAllocator(block));
+    checkSizes(block, 0, 16);
+    alloc_free(block);
+
+    buddy_free(h);
+}
+
+void test_alloc_newIn(void) {
+    Arena *a = arena_new(0);
+    int arr[] = { 10, 20, 30, 40, 50 };
+
+    // Block and its data come from the arena
+    AllocBlock *block = alloc_newIn(a, 2 * SI, ALLOC_STRAT_GEOMETRIC);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL_PTR(arena_allocator(a), alloc_getAllocator(block));
+    checkSizes(block, 0, 2 * SI);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, SI));
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[1], (int*)alloc_getBlock(block), 4);
+
+    // Copies and splits stay in the arena
+    AllocBlock *copy = alloc_copy(block);
+    TEST_ASSERT_EQUAL_PTR(arena_allocator(a), alloc_getAllocator(copy));
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[1], (int*)alloc_getBlock(copy), 4);
+
+    AllocBlock *lb, *rb;
+    TEST_ASSERT_TRUE(alloc_split(copy, &lb, &rb, 2 * SI));
+    TEST_ASSERT_EQUAL_PTR(arena_allocator(a), alloc_getAllocator(lb));
+    TEST_ASSERT_EQUAL_PTR(arena_allocator(a), alloc_getAllocator(rb));
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[3], (int*)alloc_getBlock(rb), 2);
+
+    // Chunked blocks take chunks from the arena
+    AllocBlock *chunked = alloc_newIn(a, 0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_TRUE(alloc_setChunkSize(chunked, 2 * SI));
+    TEST_ASSERT_TRUE(alloc_append(chunked, arr, 5 * SI));
+    TEST_ASSERT_EQUAL_INT(50, *(int*)alloc_index(chunked, 4 * SI));
+
+    // Freeing is a no-op, everything is released by the arena
+    alloc_free(block);
+    TEST_ASSERT_TRUE(arena_used(a) > 0);
+    arena_reset(a);
+    TEST_ASSERT_EQUAL_INT(0, arena_used(a));
+
+    // NULL arena behaves as alloc_new
+    block = alloc_newIn(NULL, SI, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_EQUAL_PTR(mem_getAllocator(), alloc_getAllocator(block));
+    alloc_free(block);
+
+    arena_free(a);
+}
+
+void test_alloc_newWith(void) {
+    size_t live = 0;
+    Allocator counting = { countingAlloc, countingRealloc, countingFree, &live };
+    int arr[] = { 10, 20, 30, 40, 50 };
+
+    // All memory (block and data) goes through the allocator, and is released through it
+    AllocBlock *block = alloc_newWith(&counting, SI, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL_PTR(&counting, alloc_getAllocator(block));
+    TEST_ASSERT_EQUAL_INT(2, live);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+
+    AllocBlock *chunked = alloc_newWith(&counting, 0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_TRUE(alloc_setChunkSize(chunked, 2 * SI));
+    TEST_ASSERT_TRUE(alloc_append(chunked, arr, 5 * SI));
+    TEST_ASSERT_EQUAL_INT(2 + 5, live); // + AllocBlock, chunk table and 3 chunks
+
+    AllocBlock *lb, *rb;
+    TEST_ASSERT_TRUE(alloc_split(block, &lb, &rb, 2 * SI));
+    TEST_ASSERT_EQUAL_PTR(&counting, alloc_getAllocator(lb));
+    TEST_ASSERT_EQUAL_PTR(&counting, alloc_getAllocator(rb));
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[2], (int*)alloc_getBlock(rb), 3);
+
+    alloc_free(lb);
+    alloc_free(rb);
+    alloc_free(chunked);
+    TEST_ASSERT_EQUAL_INT(0, live);
+
+    // Blocks use the default allocator when none is given
+    mem_setAllocator(&counting);
+    block = alloc_new(SI, ALLOC_STRAT_BUDDY);
+    TEST_ASSERT_EQUAL_PTR(&counting, alloc_getAllocator(block));
+    TEST_ASSERT_EQUAL_INT(2, live);
+    mem_setAllocator(NULL);
+    
+    // The block keeps its allocator after the default changes
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    alloc_free(block);
+    TEST_ASSERT_EQUAL_INT(0, live);
+}
+
 void test_alloc_remove_stratBuddy(void) {
     int arr[] = { 10, 20, 30, 40, 50 };
     AllocBlock *block = alloc_new(0, ALLOC_STRAT_BUDDY);
+    // Shrink on every removal (see test_alloc_setShrink for the default)
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
 
     // Append some items to the block
     TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
@@ -574,6 +933,7 @@ void test_alloc_remove_stratBuddy(void) {
     // Reset
     alloc_free(block);
     block = alloc_new(0, ALLOC_STRAT_BUDDY);
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
     TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
 
     // Removing out of bounds should do nothing
@@ -593,9 +953,44 @@ void test_alloc_remove_stratBuddy(void) {
     alloc_free(block);
 }
 
+void test_alloc_remove_stratChunks(void) {
+    int arr[] = { 10, 20, 30, 40, 50, 60, 70 };
+    AllocBlock *block = newChunked();
+    // Shrink on every removal (see test_alloc_setShrink for the default)
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 7 * SI));
+    checkSizes(block, 7 * SI, 8 * SI);
+
+    // Remove across chunk boundaries (unused chunks are released)
+    TEST_ASSERT_TRUE(alloc_remove(block, SI, 3 * SI));
+    checkSizes(block, 4 * SI, 4 * SI);
+    int exp1[] = { 10, 50, 60, 70 };
+    checkInts(block, exp1, 4);
+
+    // Keep chunks when below the shrink threshold
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 0.0));
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, 3 * SI));
+    checkSizes(block, SI, 4 * SI);
+    TEST_ASSERT_EQUAL_INT(70, *(int*)alloc_index(block, 0));
+
+    // Out of bounds
+    TEST_ASSERT_FALSE(alloc_remove(block, 0, 2 * SI));
+
+    // Full remove releases all chunks
+    TEST_ASSERT_TRUE(alloc_shrinkToFit(block));
+    checkSizes(block, SI, 2 * SI);
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, SI));
+    checkSizes(block, 0, 0);
+
+    alloc_free(block);
+}
+
 void test_alloc_remove_stratDynamic(void) {
     int arr[] = { 10, 20, 30, 40, 50 };
     AllocBlock *block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    // Shrink on every removal (see test_alloc_setShrink for the default)
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
 
     // Append some items to the block
     TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
@@ -627,6 +1022,7 @@ void test_alloc_remove_stratDynamic(void) {
     // Reset
     alloc_free(block);
     block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 1.0));
     TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
 
     // Removing out of bounds should do nothing
@@ -676,6 +1072,12 @@ void test_alloc_resize_stratBuddy(void) {
     TEST_ASSERT_NULL(alloc_getBlock(block));
     checkSizes(block, 0, 0);
 
+    // Sizes that cannot be rounded to a power of 2 fail (and leave the block untouched)
+    TEST_ASSERT_TRUE(alloc_resize(block, 10));
+    TEST_ASSERT_FALSE(alloc_resize(block, SIZE_MAX / 2 + 2));
+    TEST_ASSERT_FALSE(alloc_resize(block, SIZE_MAX));
+    checkSizes(block, 0, 16);
+
     alloc_free(block);
 
     // TODO - Test resize below value of used
@@ -780,6 +1182,146 @@ void test_alloc_setAt_stratDynamic(void) {
     alloc_free(block);
 }
 
+void test_alloc_setChunkItem(void) {
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_TRUE(alloc_setChunkSize(block, 16));
+    TEST_ASSERT_FALSE(alloc_setChunkItem(block, 0));
+    TEST_ASSERT_FALSE(alloc_setChunkItem(block, 17));
+    TEST_ASSERT_TRUE(alloc_setChunkItem(block, 3));
+    TEST_ASSERT_FALSE(alloc_setChunkSize(block, 2)); // Smaller than an item
+
+    // Chunks of 16 bytes hold 5 items of 3 bytes, sizes are rounded up to whole chunks of 15 bytes
+    char data[40];
+    for (int i = 0; i < 40; i++) data[i] = (char)i;
+    TEST_ASSERT_TRUE(alloc_append(block, data, 39));
+    checkSizes(block, 39, 45);
+    size_t len;
+    for (size_t i = 0; i < 39; i += 3) {
+        TEST_ASSERT_EQUAL_MEMORY(data + i, alloc_index(block, i), 3);
+        TEST_ASSERT_NOT_NULL(alloc_span(block, i, &len));
+        TEST_ASSERT_EQUAL_INT(i < 30 ? 15 - i % 15 : 39 - i, len);
+    }
+
+    // Moves across chunks keep whole items
+    TEST_ASSERT_TRUE(alloc_remove(block, 3, 6));
+    TEST_ASSERT_TRUE(alloc_insert(block, data + 3, 3, 6));
+    char out[39];
+    TEST_ASSERT_TRUE(alloc_read(block, out, 0, 39));
+    TEST_ASSERT_EQUAL_MEMORY(data, out, 39);
+
+    // Cannot change while chunks are held
+    TEST_ASSERT_FALSE(alloc_setChunkItem(block, 4));
+    alloc_free(block);
+}
+
+void test_alloc_setChunkSize(void) {
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_EQUAL_INT(ALLOC_CHUNK_SIZE, alloc_getChunkSize(block));
+
+    // Must be a non-zero power of 2
+    TEST_ASSERT_FALSE(alloc_setChunkSize(NULL, 16));
+    TEST_ASSERT_FALSE(alloc_setChunkSize(block, 0));
+    TEST_ASSERT_FALSE(alloc_setChunkSize(block, 24));
+    TEST_ASSERT_TRUE(alloc_setChunkSize(block, 16));
+    TEST_ASSERT_EQUAL_INT(16, alloc_getChunkSize(block));
+
+    // Sizes are rounded up to whole chunks
+    TEST_ASSERT_TRUE(alloc_resize(block, 17));
+    checkSizes(block, 0, 32);
+
+    // Cannot change while chunks are held
+    TEST_ASSERT_FALSE(alloc_setChunkSize(block, 32));
+    TEST_ASSERT_TRUE(alloc_resize(block, 0));
+    TEST_ASSERT_TRUE(alloc_setChunkSize(block, 32));
+
+    // Overflow
+    TEST_ASSERT_FALSE(alloc_resize(block, SIZE_MAX));
+    checkSizes(block, 0, 0);
+
+    alloc_free(block);
+}
+
+void test_alloc_setGrowth(void) {
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_GEOMETRIC);
+
+    // Invalid growth factors are rejected
+    TEST_ASSERT_FALSE(alloc_setGrowth(NULL, 2.0, 0));
+    TEST_ASSERT_FALSE(alloc_setGrowth(block, 0.5, 0));
+
+    // Factor of 1.0 grows only by the minimum increment
+    TEST_ASSERT_TRUE(alloc_setGrowth(block, 1.0, 10));
+    TEST_ASSERT_TRUE(alloc_resize(block, 1));
+    checkSizes(block, 0, 10);
+    TEST_ASSERT_TRUE(alloc_resize(block, 11));
+    checkSizes(block, 0, 20);
+
+    // Shrinking is exact
+    TEST_ASSERT_TRUE(alloc_resize(block, 5));
+    checkSizes(block, 0, 5);
+
+    // Growth policy is kept by copies
+    TEST_ASSERT_TRUE(alloc_setGrowth(block, 3.0, 0));
+    AllocBlock *copy = alloc_copy(block);
+    TEST_ASSERT_TRUE(alloc_resize(copy, 6));
+    checkSizes(copy, 0, 15);
+
+    alloc_free(copy);
+    alloc_free(block);
+}
+
+void test_alloc_setShrink(void) {
+    int arr[] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_BUDDY);
+
+    // Invalid thresholds are rejected
+    TEST_ASSERT_FALSE(alloc_setShrink(NULL, 0.5));
+    TEST_ASSERT_FALSE(alloc_setShrink(block, -0.1));
+    TEST_ASSERT_FALSE(alloc_setShrink(block, 1.5));
+
+    // Only shrink when less than half of the block is used
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 0.5));
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    checkSizes(block, 5 * SI, 8 * SI);
+
+    // Push/pop around the power of two boundary does not resize
+    TEST_ASSERT_TRUE(alloc_remove(block, 4 * SI, SI));
+    checkSizes(block, 4 * SI, 8 * SI);
+    TEST_ASSERT_TRUE(alloc_append(block, &arr[4], SI));
+    checkSizes(block, 5 * SI, 8 * SI);
+    TEST_ASSERT_TRUE(alloc_remove(block, 4 * SI, SI));
+    checkSizes(block, 4 * SI, 8 * SI);
+
+    // Falling below the threshold shrinks
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, SI));
+    checkSizes(block, 3 * SI, 4 * SI);
+    int exp[] = { 20, 30, 40 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, (int*)alloc_getBlock(block), 3);
+
+    // Never shrink
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 0.0));
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, 3 * SI));
+    checkSizes(block, 0, 4 * SI);
+
+    alloc_free(block);
+
+    // By default, push/pop at a steady size keeps the slack of the first growth
+    AllocStrategy strats[] = { ALLOC_STRAT_DYNAMIC, ALLOC_STRAT_BUDDY, ALLOC_STRAT_GEOMETRIC };
+    int items[128] = { 0 };
+    mem_enableStats(true);
+    for (size_t i = 0; i < sizeof(strats) / sizeof(strats[0]); i++) {
+        block = alloc_new(0, strats[i]);
+        TEST_ASSERT_TRUE(alloc_append(block, items, sizeof(items)));
+        mem_resetStats();
+        for (int n = 0; n < 1000; n++) {
+            TEST_ASSERT_TRUE(alloc_append(block, &n, SI));
+            TEST_ASSERT_TRUE(alloc_remove(block, sizeof(items), SI));
+        }
+        TEST_ASSERT_TRUE(mem_getStats().reallocs <= 1);
+        alloc_free(block);
+    }
+    mem_enableStats(false);
+}
+
 void test_alloc_setStrat(void) {
     AllocBlock *block;
 
@@ -820,6 +1362,84 @@ void test_alloc_setStrat(void) {
     checkSizes(block, 0, 32); // Buddy strategy rounds up
 
     alloc_free(block);
+
+    // Changing to and from chunks keeps the data
+    int arr[] = { 10, 20, 30, 40, 50 };
+    block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_setChunkSize(block, 2 * SI));
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+
+    alloc_setStrat(block, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_EQUAL_INT(ALLOC_STRAT_CHUNKS, alloc_getStrat(block));
+    TEST_ASSERT_NULL(alloc_getBlock(block));
+    checkSizes(block, 5 * SI, 6 * SI);
+    checkInts(block, arr, 5);
+
+    alloc_setStrat(block, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_NOT_NULL(alloc_getBlock(block));
+    checkSizes(block, 5 * SI, 6 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, (int*)alloc_getBlock(block), 5);
+
+    alloc_free(block);
+}
+
+void test_alloc_shrinkToFit(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_setShrink(block, 0.0));
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, 2 * SI));
+    checkSizes(block, 3 * SI, 5 * SI);
+
+    // Shrinks to the exact used size
+    TEST_ASSERT_TRUE(alloc_shrinkToFit(block));
+    checkSizes(block, 3 * SI, 3 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[2], (int*)alloc_getBlock(block), 3);
+
+    // Shrinks to the size allowed by the strategy
+    alloc_setStrat(block, ALLOC_STRAT_BUDDY);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    checkSizes(block, 8 * SI, 8 * SI);
+    TEST_ASSERT_TRUE(alloc_remove(block, 0, 5 * SI));
+    checkSizes(block, 3 * SI, 8 * SI);
+    TEST_ASSERT_TRUE(alloc_shrinkToFit(block));
+    checkSizes(block, 3 * SI, 4 * SI);
+
+    TEST_ASSERT_FALSE(alloc_shrinkToFit(NULL));
+
+    alloc_free(block);
+}
+
+void test_alloc_span(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    size_t len;
+
+    // Contiguous blocks span to the end of the used memory
+    AllocBlock *block = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    TEST_ASSERT_EQUAL_PTR(alloc_index(block, SI), alloc_span(block, SI, &len));
+    TEST_ASSERT_EQUAL_INT(4 * SI, len);
+    TEST_ASSERT_NULL(alloc_span(block, 5 * SI, &len));
+    TEST_ASSERT_EQUAL_INT(0, len);
+    alloc_free(block);
+
+    // Chunked blocks span to the end of the chunk
+    block = newChunked();
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+    TEST_ASSERT_EQUAL_INT(10, *(int*)alloc_span(block, 0, &len));
+    TEST_ASSERT_EQUAL_INT(2 * SI, len);
+    TEST_ASSERT_EQUAL_INT(20, *(int*)alloc_span(block, SI, &len));
+    TEST_ASSERT_EQUAL_INT(SI, len);
+    TEST_ASSERT_EQUAL_INT(50, *(int*)alloc_span(block, 4 * SI, &len));
+    TEST_ASSERT_EQUAL_INT(SI, len);
+
+    // Reading across chunks
+    int out[3];
+    TEST_ASSERT_TRUE(alloc_read(block, out, SI, 3 * SI));
+    TEST_ASSERT_EQUAL_INT_ARRAY(&arr[1], out, 3);
+    TEST_ASSERT_FALSE(alloc_read(block, out, 3 * SI, 3 * SI));
+
+    alloc_free(block);
 }
 
 void test_alloc_split_stratBuddy(void) {
@@ -966,28 +1586,72 @@ void test_alloc_split_stratDynamic(void) {
     alloc_free(block);
 }
 
+void test_alloc_split_stratChunks(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    AllocBlock *block = newChunked();
+    TEST_ASSERT_TRUE(alloc_append(block, arr, 5 * SI));
+
+    // Copies keep the chunk size
+    AllocBlock *copy = alloc_copy(block);
+    checkSizes(copy, 5 * SI, 6 * SI);
+    TEST_ASSERT_EQUAL_INT(2 * SI, alloc_getChunkSize(copy));
+    checkInts(copy, arr, 5);
+    alloc_free(copy);
+
+    // Split in the middle of a chunk
+    AllocBlock *leftBlock = NULL;
+    AllocBlock *rightBlock = NULL;
+    TEST_ASSERT_TRUE(alloc_split(block, &leftBlock, &rightBlock, 3 * SI));
+
+    checkSizes(leftBlock, 3 * SI, 4 * SI);
+    checkInts(leftBlock, arr, 3);
+    checkSizes(rightBlock, 2 * SI, 2 * SI);
+    checkInts(rightBlock, &arr[3], 2);
+    TEST_ASSERT_EQUAL_INT(ALLOC_STRAT_CHUNKS, alloc_getStrat(rightBlock));
+
+    alloc_free(leftBlock);
+    alloc_free(rightBlock);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(test_alloc_append_stratBuddy);
+    RUN_TEST(test_alloc_append_stratChunks);
     RUN_TEST(test_alloc_append_stratDynamic);
+    RUN_TEST(test_alloc_append_stratGeometric);
     RUN_TEST(test_alloc_clear_stratBuddy);
     RUN_TEST(test_alloc_clear_stratDynamic);
     RUN_TEST(test_alloc_copy_stratBuddy);
     RUN_TEST(test_alloc_copy_stratDynamic);
+    RUN_TEST(test_alloc_detach);
     RUN_TEST(test_alloc_index);
     RUN_TEST(test_alloc_insert_stratBuddy);
+    RUN_TEST(test_alloc_insert_stratChunks);
     RUN_TEST(test_alloc_insert_stratDynamic);
+    RUN_TEST(test_alloc_insertSpace);
+    RUN_TEST(test_alloc_move);
     RUN_TEST(test_alloc_new_stratBuddy);
     RUN_TEST(test_alloc_new_stratDynamic);
+    RUN_TEST(test_alloc_newBuddy);
+    RUN_TEST(test_alloc_newIn);
+    RUN_TEST(test_alloc_newWith);
     RUN_TEST(test_alloc_remove_stratBuddy);
+    RUN_TEST(test_alloc_remove_stratChunks);
     RUN_TEST(test_alloc_remove_stratDynamic);
     RUN_TEST(test_alloc_resize_stratBuddy);
     RUN_TEST(test_alloc_resize_stratDynamic);
     RUN_TEST(test_alloc_setAt_stratBuddy);
     RUN_TEST(test_alloc_setAt_stratDynamic);
+    RUN_TEST(test_alloc_setChunkItem);
+    RUN_TEST(test_alloc_setChunkSize);
+    RUN_TEST(test_alloc_setGrowth);
+    RUN_TEST(test_alloc_setShrink);
     RUN_TEST(test_alloc_setStrat);
+    RUN_TEST(test_alloc_shrinkToFit);
+    RUN_TEST(test_alloc_span);
     RUN_TEST(test_alloc_split_stratBuddy);
+    RUN_TEST(test_alloc_split_stratChunks);
     RUN_TEST(test_alloc_split_stratDynamic);
 
     return UNITY_END();
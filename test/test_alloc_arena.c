@@ -0,0 +1,135 @@
+/*
+    File        : test_alloc_arena.c
+    Description : Arena (bump pointer) allocator with save/restore marks and bulk reset.
+*/
+
+#include <stdint.h>
+
+#include "alloc_arena.h"
+#include "unity.h"
+
+#define isAligned(p) (((uintptr_t)(p) % ARENA_ALIGN) == 0)
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_arena_alloc(void) {
+    Arena *a = arena_new(256);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_INT(0, arena_used(a));
+
+    // Zero size and NULL arena
+    TEST_ASSERT_NULL(arena_alloc(a, 0));
+    TEST_ASSERT_NULL(arena_alloc(NULL, 8));
+
+    // Allocations are aligned and consecutive
+    char *p1 = (char*)arena_alloc(a, 1);
+    char *p2 = (char*)arena_alloc(a, 10);
+    TEST_ASSERT_NOT_NULL(p1);
+    TEST_ASSERT_NOT_NULL(p2);
+    TEST_ASSERT_TRUE(isAligned(p1));
+    TEST_ASSERT_TRUE(isAligned(p2));
+    TEST_ASSERT_EQUAL_PTR(p1 + ARENA_ALIGN, p2);
+    TEST_ASSERT_EQUAL_INT(2 * ARENA_ALIGN, arena_used(a));
+
+    // Memory is usable
+    memset(p2, 'x', 10);
+    TEST_ASSERT_EQUAL_CHAR('x', p2[9]);
+
+    // Allocations larger than a region get their own region
+    char *big = (char*)arena_alloc(a, 1000);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 0, 1000);
+    TEST_ASSERT_TRUE(arena_used(a) >= 1000 + 2 * ARENA_ALIGN);
+
+    // Overflow
+    TEST_ASSERT_NULL(arena_alloc(a, SIZE_MAX));
+
+    arena_free(a);
+}
+
+void test_arena_realloc(void) {
+    Arena *a = arena_new(256);
+
+    // Most recent allocation grows in place
+    int *p = (int*)arena_alloc(a, 4 * sizeof(int));
+    for (int i = 0; i < 4; i++) p[i] = i;
+    int *q = (int*)arena_realloc(a, p, 4 * sizeof(int), 8 * sizeof(int));
+    TEST_ASSERT_EQUAL_PTR(p, q);
+
+    // Older allocations are copied
+    int *other = (int*)arena_alloc(a, sizeof(int));
+    TEST_ASSERT_NOT_NULL(other);
+    q = (int*)arena_realloc(a, p, 8 * sizeof(int), 16 * sizeof(int));
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_TRUE(q != p);
+    int exp[] = { 0, 1, 2, 3 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, q, 4);
+
+    // Growing beyond the region copies into a new region
+    int *r = (int*)arena_realloc(a, q, 16 * sizeof(int), 1024 * sizeof(int));
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, r, 4);
+
+    // NULL pointer allocates, zero size returns NULL
+    TEST_ASSERT_NOT_NULL(arena_realloc(a, NULL, 0, 8));
+    TEST_ASSERT_NULL(arena_realloc(a, r, 1024 * sizeof(int), 0));
+
+    arena_free(a);
+}
+
+void test_arena_reset(void) {
+    Arena *a = arena_new(128);
+
+    void *first = arena_alloc(a, 16);
+    for (int i = 0; i < 100; i++) TEST_ASSERT_NOT_NULL(arena_alloc(a, 64));
+    TEST_ASSERT_TRUE(arena_used(a) >= 100 * 64);
+
+    // Reset releases everything at once and memory is reused
+    arena_reset(a);
+    TEST_ASSERT_EQUAL_INT(0, arena_used(a));
+    TEST_ASSERT_EQUAL_PTR(first, arena_alloc(a, 16));
+
+    // Regions are reused after reset
+    for (int i = 0; i < 100; i++) TEST_ASSERT_NOT_NULL(arena_alloc(a, 64));
+
+    arena_reset(NULL);
+    arena_free(a);
+}
+
+void test_arena_restore(void) {
+    Arena *a = arena_new(128);
+
+    arena_alloc(a, 16);
+    ArenaMark outer = arena_save(a);
+    size_t outerUsed = arena_used(a);
+
+    void *p1 = arena_alloc(a, 100);
+    ArenaMark inner = arena_save(a);
+    size_t innerUsed = arena_used(a);
+
+    // Allocate across several regions
+    for (int i = 0; i < 10; i++) TEST_ASSERT_NOT_NULL(arena_alloc(a, 100));
+
+    // Restore the inner mark
+    arena_restore(a, inner);
+    TEST_ASSERT_EQUAL_INT(innerUsed, arena_used(a));
+
+    // Restore the outer mark
+    arena_restore(a, outer);
+    TEST_ASSERT_EQUAL_INT(outerUsed, arena_used(a));
+    TEST_ASSERT_EQUAL_PTR(p1, arena_alloc(a, 100));
+
+    arena_free(a);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arena_alloc);
+    RUN_TEST(test_arena_realloc);
+    RUN_TEST(test_arena_reset);
+    RUN_TEST(test_arena_restore);
+
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/*
+    File        : test_alloc_buddy.c
+    Description : Buddy system allocator over a pre-reserved region, with per-order free lists,
+                  buddy coalescing, in-place growth and fragmentation statistics.
+*/
+
+#include <stdint.h>
+
+#include "alloc_buddy.h"
+#include "unity.h"
+
+#define checkStats(h, expUsed, expAllocs, expFreeBlocks) do { \
+    BuddyStats s = buddy_stats(h); \
+    TEST_ASSERT_EQUAL_INT(expUsed, s.used); \
+    TEST_ASSERT_EQUAL_INT(s.total - (expUsed), s.free); \
+    TEST_ASSERT_EQUAL_INT(expAllocs, s.allocations); \
+    TEST_ASSERT_EQUAL_INT(expFreeBlocks, s.freeBlocks); \
+} while (0)
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_buddy_alloc(void) {
+    Buddy *h = buddy_new(1024, 64);
+    TEST_ASSERT_NOT_NULL(h);
+    checkStats(h, 0, 0, 1);
+
+    // Zero size, NULL heap and sizes larger than the region
+    TEST_ASSERT_NULL(buddy_alloc(h, 0));
+    TEST_ASSERT_NULL(buddy_alloc(NULL, 8));
+    TEST_ASSERT_NULL(buddy_alloc(h, 1025));
+    TEST_ASSERT_NULL(buddy_alloc(h, SIZE_MAX));
+
+    // Requests are rounded to a power of 2, at least the minimum block
+    char *p1 = (char*)buddy_alloc(h, 1);
+    TEST_ASSERT_NOT_NULL(p1);
+    TEST_ASSERT_EQUAL_INT(64, buddy_blockSize(h, p1));
+    checkStats(h, 64, 1, 4); // 64 + 128 + 256 + 512 free
+
+    // The buddy of the first block is handed out next
+    char *p2 = (char*)buddy_alloc(h, 60);
+    TEST_ASSERT_EQUAL_PTR(p1 + 64, p2);
+
+    char *p3 = (char*)buddy_alloc(h, 200);
+    TEST_ASSERT_EQUAL_INT(256, buddy_blockSize(h, p3));
+    TEST_ASSERT_EQUAL_INT(0, (size_t)(p3 - p1) % 256);
+    checkStats(h, 384, 3, 2); // 128 + 512 free
+
+    // Memory is usable
+    memset(p3, 'x', 256);
+    TEST_ASSERT_EQUAL_CHAR('x', p3[255]);
+
+    // Exhaust the heap
+    TEST_ASSERT_NOT_NULL(buddy_alloc(h, 512));
+    TEST_ASSERT_NOT_NULL(buddy_alloc(h, 128));
+    TEST_ASSERT_NULL(buddy_alloc(h, 1));
+    checkStats(h, 1024, 5, 0);
+
+    // Pointers not allocated from the heap
+    int x;
+    TEST_ASSERT_EQUAL_INT(0, buddy_blockSize(h, &x));
+    TEST_ASSERT_EQUAL_INT(0, buddy_blockSize(h, p1 + 1));
+
+    buddy_free(h);
+}
+
+void test_buddy_new(void) {
+    // Sizes are rounded up to powers of 2
+    Buddy *h = buddy_new(1000, 50);
+    TEST_ASSERT_NOT_NULL(h);
+    TEST_ASSERT_EQUAL_INT(1024, buddy_stats(h).total);
+    TEST_ASSERT_EQUAL_INT(64, buddy_blockSize(h, buddy_alloc(h, 1)));
+    buddy_free(h);
+
+    // Defaults
+    h = buddy_new(0, 0);
+    TEST_ASSERT_EQUAL_INT(BUDDY_HEAP_SIZE, buddy_stats(h).total);
+    TEST_ASSERT_EQUAL_INT(BUDDY_MIN_BLOCK, buddy_blockSize(h, buddy_alloc(h, 1)));
+    buddy_free(h);
+
+    // Minimum block larger than the region, and overflow
+    TEST_ASSERT_NULL(buddy_new(64, 128));
+    TEST_ASSERT_NULL(buddy_new(SIZE_MAX, 0));
+
+    buddy_free(NULL);
+}
+
+void test_buddy_realloc(void) {
+    Buddy *h = buddy_new(1024, 64);
+
+    // Grows in place while the following buddies are free
+    int *p = (int*)buddy_alloc(h, 64);
+    for (int i = 0; i < 16; i++) p[i] = i;
+    TEST_ASSERT_EQUAL_PTR(p, buddy_realloc(h, p, 64, 200));
+    TEST_ASSERT_EQUAL_INT(256, buddy_blockSize(h, p));
+    checkStats(h, 256, 1, 2);
+
+    // Shrinks in place, freeing the upper halves
+    TEST_ASSERT_EQUAL_PTR(p, buddy_realloc(h, p, 256, 64));
+    TEST_ASSERT_EQUAL_INT(64, buddy_blockSize(h, p));
+    checkStats(h, 64, 1, 4);
+
+    // Moves when the buddy is taken
+    int *blocker = (int*)buddy_alloc(h, 64);
+    TEST_ASSERT_EQUAL_PTR((char*)p + 64, blocker);
+    int *q = (int*)buddy_realloc(h, p, 64, 128);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_TRUE(q != p);
+    int exp[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, q, 16);
+    checkStats(h, 192, 2, 3); // 64 + 256 + 512 free
+    
+    // Failure leaves the memory untouched
+    TEST_ASSERT_NULL(buddy_realloc(h, q, 128, 2048));
+    TEST_ASSERT_NULL(buddy_realloc(h, q, 128, 0));
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, q, 16);
+
+    // NULL pointer allocates
+    TEST_ASSERT_NOT_NULL(buddy_realloc(h, NULL, 0, 8));
+
+    buddy_free(h);
+}
+
+void test_buddy_release(void) {
+    Buddy *h = buddy_new(1024, 64);
+
+    void *ps[16];
+    for (int i = 0; i < 16; i++) ps[i] = buddy_alloc(h, 64);
+    checkStats(h, 1024, 16, 0);
+
+    // Releasing every other block cannot coalesce
+    for (int i = 0; i < 16; i += 2) buddy_release(h, ps[i]);
+    checkStats(h, 512, 8, 8);
+    BuddyStats s = buddy_stats(h);
+    TEST_ASSERT_EQUAL_INT(64, s.largestFree);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 1.0 - 64.0 / 512.0, s.fragmentation);
+
+    // 512 bytes are free but not contiguous
+    TEST_ASSERT_NULL(buddy_alloc(h, 128));
+
+    // Releasing the rest coalesces back to the whole region
+    for (int i = 1; i < 16; i += 2) buddy_release(h, ps[i]);
+    checkStats(h, 0, 0, 1);
+    s = buddy_stats(h);
+    TEST_ASSERT_EQUAL_INT(1024, s.largestFree);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 0.0, s.fragmentation);
+    TEST_ASSERT_EQUAL_PTR(ps[0], buddy_alloc(h, 1024));
+
+    // NULL and foreign pointers are ignored
+    int x;
+    buddy_release(h, NULL);
+    buddy_release(h, &x);
+    buddy_release(NULL, ps[0]);
+    checkStats(h, 1024, 1, 0);
+
+    buddy_free(h);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_buddy_alloc);
+    RUN_TEST(test_buddy_new);
+    RUN_TEST(test_buddy_realloc);
+    RUN_TEST(test_buddy_release);
+
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*
+    File        : test_alloc_flex.c
+    Description : Single allocation memory block with the header and data stored together. 
+                  Functions that may grow the block return its (possibly moved) new address.
+*/
+
+#include "alloc_flex.h"
+#include "unity.h"
+
+#define SI sizeof(int)
+
+#define checkSizes(f, used, size) { \
+    TEST_ASSERT_NOT_NULL(f); \
+    TEST_ASSERT_EQUAL_INT(used, flex_getUsed(f)); \
+    TEST_ASSERT_EQUAL_INT(size, flex_getSize(f)); \
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_flex_append(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+
+    FlexBlock *f = flex_new(0, ALLOC_STRAT_BUDDY);
+    checkSizes(f, 0, 0);
+    TEST_ASSERT_NULL(flex_index(f, 0));
+
+    f = flex_append(f, arr, SI);
+    checkSizes(f, SI, SI);
+    TEST_ASSERT_EQUAL_INT(10, *(int*)flex_index(f, 0));
+
+    f = flex_append(f, &arr[1], 4 * SI);
+    checkSizes(f, 5 * SI, 8 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, (int*)flex_index(f, 0), 5);
+
+    // Failures leave the block untouched
+    TEST_ASSERT_NULL(flex_append(f, NULL, SI));
+    TEST_ASSERT_NULL(flex_append(f, arr, 0));
+    TEST_ASSERT_NULL(flex_append(NULL, arr, SI));
+    checkSizes(f, 5 * SI, 8 * SI);
+
+    flex_free(f);
+
+    // Geometric growth
+    f = flex_new(0, ALLOC_STRAT_GEOMETRIC);
+    for (int i = 0; i < 100; i++) f = flex_append(f, &i, SI);
+    checkSizes(f, 100 * SI, flex_getSize(f));
+    TEST_ASSERT_TRUE(flex_getSize(f) >= 100 * SI);
+    for (int i = 0; i < 100; i++) TEST_ASSERT_EQUAL_INT(i, *(int*)flex_index(f, i * SI));
+    flex_free(f);
+}
+
+void test_flex_insert(void) {
+    int arr[] = { 10, 20, 30 };
+    FlexBlock *f = flex_new(3 * SI, ALLOC_STRAT_DYNAMIC);
+    f = flex_append(f, arr, 3 * SI);
+
+    int i = 15;
+    f = flex_insert(f, &i, SI, SI);
+    checkSizes(f, 4 * SI, 4 * SI);
+    int exp1[] = { 10, 15, 20, 30 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp1, (int*)flex_index(f, 0), 4);
+
+    i = 5;
+    f = flex_insert(f, &i, 0, SI);
+    int exp2[] = { 5, 10, 15, 20, 30 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp2, (int*)flex_index(f, 0), 5);
+
+    // Out of bounds
+    TEST_ASSERT_NULL(flex_insert(f, &i, 6 * SI, SI));
+    checkSizes(f, 5 * SI, 5 * SI);
+
+    flex_free(f);
+}
+
+void test_flex_new(void) {
+    FlexBlock *f = flex_new(10, ALLOC_STRAT_BUDDY);
+    checkSizes(f, 0, 16);
+    flex_free(f);
+
+    f = flex_new(10, ALLOC_STRAT_GEOMETRIC);
+    checkSizes(f, 0, 10);
+    flex_free(f);
+
+    f = flex_new(10, ALLOC_STRAT_DYNAMIC);
+    checkSizes(f, 0, 10);
+
+    // Data is aligned
+    TEST_ASSERT_EQUAL_INT(0, (size_t)f->data % _Alignof(max_align_t));
+    flex_free(f);
+
+    // Unsupported strategies and sizes
+    TEST_ASSERT_NULL(flex_new(10, ALLOC_STRAT_CHUNKS));
+    TEST_ASSERT_NULL(flex_new(10, _ALLOC_STRAT_MAX));
+    TEST_ASSERT_NULL(flex_new(SIZE_MAX, ALLOC_STRAT_DYNAMIC));
+    TEST_ASSERT_NULL(flex_new(SIZE_MAX, ALLOC_STRAT_BUDDY));
+}
+
+static void *countingRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    *(size_t*)ctx += newSize - oldSize;
+    return realloc(p, newSize);
+}
+
+static void *countingAlloc(void *ctx, size_t size) { return countingRealloc(ctx, NULL, 0, size); }
+
+static void countingFree(void *ctx, void *p, size_t size) {
+    if (p != NULL) *(size_t*)ctx -= size;
+    free(p);
+}
+
+void test_flex_newWith(void) {
+    // All memory goes through the allocator, with the sizes it was taken with
+    size_t live = 0;
+    Allocator counting = { countingAlloc, countingRealloc, countingFree, &live };
+    FlexBlock *f = flex_newWith(&counting, 10, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(sizeof(FlexBlock) + 10, live);
+    int arr[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    f = flex_append(f, arr, sizeof(arr));
+    TEST_ASSERT_EQUAL_INT(sizeof(FlexBlock) + sizeof(arr), live);
+    TEST_ASSERT_EQUAL_PTR(&counting, f->allocator);
+    flex_free(f);
+    TEST_ASSERT_EQUAL_INT(0, live);
+
+    // The default allocator when none is given
+    mem_setAllocator(&counting);
+    f = flex_new(0, ALLOC_STRAT_GEOMETRIC);
+    mem_setAllocator(NULL);
+    TEST_ASSERT_EQUAL_INT(sizeof(FlexBlock), live);
+    f = flex_append(f, arr, sizeof(arr));
+    TEST_ASSERT_EQUAL_INT(sizeof(FlexBlock) + ALLOC_GROWTH_MIN, live);
+    flex_free(f);
+    TEST_ASSERT_EQUAL_INT(0, live);
+}
+
+void test_flex_remove(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    FlexBlock *f = flex_new(0, ALLOC_STRAT_DYNAMIC);
+    f = flex_append(f, arr, 5 * SI);
+
+    // Removing never reallocates
+    TEST_ASSERT_TRUE(flex_remove(f, SI, 2 * SI));
+    checkSizes(f, 3 * SI, 5 * SI);
+    int exp[] = { 10, 40, 50 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, (int*)flex_index(f, 0), 3);
+
+    // Out of bounds
+    TEST_ASSERT_FALSE(flex_remove(f, 3 * SI, SI));
+    TEST_ASSERT_FALSE(flex_remove(f, 0, 4 * SI));
+    TEST_ASSERT_FALSE(flex_remove(f, 0, 0));
+
+    // Shrink releases the memory
+    f = flex_shrinkToFit(f);
+    checkSizes(f, 3 * SI, 3 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, (int*)flex_index(f, 0), 3);
+
+    flex_clear(f);
+    checkSizes(f, 0, 3 * SI);
+
+    flex_free(f);
+}
+
+void test_flex_resize(void) {
+    int arr[] = { 10, 20, 30, 40, 50 };
+    FlexBlock *f = flex_new(0, ALLOC_STRAT_BUDDY);
+
+    f = flex_resize(f, 20);
+    checkSizes(f, 0, 32);
+
+    // Truncate data
+    f = flex_append(f, arr, 5 * SI);
+    f = flex_resize(f, 2 * SI);
+    checkSizes(f, 2 * SI, 2 * SI);
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, (int*)flex_index(f, 0), 2);
+
+    // Overflow
+    TEST_ASSERT_NULL(flex_resize(f, SIZE_MAX));
+    checkSizes(f, 2 * SI, 2 * SI);
+
+    flex_free(f);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_flex_append);
+    RUN_TEST(test_flex_insert);
+    RUN_TEST(test_flex_new);
+    RUN_TEST(test_flex_newWith);
+    RUN_TEST(test_flex_remove);
+    RUN_TEST(test_flex_resize);
+
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+/*
+    File        : test_alloc_pool.c
+    Description : Pool (slab) allocator for fixed size objects with free list recycling, and 
+                  per-thread pools for small objects.
+*/
+
+#include <pthread.h>
+#include <string.h>
+
+#include "alloc_pool.h"
+#include "mem.h"
+#include "unity.h"
+
+#define OBJECTS 200
+#define REMOTE_OBJECTS 1000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_pool_alloc(void) {
+    Pool *p = pool_new(24, 8);
+    TEST_ASSERT_NOT_NULL(p);
+
+    // Invalid pools
+    TEST_ASSERT_NULL(pool_new(0, 8));
+    TEST_ASSERT_NULL(pool_alloc(NULL));
+
+    // Allocate across several slabs, all objects are distinct and usable
+    char *objs[OBJECTS];
+    for (int i = 0; i < OBJECTS; i++) {
+        objs[i] = (char*)pool_alloc(p);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+        memset(objs[i], i, 24);
+    }
+    for (int i = 0; i < OBJECTS; i++) {
+        TEST_ASSERT_EQUAL_CHAR((char)i, objs[i][0]);
+        TEST_ASSERT_EQUAL_CHAR((char)i, objs[i][23]);
+    }
+
+    pool_free(p);
+
+    // Objects smaller than a pointer
+    Pool small;
+    TEST_ASSERT_TRUE(pool_init(&small, 1, 0));
+    char *c1 = (char*)pool_alloc(&small);
+    char *c2 = (char*)pool_alloc(&small);
+    TEST_ASSERT_TRUE(c2 - c1 >= (int)sizeof(void*) || c1 - c2 >= (int)sizeof(void*));
+    pool_destroy(&small);
+
+    // Slabs are counted by the memory statistics
+    mem_enableStats(true);
+    size_t live = mem_getStats().liveBytes;
+    Pool counted;
+    TEST_ASSERT_TRUE(pool_init(&counted, 32, 8));
+    TEST_ASSERT_NOT_NULL(pool_alloc(&counted));
+    TEST_ASSERT_TRUE(mem_getStats().liveBytes >= live + 8 * 32);
+    pool_destroy(&counted);
+    TEST_ASSERT_EQUAL_size_t(live, mem_getStats().liveBytes);
+    mem_enableStats(false);
+}
+
+void test_pool_release(void) {
+    Pool *p = pool_new(32, 4);
+
+    // Released objects are recycled (last in, first out)
+    void *a = pool_alloc(p);
+    void *b = pool_alloc(p);
+    pool_release(p, a);
+    pool_release(p, b);
+    TEST_ASSERT_EQUAL_PTR(b, pool_alloc(p));
+    TEST_ASSERT_EQUAL_PTR(a, pool_alloc(p));
+
+    // Release all and reallocate without new slabs
+    void *objs[OBJECTS];
+    for (int i = 0; i < OBJECTS; i++) objs[i] = pool_alloc(p);
+    PoolSlab *slabs = p->slabs;
+    for (int i = 0; i < OBJECTS; i++) pool_release(p, objs[i]);
+    for (int i = 0; i < OBJECTS; i++) objs[i] = pool_alloc(p);
+    TEST_ASSERT_EQUAL_PTR(slabs, p->slabs);
+
+    pool_release(p, NULL);
+    pool_free(p);
+}
+
+static void *allocInThread(void *arg) {
+    void **objs = (void**)arg;
+    for (int i = 0; i < OBJECTS; i++) {
+        objs[i] = pool_allocSmall(40);
+        memset(objs[i], 0xAB, 40);
+    }
+    return NULL;
+}
+
+static void *releaseInThread(void *arg) {
+    void **objs = (void**)arg;
+    for (int i = 0; i < REMOTE_OBJECTS; i++) pool_releaseSmall(objs[i], 200);
+    return NULL;
+}
+
+static pthread_key_t lateKey;
+static void *lateObj;
+
+// TLS destructor running after the small object pools of the thread were retired
+static void releaseLate(void *arg) {
+    (void)arg;
+    lateObj = pool_allocSmall(100);
+    pool_releaseSmall(lateObj, 100);
+}
+
+static void *allocLate(void *arg) {
+    pool_releaseSmall(pool_allocSmall(100), 100);
+    pthread_setspecific(lateKey, arg);
+    return NULL;
+}
+
+static void *allocOne(void *arg) {
+    *(void**)arg = pool_allocSmall(100);
+    return NULL;
+}
+
+void test_pool_allocSmall(void) {
+    // Zero and large sizes
+    TEST_ASSERT_NULL(pool_allocSmall(0));
+    void *big = pool_allocSmall(POOL_SMALL_MAX + 1);
+    TEST_ASSERT_NOT_NULL(big);
+    pool_releaseSmall(big, POOL_SMALL_MAX + 1);
+
+    // Objects of the same size class are recycled
+    void *a = pool_allocSmall(20);
+    pool_releaseSmall(a, 20);
+    TEST_ASSERT_EQUAL_PTR(a, pool_allocSmall(30));
+    pool_releaseSmall(a, 30);
+
+    // Objects allocated by another (exited) thread remain valid and can be released here
+    void *objs[OBJECTS];
+    pthread_t t;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, allocInThread, objs));
+    pthread_join(t, NULL);
+    for (int i = 0; i < OBJECTS; i++) {
+        TEST_ASSERT_EQUAL_HEX8(0xAB, ((unsigned char*)objs[i])[39]);
+        pool_releaseSmall(objs[i], 40);
+    }
+
+    // Objects released by another thread come back through the depot instead of new slabs
+    static void *remote[REMOTE_OBJECTS], *again[REMOTE_OBJECTS];
+    for (int i = 0; i < REMOTE_OBJECTS; i++) remote[i] = pool_allocSmall(200);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, releaseInThread, remote));
+    pthread_join(t, NULL);
+    int reused = 0;
+    for (int i = 0; i < REMOTE_OBJECTS; i++) {
+        again[i] = pool_allocSmall(200);
+        for (int j = 0; j < REMOTE_OBJECTS; j++) reused += again[i] == remote[j];
+    }
+    TEST_ASSERT_TRUE(reused >= REMOTE_OBJECTS - POOL_SMALL_CACHED - POOL_SMALL_BATCH);
+    for (int i = 0; i < REMOTE_OBJECTS; i++) pool_releaseSmall(again[i], 200);
+
+    // Objects released by a thread after its pools were retired go to the next new thread
+    TEST_ASSERT_EQUAL_INT(0, pthread_key_create(&lateKey, releaseLate));
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, allocLate, &lateKey));
+    pthread_join(t, NULL);
+    TEST_ASSERT_NOT_NULL(lateObj);
+    void *adopted = NULL;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, allocOne, &adopted));
+    pthread_join(t, NULL);
+    TEST_ASSERT_EQUAL_PTR(lateObj, adopted);
+    pool_releaseSmall(adopted, 100);
+    pthread_key_delete(lateKey);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pool_alloc);
+    RUN_TEST(test_pool_release);
+    RUN_TEST(test_pool_allocSmall);
+
+    return UNITY_END();
+}
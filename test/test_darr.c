@@ -4,6 +4,8 @@
     Description : Dynamic Array Library for managing and resizing arrays of any single type.
 */
 
+#include <string.h>
+
 #include "darr.h"
 #include "unity.h"
 
@@ -207,6 +209,33 @@ void test_darr_index(void) {
 
     darr_free(darr);
     darr_free(emptyDarr);
+
+    // Chunked items never straddle two chunks, whatever their size
+    typedef struct { int a, b, c; } Item;
+    const size_t sizes[] = { 3, sizeof(Item) };
+    for (size_t s = 0; s < 2; s++) {
+        size_t is = sizes[s];
+        darr = darr_new(0, is, ALLOC_STRAT_CHUNKS);
+        TEST_ASSERT_TRUE(alloc_setChunkSize(darr->block, 16));
+        unsigned char items[64 * sizeof(Item)];
+        for (size_t i = 0; i < sizeof(items); i++) items[i] = (unsigned char)i;
+        TEST_ASSERT_TRUE(darr_append(darr, items, 64));
+        for (size_t i = 0; i < 64; i++)
+            TEST_ASSERT_EQUAL_MEMORY(items + i * is, darr_index(darr, i), is);
+
+        // Inserts and removes shift items across chunks
+        TEST_ASSERT_TRUE(darr_remove(darr, 1, 9));
+        TEST_ASSERT_TRUE(darr_insert(darr, items + is, 1, 9));
+        for (size_t i = 0; i < 64; i++)
+            TEST_ASSERT_EQUAL_MEMORY(items + i * is, darr_index(darr, i), is);
+        darr_free(darr);
+    }
+
+    // Items larger than the default chunk get larger chunks
+    darr = darr_new(2, ALLOC_CHUNK_SIZE + 1, ALLOC_STRAT_CHUNKS);
+    TEST_ASSERT_NOT_NULL(darr);
+    TEST_ASSERT_EQUAL_INT(2 * ALLOC_CHUNK_SIZE, alloc_getChunkSize(darr->block));
+    darr_free(darr);
 }
 
 void test_darr_insert(void) {
@@ -317,6 +346,35 @@ void test_darr_new(void) {
     darr_free(darr);
 }
 
+void test_darr_newIn(void) {
+    Arena *a = arena_new(0);
+    int data[] = { 1, 2, 3, 4, 5, 6 };
+
+    for (int n = 0; n < 100; n++) {
+        DArr *darr = darr_newIn(a, 2, SI, ALLOC_STRAT_GEOMETRIC);
+        TEST_ASSERT_NOT_NULL(darr);
+        TEST_ASSERT_EQUAL_PTR(arena_allocator(a), alloc_getAllocator(darr->block));
+        TEST_ASSERT_TRUE(darr_append(darr, data, 6));
+        checkValues(darr, data, 6);
+
+        DArr *copy = darr_copy(darr);
+        checkValues(copy, data, 6);
+
+        DArr *left, *right;
+        TEST_ASSERT_TRUE(darr_split(copy, &left, &right, 3));
+        checkValues(right, (&data[3]), 3);
+        darr_free(left);
+        darr_free(right);
+        darr_free(darr);
+    }
+
+    // Everything is released with a single reset
+    arena_reset(a);
+    TEST_ASSERT_EQUAL_INT(0, arena_used(a));
+
+    arena_free(a);
+}
+
 void test_darr_remove(void) {
     DArr *darr = darr_new(10, SI, ALLOC_STRAT_DYNAMIC);
     TEST_ASSERT_NOT_NULL(darr);
@@ -434,6 +492,119 @@ void test_darr_setAt(void) {
     darr_free(darr);
 }
 
+/**
+ * @brief Check the items of a DArr against a plain array.
+ */
+static void checkGap(DArr *d, const int *exp, size_t n) {
+    TEST_ASSERT_EQUAL_INT(n, darr_len(d));
+    for (size_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_INT(exp[i], *(int*)darr_index(d, i));
+    TEST_ASSERT_NULL(darr_index(d, n));
+}
+
+void test_darr_setGap(void) {
+    const AllocStrategy strats[] = { ALLOC_STRAT_DYNAMIC, ALLOC_STRAT_GEOMETRIC, ALLOC_STRAT_CHUNKS };
+    for (size_t s = 0; s < sizeof(strats) / sizeof(strats[0]); s++) {
+        DArr *darr = darr_new(0, SI, strats[s]);
+        TEST_ASSERT_NOT_NULL(darr);
+        if (strats[s] == ALLOC_STRAT_CHUNKS) TEST_ASSERT_TRUE(alloc_setChunkSize(darr->block, 64));
+        TEST_ASSERT_TRUE(darr_setGap(darr, true));
+
+        // Edits around a cursor that sometimes jumps, mirrored in a plain array
+        int exp[4096];
+        size_t n = 0, cursor = 0;
+        unsigned seed = 1;
+        for (int op = 0; op < 3000; op++) {
+            seed = seed * 1103515245 + 12345;
+            unsigned r = (seed >> 16) % 100;
+            if (r < 5) {
+                cursor = n > 0 ? (seed >> 4) % (n + 1) : 0; // Jump
+            } else if (r < 70 && n + 3 < sizeof(exp) / SI) {
+                int items[] = { op, -op, op * 3 };
+                size_t count = r % 3 + 1;
+                TEST_ASSERT_TRUE(darr_insert(darr, items, cursor, count));
+                memmove(exp + cursor + count, exp + cursor, (n - cursor) * SI);
+                memcpy(exp + cursor, items, count * SI);
+                n += count;
+                cursor += count;
+            } else if (r < 90 && cursor > 0) {
+                TEST_ASSERT_TRUE(darr_remove(darr, cursor - 1, 1)); // Backspace
+                memmove(exp + cursor - 1, exp + cursor, (n - cursor) * SI);
+                n--;
+                cursor--;
+            } else if (n >= 4) {
+                // Overwrite across the cursor
+                size_t idx = cursor >= 2 ? cursor - 2 : 0;
+                if (idx + 4 > n) idx = n - 4;
+                int items[] = { 7, 8, 9, 10 };
+                TEST_ASSERT_TRUE(darr_setAt(darr, items, idx, 4));
+                memcpy(exp + idx, items, sizeof(items));
+            }
+            if (op % 100 == 0) checkGap(darr, exp, n);
+        }
+        checkGap(darr, exp, n);
+        TEST_ASSERT_TRUE(darr_size(darr) >= n);
+
+        // Copies and splits keep the items and the mode
+        DArr *copy = darr_copy(darr);
+        checkGap(copy, exp, n);
+        DArr *left, *right;
+        TEST_ASSERT_TRUE(darr_split(copy, &left, &right, n / 2));
+        checkGap(left, exp, n / 2);
+        checkGap(right, exp + n / 2, n - n / 2);
+        TEST_ASSERT_TRUE(left->gapMode && right->gapMode);
+        darr_free(left);
+        darr_free(right);
+
+        // Leaving the mode makes the items contiguous again
+        TEST_ASSERT_TRUE(darr_setGap(darr, false));
+        TEST_ASSERT_EQUAL_INT(0, darr->gapLen);
+        checkGap(darr, exp, n);
+        if (strats[s] != ALLOC_STRAT_CHUNKS)
+            TEST_ASSERT_EQUAL_INT_ARRAY(exp, (int*)darr_first(darr), n);
+        darr_free(darr);
+    }
+
+    // Resizes and clears drop the gap
+    DArr *darr = darr_new(0, SI, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_TRUE(darr_setGap(darr, true));
+    int data[] = { 1, 2, 3, 4, 5, 6 };
+    TEST_ASSERT_TRUE(darr_append(darr, data, 6));
+    TEST_ASSERT_TRUE(darr_remove(darr, 1, 2));
+    TEST_ASSERT_TRUE(darr->gapLen > 0);
+    TEST_ASSERT_TRUE(darr_resize(darr, 3));
+    int exp[] = { 1, 4, 5 };
+    checkValues(darr, exp, 3);
+    darr_clear(darr);
+    TEST_ASSERT_TRUE(darr_isEmpty(darr));
+    TEST_ASSERT_EQUAL_INT(0, darr->gapLen);
+    darr_free(darr);
+
+    TEST_ASSERT_FALSE(darr_setGap(NULL, true));
+}
+
+void test_darr_shrinkToFit(void) {
+    DArr *darr = darr_new(10, SI, ALLOC_STRAT_DYNAMIC);
+    TEST_ASSERT_NOT_NULL(darr);
+    TEST_ASSERT_TRUE(alloc_setShrink(darr->block, 0.0));
+
+    int data[] = { 1, 2, 3, 4, 5, 6 };
+    TEST_ASSERT_TRUE(darr_append(darr, data, 6));
+
+    // Removals keep the allocated slots
+    TEST_ASSERT_TRUE(darr_remove(darr, 0, 3));
+    TEST_ASSERT_EQUAL_INT(10, darr_size(darr));
+
+    // Shrink releases the unused slots
+    TEST_ASSERT_TRUE(darr_shrinkToFit(darr));
+    TEST_ASSERT_EQUAL_INT(3, darr_size(darr));
+    int exp[] = { 4, 5, 6 };
+    checkValues(darr, exp, 3);
+
+    TEST_ASSERT_FALSE(darr_shrinkToFit(NULL));
+
+    darr_free(darr);
+}
+
 void test_darr_split(void) {
     // Create a DArr and insert some data
     DArr *darr = darr_new(10, SI, ALLOC_STRAT_DYNAMIC);
@@ -515,9 +686,12 @@ int main(void) {
     RUN_TEST(test_darr_index);
     RUN_TEST(test_darr_insert);
     RUN_TEST(test_darr_new);
+    RUN_TEST(test_darr_newIn);
     RUN_TEST(test_darr_remove);
     RUN_TEST(test_darr_resize);
     RUN_TEST(test_darr_setAt);
+    RUN_TEST(test_darr_setGap);
+    RUN_TEST(test_darr_shrinkToFit);
     RUN_TEST(test_darr_split);
 
     return UNITY_END();
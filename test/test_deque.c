@@ -0,0 +1,244 @@
+/*
+    File        : test_deque.c
+    Description : Double-ended queue of items of any single type, stored in a ring buffer on an
+                  AllocBlock, with O(1) push and pop at both ends.
+*/
+
+#include "deque.h"
+#include "unity.h"
+
+#define SI sizeof(int)
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Check the items of a Deque, front to back.
+ */
+static void checkItems(Deque *q, const int *exp, size_t n) {
+    TEST_ASSERT_EQUAL_INT(n, deque_len(q));
+    TEST_ASSERT_EQUAL_INT(n == 0, deque_isEmpty(q));
+    for (size_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_INT(exp[i], *(int*)deque_index(q, i));
+    TEST_ASSERT_NULL(deque_index(q, n));
+}
+
+void test_deque_clear(void) {
+    Deque *q = deque_new(0, SI);
+    int arr[] = { 1, 2, 3 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 3));
+    deque_clear(q);
+    checkItems(q, arr, 0);
+    TEST_ASSERT_EQUAL_INT(DEQUE_MIN_SIZE, deque_size(q));
+    TEST_ASSERT_TRUE(deque_pushFront(q, arr, 3));
+    checkItems(q, arr, 3);
+    deque_free(q);
+    deque_clear(NULL);
+}
+
+void test_deque_new(void) {
+    Deque *q = deque_new(0, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EQUAL_INT(DEQUE_MIN_SIZE, deque_size(q));
+    TEST_ASSERT_TRUE(deque_isEmpty(q));
+    deque_free(q);
+
+    // Sizes are powers of 2
+    q = deque_new(100, 3);
+    TEST_ASSERT_EQUAL_INT(128, deque_size(q));
+    TEST_ASSERT_EQUAL_INT(128 * 3, alloc_getUsed(q->block));
+    deque_free(q);
+
+    // Arena memory
+    Arena *a = arena_new(0);
+    q = deque_newWith(arena_allocator(a), 16, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    int i = 5;
+    TEST_ASSERT_TRUE(deque_pushBack(q, &i, 1));
+    deque_free(q);
+    arena_free(a);
+
+    TEST_ASSERT_NULL(deque_new(8, 0));
+    TEST_ASSERT_NULL(deque_new(SIZE_MAX, SI));
+    TEST_ASSERT_EQUAL_INT(0, deque_size(NULL));
+    deque_free(NULL);
+}
+
+void test_deque_pop(void) {
+    Deque *q = deque_new(0, SI);
+    int arr[] = { 1, 2, 3, 4, 5 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 5));
+
+    int out[5];
+    TEST_ASSERT_EQUAL_INT(2, deque_popFront(q, out, 2));
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, out, 2);
+    TEST_ASSERT_EQUAL_INT(1, deque_popBack(q, out, 1));
+    TEST_ASSERT_EQUAL_INT(5, out[0]);
+    checkItems(q, arr + 2, 2);
+
+    // Bulk pops stop at the items held, NULL discards
+    TEST_ASSERT_EQUAL_INT(1, deque_popBack(q, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(1, deque_popFront(q, out, 10));
+    TEST_ASSERT_EQUAL_INT(3, out[0]);
+    TEST_ASSERT_EQUAL_INT(0, deque_popFront(q, out, 1));
+    TEST_ASSERT_EQUAL_INT(0, deque_popBack(q, out, 1));
+    checkItems(q, arr, 0);
+
+    // Pops across the end of the ring keep the order
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 5));
+    TEST_ASSERT_EQUAL_INT(3, deque_popFront(q, NULL, 3));
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 3));
+    TEST_ASSERT_EQUAL_INT(5, deque_popBack(q, out, 5));
+    int exp[] = { 4, 5, 1, 2, 3 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, out, 5);
+    TEST_ASSERT_EQUAL_INT(DEQUE_MIN_SIZE, deque_size(q));
+
+    TEST_ASSERT_EQUAL_INT(0, deque_popFront(NULL, out, 1));
+    deque_free(q);
+}
+
+void test_deque_push(void) {
+    Deque *q = deque_new(0, SI);
+
+    // Both ends, wrapping around the start of the ring
+    int arr[] = { 1, 2, 3 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 3));
+    int front[] = { -2, -1 };
+    TEST_ASSERT_TRUE(deque_pushFront(q, front, 2));
+    int i = 0;
+    TEST_ASSERT_TRUE(deque_pushFront(q, &i, 1));
+    int exp1[] = { 0, -2, -1, 1, 2, 3 };
+    checkItems(q, exp1, 6);
+    TEST_ASSERT_EQUAL_INT(DEQUE_MIN_SIZE, deque_size(q));
+
+    // Growing a wrapped ring keeps the order
+    int more[] = { 4, 5, 6, 7, 8 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, more, 5));
+    TEST_ASSERT_EQUAL_INT(16, deque_size(q));
+    int exp2[] = { 0, -2, -1, 1, 2, 3, 4, 5, 6, 7, 8 };
+    checkItems(q, exp2, 11);
+
+    // FIFO through many growths and wraps
+    deque_clear(q);
+    int next = 0, expected = 0;
+    for (int round = 0; round < 1000; round++) {
+        for (int j = 0; j < round % 7 + 1; j++, next++) 
+            TEST_ASSERT_TRUE(deque_pushBack(q, &next, 1));
+        for (int j = 0; j < round % 5 + 1 && !deque_isEmpty(q); j++, expected++) {
+            TEST_ASSERT_EQUAL_INT(1, deque_popFront(q, &i, 1));
+            TEST_ASSERT_EQUAL_INT(expected, i);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(next - expected, deque_len(q));
+    TEST_ASSERT_TRUE(deque_size(q) >= deque_len(q));
+    TEST_ASSERT_TRUE(math_isPow2(deque_size(q)));
+
+    TEST_ASSERT_FALSE(deque_pushBack(q, NULL, 1));
+    TEST_ASSERT_FALSE(deque_pushFront(q, arr, 0));
+    TEST_ASSERT_FALSE(deque_pushBack(NULL, arr, 1));
+    deque_free(q);
+}
+
+void test_deque_reserve(void) {
+    Deque *q = deque_new(0, SI);
+    int arr[] = { 1, 2, 3, 4, 5, 6 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 6));
+    TEST_ASSERT_EQUAL_INT(4, deque_popFront(q, NULL, 4));
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 6)); // Wraps
+
+    TEST_ASSERT_TRUE(deque_reserve(q, 33));
+    TEST_ASSERT_EQUAL_INT(64, deque_size(q));
+    int exp[] = { 5, 6, 1, 2, 3, 4, 5, 6 };
+    checkItems(q, exp, 8);
+    TEST_ASSERT_TRUE(deque_reserve(q, 4));
+    TEST_ASSERT_EQUAL_INT(64, deque_size(q));
+
+    TEST_ASSERT_FALSE(deque_reserve(q, SIZE_MAX));
+    checkItems(q, exp, 8);
+    TEST_ASSERT_FALSE(deque_reserve(NULL, 8));
+    deque_free(q);
+}
+
+void test_deque_reserveBack(void) {
+    Deque *q = deque_new(0, SI);
+    int arr[] = { 1, 2, 3, 4, 5, 6 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 6));
+    TEST_ASSERT_EQUAL_INT(5, deque_popFront(q, NULL, 5));
+
+    // Slots wrap at the end of the ring: two spans
+    void *spans[2];
+    size_t lens[2];
+    TEST_ASSERT_TRUE(deque_reserveBack(q, 4, spans, lens));
+    TEST_ASSERT_EQUAL_INT(8, deque_size(q));
+    TEST_ASSERT_EQUAL_INT(2, lens[0]);
+    TEST_ASSERT_EQUAL_INT(2, lens[1]);
+    memcpy(spans[0], arr, 2 * SI);
+    memcpy(spans[1], arr + 2, 2 * SI);
+    TEST_ASSERT_TRUE(deque_commitBack(q, 4));
+    int exp1[] = { 6, 1, 2, 3, 4 }, out[16];
+    TEST_ASSERT_EQUAL_INT(5, deque_popFront(q, out, 5));
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp1, out, 5);
+
+    // Growing for the slots, committing fewer than reserved
+    TEST_ASSERT_TRUE(deque_reserveBack(q, 10, spans, lens));
+    TEST_ASSERT_EQUAL_INT(16, deque_size(q));
+    TEST_ASSERT_EQUAL_INT(10, lens[0] + lens[1]);
+    ((int*)spans[0])[0] = 7;
+    TEST_ASSERT_TRUE(deque_commitBack(q, 1));
+    TEST_ASSERT_EQUAL_INT(1, deque_len(q));
+    TEST_ASSERT_EQUAL_INT(7, *(int*)deque_index(q, 0));
+
+    // Single span, and invalid requests
+    TEST_ASSERT_TRUE(deque_reserveBack(q, 3, spans, lens));
+    TEST_ASSERT_EQUAL_INT(3, lens[0]);
+    TEST_ASSERT_EQUAL_INT(0, lens[1]);
+    TEST_ASSERT_NULL(spans[1]);
+    TEST_ASSERT_FALSE(deque_reserveBack(q, 0, spans, lens));
+    TEST_ASSERT_FALSE(deque_reserveBack(NULL, 1, spans, lens));
+    TEST_ASSERT_FALSE(deque_commitBack(q, 16));
+    TEST_ASSERT_FALSE(deque_commitBack(NULL, 1));
+    TEST_ASSERT_EQUAL_INT(1, deque_len(q));
+    deque_free(q);
+}
+
+void test_deque_span(void) {
+    Deque *q = deque_new(0, SI);
+    int arr[] = { 1, 2, 3, 4, 5, 6 };
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 6));
+    TEST_ASSERT_EQUAL_INT(3, deque_popFront(q, NULL, 3));
+    TEST_ASSERT_TRUE(deque_pushBack(q, arr, 4));
+
+    // Two spans: the end of the ring, then its start
+    size_t len;
+    int *span = (int*)deque_span(q, 0, &len);
+    TEST_ASSERT_EQUAL_INT(5, len);
+    int exp1[] = { 4, 5, 6, 1, 2 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp1, span, 5);
+    span = (int*)deque_span(q, len, &len);
+    TEST_ASSERT_EQUAL_INT(2, len);
+    int exp2[] = { 3, 4 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp2, span, 2);
+
+    // A span from within
+    span = (int*)deque_span(q, 3, &len);
+    TEST_ASSERT_EQUAL_INT(2, len);
+    TEST_ASSERT_EQUAL_INT(1, span[0]);
+
+    TEST_ASSERT_NULL(deque_span(q, 7, &len));
+    TEST_ASSERT_EQUAL_INT(0, len);
+    TEST_ASSERT_NULL(deque_span(NULL, 0, &len));
+    deque_free(q);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deque_clear);
+    RUN_TEST(test_deque_new);
+    RUN_TEST(test_deque_pop);
+    RUN_TEST(test_deque_push);
+    RUN_TEST(test_deque_reserve);
+    RUN_TEST(test_deque_reserveBack);
+    RUN_TEST(test_deque_span);
+
+    return UNITY_END();
+}
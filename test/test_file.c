@@ -4,6 +4,7 @@
     Description : File Operations
 */
 
+#include <dirent.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -28,16 +29,85 @@ void createDataFile(const char *path, size_t lineLen, size_t lineCount) {
 void checkRead(size_t lineLen, size_t lineCount) {
     char *path = PATH_DATA "file_read.txt";
     createDataFile(path, lineLen, lineCount);
-    char *text = file_read(path);
+    size_t size;
+    char *text = file_read(path, &size);
     TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_INT(lineLen * lineCount, size);
     TEST_ASSERT_EQUAL_INT(lineLen * lineCount, strlen(text));
     free(text);
     file_delete(path);
 }
 
+/**
+ * @brief Progress callback counting its calls, cancelling once `arg` calls are left.
+ */
+static size_t progressCalls;
+static bool countProgress(size_t copied, size_t total, void *arg) {
+    TEST_ASSERT_TRUE(copied <= total || total == 0);
+    progressCalls++;
+    return arg == NULL || progressCalls < *(size_t*)arg;
+}
+
 void setUp(void) {}
 void tearDown(void) {}
 
+void test_file_copy(void) {
+    char *src = PATH_DATA "file_copy_src.bin";
+    char *dst = PATH_DATA "file_copy_dst.bin";
+
+    // Binary content (embedded NUL bytes) over several chunks
+    size_t size = 2 * FILE_COPY_CHUNK + 12345;
+    char *data = (char*)malloc(size);
+    for (size_t i = 0; i < size; i++) data[i] = (char)(i * 31 % 251);
+    TEST_ASSERT_TRUE(file_write(src, data, size, false));
+    TEST_ASSERT_TRUE(file_write(dst, "old content, longer than nothing", 32, false));
+
+    progressCalls = 0;
+    TEST_ASSERT_TRUE(file_copy(src, dst, countProgress, NULL));
+    TEST_ASSERT_GREATER_OR_EQUAL(3, progressCalls);
+    size_t copySize;
+    char *copy = file_read(dst, &copySize);
+    TEST_ASSERT_EQUAL_INT(size, copySize);
+    TEST_ASSERT_EQUAL_MEMORY(data, copy, size);
+    free(copy);
+
+    // Cancelled by the progress callback: the partial copy is removed
+    size_t cancelAt = 1;
+    progressCalls = 0;
+    TEST_ASSERT_FALSE(file_copy(src, dst, countProgress, &cancelAt));
+    TEST_ASSERT_EQUAL_INT(1, progressCalls);
+    TEST_ASSERT_NULL(fopen(dst, "r"));
+
+    // Empty file
+    TEST_ASSERT_TRUE(file_write(src, "", 0, false));
+    TEST_ASSERT_TRUE(file_copy(src, dst, NULL, NULL));
+    copy = file_read(dst, &copySize);
+    TEST_ASSERT_EQUAL_INT(0, copySize);
+    free(copy);
+
+    // Files that report a size of 0 (not copied by the kernel)
+    TEST_ASSERT_TRUE(file_copy("/proc/self/status", dst, NULL, NULL));
+    copy = file_read(dst, &copySize);
+    TEST_ASSERT_GREATER_THAN(0, copySize);
+    TEST_ASSERT_NOT_NULL(strstr(copy, "Name:"));
+    free(copy);
+
+    // A file is not copied onto itself
+    TEST_ASSERT_TRUE(file_write(src, "abc", 3, false));
+    TEST_ASSERT_FALSE(file_copy(src, src, NULL, NULL));
+    copy = file_read(src, &copySize);
+    TEST_ASSERT_EQUAL_STRING("abc", copy);
+    free(copy);
+
+    TEST_ASSERT_FALSE(file_copy(PATH_DATA "non_existent_file.txt", dst, NULL, NULL));
+    TEST_ASSERT_FALSE(file_copy(PATH_DATA, dst, NULL, NULL));
+    TEST_ASSERT_FALSE(file_copy(src, PATH_DATA "non_existent_dir/file.txt", NULL, NULL));
+    TEST_ASSERT_FALSE(file_copy(NULL, dst, NULL, NULL));
+    free(data);
+    file_delete(src);
+    file_delete(dst);
+}
+
 void test_file_create(void) {
     char *path = PATH_DATA "test_file_create.txt";
     char *content = "This is a test file for creation.";
@@ -58,6 +128,8 @@ void test_file_create(void) {
     // Try creating the file again - should return false because it already exists
     bool fileRecreated = file_create(path, "New content");
     TEST_ASSERT_FALSE(fileRecreated);
+    TEST_ASSERT_FALSE(file_create(PATH_DATA "non_existent_dir/file.txt", content));
+    TEST_ASSERT_FALSE(file_create(NULL, content));
 
     // Clean up: delete the test file
     bool fileDeleted = file_delete(path);
@@ -83,6 +155,61 @@ void test_file_delete(void) {
     TEST_ASSERT_TRUE(fileDeleted);
 }
 
+void test_file_map(void) {
+    char *path = PATH_DATA "file_map.txt";
+    char *content = "file_map\nI am some text for mapping";
+    file_delete(path);
+    file_create(path, content);
+
+    // Content is mapped as is (no NUL terminator), for every access pattern
+    FileAccess accesses[] = { FILE_ACCESS_NORMAL, FILE_ACCESS_SEQUENTIAL, FILE_ACCESS_RANDOM };
+    for (size_t i = 0; i < 3; i++) {
+        FileView view;
+        TEST_ASSERT_TRUE(file_map(path, accesses[i], &view));
+        TEST_ASSERT_NOT_NULL(view.base);
+        TEST_ASSERT_EQUAL_INT(strlen(content), view.size);
+        TEST_ASSERT_EQUAL_MEMORY(content, view.data, view.size);
+        TEST_ASSERT_TRUE(file_advise(&view, FILE_ACCESS_RANDOM));
+        file_unmap(&view);
+        TEST_ASSERT_NULL(view.base);
+        TEST_ASSERT_EQUAL_INT(0, view.size);
+    }
+
+    // The view outlives the file
+    FileView view;
+    TEST_ASSERT_TRUE(file_map(path, FILE_ACCESS_NORMAL, &view));
+    file_delete(path);
+    TEST_ASSERT_EQUAL_MEMORY(content, view.data, view.size);
+    file_unmap(&view);
+
+    // Long file
+    createDataFile(path, 80, 1000);
+    TEST_ASSERT_TRUE(file_map(path, FILE_ACCESS_SEQUENTIAL, &view));
+    TEST_ASSERT_EQUAL_INT(80 * 1000, view.size);
+    TEST_ASSERT_EQUAL_CHAR('\n', view.data[80 * 500 - 1]);
+    TEST_ASSERT_EQUAL_CHAR('A', view.data[80 * 1000 - 1]);
+    file_unmap(&view);
+    file_delete(path);
+
+    // Empty file gives an empty view
+    file_create(path, "");
+    TEST_ASSERT_TRUE(file_map(path, FILE_ACCESS_NORMAL, &view));
+    TEST_ASSERT_EQUAL_INT(0, view.size);
+    TEST_ASSERT_NULL(view.base);
+    TEST_ASSERT_NOT_NULL(view.data);
+    TEST_ASSERT_TRUE(file_advise(&view, FILE_ACCESS_SEQUENTIAL));
+    file_unmap(&view);
+    file_delete(path);
+
+    // Non-existent files and directories cannot be mapped
+    TEST_ASSERT_FALSE(file_map(PATH_DATA "non_existent_file.txt", FILE_ACCESS_NORMAL, &view));
+    TEST_ASSERT_EQUAL_INT(0, view.size);
+    TEST_ASSERT_FALSE(file_map(PATH_DATA, FILE_ACCESS_NORMAL, &view));
+    TEST_ASSERT_FALSE(file_map(NULL, FILE_ACCESS_NORMAL, &view));
+    TEST_ASSERT_FALSE(file_map(path, FILE_ACCESS_NORMAL, NULL));
+    file_unmap(NULL);
+}
+
 void test_file_open(void) {
     char *path = PATH_DATA "file_open.txt";
     char *content = "file_open\nI am some text for testing";
@@ -112,7 +239,7 @@ void test_file_read(void) {
     file_delete(path);
     file_create(path, expText);
 
-    char *text = file_read(path);
+    char *text = file_read(path, NULL);
     TEST_ASSERT_NOT_NULL(text);
     TEST_ASSERT_EQUAL_STRING(expText, text);
     free(text);
@@ -124,18 +251,101 @@ void test_file_read(void) {
     // Long Line File
     checkRead(1000, 1);
 
-    // Non-Existent File
-    char *nonExistentText = file_read(PATH_DATA "non_existent_file.txt");
+    // Larger than the initial buffer of files without a known size
+    checkRead(1000, 200);
+
+    // Empty File
+    size_t size = 1;
+    file_create(path, "");
+    text = file_read(path, &size);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_INT(0, size);
+    TEST_ASSERT_EQUAL_STRING("", text);
+    free(text);
+    file_delete(path);
+
+    // Binary File (embedded NUL bytes)
+    char bin[] = { 'a', '\0', 'b', '\n', '\0', (char)0xff };
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    fwrite(bin, 1, sizeof(bin), f);
+    fclose(f);
+    text = file_read(path, &size);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin), size);
+    TEST_ASSERT_EQUAL_MEMORY(bin, text, sizeof(bin));
+    TEST_ASSERT_EQUAL_CHAR('\0', text[size]);
+    free(text);
+    file_delete(path);
+
+    // Files that report a size of 0 are read in chunks
+    text = file_read("/proc/self/status", &size);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_GREATER_THAN(0, size);
+    TEST_ASSERT_EQUAL_INT(size, strlen(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "Name:"));
+    free(text);
+
+    // Non-Existent File and Directory
+    char *nonExistentText = file_read(PATH_DATA "non_existent_file.txt", &size);
     TEST_ASSERT_NULL(nonExistentText);
+    TEST_ASSERT_EQUAL_INT(0, size);
+    TEST_ASSERT_NULL(file_read(PATH_DATA, NULL));
+    TEST_ASSERT_NULL(file_read(NULL, NULL));
+}
+
+void test_file_write(void) {
+    char *path = PATH_DATA "file_write.txt";
+    file_delete(path);
+
+    // Creates the file, then replaces it
+    size_t size;
+    char *text;
+    const char *contents[] = { "first content", "second, longer content\n", "" };
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(file_write(path, contents[i], strlen(contents[i]), true));
+        text = file_read(path, &size);
+        TEST_ASSERT_NOT_NULL(text);
+        TEST_ASSERT_EQUAL_STRING(contents[i], text);
+        free(text);
+    }
+
+    // Binary content, synced in a batch
+    char bin[] = { 'x', '\0', 'y' };
+    TEST_ASSERT_TRUE(file_write(path, bin, sizeof(bin), false));
+    TEST_ASSERT_TRUE(file_syncFs(path));
+    TEST_ASSERT_TRUE(file_syncFs(PATH_DATA));
+    text = file_read(path, &size);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin), size);
+    TEST_ASSERT_EQUAL_MEMORY(bin, text, size);
+    free(text);
+
+    // No temporary file is left behind
+    DIR *dir = opendir(PATH_DATA);
+    TEST_ASSERT_NOT_NULL(dir);
+    for (struct dirent *e; (e = readdir(dir)) != NULL;) 
+        TEST_ASSERT_NULL(strstr(e->d_name, "file_write.txt.tmp"));
+    closedir(dir);
+    file_delete(path);
+
+    // Invalid paths and arguments
+    TEST_ASSERT_FALSE(file_write(PATH_DATA "non_existent_dir/file.txt", "a", 1, true));
+    TEST_ASSERT_FALSE(file_write(NULL, "a", 1, true));
+    TEST_ASSERT_FALSE(file_write(path, NULL, 1, true));
+    TEST_ASSERT_FALSE(file_syncFs(PATH_DATA "non_existent_file.txt"));
+    TEST_ASSERT_FALSE(file_syncFs(NULL));
 }
 
 int main(void) {
     UNITY_BEGIN();
 
+    RUN_TEST(test_file_copy);
     RUN_TEST(test_file_create);
     RUN_TEST(test_file_delete);
+    RUN_TEST(test_file_map);
     RUN_TEST(test_file_open);
     RUN_TEST(test_file_read);
+    RUN_TEST(test_file_write);
 
     return UNITY_END();
 }
@@ -0,0 +1,308 @@
+/*
+    File        : test_file_async.c
+    Description : Asynchronous file I/O engine over io_uring, with a thread pool (pread/pwrite)
+                  fallback, reading into and writing from plain buffers, AllocBlocks and DArrs.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "file_async.h"
+#include "unity.h"
+
+#ifndef PATH_ROOT
+    #define PATH_ROOT "."
+#endif
+
+#define PATH_DATA PATH_ROOT "/test/data/"
+#define FILES 8
+#define FILE_SIZE 10000
+
+static const AsyncEngine engines[] = { ASYNC_ENGINE_URING, ASYNC_ENGINE_THREADS };
+
+/**
+ * @brief Create an Async object for an engine, NULL if io_uring is not available.
+ */
+static Async *newAsync(unsigned depth, AsyncEngine engine) {
+    Async *a = async_new(depth, engine);
+    if (engine == ASYNC_ENGINE_THREADS) TEST_ASSERT_NOT_NULL(a);
+    if (a != NULL) TEST_ASSERT_EQUAL_INT(engine, async_engine(a));
+    return a;
+}
+
+/**
+ * @brief Wait for `count` completions, checking each of them transferred `size` bytes.
+ */
+static void waitAll(Async *a, int count, ssize_t size, bool seen[]) {
+    AsyncCompletion c[4];
+    for (int done = 0; done < count;) {
+        int n = async_wait(a, c, 4);
+        TEST_ASSERT_GREATER_THAN(0, n);
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_INT(size, c[i].result);
+            int idx = (int)(intptr_t)c[i].userData;
+            TEST_ASSERT_FALSE(seen[idx]);
+            seen[idx] = true;
+        }
+        done += n;
+    }
+    TEST_ASSERT_EQUAL_INT(0, async_pending(a));
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_async_new(void) {
+    // Auto picks one of the engines
+    Async *a = async_new(0, ASYNC_ENGINE_AUTO);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_EQUAL(ASYNC_ENGINE_AUTO, async_engine(a));
+    TEST_ASSERT_EQUAL_INT(0, async_pending(a));
+    async_free(a);
+
+    TEST_ASSERT_EQUAL_INT(ASYNC_ENGINE_AUTO, async_engine(NULL));
+    TEST_ASSERT_EQUAL_INT(0, async_pending(NULL));
+    async_free(NULL);
+}
+
+void test_async_read(void) {
+    char paths[FILES][64];
+    char contents[FILES][FILE_SIZE];
+    int fds[FILES];
+    for (int f = 0; f < FILES; f++) {
+        snprintf(paths[f], sizeof(paths[f]), "%sasync_read_%d.bin", PATH_DATA, f);
+        for (int i = 0; i < FILE_SIZE; i++) contents[f][i] = (char)(f * 31 + i);
+        TEST_ASSERT_TRUE(file_write(paths[f], contents[f], FILE_SIZE, false));
+        fds[f] = open(paths[f], O_RDONLY);
+        TEST_ASSERT_NOT_EQUAL(-1, fds[f]);
+    }
+
+    for (size_t e = 0; e < 2; e++) {
+        Async *a = newAsync(FILES, engines[e]);
+        if (a == NULL) continue;
+
+        // A batch of reads into buffers, from an offset
+        char buffs[FILES][FILE_SIZE];
+        bool seen[FILES] = { false };
+        for (int f = 0; f < FILES; f++)
+            TEST_ASSERT_TRUE(async_read(a, fds[f], buffs[f], FILE_SIZE, 100, (void*)(intptr_t)f));
+        TEST_ASSERT_EQUAL_INT(FILES, async_pending(a));
+
+        // The queue is full
+        TEST_ASSERT_FALSE(async_read(a, fds[0], buffs[0], 1, 0, NULL));
+        TEST_ASSERT_EQUAL_INT(FILES, async_submit(a));
+        TEST_ASSERT_EQUAL_INT(0, async_submit(a));
+        waitAll(a, FILES, FILE_SIZE - 100, seen);
+        for (int f = 0; f < FILES; f++)
+            TEST_ASSERT_EQUAL_MEMORY(contents[f] + 100, buffs[f], FILE_SIZE - 100);
+
+        // Reads appended to AllocBlocks and DArrs
+        AllocBlock *blocks[FILES / 2];
+        DArr *darrs[FILES / 2];
+        for (int f = 0; f < FILES / 2; f++) {
+            blocks[f] = alloc_new(0, ALLOC_STRAT_BUDDY);
+            alloc_append(blocks[f], "hdr", 3);
+            darrs[f] = darr_new(0, sizeof(int), ALLOC_STRAT_GEOMETRIC);
+            void *data = (void*)(intptr_t)f;
+            TEST_ASSERT_TRUE(async_readBlock(a, fds[f], blocks[f], FILE_SIZE, 0, data));
+            TEST_ASSERT_TRUE(async_readDArr(a, fds[FILES / 2 + f], darrs[f], 100, 0,
+                (void*)(intptr_t)(FILES / 2 + f)));
+        }
+        memset(seen, 0, sizeof(seen));
+        AsyncCompletion c[FILES];
+        int done = 0;
+        while (done < FILES) {
+            int n = async_wait(a, c, FILES);
+            TEST_ASSERT_GREATER_THAN(0, n);
+            for (int i = 0; i < n; i++) seen[(intptr_t)c[i].userData] = true;
+            done += n;
+        }
+        for (int f = 0; f < FILES / 2; f++) {
+            TEST_ASSERT_TRUE(seen[f]);
+            TEST_ASSERT_EQUAL_INT(3 + FILE_SIZE, alloc_getUsed(blocks[f]));
+            TEST_ASSERT_EQUAL_MEMORY("hdr", alloc_getBlock(blocks[f]), 3);
+            TEST_ASSERT_EQUAL_MEMORY(contents[f], (char*)alloc_getBlock(blocks[f]) + 3, FILE_SIZE);
+            TEST_ASSERT_EQUAL_INT(100, darr_len(darrs[f]));
+            const char *exp = contents[FILES / 2 + f];
+            TEST_ASSERT_EQUAL_MEMORY(exp, darr_first(darrs[f]), 100 * sizeof(int));
+            alloc_free(blocks[f]);
+            darr_free(darrs[f]);
+        }
+
+        // End of file and errors are reported in the completion
+        char buff[16];
+        TEST_ASSERT_TRUE(async_read(a, fds[0], buff, sizeof(buff), FILE_SIZE, NULL));
+        TEST_ASSERT_TRUE(async_write(a, fds[0], buff, sizeof(buff), 0, NULL)); // Read-only
+        int n = 0;
+        while (n < 2) {
+            int got = async_wait(a, c + n, 2 - n);
+            TEST_ASSERT_GREATER_THAN(0, got);
+            n += got;
+        }
+        TEST_ASSERT_TRUE((c[0].result == 0 && c[1].result == -EBADF)
+            || (c[1].result == 0 && c[0].result == -EBADF));
+
+        // Nothing pending, polling returns nothing
+        TEST_ASSERT_EQUAL_INT(0, async_wait(a, c, FILES));
+        TEST_ASSERT_EQUAL_INT(0, async_poll(a, c, FILES));
+
+        // Invalid requests
+        AllocBlock *chunked = alloc_new(0, ALLOC_STRAT_CHUNKS);
+        TEST_ASSERT_FALSE(async_readBlock(a, fds[0], chunked, 10, 0, NULL));
+        TEST_ASSERT_FALSE(async_read(a, -1, buff, 1, 0, NULL));
+        TEST_ASSERT_FALSE(async_read(a, fds[0], buff, 1, -1, NULL));
+        TEST_ASSERT_FALSE(async_read(a, fds[0], NULL, 1, 0, NULL));
+        TEST_ASSERT_FALSE(async_read(NULL, fds[0], buff, 1, 0, NULL));
+        TEST_ASSERT_EQUAL_INT(0, async_pending(a));
+        alloc_free(chunked);
+
+        // Queued requests are dropped when freed
+        TEST_ASSERT_TRUE(async_read(a, fds[0], buff, sizeof(buff), 0, NULL));
+        async_free(a);
+    }
+
+    for (int f = 0; f < FILES; f++) {
+        close(fds[f]);
+        file_delete(paths[f]);
+    }
+}
+
+void test_async_readBlock(void) {
+    char paths[4][64];
+    char contents[4][FILE_SIZE];
+    int fds[4];
+    for (int f = 0; f < 4; f++) {
+        snprintf(paths[f], sizeof(paths[f]), "%sasync_block_%d.bin", PATH_DATA, f);
+        for (int i = 0; i < FILE_SIZE; i++) contents[f][i] = (char)(f * 17 + i);
+        TEST_ASSERT_TRUE(file_write(paths[f], contents[f], FILE_SIZE, false));
+        fds[f] = open(paths[f], O_RDONLY);
+        TEST_ASSERT_NOT_EQUAL(-1, fds[f]);
+    }
+
+    for (size_t e = 0; e < 2; e++) {
+        Async *a = newAsync(0, engines[e]);
+        if (a == NULL) continue;
+
+        // Two reads in flight into one block, the first one short (end of file)
+        AllocBlock *b = alloc_new(0, ALLOC_STRAT_BUDDY);
+        alloc_append(b, "hdr", 3);
+        TEST_ASSERT_TRUE(alloc_resize(b, 3 + 2 * FILE_SIZE));
+        TEST_ASSERT_TRUE(async_readBlock(a, fds[0], b, FILE_SIZE, FILE_SIZE - 100, NULL));
+        TEST_ASSERT_TRUE(async_readBlock(a, fds[1], b, FILE_SIZE, 0, NULL));
+
+        // The block is not grown while reads into it are pending
+        const void *data = alloc_getBlock(b);
+        TEST_ASSERT_FALSE(async_readBlock(a, fds[2], b, alloc_getSize(b), 0, NULL));
+        TEST_ASSERT_TRUE(data == alloc_getBlock(b));
+
+        // Same with a DArr, the first read ending mid-item
+        DArr *d = darr_new(0, sizeof(int), ALLOC_STRAT_GEOMETRIC);
+        TEST_ASSERT_TRUE(darr_expand(d, 200));
+        TEST_ASSERT_TRUE(async_readDArr(a, fds[2], d, 100, FILE_SIZE - 102, NULL));
+        TEST_ASSERT_TRUE(async_readDArr(a, fds[3], d, 100, 0, NULL));
+        TEST_ASSERT_FALSE(async_readDArr(a, fds[3], d, darr_size(d), 0, NULL));
+
+        AsyncCompletion c[4];
+        for (int done = 0; done < 4;) {
+            int n = async_wait(a, c, 4);
+            TEST_ASSERT_GREATER_THAN(0, n);
+            done += n;
+        }
+
+        // The bytes of the second reads follow those of the short ones
+        const char *got = (const char*)alloc_getBlock(b);
+        TEST_ASSERT_EQUAL_INT(3 + 100 + FILE_SIZE, alloc_getUsed(b));
+        TEST_ASSERT_EQUAL_MEMORY("hdr", got, 3);
+        TEST_ASSERT_EQUAL_MEMORY(contents[0] + FILE_SIZE - 100, got + 3, 100);
+        TEST_ASSERT_EQUAL_MEMORY(contents[1], got + 103, FILE_SIZE);
+
+        got = (const char*)darr_first(d);
+        TEST_ASSERT_EQUAL_INT(25 + 100, darr_len(d));
+        TEST_ASSERT_EQUAL_MEMORY(contents[2] + FILE_SIZE - 102, got, 25 * sizeof(int));
+        TEST_ASSERT_EQUAL_MEMORY(contents[3], got + 25 * sizeof(int), 100 * sizeof(int));
+
+        // Nothing pending, the block grows again
+        TEST_ASSERT_TRUE(async_readBlock(a, fds[2], b, alloc_getSize(b), 0, NULL));
+        TEST_ASSERT_EQUAL_INT(1, async_wait(a, c, 4));
+        TEST_ASSERT_EQUAL_INT(3 + 100 + 2 * FILE_SIZE, alloc_getUsed(b));
+
+        alloc_free(b);
+        darr_free(d);
+        async_free(a);
+    }
+
+    for (int f = 0; f < 4; f++) {
+        close(fds[f]);
+        file_delete(paths[f]);
+    }
+}
+
+void test_async_write(void) {
+    char *path = PATH_DATA "async_write.bin";
+
+    for (size_t e = 0; e < 2; e++) {
+        Async *a = newAsync(4, engines[e]);
+        if (a == NULL) continue;
+
+        file_delete(path);
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        TEST_ASSERT_NOT_EQUAL(-1, fd);
+
+        // Writes from a buffer, an AllocBlock and a DArr, at their own offsets
+        AllocBlock *b = alloc_new(0, ALLOC_STRAT_DYNAMIC);
+        alloc_append(b, "block-data", 10);
+        DArr *d = darr_new(0, sizeof(int), ALLOC_STRAT_BUDDY);
+        int items[] = { 1, 2, 3, 4 };
+        darr_append(d, items, 4);
+
+        TEST_ASSERT_TRUE(async_write(a, fd, "buffer", 6, 0, (void*)0));
+        TEST_ASSERT_TRUE(async_writeBlock(a, fd, b, 6, (void*)1));
+        TEST_ASSERT_TRUE(async_writeDArr(a, fd, d, 16, (void*)2));
+        TEST_ASSERT_FALSE(async_writeBlock(a, fd, NULL, 0, NULL));
+        TEST_ASSERT_FALSE(async_writeDArr(a, fd, NULL, 0, NULL));
+
+        bool seen[3] = { false };
+        AsyncCompletion c[3];
+        int done = 0;
+        while (done < 3) {
+            int n = async_wait(a, c, 3);
+            TEST_ASSERT_GREATER_THAN(0, n);
+            for (int i = 0; i < n; i++) {
+                intptr_t idx = (intptr_t)c[i].userData;
+                int expSize = idx == 0 ? 6 : idx == 1 ? 10 : (int)sizeof(items);
+                TEST_ASSERT_EQUAL_INT(expSize, c[i].result);
+                seen[idx] = true;
+            }
+            done += n;
+        }
+        TEST_ASSERT_TRUE(seen[0] && seen[1] && seen[2]);
+        close(fd);
+
+        size_t size;
+        char *text = file_read(path, &size);
+        TEST_ASSERT_EQUAL_INT(16 + sizeof(items), size);
+        TEST_ASSERT_EQUAL_MEMORY("bufferblock-data", text, 16);
+        TEST_ASSERT_EQUAL_MEMORY(items, text + 16, sizeof(items));
+        free(text);
+
+        alloc_free(b);
+        darr_free(d);
+        async_free(a);
+    }
+
+    file_delete(path);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_async_new);
+    RUN_TEST(test_async_read);
+    RUN_TEST(test_async_readBlock);
+    RUN_TEST(test_async_write);
+
+    return UNITY_END();
+}
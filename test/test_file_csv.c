@@ -0,0 +1,226 @@
+/*
+    File        : test_file_csv.c
+    Description : Streaming parser of delimited text (CSV, TSV) into one DArr per column, with
+                  numeric columns parsed in place and string columns stored without allocating
+                  per field.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_csv.h"
+#include "unity.h"
+
+#ifndef PATH_ROOT
+    #define PATH_ROOT "."
+#endif
+
+#define PATH_DATA PATH_ROOT "/test/data/"
+#define PATH_CSV PATH_DATA "file_csv.csv"
+
+/**
+ * @brief Check a string field.
+ */
+static void checkStr(Csv *c, size_t col, size_t row, const char *expected) {
+    size_t len;
+    const char *s = csv_str(c, col, row, &len);
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_INT(strlen(expected), len);
+    if (len > 0) TEST_ASSERT_EQUAL_MEMORY(expected, s, len);
+}
+
+/**
+ * @brief Parse a whole text, returning the parser (at the end of the text, or on its error).
+ */
+static Csv *parse(const char *text, char delim, const CsvType *types, size_t cols, bool header) {
+    file_delete(PATH_CSV);
+    TEST_ASSERT_TRUE(file_write(PATH_CSV, text, strlen(text), false));
+    Csv *c = csv_open(PATH_CSV, delim, types, cols, header);
+    TEST_ASSERT_NOT_NULL(c);
+    csv_read(c, 0);
+    return c;
+}
+
+void setUp(void) {}
+void tearDown(void) { file_delete(PATH_CSV); }
+
+void test_csv_read(void) {
+    // Header, quoting, CRLF, blank lines, empty fields and a last record without a newline
+    const CsvType types[] = { CSV_INT, CSV_STR, CSV_DOUBLE, CSV_SKIP };
+    const char *text =
+        "id,\"na\"\"me\",value,unused\r\n"
+        "1,plain,1.5,x\r\n"
+        "\n"
+        "-42,\"with, comma\",-2.5e3,\"y\"\n"
+        "\r\n"
+        "7,\"multi\nline \"\"quoted\"\"\",,\n"
+        "+9223372036854775807,,0.1,z";
+    Csv *c = parse(text, ',', types, 4, true);
+    TEST_ASSERT_FALSE(csv_error(c));
+    TEST_ASSERT_EQUAL_INT(4, c->rows);
+
+    TEST_ASSERT_EQUAL_STRING("id", csv_name(c, 0));
+    TEST_ASSERT_EQUAL_STRING("na\"me", csv_name(c, 1));
+    TEST_ASSERT_EQUAL_STRING("unused", csv_name(c, 3));
+    TEST_ASSERT_NULL(csv_name(c, 4));
+
+    DArr *ids = csv_column(c, 0), *values = csv_column(c, 2);
+    TEST_ASSERT_EQUAL_INT(4, darr_len(ids));
+    TEST_ASSERT_EQUAL_INT64(1, *(int64_t*)darr_index(ids, 0));
+    TEST_ASSERT_EQUAL_INT64(-42, *(int64_t*)darr_index(ids, 1));
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, *(int64_t*)darr_index(ids, 3));
+    TEST_ASSERT_TRUE(1.5 == *(double*)darr_index(values, 0));
+    TEST_ASSERT_TRUE(-2500.0 == *(double*)darr_index(values, 1));
+    TEST_ASSERT_TRUE(*(double*)darr_index(values, 2) != *(double*)darr_index(values, 2)); // NaN
+    TEST_ASSERT_TRUE(0.1 == *(double*)darr_index(values, 3));
+
+    checkStr(c, 1, 0, "plain");
+    checkStr(c, 1, 1, "with, comma");
+    checkStr(c, 1, 2, "multi\nline \"quoted\"");
+    checkStr(c, 1, 3, "");
+    TEST_ASSERT_NULL(csv_column(c, 3));
+    TEST_ASSERT_NULL(csv_column(c, 4));
+
+    size_t len;
+    TEST_ASSERT_NULL(csv_str(c, 0, 0, &len));
+    TEST_ASSERT_NULL(csv_str(c, 1, 4, &len));
+    TEST_ASSERT_EQUAL_INT(0, csv_read(c, 0));
+    csv_free(c);
+
+    // TSV from a pipe, without a header
+    const CsvType tsvTypes[] = { CSV_STR, CSV_INT };
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    const char *tsv = "a b\t1\n\"c\td\"\t2\n";
+    TEST_ASSERT_EQUAL_INT(strlen(tsv), write(fds[1], tsv, strlen(tsv)));
+    close(fds[1]);
+    c = csv_new(fds[0], '\t', tsvTypes, 2, false);
+    TEST_ASSERT_EQUAL_INT(2, csv_read(c, 0));
+    TEST_ASSERT_NULL(csv_name(c, 0));
+    checkStr(c, 0, 0, "a b");
+    checkStr(c, 0, 1, "c\td");
+    TEST_ASSERT_EQUAL_INT64(2, *(int64_t*)darr_index(csv_column(c, 1), 1));
+    csv_free(c);
+    TEST_ASSERT_EQUAL_INT(0, close(fds[0]));
+}
+
+void test_csv_stream(void) {
+    // Records spanning buffer refills, and a field larger than the buffer
+    size_t rows = 20000, big = 3 * READER_BUFF_SIZE;
+    FILE *f = fopen(PATH_CSV, "w");
+    TEST_ASSERT_NOT_NULL(f);
+    for (size_t i = 0; i < rows; i++) {
+        if (i == rows / 2) {
+            fputc('"', f);
+            for (size_t j = 0; j < big; j++) fputc(j % 1000 == 999 ? '\n' : 'q', f);
+            fprintf(f, "\",%zu,%zu.25\n", i, i);
+        } else {
+            fprintf(f, "row%zu,%zu,%zu.25\n", i, i, i);
+        }
+    }
+    fclose(f);
+
+    // Read in batches, the columns emptied between them
+    const CsvType types[] = { CSV_STR, CSV_INT, CSV_DOUBLE };
+    Csv *c = csv_open(PATH_CSV, ',', types, 3, false);
+    size_t total = 0, n;
+    char expected[32];
+    while ((n = csv_read(c, 777)) > 0) {
+        TEST_ASSERT_EQUAL_INT(n, c->rows);
+        for (size_t r = 0; r < n; r++) {
+            size_t i = total + r;
+            TEST_ASSERT_EQUAL_INT64(i, *(int64_t*)darr_index(csv_column(c, 1), r));
+            TEST_ASSERT_TRUE(i + 0.25 == *(double*)darr_index(csv_column(c, 2), r));
+            size_t len;
+            const char *s = csv_str(c, 0, r, &len);
+            if (i == rows / 2) {
+                TEST_ASSERT_EQUAL_INT(big, len);
+                TEST_ASSERT_EQUAL_CHAR('\n', s[999]);
+            } else {
+                snprintf(expected, sizeof(expected), "row%zu", i);
+                checkStr(c, 0, r, expected);
+            }
+        }
+        total += n;
+        csv_clear(c);
+    }
+    TEST_ASSERT_EQUAL_INT(rows, total);
+    TEST_ASSERT_FALSE(csv_error(c));
+    csv_free(c);
+}
+
+void test_csv_numbers(void) {
+    // Parsed exactly as strtod, in and out of the fast path
+    const char *nums[] = {
+        "0", "-0", "3.14159", "1e22", "1e23", "123456789012345678", "9007199254740993",
+        "0.1e-5", "2.2250738585072014e-308", "1.7976931348623157e308", "12345678901234567890123",
+        "-.5", "5.", "1E+2", "inf", "-nan"
+    };
+    size_t count = sizeof(nums) / sizeof(nums[0]);
+    char text[1024] = "";
+    for (size_t i = 0; i < count; i++) {
+        strcat(text, nums[i]);
+        strcat(text, "\n");
+    }
+
+    const CsvType types[] = { CSV_DOUBLE };
+    Csv *c = parse(text, ',', types, 1, false);
+    TEST_ASSERT_FALSE(csv_error(c));
+    TEST_ASSERT_EQUAL_INT(count, c->rows);
+    for (size_t i = 0; i < count; i++) {
+        double expected = strtod(nums[i], NULL), value = *(double*)darr_index(csv_column(c, 0), i);
+        if (expected != expected) TEST_ASSERT_TRUE(value != value);
+        else TEST_ASSERT_EQUAL_MEMORY(&expected, &value, sizeof(double));
+    }
+    csv_free(c);
+
+    // Integer range
+    const CsvType intTypes[] = { CSV_INT };
+    c = parse("-9223372036854775808\n9223372036854775807\n", ',', intTypes, 1, false);
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, *(int64_t*)darr_index(csv_column(c, 0), 0));
+    TEST_ASSERT_FALSE(csv_error(c));
+    csv_free(c);
+}
+
+void test_csv_error(void) {
+    // Each stops the parser, the rows before the error are kept
+    const char *bad[] = {
+        "1,2\n3\n", // Too few fields
+        "1,2\n3,4,5\n", // Too many fields
+        "1,2\n3,x\n", // Not an integer
+        "1,2\n9223372036854775808,0\n", // Out of range
+        "1,2\n\"3\"x,4\n", // Text after closing quotes
+        "1,2\n\"3,4\n" // Unterminated quotes
+    };
+    const CsvType types[] = { CSV_INT, CSV_INT };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        Csv *c = parse(bad[i], ',', types, 2, false);
+        TEST_ASSERT_TRUE(csv_error(c));
+        TEST_ASSERT_EQUAL_INT(1, c->rows);
+        TEST_ASSERT_EQUAL_INT(1, darr_len(csv_column(c, 1)));
+        TEST_ASSERT_EQUAL_INT(0, csv_read(c, 0));
+        csv_free(c);
+    }
+
+    // Invalid arguments
+    TEST_ASSERT_NULL(csv_open(PATH_DATA "non_existent_file.csv", ',', types, 2, false));
+    TEST_ASSERT_NULL(csv_open(NULL, ',', types, 2, false));
+    TEST_ASSERT_NULL(csv_new(0, '"', types, 2, false));
+    TEST_ASSERT_NULL(csv_new(0, ',', types, 0, false));
+    TEST_ASSERT_NULL(csv_new(-1, ',', types, 2, false));
+    TEST_ASSERT_TRUE(csv_error(NULL));
+    TEST_ASSERT_EQUAL_INT(0, csv_read(NULL, 0));
+    csv_free(NULL);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_csv_error);
+    RUN_TEST(test_csv_numbers);
+    RUN_TEST(test_csv_read);
+    RUN_TEST(test_csv_stream);
+
+    return UNITY_END();
+}
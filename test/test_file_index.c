@@ -0,0 +1,140 @@
+/*
+    File        : test_file_index.c
+    Description : Line offset index of large text files, built by scanning byte ranges in parallel,
+                  and persisted to a sidecar file for instant reopening.
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "file_index.h"
+#include "unity.h"
+
+#ifndef PATH_ROOT
+    #define PATH_ROOT "."
+#endif
+
+#define PATH_DATA PATH_ROOT "/test/data/"
+
+/**
+ * @brief Check a line of a buffer.
+ */
+static void checkLine(DArr *idx, const char *data, size_t size, size_t n, const char *expected) {
+    const char *line;
+    size_t len;
+    TEST_ASSERT_TRUE(index_line(idx, data, size, n, &line, &len));
+    TEST_ASSERT_EQUAL_INT(strlen(expected), len);
+    if (len > 0) TEST_ASSERT_EQUAL_MEMORY(expected, line, len);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_index_build(void) {
+    // Empty lines, with and without a final newline
+    const char *texts[] = { "one\n\nthree\n", "one\n\nthree" };
+    for (size_t t = 0; t < 2; t++) {
+        size_t size = strlen(texts[t]);
+        DArr *idx = index_build(texts[t], size, 1);
+        TEST_ASSERT_NOT_NULL(idx);
+        TEST_ASSERT_EQUAL_INT(3, darr_len(idx));
+        checkLine(idx, texts[t], size, 0, "one");
+        checkLine(idx, texts[t], size, 1, "");
+        checkLine(idx, texts[t], size, 2, "three");
+
+        const char *line;
+        size_t len;
+        TEST_ASSERT_FALSE(index_line(idx, texts[t], size, 3, &line, &len));
+        TEST_ASSERT_FALSE(index_line(idx, texts[t], size, 0, NULL, &len));
+        darr_free(idx);
+    }
+
+    // Empty buffer and a single newline
+    DArr *idx = index_build("", 0, 0);
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(0, darr_len(idx));
+    darr_free(idx);
+    idx = index_build("\n", 1, 0);
+    TEST_ASSERT_EQUAL_INT(1, darr_len(idx));
+    checkLine(idx, "\n", 1, 0, "");
+    darr_free(idx);
+    TEST_ASSERT_NULL(index_build(NULL, 10, 0));
+
+    // Several threads (ranges split lines) give the same index as a single one
+    size_t size = 4 * INDEX_MIN_RANGE + 123;
+    char *data = (char*)malloc(size);
+    for (size_t i = 0, lineLen = 1; i < size; i++) {
+        data[i] = i % 977 == lineLen ? '\n' : 'x';
+        if (data[i] == '\n') lineLen = (lineLen * 7) % 977;
+    }
+    DArr *single = index_build(data, size, 1);
+    DArr *multi = index_build(data, size, 4);
+    TEST_ASSERT_NOT_NULL(single);
+    TEST_ASSERT_NOT_NULL(multi);
+    TEST_ASSERT_GREATER_THAN(4, darr_len(single));
+    TEST_ASSERT_EQUAL_INT(darr_len(single), darr_len(multi));
+    size_t bytes = darr_len(single) * sizeof(size_t);
+    TEST_ASSERT_EQUAL_MEMORY(darr_first(single), darr_first(multi), bytes);
+    darr_free(single);
+    darr_free(multi);
+    free(data);
+}
+
+void test_index_open(void) {
+    char *path = PATH_DATA "index_open.txt";
+    char *sidecar = PATH_DATA "index_open.txt" INDEX_SUFFIX;
+    file_delete(path);
+    file_delete(sidecar);
+    TEST_ASSERT_NULL(index_open(path, 0));
+
+    const char *text = "alpha\nbeta\ngamma\n";
+    file_create(path, text);
+
+    // Built and saved to the sidecar
+    DArr *idx = index_open(path, 0);
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(3, darr_len(idx));
+    TEST_ASSERT_EQUAL_INT(0, access(sidecar, F_OK));
+    darr_free(idx);
+
+    // Loaded from the sidecar (a wrong sidecar shows it is not rebuilt)
+    DArr *fake = index_build("a\nb\n", 4, 1);
+    TEST_ASSERT_TRUE(index_save(fake, sidecar, path));
+    darr_free(fake);
+    idx = index_open(path, 0);
+    TEST_ASSERT_EQUAL_INT(2, darr_len(idx));
+    darr_free(idx);
+
+    // Rebuilt when the file changes
+    TEST_ASSERT_TRUE(file_write(path, "one line, longer", 16, false));
+    idx = index_open(path, 0);
+    TEST_ASSERT_EQUAL_INT(1, darr_len(idx));
+    darr_free(idx);
+    idx = index_load(sidecar, path);
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(1, darr_len(idx));
+    darr_free(idx);
+
+    // Rebuilt when the sidecar is corrupted
+    TEST_ASSERT_TRUE(file_write(sidecar, "garbage", 7, false));
+    TEST_ASSERT_NULL(index_load(sidecar, NULL));
+    idx = index_open(path, 0);
+    TEST_ASSERT_EQUAL_INT(1, darr_len(idx));
+    darr_free(idx);
+
+    TEST_ASSERT_FALSE(index_save(NULL, sidecar, path));
+    TEST_ASSERT_FALSE(index_save(idx = index_build("", 0, 1), sidecar, NULL));
+    darr_free(idx);
+    TEST_ASSERT_NULL(index_open(NULL, 0));
+    file_delete(path);
+    file_delete(sidecar);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_index_build);
+    RUN_TEST(test_index_open);
+
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+/*
+    File        : test_file_reader.c
+    Description : Streaming file reader yielding chunks or lines from a reusable buffer, for files 
+                  too large to be read whole.
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_reader.h"
+#include "unity.h"
+
+#ifndef PATH_ROOT
+    #define PATH_ROOT "."
+#endif
+
+#define PATH_DATA PATH_ROOT "/test/data/"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_reader_line(void) {
+    char *path = PATH_DATA "reader_line.txt";
+    file_delete(path);
+
+    // Empty lines, a line longer than the buffer and a last line without a newline
+    char longLine[100];
+    memset(longLine, 'B', sizeof(longLine) - 1);
+    longLine[sizeof(longLine) - 1] = '\0';
+    char content[256];
+    snprintf(content, sizeof(content), "first\n\nthird line\n%s\nlast", longLine);
+    file_create(path, content);
+
+    const char *expLines[] = { "first", "", "third line", longLine, "last" };
+    Reader *r = reader_open(path, 16, FILE_ACCESS_SEQUENTIAL);
+    TEST_ASSERT_NOT_NULL(r);
+
+    const char *line;
+    size_t len;
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+        TEST_ASSERT_EQUAL_INT(strlen(expLines[i]), len);
+        if (len > 0) TEST_ASSERT_EQUAL_MEMORY(expLines[i], line, len);
+    }
+    TEST_ASSERT_FALSE(reader_line(r, &line, &len));
+    TEST_ASSERT_FALSE(reader_error(r));
+    reader_free(r);
+
+    // A file ending with a newline has no empty last line
+    file_delete(path);
+    file_create(path, "a\nb\n");
+    r = reader_open(path, 0, FILE_ACCESS_NORMAL);
+    TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+    TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+    TEST_ASSERT_EQUAL_MEMORY("b", line, len);
+    TEST_ASSERT_FALSE(reader_line(r, &line, &len));
+    reader_free(r);
+    file_delete(path);
+
+    // Invalid arguments
+    TEST_ASSERT_FALSE(reader_line(NULL, &line, &len));
+    TEST_ASSERT_NULL(reader_open(PATH_DATA "non_existent_file.txt", 0, FILE_ACCESS_NORMAL));
+    TEST_ASSERT_NULL(reader_open(NULL, 0, FILE_ACCESS_NORMAL));
+    TEST_ASSERT_NULL(reader_new(-1, 0, FILE_ACCESS_NORMAL));
+    reader_free(NULL);
+}
+
+void test_reader_peek(void) {
+    char *path = PATH_DATA "reader_peek.txt";
+    file_delete(path);
+    char content[101];
+    for (int i = 0; i < 100; i++) content[i] = (char)('a' + i % 26);
+    content[100] = '\0';
+    file_create(path, content);
+
+    // Peeked data stays buffered until skipped, the buffer grows to hold what is asked for
+    Reader *r = reader_open(path, 16, FILE_ACCESS_SEQUENTIAL);
+    const char *data;
+    TEST_ASSERT_EQUAL_INT(16, reader_peek(r, &data, 1));
+    TEST_ASSERT_EQUAL_MEMORY(content, data, 16);
+    reader_skip(r, 10);
+    TEST_ASSERT_EQUAL_INT(6, reader_peek(r, &data, 0));
+    TEST_ASSERT_EQUAL_MEMORY(content + 10, data, 6);
+    size_t n = reader_peek(r, &data, 40);
+    TEST_ASSERT_GREATER_OR_EQUAL(40, n);
+    TEST_ASSERT_EQUAL_MEMORY(content + 10, data, n);
+
+    // Fewer bytes than asked for at the end of the file, skips stop at the buffered data
+    TEST_ASSERT_EQUAL_INT(90, reader_peek(r, &data, 1000));
+    reader_skip(r, 1000);
+    TEST_ASSERT_EQUAL_INT(0, reader_peek(r, &data, 1));
+    TEST_ASSERT_EQUAL_INT(0, reader_read(r, &data));
+    TEST_ASSERT_FALSE(reader_error(r));
+    reader_free(r);
+    file_delete(path);
+
+    TEST_ASSERT_EQUAL_INT(0, reader_peek(NULL, &data, 1));
+    reader_skip(NULL, 1);
+}
+
+void test_reader_pipe(void) {
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    const char *content = "one\ntwo\nthree";
+    TEST_ASSERT_EQUAL_INT(strlen(content), write(fds[1], content, strlen(content)));
+    close(fds[1]);
+
+    Reader *r = reader_new(fds[0], 4, FILE_ACCESS_SEQUENTIAL);
+    TEST_ASSERT_NOT_NULL(r);
+
+    const char *line;
+    size_t len;
+    TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+    TEST_ASSERT_EQUAL_MEMORY("one", line, len);
+    TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+    TEST_ASSERT_EQUAL_MEMORY("two", line, len);
+    TEST_ASSERT_TRUE(reader_line(r, &line, &len));
+    TEST_ASSERT_EQUAL_INT(5, len);
+    TEST_ASSERT_EQUAL_MEMORY("three", line, len);
+    TEST_ASSERT_FALSE(reader_line(r, &line, &len));
+    TEST_ASSERT_FALSE(reader_error(r));
+    reader_free(r);
+
+    // The descriptor is left open for the caller
+    TEST_ASSERT_EQUAL_INT(0, close(fds[0]));
+}
+
+void test_reader_read(void) {
+    char *path = PATH_DATA "reader_read.txt";
+    file_delete(path);
+    char content[1001];
+    for (int i = 0; i < 1000; i++) content[i] = (char)('a' + i % 26);
+    content[1000] = '\0';
+    file_create(path, content);
+
+    // Chunks fill the buffer, except the last one
+    Reader *r = reader_open(path, 64, FILE_ACCESS_SEQUENTIAL);
+    TEST_ASSERT_NOT_NULL(r);
+    const char *chunk;
+    size_t n, total = 0;
+    while ((n = reader_read(r, &chunk)) > 0) {
+        TEST_ASSERT_EQUAL_INT(total + 64 <= 1000 ? 64 : 1000 - total, n);
+        TEST_ASSERT_EQUAL_MEMORY(content + total, chunk, n);
+        total += n;
+    }
+    TEST_ASSERT_EQUAL_INT(1000, total);
+    TEST_ASSERT_EQUAL_INT(0, reader_read(r, &chunk));
+    TEST_ASSERT_FALSE(reader_error(r));
+    reader_free(r);
+
+    // Chunks and lines can be mixed, a reader over a descriptor starts at its offset
+    int fd = open(path, O_RDONLY);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    TEST_ASSERT_EQUAL_INT(10, lseek(fd, 10, SEEK_SET));
+    r = reader_new(fd, 0, FILE_ACCESS_RANDOM);
+    TEST_ASSERT_EQUAL_INT(990, reader_read(r, &chunk));
+    TEST_ASSERT_EQUAL_MEMORY(content + 10, chunk, 990);
+    reader_free(r);
+    close(fd);
+    file_delete(path);
+
+    // Directories cannot be read
+    r = reader_open(PATH_DATA, 0, FILE_ACCESS_NORMAL);
+    if (r != NULL) {
+        TEST_ASSERT_EQUAL_INT(0, reader_read(r, &chunk));
+        TEST_ASSERT_TRUE(reader_error(r));
+        reader_free(r);
+    }
+    TEST_ASSERT_EQUAL_INT(0, reader_read(NULL, &chunk));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_reader_line);
+    RUN_TEST(test_reader_peek);
+    RUN_TEST(test_reader_pipe);
+    RUN_TEST(test_reader_read);
+
+    return UNITY_END();
+}
@@ -0,0 +1,200 @@
+/*
+    File        : test_file_writer.c
+    Description : Buffered file writer over direct write calls, coalescing small records into large 
+                  writes, with number formatting that bypasses stdio.
+*/
+
+#include <float.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file_writer.h"
+#include "unity.h"
+
+#ifndef PATH_ROOT
+    #define PATH_ROOT "."
+#endif
+
+#define PATH_DATA PATH_ROOT "/test/data/"
+
+/**
+ * @brief Free the writer and check the content of its file.
+ */
+static void checkFile(Writer *w, const char *path, const char *expected, size_t size) {
+    writer_free(w);
+    size_t readSize;
+    char *text = file_read(path, &readSize);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_INT(size, readSize);
+    if (size > 0) TEST_ASSERT_EQUAL_MEMORY(expected, text, size);
+    free(text);
+    file_delete(path);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_writer_numbers(void) {
+    char *path = PATH_DATA "writer_numbers.txt";
+    Writer *w = writer_open(path, 0);
+    TEST_ASSERT_NOT_NULL(w);
+
+    int64_t ints[] = { 0, 7, -7, 42, 100, -99999, INT64_MAX, INT64_MIN };
+    uint64_t uints[] = { 0, 9, 10, 12345678901234ULL, UINT64_MAX };
+    double doubles[] = { 
+        0.0, -0.0, 1.5, -2.25, 3.14159, 0.0004, -0.0004, 123456.789, 1e30, -1e-30 
+    };
+    int decimals[] = { 0, 1, 2, 3, 4, 6 };
+
+    // Formatted as printf does
+    char exp[4096];
+    size_t len = 0;
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        TEST_ASSERT_TRUE(writer_int(w, ints[i]));
+        TEST_ASSERT_TRUE(writer_str(w, ","));
+        len += (size_t)snprintf(exp + len, sizeof(exp) - len, "%lld,", (long long)ints[i]);
+    }
+    for (size_t i = 0; i < sizeof(uints) / sizeof(uints[0]); i++) {
+        TEST_ASSERT_TRUE(writer_uint(w, uints[i]));
+        TEST_ASSERT_TRUE(writer_str(w, ","));
+        unsigned long long u = uints[i];
+        len += (size_t)snprintf(exp + len, sizeof(exp) - len, "%llu,", u);
+    }
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+        for (size_t j = 0; j < sizeof(decimals) / sizeof(decimals[0]); j++) {
+            TEST_ASSERT_TRUE(writer_double(w, doubles[i], decimals[j]));
+            TEST_ASSERT_TRUE(writer_str(w, "\n"));
+            double d = doubles[i];
+            len += (size_t)snprintf(exp + len, sizeof(exp) - len, "%.*f\n", decimals[j], d);
+        }
+    }
+
+    TEST_ASSERT_TRUE(writer_flush(w));
+    TEST_ASSERT_FALSE(writer_error(w));
+    checkFile(w, path, exp, len);
+
+    // Out of range decimals are clamped, non-finite values fall back to printf
+    w = writer_open(path, 0);
+    TEST_ASSERT_TRUE(writer_double(w, 0.5, -3));
+    TEST_ASSERT_TRUE(writer_str(w, " "));
+    TEST_ASSERT_TRUE(writer_double(w, 2.0, 100));
+    TEST_ASSERT_TRUE(writer_str(w, " "));
+    TEST_ASSERT_TRUE(writer_double(w, -DBL_MAX * 2, 2));
+    TEST_ASSERT_TRUE(writer_str(w, " "));
+    TEST_ASSERT_TRUE(writer_double(w, 1.0 / 3.0, 17));
+    snprintf(exp, sizeof(exp), "0 %.17f -inf %.17f", 2.0, 1.0 / 3.0);
+    checkFile(w, path, exp, strlen(exp));
+}
+
+void test_writer_write(void) {
+    char *path = PATH_DATA "writer_write.txt";
+    TEST_ASSERT_NULL(writer_open(NULL, 0));
+    TEST_ASSERT_NULL(writer_open(PATH_DATA "non_existent_dir/file.txt", 0));
+    TEST_ASSERT_NULL(writer_new(-1, 0));
+
+    // Records smaller than, crossing and larger than the buffer
+    char exp[4000];
+    for (size_t i = 0; i < sizeof(exp); i++) exp[i] = (char)('a' + i % 26);
+
+    Writer *w = writer_open(path, 16);
+    TEST_ASSERT_NOT_NULL(w);
+    TEST_ASSERT_TRUE(writer_write(w, exp, 10));
+    TEST_ASSERT_TRUE(writer_write(w, exp + 10, 10));
+    TEST_ASSERT_TRUE(writer_write(w, exp + 20, 0));
+    TEST_ASSERT_TRUE(writer_write(w, exp + 20, 100));
+    TEST_ASSERT_TRUE(writer_write(w, exp + 120, 5));
+    TEST_ASSERT_TRUE(writer_write(w, exp + 125, 16));
+    TEST_ASSERT_FALSE(writer_write(w, NULL, 1));
+    TEST_ASSERT_FALSE(writer_str(w, NULL));
+
+    // Segments, fitting in the buffer or not, and more than a single writev batch
+    struct iovec iov[200];
+    size_t len = 141;
+    iov[0] = (struct iovec){ exp + len, 3 };
+    iov[1] = (struct iovec){ exp + len + 3, 0 };
+    iov[2] = (struct iovec){ exp + len + 3, 4 };
+    TEST_ASSERT_TRUE(writer_writev(w, iov, 3));
+    len += 7;
+    for (int i = 0; i < 200; i++) iov[i] = (struct iovec){ exp + len + (size_t)i * 10, 10 };
+    TEST_ASSERT_TRUE(writer_writev(w, iov, 200));
+    len += 2000;
+    TEST_ASSERT_TRUE(writer_writev(w, iov, 0));
+    TEST_ASSERT_FALSE(writer_writev(w, NULL, 1));
+
+    TEST_ASSERT_TRUE(writer_sync(w));
+    checkFile(w, path, exp, len);
+}
+
+void test_writer_darr(void) {
+    char *path = PATH_DATA "writer_darr.txt";
+    int items[5000];
+    for (int i = 0; i < 5000; i++) items[i] = i;
+
+    // Contiguous and chunked DArr
+    AllocStrategy strats[] = { ALLOC_STRAT_BUDDY, ALLOC_STRAT_CHUNKS };
+    for (size_t s = 0; s < 2; s++) {
+        DArr *d = darr_new(0, sizeof(int), strats[s]);
+        TEST_ASSERT_TRUE(darr_append(d, items, 5000));
+
+        Writer *w = writer_open(path, 1024);
+        TEST_ASSERT_TRUE(writer_str(w, "ab"));
+        TEST_ASSERT_TRUE(writer_darr(w, d));
+        TEST_ASSERT_FALSE(writer_darr(w, NULL));
+
+        char exp[2 + sizeof(items)];
+        memcpy(exp, "ab", 2);
+        memcpy(exp + 2, items, sizeof(items));
+        checkFile(w, path, exp, sizeof(exp));
+        darr_free(d);
+    }
+
+    // Gap buffer DArr: the gap slots are skipped
+    DArr *d = darr_new(0, sizeof(int), ALLOC_STRAT_BUDDY);
+    TEST_ASSERT_TRUE(darr_setGap(d, true));
+    TEST_ASSERT_TRUE(darr_append(d, items, 5000));
+    TEST_ASSERT_TRUE(darr_remove(d, 2500, 1));
+    TEST_ASSERT_TRUE(d->gapLen > 0 && d->gap < darr_len(d));
+
+    Writer *w = writer_open(path, 1024);
+    TEST_ASSERT_TRUE(writer_darr(w, d));
+    int exp[4999];
+    memcpy(exp, items, 2500 * sizeof(int));
+    memcpy(exp + 2500, items + 2501, 2499 * sizeof(int));
+    checkFile(w, path, (char*)exp, sizeof(exp));
+    darr_free(d);
+}
+
+void test_writer_error(void) {
+    // Writes to a closed pipe fail and stay failed
+    int fds[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(fds));
+    close(fds[0]);
+    void (*handler)(int) = signal(SIGPIPE, SIG_IGN);
+
+    Writer *w = writer_new(fds[1], 8);
+    TEST_ASSERT_TRUE(writer_write(w, "1234", 4));
+    TEST_ASSERT_FALSE(writer_flush(w));
+    TEST_ASSERT_TRUE(writer_error(w));
+    TEST_ASSERT_FALSE(writer_write(w, "1", 1));
+    TEST_ASSERT_FALSE(writer_sync(w));
+    writer_free(w);
+
+    signal(SIGPIPE, handler);
+    TEST_ASSERT_EQUAL_INT(0, close(fds[1]));
+    TEST_ASSERT_TRUE(writer_error(NULL));
+    TEST_ASSERT_FALSE(writer_flush(NULL));
+    writer_free(NULL);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_writer_darr);
+    RUN_TEST(test_writer_error);
+    RUN_TEST(test_writer_numbers);
+    RUN_TEST(test_writer_write);
+
+    return UNITY_END();
+}
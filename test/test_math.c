@@ -4,9 +4,22 @@
     Description : Mathematical utility functions and macros.
 */
 
+#include <stdint.h>
+
 #include "math.h"
 #include "unity.h"
 
+#define TOP ((size_t)1 << (MATH_SIZE_BITS - 1))
+
+/**
+ * @brief Reference next power of 2 (0 on overflow).
+ */
+static size_t refNextPow2(size_t x) {
+    size_t p = 1;
+    while (p < x) { if (p == TOP) return 0; p <<= 1; }
+    return p;
+}
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -42,11 +55,78 @@ void test_math_min(void) {
     TEST_ASSERT_EQUAL_FLOAT(5.0f, math_min(5.0f, 5.0f));      // Testing with equal values
 }
 
+void test_math_clz(void) {
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS, math_clz(0));
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS - 1, math_clz(1));
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS - 4, math_clz(15));
+    TEST_ASSERT_EQUAL_INT(0, math_clz(TOP));
+    TEST_ASSERT_EQUAL_INT(0, math_clz(SIZE_MAX));
+    for (int i = 0; i < MATH_SIZE_BITS; i++) 
+        TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS - 1 - i, math_clz((size_t)1 << i));
+}
+
+void test_math_ctz(void) {
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS, math_ctz(0));
+    TEST_ASSERT_EQUAL_INT(0, math_ctz(1));
+    TEST_ASSERT_EQUAL_INT(3, math_ctz(24));
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS - 1, math_ctz(TOP));
+    for (int i = 0; i < MATH_SIZE_BITS; i++) TEST_ASSERT_EQUAL_INT(i, math_ctz(SIZE_MAX << i));
+}
+
+void test_math_ilog2(void) {
+    TEST_ASSERT_EQUAL_INT(-1, math_ilog2(0));
+    TEST_ASSERT_EQUAL_INT(0, math_ilog2(1));
+    TEST_ASSERT_EQUAL_INT(1, math_ilog2(3));
+    TEST_ASSERT_EQUAL_INT(10, math_ilog2(1024));
+    TEST_ASSERT_EQUAL_INT(10, math_ilog2(2047));
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS - 1, math_ilog2(SIZE_MAX));
+}
+
+void test_math_isPow2(void) {
+    TEST_ASSERT_FALSE(math_isPow2(0));
+    TEST_ASSERT_TRUE(math_isPow2(1));
+    TEST_ASSERT_TRUE(math_isPow2(64));
+    TEST_ASSERT_FALSE(math_isPow2(65));
+    TEST_ASSERT_TRUE(math_isPow2(TOP));
+    TEST_ASSERT_FALSE(math_isPow2(SIZE_MAX));
+}
+
+void test_math_nextPow2(void) {
+    TEST_ASSERT_EQUAL_UINT64(1, math_nextPow2(0));
+    TEST_ASSERT_EQUAL_UINT64(1, math_nextPow2(1));
+    TEST_ASSERT_EQUAL_UINT64(2, math_nextPow2(2));
+    TEST_ASSERT_EQUAL_UINT64(4, math_nextPow2(3));
+    TEST_ASSERT_EQUAL_UINT64(16, math_nextPow2(10));
+    TEST_ASSERT_EQUAL_UINT64(1024, math_nextPow2(1024));
+    TEST_ASSERT_EQUAL_UINT64(2048, math_nextPow2(1025));
+    for (size_t x = 0; x < 5000; x++) TEST_ASSERT_EQUAL_UINT64(refNextPow2(x), math_nextPow2(x));
+
+    // Overflow
+    TEST_ASSERT_EQUAL_UINT64(TOP, math_nextPow2(TOP));
+    TEST_ASSERT_EQUAL_UINT64(TOP, math_nextPow2(TOP - 1));
+    TEST_ASSERT_EQUAL_UINT64(0, math_nextPow2(TOP + 1));
+    TEST_ASSERT_EQUAL_UINT64(0, math_nextPow2(SIZE_MAX));
+}
+
+void test_math_popcount(void) {
+    TEST_ASSERT_EQUAL_INT(0, math_popcount(0));
+    TEST_ASSERT_EQUAL_INT(1, math_popcount(1));
+    TEST_ASSERT_EQUAL_INT(4, math_popcount(0xF0));
+    TEST_ASSERT_EQUAL_INT(1, math_popcount(TOP));
+    TEST_ASSERT_EQUAL_INT(MATH_SIZE_BITS, math_popcount(SIZE_MAX));
+}
+
 int main(void) {
     UNITY_BEGIN();
 
+    RUN_TEST(test_math_clz);
+    RUN_TEST(test_math_ctz);
+    RUN_TEST(test_math_ilog2);
+    RUN_TEST(test_math_isPow2);
     RUN_TEST(test_math_max);
     RUN_TEST(test_math_min);
+    RUN_TEST(test_math_nextPow2);
+    RUN_TEST(test_math_popcount);
 
     return UNITY_END();
 }
@@ -4,9 +4,15 @@
     Description : Dynamic memory management operations.
 */
 
+#include <pthread.h>
+#include <string.h>
+
+#include "alloc.h"
 #include "mem.h"
 #include "unity.h"
 
+#define THREAD_ALLOCS 1000
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -43,34 +49,225 @@ void test_mem_realloc(void) {
     void *mem = NULL;
 
     // Test realloc with NULL and size 0
-    mem = mem_realloc(mem, 0);
+    mem = mem_realloc(mem, 0, 0);
     TEST_ASSERT_NULL(mem);
 
     // Test realloc with NULL and valid size (acts like malloc)
-    mem = mem_realloc(NULL, 10);
+    mem = mem_realloc(NULL, 0, 10);
     TEST_ASSERT_NOT_NULL(mem);
     free(mem);
 
     // Test realloc with a valid block
     mem = mem_alloc(10);
     TEST_ASSERT_NOT_NULL(mem);
-    mem = mem_realloc(mem, 20);
+    mem = mem_realloc(mem, 10, 20);
     TEST_ASSERT_NOT_NULL(mem);
     free(mem);
 
     // Test realloc with size 0 on a valid block
     mem = mem_alloc(10);
     TEST_ASSERT_NOT_NULL(mem);
-    mem = mem_realloc(mem, 0);
+    mem = mem_realloc(mem, 10, 0);
     TEST_ASSERT_NULL(mem);
 }
 
+/**
+ * @brief Allocator callbacks that count the calls in `ctx` (size_t[3]: alloc, realloc, free).
+ */
+static void *countingAlloc(void *ctx, size_t size) { ((size_t*)ctx)[0]++; return malloc(size); }
+
+static void *countingRealloc(void *ctx, void *p, size_t oldSize, size_t newSize) {
+    (void)oldSize;
+    ((size_t*)ctx)[1]++;
+    return realloc(p, newSize);
+}
+
+static void countingFree(void *ctx, void *p, size_t size) { (void)size; ((size_t*)ctx)[2]++; free(p); }
+
+void test_mem_setAllocator(void) {
+    size_t calls[3] = { 0, 0, 0 };
+    Allocator counting = { countingAlloc, countingRealloc, countingFree, calls };
+
+    // System allocator by default
+    TEST_ASSERT_EQUAL_PTR(mem_systemAllocator(), mem_getAllocator());
+
+    // mem_* functions use the default allocator
+    mem_setAllocator(&counting);
+    TEST_ASSERT_EQUAL_PTR(&counting, mem_getAllocator());
+    int *p = (int*)mem_calloc(4, sizeof(int));
+    for (int i = 0; i < 4; i++) TEST_ASSERT_EQUAL_INT(0, p[i]);
+    p = (int*)mem_realloc(p, 4 * sizeof(int), 8 * sizeof(int));
+    mem_free(p, 8 * sizeof(int));
+    mem_free(mem_alloc(10), 10);
+    mem_free(NULL, 0);
+    TEST_ASSERT_EQUAL_INT(2, calls[0]);
+    TEST_ASSERT_EQUAL_INT(1, calls[1]);
+    TEST_ASSERT_EQUAL_INT(2, calls[2]);
+
+    // NULL restores the system allocator
+    mem_setAllocator(NULL);
+    TEST_ASSERT_EQUAL_PTR(mem_systemAllocator(), mem_getAllocator());
+    mem_free(mem_alloc(10), 10);
+    TEST_ASSERT_EQUAL_INT(2, calls[0]);
+
+    // Explicit allocators
+    p = (int*)mem_allocWith(&counting, sizeof(int));
+    p = (int*)mem_reallocWith(&counting, p, sizeof(int), 2 * sizeof(int));
+    TEST_ASSERT_NULL(mem_reallocWith(&counting, p, 2 * sizeof(int), 0));
+    mem_freeWith(&counting, p, 2 * sizeof(int));
+    TEST_ASSERT_NULL(mem_allocWith(&counting, 0));
+    TEST_ASSERT_EQUAL_INT(3, calls[0]);
+    TEST_ASSERT_EQUAL_INT(2, calls[1]);
+    TEST_ASSERT_EQUAL_INT(3, calls[2]);
+
+    // Small objects come from the allocator, or from the small object pools for the system one
+    p = (int*)mem_allocObject(&counting, sizeof(int));
+    TEST_ASSERT_NOT_NULL(p);
+    mem_freeObject(&counting, p, sizeof(int));
+    TEST_ASSERT_EQUAL_INT(4, calls[0]);
+    TEST_ASSERT_EQUAL_INT(4, calls[2]);
+    p = (int*)mem_allocObject(mem_systemAllocator(), sizeof(int));
+    mem_freeObject(mem_systemAllocator(), p, sizeof(int));
+    TEST_ASSERT_TRUE(p == mem_allocObject(mem_systemAllocator(), sizeof(int)));
+    mem_freeObject(mem_systemAllocator(), p, sizeof(int));
+    mem_freeObject(&counting, NULL, sizeof(int));
+}
+
+/**
+ * @brief Thread body allocating and freeing THREAD_ALLOCS blocks of 100 bytes.
+ */
+static void *allocThread(void *arg) {
+    (void)arg;
+    for (int i = 0; i < THREAD_ALLOCS; i++) mem_free(mem_alloc(100), 100);
+    return NULL;
+}
+
+static void *freeThread(void *arg) {
+    mem_free(arg, MEM_STATS_PEAK_STEP);
+    return NULL;
+}
+
+void test_mem_stats(void) {
+    TEST_ASSERT_FALSE(mem_statsEnabled());
+    mem_enableStats(true);
+    mem_resetStats();
+    TEST_ASSERT_TRUE(mem_statsEnabled());
+    size_t live = mem_getStats().liveBytes;
+
+    // Allocations, reallocations and frees
+    char *p = (char*)mem_alloc(10);
+    char *q = (char*)mem_calloc(10, 100);
+    p = (char*)mem_realloc(p, 10, 20);
+    MemStats s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(2, s.allocs);
+    TEST_ASSERT_EQUAL_INT(1, s.reallocs);
+    TEST_ASSERT_EQUAL_INT(0, s.frees);
+    TEST_ASSERT_EQUAL_INT(live + 20 + 1000, s.liveBytes);
+    TEST_ASSERT_EQUAL_INT(1, s.sizeClasses[0]); // 10
+    TEST_ASSERT_EQUAL_INT(1, s.sizeClasses[1]); // 20 (16, 32]
+    TEST_ASSERT_EQUAL_INT(1, s.sizeClasses[6]); // 1000 (512, 1024]
+
+    mem_free(q, 1000);
+    mem_free(p, 20);
+    s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(2, s.frees);
+    TEST_ASSERT_EQUAL_INT(live, s.liveBytes);
+    TEST_ASSERT_EQUAL_INT(live + 20 + 1000, s.peakBytes);
+
+    // Reallocations that move the memory record the bytes copied
+    size_t copied = mem_getStats().reallocBytesCopied;
+    p = (char*)mem_alloc(16);
+    q = (char*)mem_alloc(16);
+    char *r = (char*)mem_realloc(p, 16, 1 << 20);
+    s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(copied + (r != p ? 16 : 0), s.reallocBytesCopied);
+    TEST_ASSERT_EQUAL_INT(1, s.sizeClasses[16]); // 2^20
+    mem_free(r, 1 << 20);
+    mem_free(q, 16);
+
+    // AllocBlock resizes are covered (its header comes from a pool slab, counted on first use)
+    alloc_free(alloc_new(0, ALLOC_STRAT_BUDDY));
+    live = mem_getStats().liveBytes;
+    mem_resetStats();
+    AllocBlock *b = alloc_new(0, ALLOC_STRAT_BUDDY);
+    for (int i = 0; i < 100; i++) alloc_append(b, &i, sizeof(i));
+    s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(1, s.allocs);
+    TEST_ASSERT_TRUE(s.reallocs > 0);
+    TEST_ASSERT_EQUAL_INT(live + 512, s.liveBytes);
+    alloc_free(b);
+    TEST_ASSERT_EQUAL_INT(live, mem_getStats().liveBytes);
+
+    // Counters of other threads are merged, including exited threads
+    mem_resetStats();
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], NULL, allocThread, NULL);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(4 * THREAD_ALLOCS, s.allocs);
+    TEST_ASSERT_EQUAL_INT(4 * THREAD_ALLOCS, s.frees);
+    TEST_ASSERT_EQUAL_INT(4 * THREAD_ALLOCS, s.sizeClasses[3]);
+    TEST_ASSERT_EQUAL_INT(live, s.liveBytes);
+
+    // Memory freed by another thread than the one that allocated it
+    p = (char*)mem_alloc(MEM_STATS_PEAK_STEP);
+    pthread_create(&threads[0], NULL, freeThread, p);
+    pthread_join(threads[0], NULL);
+    TEST_ASSERT_EQUAL_INT(live, mem_getStats().liveBytes);
+
+    // The peak is sampled by threads growing by a step, without a read at the top
+    mem_resetStats();
+    p = (char*)mem_alloc(MEM_STATS_PEAK_STEP);
+    mem_free(p, MEM_STATS_PEAK_STEP);
+    s = mem_getStats();
+    TEST_ASSERT_EQUAL_INT(live, s.liveBytes);
+    TEST_ASSERT_EQUAL_INT(live + MEM_STATS_PEAK_STEP, s.peakBytes);
+
+    // Disabled statistics are kept but not updated
+    mem_enableStats(false);
+    mem_free(mem_alloc(10), 10);
+    TEST_ASSERT_EQUAL_INT(1, mem_getStats().allocs);
+}
+
+void test_mem_dumpStats(void) {
+    char buf[4096];
+    FILE *f = tmpfile();
+    TEST_ASSERT_NOT_NULL(f);
+
+    TEST_ASSERT_FALSE(mem_dumpStats(NULL, MEM_STATS_TEXT));
+
+    TEST_ASSERT_TRUE(mem_dumpStats(f, MEM_STATS_TEXT));
+    rewind(f);
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[n] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(buf, "live bytes: "));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "realloc bytes copied: "));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "  <= 16: "));
+
+    rewind(f);
+    TEST_ASSERT_TRUE(mem_dumpStats(f, MEM_STATS_JSON));
+    long end = ftell(f);
+    rewind(f);
+    n = fread(buf, 1, (size_t)end, f);
+    buf[n] = '\0';
+    TEST_ASSERT_EQUAL_CHAR('{', buf[0]);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"peakBytes\":"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "{\"maxBytes\":16,\"count\":"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "{\"maxBytes\":null,\"count\":"));
+    TEST_ASSERT_EQUAL_STRING("]}\n", buf + n - 3);
+
+    fclose(f);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(test_mem_alloc);
     RUN_TEST(test_mem_calloc);
+    RUN_TEST(test_mem_dumpStats);
     RUN_TEST(test_mem_realloc);
+    RUN_TEST(test_mem_setAllocator);
+    RUN_TEST(test_mem_stats);
 
     return UNITY_END();
 }
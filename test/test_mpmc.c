@@ -0,0 +1,179 @@
+/*
+    File        : test_mpmc.c
+    Description : Bounded lock-free queue of items of any single type shared by any number of
+                  producer and consumer threads, with blocking variants waiting on futexes.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "mpmc.h"
+#include "unity.h"
+
+#define SI sizeof(int)
+#define THREADS 4
+#define ITEMS_PER_PRODUCER 100000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Item of the threaded test: producer and its sequence number
+typedef struct {
+    int producer, n;
+} Item;
+
+typedef struct {
+    Mpmc *q;
+    int id;
+    size_t count; // Items popped (consumers)
+    long long sum; // Sum of the sequence numbers popped (consumers)
+    bool ordered; // Items of each producer popped in order (consumers)
+} Worker;
+
+static void *produce(void *arg) {
+    Worker *w = (Worker*)arg;
+    for (int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        Item item = { w->id, i };
+        if (!mpmc_push(w->q, &item)) return NULL;
+    }
+    return NULL;
+}
+
+static void *consume(void *arg) {
+    Worker *w = (Worker*)arg;
+    int last[THREADS];
+    for (int i = 0; i < THREADS; i++) last[i] = -1;
+    Item item;
+    while (mpmc_pop(w->q, &item)) {
+        w->ordered &= item.n > last[item.producer];
+        last[item.producer] = item.n;
+        w->sum += item.n;
+        w->count++;
+    }
+    return NULL;
+}
+
+static void *popOne(void *arg) {
+    int item;
+    return mpmc_pop((Mpmc*)arg, &item) ? NULL : arg;
+}
+
+void test_mpmc_close(void) {
+    Mpmc *q = mpmc_new(4, SI);
+    int i = 1, out;
+    TEST_ASSERT_TRUE(mpmc_push(q, &i));
+    mpmc_close(q);
+
+    // Pushes fail, pops drain the queue then fail instead of blocking
+    TEST_ASSERT_FALSE(mpmc_push(q, &i));
+    TEST_ASSERT_FALSE(mpmc_tryPush(q, &i));
+    TEST_ASSERT_TRUE(mpmc_pop(q, &out));
+    TEST_ASSERT_EQUAL_INT(1, out);
+    TEST_ASSERT_FALSE(mpmc_pop(q, &out));
+    mpmc_free(q);
+    mpmc_close(NULL);
+}
+
+void test_mpmc_new(void) {
+    Mpmc *q = mpmc_new(0, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EQUAL_INT(MPMC_MIN_SIZE, mpmc_size(q));
+    TEST_ASSERT_EQUAL_INT(0, mpmc_len(q));
+    mpmc_free(q);
+
+    // Sizes are powers of 2, slots keep the sequence numbers aligned
+    q = mpmc_new(100, 3);
+    TEST_ASSERT_EQUAL_INT(128, mpmc_size(q));
+    TEST_ASSERT_EQUAL_INT(2 * sizeof(size_t), q->stride);
+    TEST_ASSERT_TRUE((char*)&q->head - (char*)&q->tail >= MPMC_CACHE_LINE);
+    mpmc_free(q);
+
+    Arena *a = arena_new(0);
+    q = mpmc_newWith(arena_allocator(a), 4, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    mpmc_free(q);
+    arena_free(a);
+
+    TEST_ASSERT_NULL(mpmc_new(4, 0));
+    TEST_ASSERT_NULL(mpmc_new(SIZE_MAX, SI));
+    TEST_ASSERT_EQUAL_INT(0, mpmc_size(NULL));
+    mpmc_free(NULL);
+}
+
+void test_mpmc_threads(void) {
+    // Every item is popped once, those of each producer in order
+    Mpmc *q = mpmc_new(64, sizeof(Item));
+    pthread_t producers[THREADS], consumers[THREADS];
+    Worker p[THREADS], c[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        c[i] = (Worker){ q, i, 0, 0, true };
+        p[i] = (Worker){ q, i, 0, 0, true };
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&consumers[i], NULL, consume, &c[i]));
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&producers[i], NULL, produce, &p[i]));
+    }
+    for (int i = 0; i < THREADS; i++) TEST_ASSERT_EQUAL_INT(0, pthread_join(producers[i], NULL));
+    mpmc_close(q);
+
+    size_t count = 0;
+    long long sum = 0;
+    for (int i = 0; i < THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(consumers[i], NULL));
+        TEST_ASSERT_TRUE(c[i].ordered);
+        count += c[i].count;
+        sum += c[i].sum;
+    }
+    TEST_ASSERT_EQUAL_INT(THREADS * ITEMS_PER_PRODUCER, count);
+    TEST_ASSERT_TRUE(sum == (long long)THREADS * ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER - 1) / 2);
+    TEST_ASSERT_EQUAL_INT(0, mpmc_len(q));
+    mpmc_free(q);
+
+    // A push wakes a single blocked consumer, each woken one wakes the next for the items left
+    q = mpmc_new(THREADS, SI);
+    for (int i = 0; i < THREADS; i++)
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&consumers[i], NULL, popOne, q));
+    while (atomic_load(&q->popWaiters) < THREADS) sched_yield();
+    for (int i = 0; i < THREADS; i++) TEST_ASSERT_TRUE(mpmc_push(q, &i));
+    for (int i = 0; i < THREADS; i++) {
+        void *ret;
+        TEST_ASSERT_EQUAL_INT(0, pthread_join(consumers[i], &ret));
+        TEST_ASSERT_NULL(ret);
+    }
+    TEST_ASSERT_EQUAL_INT(0, mpmc_len(q));
+    mpmc_free(q);
+}
+
+void test_mpmc_tryPush(void) {
+    Mpmc *q = mpmc_new(4, SI);
+    int arr[] = { 1, 2, 3, 4, 5 }, out;
+
+    // Full and empty
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(mpmc_tryPush(q, &arr[i]));
+    TEST_ASSERT_FALSE(mpmc_tryPush(q, &arr[4]));
+    TEST_ASSERT_EQUAL_INT(4, mpmc_len(q));
+    TEST_ASSERT_TRUE(mpmc_tryPop(q, &out));
+    TEST_ASSERT_EQUAL_INT(1, out);
+
+    // Slots are reused on the next lap, in order
+    TEST_ASSERT_TRUE(mpmc_tryPush(q, &arr[4]));
+    for (int i = 1; i < 5; i++) {
+        TEST_ASSERT_TRUE(mpmc_tryPop(q, &out));
+        TEST_ASSERT_EQUAL_INT(arr[i], out);
+    }
+    TEST_ASSERT_FALSE(mpmc_tryPop(q, &out));
+    TEST_ASSERT_EQUAL_INT(0, mpmc_len(q));
+
+    TEST_ASSERT_FALSE(mpmc_tryPush(q, NULL));
+    TEST_ASSERT_FALSE(mpmc_tryPop(NULL, &out));
+    mpmc_free(q);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_mpmc_close);
+    RUN_TEST(test_mpmc_new);
+    RUN_TEST(test_mpmc_threads);
+    RUN_TEST(test_mpmc_tryPush);
+
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+/*
+    File        : test_scan.c
+    Description : Byte search kernels (first byte, first of a set, occurrence count) with SSE2, AVX2
+                  and AVX-512 implementations selected at runtime, and a scalar fallback.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan.h"
+#include "unity.h"
+
+#define BUFF_SIZE 600
+
+/**
+ * @brief Reference search for the first byte of a set.
+ */
+static const char *refAny(const char *s, size_t n, const char *set, size_t setLen) {
+    for (size_t i = 0; i < n; i++) if (memchr(set, s[i], setLen) != NULL) return s + i;
+    return NULL;
+}
+
+/**
+ * @brief Reference count of a byte.
+ */
+static size_t refCount(const char *s, size_t n, char c) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) count += s[i] == c;
+    return count;
+}
+
+/**
+ * @brief Check the marks of scan_mask against the reference search.
+ */
+static void checkMask(const char *s, size_t n, const char *set, size_t setLen) {
+    uint64_t masks[BUFF_SIZE / 64 + 1];
+    memset(masks, 0xAA, sizeof(masks));
+    scan_mask(s, n, set, setLen, masks);
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        uint64_t expected = 0;
+        for (size_t b = 0; b < 64 && w * 64 + b < n; b++)
+            if (memchr(set, s[w * 64 + b], setLen) != NULL) expected |= (uint64_t)1 << b;
+        TEST_ASSERT_EQUAL_HEX64(expected, masks[w]);
+    }
+}
+
+/**
+ * @brief Check the kernels of the current level against the references, at every offset and length
+ * of a buffer (so that heads and tails of each vector width are covered).
+ */
+static void checkLevel(void) {
+    char buff[BUFF_SIZE];
+    srand(42);
+    for (size_t i = 0; i < BUFF_SIZE; i++) buff[i] = (char)('a' + rand() % 26);
+    buff[BUFF_SIZE - 1] = '\n';
+    buff[300] = '\0';
+    buff[301] = (char)0xFF;
+
+    const char *sets[] = { "xyz", "\n,;\"", "0123456789ABCDEF", "q" };
+    for (size_t off = 0; off < 70; off++) {
+        for (size_t n = 0; off + n <= BUFF_SIZE; n += 1 + n / 8) {
+            const char *s = buff + off;
+            TEST_ASSERT_EQUAL_PTR(memchr(s, '\n', n), scan_byte(s, n, '\n'));
+            TEST_ASSERT_EQUAL_PTR(memchr(s, 'k', n), scan_byte(s, n, 'k'));
+            TEST_ASSERT_EQUAL_PTR(memchr(s, 0xFF, n), scan_byte(s, n, (char)0xFF));
+            TEST_ASSERT_EQUAL_INT(refCount(s, n, 'e'), scan_count(s, n, 'e'));
+            TEST_ASSERT_EQUAL_INT(refCount(s, n, '\0'), scan_count(s, n, '\0'));
+            for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); k++) {
+                size_t setLen = strlen(sets[k]);
+                const char *expected = refAny(s, n, sets[k], setLen);
+                TEST_ASSERT_EQUAL_PTR(expected, scan_any(s, n, sets[k], setLen));
+            }
+            TEST_ASSERT_EQUAL_PTR(refAny(s, n, "\0!", 2), scan_any(s, n, "\0!", 2));
+            for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); k++)
+                checkMask(s, n, sets[k], strlen(sets[k]));
+        }
+    }
+
+    // Counts beyond the byte counters of the vector kernels
+    size_t size = 1 << 20;
+    char *big = (char*)malloc(size);
+    memset(big, '\n', size);
+    TEST_ASSERT_EQUAL_INT(size, scan_count(big, size, '\n'));
+    TEST_ASSERT_EQUAL_INT(size - 1, scan_count(big + 1, size - 1, '\n'));
+    TEST_ASSERT_EQUAL_PTR(NULL, scan_byte(big, size, 'x'));
+    big[size - 3] = 'x';
+    TEST_ASSERT_EQUAL_PTR(big + size - 3, scan_byte(big, size, 'x'));
+    TEST_ASSERT_EQUAL_PTR(big + size - 3, scan_any(big, size, "yx", 2));
+    free(big);
+}
+
+void setUp(void) {}
+void tearDown(void) { scan_setLevel(SCAN_AVX512); }
+
+void test_scan_level(void) {
+    ScanLevel best = scan_level();
+    TEST_ASSERT_EQUAL_INT(best, scan_setLevel(SCAN_AVX512));
+    TEST_ASSERT_EQUAL_INT(SCAN_SCALAR, scan_setLevel(SCAN_SCALAR));
+    TEST_ASSERT_EQUAL_INT(SCAN_SCALAR, scan_level());
+}
+
+void test_scan_kernels(void) {
+    // Every level supported by this CPU gives the same results
+    for (int level = SCAN_SCALAR; level <= SCAN_AVX512; level++) {
+        if (scan_setLevel((ScanLevel)level) != (ScanLevel)level) break;
+        checkLevel();
+    }
+
+    TEST_ASSERT_NULL(scan_byte(NULL, 10, 'a'));
+    TEST_ASSERT_NULL(scan_any("abc", 3, NULL, 2));
+    TEST_ASSERT_NULL(scan_any("abc", 3, "abc", 0));
+    TEST_ASSERT_EQUAL_INT(0, scan_count(NULL, 10, 'a'));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scan_level);
+    RUN_TEST(test_scan_kernels);
+
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+/*
+    File        : test_spsc.c
+    Description : Bounded lock-free ring buffer moving items of any single type from one producer
+                  thread to one consumer thread, in batches.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "spsc.h"
+#include "unity.h"
+
+#define SI sizeof(int)
+#define STRESS_ITEMS 1000000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Producer thread: pushes 0 to STRESS_ITEMS - 1 in batches of varying sizes.
+ */
+static void *produce(void *arg) {
+    Spsc *q = (Spsc*)arg;
+    int batch[13];
+    for (int next = 0, n = 1; next < STRESS_ITEMS; n = n % 13 + 1) {
+        int count = n < STRESS_ITEMS - next ? n : STRESS_ITEMS - next;
+        for (int i = 0; i < count; i++) batch[i] = next + i;
+        for (int done = 0; done < count;) {
+            size_t pushed = spsc_push(q, batch + done, (size_t)(count - done));
+            if (pushed == 0) sched_yield();
+            done += (int)pushed;
+        }
+        next += count;
+    }
+    return NULL;
+}
+
+void test_spsc_new(void) {
+    Spsc *q = spsc_new(0, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EQUAL_INT(SPSC_MIN_SIZE, spsc_size(q));
+    TEST_ASSERT_EQUAL_INT(0, spsc_len(q));
+    spsc_free(q);
+
+    // Sizes are powers of 2, the indices of the two threads are on different cache lines
+    q = spsc_new(1000, 24);
+    TEST_ASSERT_EQUAL_INT(1024, spsc_size(q));
+    TEST_ASSERT_TRUE((char*)&q->head - (char*)&q->tail >= SPSC_CACHE_LINE);
+    spsc_free(q);
+
+    Arena *a = arena_new(0);
+    q = spsc_newWith(arena_allocator(a), 4, SI);
+    TEST_ASSERT_NOT_NULL(q);
+    spsc_free(q);
+    arena_free(a);
+
+    TEST_ASSERT_NULL(spsc_new(4, 0));
+    TEST_ASSERT_NULL(spsc_new(SIZE_MAX, SI));
+    TEST_ASSERT_EQUAL_INT(0, spsc_size(NULL));
+    TEST_ASSERT_EQUAL_INT(0, spsc_len(NULL));
+    spsc_free(NULL);
+}
+
+void test_spsc_push(void) {
+    Spsc *q = spsc_new(8, SI);
+    int arr[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, out[10];
+
+    // Pushes stop when full, pops when empty
+    TEST_ASSERT_EQUAL_INT(6, spsc_push(q, arr, 6));
+    TEST_ASSERT_EQUAL_INT(2, spsc_push(q, arr + 6, 4));
+    TEST_ASSERT_EQUAL_INT(0, spsc_push(q, arr, 1));
+    TEST_ASSERT_EQUAL_INT(8, spsc_len(q));
+    TEST_ASSERT_EQUAL_INT(5, spsc_pop(q, out, 5));
+    TEST_ASSERT_EQUAL_INT_ARRAY(arr, out, 5);
+
+    // Batches wrapping at the end of the ring keep the order
+    TEST_ASSERT_EQUAL_INT(5, spsc_push(q, arr, 10));
+    TEST_ASSERT_EQUAL_INT(8, spsc_pop(q, out, 10));
+    int exp[] = { 6, 7, 8, 1, 2, 3, 4, 5 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(exp, out, 8);
+    TEST_ASSERT_EQUAL_INT(0, spsc_pop(q, out, 1));
+    TEST_ASSERT_EQUAL_INT(0, spsc_len(q));
+
+    TEST_ASSERT_EQUAL_INT(0, spsc_push(q, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(0, spsc_pop(q, NULL, 1));
+    TEST_ASSERT_EQUAL_INT(0, spsc_push(NULL, arr, 1));
+    spsc_free(q);
+}
+
+void test_spsc_threads(void) {
+    // Every item arrives once, in order
+    Spsc *q = spsc_new(64, SI);
+    pthread_t producer;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, produce, q));
+
+    int out[17], expected = 0;
+    bool ordered = true;
+    while (expected < STRESS_ITEMS) {
+        size_t n = spsc_pop(q, out, sizeof(out) / SI);
+        if (n == 0) sched_yield();
+        for (size_t i = 0; i < n; i++) ordered &= out[i] == expected++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, pthread_join(producer, NULL));
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_INT(0, spsc_len(q));
+    spsc_free(q);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_spsc_new);
+    RUN_TEST(test_spsc_push);
+    RUN_TEST(test_spsc_threads);
+
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+/*
+    File        : test_tpool.c
+    Description : Work-stealing thread pool running the parallel operations of the library: a
+                  Chase-Lev deque per worker, idle workers parked on a futex, and task groups to
+                  wait on.
+*/
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+
+#include "tpool.h"
+#include "unity.h"
+
+#define TASKS 20000
+#define WORKERS 4
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Range of the recursive sum, split in two subtasks down to a leaf size
+typedef struct {
+    TPool *pool;
+    const int *items;
+    size_t len;
+    long long sum;
+} Sum;
+
+static void count(void *arg) {
+    atomic_fetch_add_explicit((_Atomic int*)arg, 1, memory_order_relaxed);
+}
+
+static void cpus(void *arg) {
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) *(int*)arg = CPU_COUNT(&set);
+}
+
+static void sum(void *arg) {
+    Sum *s = (Sum*)arg;
+    if (s->len <= 64) {
+        for (size_t i = 0; i < s->len; i++) s->sum += s->items[i];
+        return;
+    }
+
+    // Submitted to the deque of the worker, the other half stays on this thread
+    Sum left = { s->pool, s->items, s->len / 2, 0 };
+    Sum right = { s->pool, s->items + left.len, s->len - left.len, 0 };
+    TPoolGroup g;
+    tpool_groupInit(&g);
+    if (!tpool_submit(s->pool, &g, sum, &left)) sum(&left);
+    sum(&right);
+    tpool_wait(s->pool, &g);
+    s->sum = left.sum + right.sum;
+}
+
+void test_tpool_new(void) {
+    TPool *p = tpool_new(WORKERS, false);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_INT(WORKERS, tpool_workers(p));
+    TEST_ASSERT_TRUE((char*)&p->workers[0].bottom - (char*)&p->workers[0].top >= TPOOL_CACHE_LINE);
+    tpool_free(p);
+
+    // One worker per CPU, pinned to one of the CPUs the process may run on
+    p = tpool_new(0, true);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE(tpool_workers(p) >= 1);
+    _Atomic int n = 0;
+    int pinned = 0;
+    TPoolGroup g;
+    tpool_groupInit(&g);
+    TEST_ASSERT_TRUE(tpool_submit(p, &g, count, &n));
+    TEST_ASSERT_TRUE(tpool_submit(p, &g, cpus, &pinned));
+    tpool_wait(p, &g);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_INT(1, pinned);
+    tpool_free(p);
+
+    // The default pool is shared and never freed
+    TEST_ASSERT_NOT_NULL(tpool_default());
+    TEST_ASSERT_TRUE(tpool_default() == tpool_default());
+    tpool_free(tpool_default());
+    TEST_ASSERT_TRUE(tpool_workers(tpool_default()) >= 1);
+
+    TEST_ASSERT_EQUAL_INT(0, tpool_workers(NULL));
+    tpool_free(NULL);
+}
+
+void test_tpool_submit(void) {
+    TPool *p = tpool_new(WORKERS, false);
+    _Atomic int n = 0, other = 0;
+
+    // More tasks than the queue shared by the workers holds
+    TPoolGroup g, h;
+    tpool_groupInit(&g);
+    tpool_groupInit(&h);
+    for (int i = 0; i < TASKS; i++) {
+        TEST_ASSERT_TRUE(tpool_submit(p, &g, count, &n));
+        if (i % 4 == 0) TEST_ASSERT_TRUE(tpool_submit(p, &h, count, &other));
+    }
+    tpool_wait(p, &g);
+    TEST_ASSERT_EQUAL_INT(TASKS, n);
+    tpool_wait(p, &h);
+    TEST_ASSERT_EQUAL_INT(TASKS / 4, other);
+
+    // Waiting for an empty group returns at once
+    tpool_wait(p, &g);
+
+    // Tasks without a group are run before the pool is freed
+    for (int i = 0; i < 100; i++) TEST_ASSERT_TRUE(tpool_submit(p, NULL, count, &n));
+    tpool_free(p);
+    TEST_ASSERT_EQUAL_INT(TASKS + 100, n);
+
+    TEST_ASSERT_FALSE(tpool_submit(NULL, NULL, count, &n));
+    p = tpool_new(1, false);
+    TEST_ASSERT_FALSE(tpool_submit(p, NULL, NULL, NULL));
+    tpool_wait(p, NULL);
+    tpool_free(p);
+}
+
+void test_tpool_wait(void) {
+    // Tasks submit and wait for subtasks (deques grow past their initial size)
+    size_t len = 1 << 18;
+    int *items = malloc(len * sizeof(int));
+    long long expected = 0;
+    for (size_t i = 0; i < len; i++) {
+        items[i] = (int)(i % 1000);
+        expected += items[i];
+    }
+
+    TPool *p = tpool_new(WORKERS, false);
+    Sum s = { p, items, len, 0 };
+    TPoolGroup g;
+    tpool_groupInit(&g);
+    TEST_ASSERT_TRUE(tpool_submit(p, &g, sum, &s));
+    tpool_wait(p, &g);
+    TEST_ASSERT_TRUE(s.sum == expected);
+
+    // From outside the pool, the waiting thread runs tasks too
+    s.sum = 0;
+    sum(&s);
+    TEST_ASSERT_TRUE(s.sum == expected);
+    tpool_free(p);
+
+    // A single worker must not deadlock on nested waits
+    p = tpool_new(1, false);
+    s = (Sum){ p, items, len, 0 };
+    TEST_ASSERT_TRUE(tpool_submit(p, &g, sum, &s));
+    tpool_wait(p, &g);
+    TEST_ASSERT_TRUE(s.sum == expected);
+    tpool_free(p);
+    free(items);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_tpool_new);
+    RUN_TEST(test_tpool_submit);
+    RUN_TEST(test_tpool_wait);
+
+    return UNITY_END();
+}